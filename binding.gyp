@@ -13,13 +13,19 @@
         "src/parser.c",
       ],
       "variables": {
-        "has_scanner": "<!(node -p \"fs.existsSync('src/scanner.c')\")"
+        "has_scanner": "<!(node -p \"fs.existsSync('src/scanner.c')\")",
+        # Opt-in release build of the parser: ASCIIDOC_RELEASE=1 adds -O3 and LTO, and
+        # ASCIIDOC_PGO_PROFILE names a clang .profdata from `make pgo-profile CC=clang`.
+        "asciidoc_release": "<!(node -p \"process.env.ASCIIDOC_RELEASE || ''\")",
+        "asciidoc_pgo_profile": "<!(node -p \"process.env.ASCIIDOC_PGO_PROFILE || ''\")",
       },
       "conditions": [
         ["has_scanner=='true'", {
           "sources+": ["src/scanner.c"],
         }],
         ["OS!='win'", {
+          "sources+": ["bindings/c/mapping.c"],
+          "include_dirs+": ["bindings/c"],
           "cflags_c": [
             "-std=c11",
           ],
@@ -32,6 +38,20 @@
             "/STACK:8388608",  # 8MB stack (default is 1MB)
           ],
         }],
+        ["OS!='win' and asciidoc_release!=''", {
+          "cflags_c+": ["-O3", "-flto"],
+          "ldflags+": ["-O3", "-flto"],
+          "xcode_settings": {
+            "GCC_OPTIMIZATION_LEVEL": "3",
+            "LLVM_LTO": "YES",
+          },
+        }],
+        ["OS!='win' and asciidoc_pgo_profile!=''", {
+          "cflags_c+": ["-fprofile-use=<(asciidoc_pgo_profile)", "-Wno-profile-instr-unprofiled"],
+          "xcode_settings": {
+            "OTHER_CFLAGS+": ["-fprofile-use=<(asciidoc_pgo_profile)"],
+          },
+        }],
       ],
     }
   ]
@@ -0,0 +1,316 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tree_sitter/tree-sitter-asciidoc-chunked.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "split.h"
+#include "tree_sitter/array.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+#ifndef ASCIIDOC_CHUNK_MIN_BYTES
+#define ASCIIDOC_CHUNK_MIN_BYTES (1u << 20)
+#endif
+
+typedef struct {
+  TSAsciidocChunkedParser *owner;
+  TSParser *parser;
+} Worker;
+
+struct TSAsciidocChunkedParser {
+  uint32_t min_chunk_bytes;
+  Array(uint32_t) split_points;
+  Array(uint32_t) split_rows;
+  SplitScanner scanner;
+  TSPoint end_point;
+
+  // Workers [0, thread_count) run on their own threads during a parse; the
+  // last one is the calling thread's. Parsers are kept between parses.
+  Worker *workers;
+  uint32_t thread_count;
+
+  pthread_mutex_t mutex;
+  const char *source;
+  uint32_t length;
+  TSAsciidocChunk *chunks;
+  Array(uint32_t) jobs;
+  uint32_t next_job;
+};
+
+struct TSAsciidocChunkedTree {
+  TSAsciidocChunk *chunks;
+  uint32_t chunk_count;
+  // Named top-level blocks before each chunk, and the total at the end.
+  uint32_t *child_offsets;
+};
+
+// Records the split points of `source` and the point at its end.
+static void prescan(TSAsciidocChunkedParser *self, const char *source, uint32_t length) {
+  array_clear(&self->split_points);
+  array_clear(&self->split_rows);
+  split_scanner_reset(&self->scanner);
+  uint32_t start = 0;
+  while (start < length) {
+    const char *newline = memchr(source + start, '\n', length - start);
+    uint32_t end = newline ? (uint32_t)(newline - source) : length;
+    uint32_t split, row;
+    if (split_scanner_line(&self->scanner, source + start, end - start, start, &split, &row)) {
+      array_push(&self->split_points, split);
+      array_push(&self->split_rows, row);
+    }
+    if (!newline) {
+      self->end_point = (TSPoint){self->scanner.row - 1, end - start};
+      return;
+    }
+    start = end + 1;
+  }
+  self->end_point = (TSPoint){self->scanner.row, 0};
+}
+
+TSAsciidocChunkedParser *ts_asciidoc_chunked_parser_new(uint32_t thread_count) {
+  const TSLanguage *language = tree_sitter_asciidoc();
+  TSAsciidocChunkedParser *self = calloc(1, sizeof(TSAsciidocChunkedParser));
+  self->min_chunk_bytes = ASCIIDOC_CHUNK_MIN_BYTES;
+  self->thread_count = thread_count;
+  self->workers = calloc(thread_count + 1, sizeof(Worker));
+  for (uint32_t i = 0; i <= thread_count; i++) {
+    self->workers[i].owner = self;
+    self->workers[i].parser = ts_parser_new();
+    ts_parser_set_language(self->workers[i].parser, language);
+  }
+  pthread_mutex_init(&self->mutex, NULL);
+  return self;
+}
+
+void ts_asciidoc_chunked_parser_delete(TSAsciidocChunkedParser *self) {
+  if (!self) {
+    return;
+  }
+  for (uint32_t i = 0; i <= self->thread_count; i++) {
+    ts_parser_delete(self->workers[i].parser);
+  }
+  free(self->workers);
+  pthread_mutex_destroy(&self->mutex);
+  array_delete(&self->split_points);
+  array_delete(&self->split_rows);
+  split_scanner_delete(&self->scanner);
+  array_delete(&self->jobs);
+  free(self);
+}
+
+void ts_asciidoc_chunked_parser_set_min_chunk_bytes(TSAsciidocChunkedParser *self,
+                                                    uint32_t bytes) {
+  self->min_chunk_bytes = bytes > 0 ? bytes : 1;
+}
+
+const uint32_t *ts_asciidoc_chunked_parser_split_points(TSAsciidocChunkedParser *self,
+                                                        const char *source, uint32_t length,
+                                                        uint32_t *count) {
+  prescan(self, source, length);
+  *count = self->split_points.size;
+  return self->split_points.contents;
+}
+
+static void parse_chunk(Worker *worker, TSAsciidocChunk *chunk) {
+  TSAsciidocChunkedParser *self = worker->owner;
+  TSRange range = {chunk->start_point, chunk->end_point, chunk->start_byte, chunk->end_byte};
+  ts_parser_set_included_ranges(worker->parser, &range, 1);
+  chunk->tree = ts_parser_parse_string(worker->parser, NULL, self->source, self->length);
+}
+
+static void *worker_main(void *payload) {
+  Worker *worker = payload;
+  TSAsciidocChunkedParser *self = worker->owner;
+  pthread_mutex_lock(&self->mutex);
+  while (self->next_job < self->jobs.size) {
+    TSAsciidocChunk *chunk = &self->chunks[self->jobs.contents[self->next_job++]];
+    pthread_mutex_unlock(&self->mutex);
+    parse_chunk(worker, chunk);
+    pthread_mutex_lock(&self->mutex);
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return NULL;
+}
+
+static uint32_t chunk_size(const TSAsciidocChunk *chunk) {
+  return chunk->end_byte - chunk->start_byte;
+}
+
+// Largest chunks first, so that a large chunk does not start last and
+// leave the other workers idle. Insertion sort; chunks are few.
+static void sort_jobs(TSAsciidocChunkedParser *self) {
+  uint32_t *jobs = self->jobs.contents;
+  for (uint32_t i = 1; i < self->jobs.size; i++) {
+    uint32_t job = jobs[i];
+    uint32_t size = chunk_size(&self->chunks[job]);
+    uint32_t j = i;
+    while (j > 0 && chunk_size(&self->chunks[jobs[j - 1]]) < size) {
+      jobs[j] = jobs[j - 1];
+      j--;
+    }
+    jobs[j] = job;
+  }
+}
+
+TSAsciidocChunkedTree *ts_asciidoc_chunked_parser_parse(TSAsciidocChunkedParser *self,
+                                                        const char *source, uint32_t length) {
+  prescan(self, source, length);
+
+  // Every chunk but the last starts at a split point; the split points in
+  // between are skipped until the chunk is at least min_chunk_bytes long.
+  uint32_t chunk_count = 1;
+  uint32_t chunk_start = 0;
+  for (uint32_t i = 0; i < self->split_points.size; i++) {
+    if (self->split_points.contents[i] - chunk_start >= self->min_chunk_bytes) {
+      chunk_start = self->split_points.contents[i];
+      self->split_points.contents[chunk_count] = chunk_start;
+      self->split_rows.contents[chunk_count] = self->split_rows.contents[i];
+      chunk_count++;
+    }
+  }
+
+  TSAsciidocChunkedTree *tree = calloc(1, sizeof(TSAsciidocChunkedTree));
+  tree->chunk_count = chunk_count;
+  tree->chunks = calloc(chunk_count, sizeof(TSAsciidocChunk));
+  tree->child_offsets = calloc(chunk_count + 1, sizeof(uint32_t));
+  array_clear(&self->jobs);
+  for (uint32_t i = 0; i < chunk_count; i++) {
+    TSAsciidocChunk *chunk = &tree->chunks[i];
+    if (i > 0) {
+      chunk->start_byte = self->split_points.contents[i];
+      chunk->start_point = (TSPoint){self->split_rows.contents[i], 0};
+    }
+    if (i + 1 < chunk_count) {
+      chunk->end_byte = self->split_points.contents[i + 1];
+      chunk->end_point = (TSPoint){self->split_rows.contents[i + 1], 0};
+    } else {
+      chunk->end_byte = length;
+      chunk->end_point = self->end_point;
+    }
+    array_push(&self->jobs, i);
+  }
+  self->source = source;
+  self->length = length;
+  self->chunks = tree->chunks;
+  self->next_job = 0;
+  sort_jobs(self);
+
+  // Threads are started per parse: a document worth splitting takes far
+  // longer to parse than to start them.
+  uint32_t thread_count = self->thread_count < chunk_count - 1 ? self->thread_count
+                                                               : chunk_count - 1;
+  pthread_t *threads = calloc(thread_count + 1, sizeof(pthread_t));
+  uint32_t started = 0;
+  while (started < thread_count &&
+         pthread_create(&threads[started], NULL, worker_main, &self->workers[started]) == 0) {
+    started++;
+  }
+  worker_main(&self->workers[self->thread_count]);
+  for (uint32_t i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  free(threads);
+  self->source = NULL;
+  self->chunks = NULL;
+
+  for (uint32_t i = 0; i < chunk_count; i++) {
+    TSNode root = ts_tree_root_node(tree->chunks[i].tree);
+    tree->child_offsets[i + 1] = tree->child_offsets[i] + ts_node_named_child_count(root);
+  }
+  return tree;
+}
+
+void ts_asciidoc_chunked_tree_delete(TSAsciidocChunkedTree *self) {
+  if (!self) {
+    return;
+  }
+  for (uint32_t i = 0; i < self->chunk_count; i++) {
+    ts_tree_delete((TSTree *)self->chunks[i].tree);
+  }
+  free(self->chunks);
+  free(self->child_offsets);
+  free(self);
+}
+
+uint32_t ts_asciidoc_chunked_tree_chunk_count(const TSAsciidocChunkedTree *self) {
+  return self->chunk_count;
+}
+
+TSAsciidocChunk ts_asciidoc_chunked_tree_chunk(const TSAsciidocChunkedTree *self, uint32_t index) {
+  return self->chunks[index];
+}
+
+uint32_t ts_asciidoc_chunked_tree_chunk_for_byte(const TSAsciidocChunkedTree *self,
+                                                 uint32_t byte) {
+  uint32_t low = 0, high = self->chunk_count;
+  while (high - low > 1) {
+    uint32_t middle = low + (high - low) / 2;
+    if (self->chunks[middle].start_byte <= byte) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+uint32_t ts_asciidoc_chunked_tree_child_count(const TSAsciidocChunkedTree *self) {
+  return self->child_offsets[self->chunk_count];
+}
+
+TSNode ts_asciidoc_chunked_tree_child(const TSAsciidocChunkedTree *self, uint32_t index) {
+  uint32_t low = 0, high = self->chunk_count;
+  while (high - low > 1) {
+    uint32_t middle = low + (high - low) / 2;
+    if (self->child_offsets[middle] <= index) {
+      low = middle;
+    } else {
+      high = middle;
+    }
+  }
+  TSNode root = ts_tree_root_node(self->chunks[low].tree);
+  return ts_node_named_child(root, index - self->child_offsets[low]);
+}
+
+TSNode ts_asciidoc_chunked_tree_descendant_for_byte_range(const TSAsciidocChunkedTree *self,
+                                                          uint32_t start, uint32_t end) {
+  uint32_t index = ts_asciidoc_chunked_tree_chunk_for_byte(self, start);
+  const TSAsciidocChunk *chunk = &self->chunks[index];
+  TSNode root = ts_tree_root_node(chunk->tree);
+  if (end > chunk->end_byte) {
+    return root;
+  }
+  return ts_node_named_descendant_for_byte_range(root, start, end);
+}
+
+bool ts_asciidoc_chunked_tree_has_error(const TSAsciidocChunkedTree *self) {
+  for (uint32_t i = 0; i < self->chunk_count; i++) {
+    if (ts_node_has_error(ts_tree_root_node(self->chunks[i].tree))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+char *ts_asciidoc_chunked_tree_string(const TSAsciidocChunkedTree *self) {
+  Array(char) result = array_new();
+  for (uint32_t i = 0; i < self->chunk_count; i++) {
+    char *string = ts_node_string(ts_tree_root_node(self->chunks[i].tree));
+    size_t length = strlen(string);
+    // Keep the opening "(source_file" of the first chunk only, and drop the
+    // closing parenthesis of every chunk.
+    const char *children = string;
+    if (i > 0) {
+      children = strchr(string, ' ');
+      children = children ? children : string + length - 1;
+    }
+    array_extend(&result, (uint32_t)(string + length - 1 - children), children);
+    free(string);
+  }
+  array_push(&result, ')');
+  array_push(&result, '\0');
+  return result.contents;
+}
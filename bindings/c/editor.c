@@ -0,0 +1,63 @@
+#include "editor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+void editor_mark_symbols(const TSLanguage *language, uint8_t *flags, const char *const *names,
+                         uint8_t flag) {
+  uint32_t count = ts_language_symbol_count(language);
+  for (TSSymbol symbol = 0; symbol < count; symbol++) {
+    if (ts_language_symbol_type(language, symbol) != TSSymbolTypeRegular) {
+      continue;
+    }
+    const char *name = ts_language_symbol_name(language, symbol);
+    for (const char *const *candidate = names; *candidate; candidate++) {
+      if (strcmp(name, *candidate) == 0) {
+        flags[symbol] |= flag;
+      }
+    }
+  }
+}
+
+static int compare_ranges(const void *a, const void *b) {
+  const TSRange *x = a;
+  const TSRange *y = b;
+  return (x->start_byte > y->start_byte) - (x->start_byte < y->start_byte);
+}
+
+void editor_merge_ranges(RangeArray *ranges) {
+  if (ranges->size < 2) {
+    return;
+  }
+  qsort(ranges->contents, ranges->size, sizeof(TSRange), compare_ranges);
+  uint32_t write = 0;
+  for (uint32_t read = 1; read < ranges->size; read++) {
+    TSRange *last = &ranges->contents[write];
+    TSRange *next = &ranges->contents[read];
+    if (next->start_byte <= last->end_byte) {
+      if (next->end_byte > last->end_byte) {
+        last->end_byte = next->end_byte;
+      }
+    } else {
+      ranges->contents[++write] = *next;
+    }
+  }
+  ranges->size = write + 1;
+}
+
+void editor_edit_ranges(RangeArray *ranges, const TSInputEdit *edit) {
+  for (uint32_t i = 0; i < ranges->size; i++) {
+    TSRange *range = &ranges->contents[i];
+    if (range->start_byte > edit->old_end_byte) {
+      range->start_byte = range->start_byte - edit->old_end_byte + edit->new_end_byte;
+    } else if (range->start_byte > edit->start_byte) {
+      range->start_byte = edit->start_byte;
+    }
+    if (range->end_byte > edit->old_end_byte) {
+      range->end_byte = range->end_byte - edit->old_end_byte + edit->new_end_byte;
+    } else if (range->end_byte >= edit->start_byte) {
+      range->end_byte = edit->new_end_byte;
+    }
+  }
+  editor_add_range(ranges, edit->start_byte, edit->new_end_byte);
+}
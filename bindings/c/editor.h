@@ -0,0 +1,36 @@
+#ifndef TREE_SITTER_ASCIIDOC_EDITOR_H_
+#define TREE_SITTER_ASCIIDOC_EDITOR_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/array.h"
+
+// Helpers shared by the editor support library. Not installed.
+
+// Sets `flag` in flags[symbol] for every named symbol whose name is listed in
+// the NULL-terminated `names`. Every symbol is checked, because aliases can
+// give several symbols the same name.
+void editor_mark_symbols(const TSLanguage *language, uint8_t *flags, const char *const *names,
+                         uint8_t flag);
+
+typedef Array(TSRange) RangeArray;
+
+// Inclusive on both ends, so that nodes touching an edit are revisited.
+static inline bool editor_touches(uint32_t start, uint32_t end, uint32_t range_start,
+                                  uint32_t range_end) {
+  return start <= range_end && end >= range_start;
+}
+
+static inline void editor_add_range(RangeArray *ranges, uint32_t start, uint32_t end) {
+  array_push(ranges, ((TSRange){.start_byte = start, .end_byte = end}));
+}
+
+// Sorts byte ranges and merges the overlapping ones.
+void editor_merge_ranges(RangeArray *ranges);
+
+// Moves pending ranges for an edit and adds the edited range itself.
+void editor_edit_ranges(RangeArray *ranges, const TSInputEdit *edit);
+
+#endif // TREE_SITTER_ASCIIDOC_EDITOR_H_
@@ -0,0 +1,274 @@
+#include "tree_sitter/tree-sitter-asciidoc-fold.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "editor.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+enum {
+  SYMBOL_FOLD = 1 << 0,
+  // Nodes that cannot contain a fold; not searched for one.
+  SYMBOL_LEAF = 1 << 1,
+};
+
+// The node kinds captured by queries/folds.scm.
+static const char *const FOLD_SYMBOLS[] = {
+  "document_header",   "section_level_2",   "section_level_3",     "section_level_4",
+  "section_level_5",   "section_level_6",   "unordered_list",      "ordered_list",
+  "description_list",  "callout_list",      "example_block",       "listing_block",
+  "fenced_code_block", "block_quote",       "asciidoc_blockquote", "literal_block",
+  "sidebar_block",     "passthrough_block", "open_block",          "table_block",
+  "conditional_block", "ifdef_block",       "ifndef_block",        "ifeval_block",
+  NULL,
+};
+
+static const char *const LEAF_SYMBOLS[] = {
+  "paragraph",      "block_content", "fenced_code_block_content", "title",
+  "attribute_entry", "comment",      "block_title",               "block_attributes",
+  NULL,
+};
+
+typedef Array(TSAsciidocFold) FoldArray;
+
+struct TSAsciidocFolds {
+  uint8_t *symbol_flags;
+  uint32_t symbol_count;
+
+  FoldArray folds;
+  FoldArray added;
+  FoldArray removed;
+
+  // Ranges invalidated by edits since the last update, in new-tree bytes.
+  RangeArray pending;
+  RangeArray changed;
+  FoldArray scratch;
+};
+
+static uint8_t symbol_flags(const TSAsciidocFolds *self, TSSymbol symbol) {
+  return symbol < self->symbol_count ? self->symbol_flags[symbol] : 0;
+}
+
+TSAsciidocFolds *ts_asciidoc_folds_new(void) {
+  const TSLanguage *language = tree_sitter_asciidoc();
+  TSAsciidocFolds *self = calloc(1, sizeof(TSAsciidocFolds));
+  self->symbol_count = ts_language_symbol_count(language);
+  self->symbol_flags = calloc(self->symbol_count, 1);
+  editor_mark_symbols(language, self->symbol_flags, FOLD_SYMBOLS, SYMBOL_FOLD);
+  editor_mark_symbols(language, self->symbol_flags, LEAF_SYMBOLS, SYMBOL_LEAF);
+  return self;
+}
+
+void ts_asciidoc_folds_delete(TSAsciidocFolds *self) {
+  if (!self) {
+    return;
+  }
+  array_delete(&self->folds);
+  array_delete(&self->added);
+  array_delete(&self->removed);
+  array_delete(&self->pending);
+  array_delete(&self->changed);
+  array_delete(&self->scratch);
+  free(self->symbol_flags);
+  free(self);
+}
+
+// Moves a fold boundary for an edit. Boundaries inside the edited text
+// snap to the start of the edit or, for ends, to its new end; either way
+// they land in the pending range and the fold is rebuilt.
+static void edit_position(uint32_t *byte, TSPoint *point, const TSInputEdit *edit, bool end) {
+  if (*byte >= edit->old_end_byte) {
+    if (point->row == edit->old_end_point.row) {
+      point->column = point->column - edit->old_end_point.column + edit->new_end_point.column;
+    }
+    point->row = point->row - edit->old_end_point.row + edit->new_end_point.row;
+    *byte = *byte - edit->old_end_byte + edit->new_end_byte;
+  } else if (*byte > edit->start_byte) {
+    *byte = end ? edit->new_end_byte : edit->start_byte;
+    *point = end ? edit->new_end_point : edit->start_point;
+  }
+}
+
+void ts_asciidoc_folds_edit(TSAsciidocFolds *self, const TSInputEdit *edit) {
+  editor_edit_ranges(&self->pending, edit);
+  for (uint32_t i = 0; i < self->folds.size; i++) {
+    TSAsciidocFold *fold = &self->folds.contents[i];
+    edit_position(&fold->start_byte, &fold->start_point, edit, false);
+    edit_position(&fold->end_byte, &fold->end_point, edit, true);
+  }
+}
+
+// Whether `byte` lies in one of the sorted, merged `ranges`.
+static bool in_ranges(const RangeArray *ranges, uint32_t byte) {
+  uint32_t low = 0, high = ranges->size;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (ranges->contents[mid].end_byte < byte) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low < ranges->size && ranges->contents[low].start_byte <= byte;
+}
+
+// Whether [start, end] overlaps one of the sorted, merged `ranges`.
+static bool touches_ranges(const RangeArray *ranges, uint32_t start, uint32_t end) {
+  uint32_t low = 0, high = ranges->size;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (ranges->contents[mid].end_byte < start) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low < ranges->size && ranges->contents[low].start_byte <= end;
+}
+
+// A fold only helps if it hides at least one line.
+static bool spans_lines(TSPoint start, TSPoint end) {
+  return end.row > start.row + 1 || (end.row == start.row + 1 && end.column > 0);
+}
+
+// Adds the folds in `root` with a boundary in a changed range, descending
+// only into nodes that touch one.
+static void collect_folds(TSAsciidocFolds *self, TSNode root) {
+  TSTreeCursor cursor = ts_tree_cursor_new(root);
+  for (;;) {
+    TSNode node = ts_tree_cursor_current_node(&cursor);
+    uint32_t start = ts_node_start_byte(node);
+    uint32_t end = ts_node_end_byte(node);
+    bool descend = false;
+    if (touches_ranges(&self->changed, start, end)) {
+      uint8_t flags = symbol_flags(self, ts_node_symbol(node));
+      if (flags & SYMBOL_FOLD &&
+          (in_ranges(&self->changed, start) || in_ranges(&self->changed, end))) {
+        TSPoint start_point = ts_node_start_point(node);
+        TSPoint end_point = ts_node_end_point(node);
+        if (spans_lines(start_point, end_point)) {
+          array_push(&self->added, ((TSAsciidocFold){
+                                     .start_byte = start,
+                                     .end_byte = end,
+                                     .start_point = start_point,
+                                     .end_point = end_point,
+                                     .symbol = ts_node_symbol(node),
+                                   }));
+        }
+      }
+      descend = !(flags & SYMBOL_LEAF);
+    }
+
+    if (descend && ts_tree_cursor_goto_first_child(&cursor)) {
+      continue;
+    }
+    while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+      if (!ts_tree_cursor_goto_parent(&cursor)) {
+        ts_tree_cursor_delete(&cursor);
+        return;
+      }
+    }
+  }
+}
+
+static int compare_folds(const void *a, const void *b) {
+  const TSAsciidocFold *x = a;
+  const TSAsciidocFold *y = b;
+  if (x->start_byte != y->start_byte) {
+    return (x->start_byte > y->start_byte) - (x->start_byte < y->start_byte);
+  }
+  if (x->end_byte != y->end_byte) {
+    return (x->end_byte < y->end_byte) - (x->end_byte > y->end_byte);
+  }
+  return (x->symbol > y->symbol) - (x->symbol < y->symbol);
+}
+
+// Drops the folds that are both in `removed` and `added`: they were
+// rebuilt exactly as they were.
+static void cancel_unchanged(FoldArray *removed, FoldArray *added) {
+  uint32_t i = 0, j = 0, removed_size = 0, added_size = 0;
+  while (i < removed->size || j < added->size) {
+    int order = i == removed->size ? 1
+                : j == added->size ? -1
+                                   : compare_folds(&removed->contents[i], &added->contents[j]);
+    if (order == 0) {
+      i++;
+      j++;
+    } else if (order < 0) {
+      removed->contents[removed_size++] = removed->contents[i++];
+    } else {
+      added->contents[added_size++] = added->contents[j++];
+    }
+  }
+  removed->size = removed_size;
+  added->size = added_size;
+}
+
+void ts_asciidoc_folds_update(TSAsciidocFolds *self, const TSTree *old_tree,
+                              const TSTree *new_tree) {
+  TSNode root = ts_tree_root_node(new_tree);
+  array_clear(&self->changed);
+  if (!old_tree) {
+    editor_add_range(&self->changed, 0, ts_node_end_byte(root));
+  } else {
+    uint32_t count;
+    TSRange *ranges = ts_tree_get_changed_ranges(old_tree, new_tree, &count);
+    for (uint32_t i = 0; i < count; i++) {
+      editor_add_range(&self->changed, ranges[i].start_byte, ranges[i].end_byte);
+    }
+    free(ranges);
+    array_push_all(&self->changed, &self->pending);
+  }
+  array_clear(&self->pending);
+  editor_merge_ranges(&self->changed);
+
+  // Split the folds into those kept and those with a boundary in a changed
+  // range, which are rebuilt from the new tree.
+  array_clear(&self->removed);
+  uint32_t kept = 0;
+  for (uint32_t i = 0; i < self->folds.size; i++) {
+    TSAsciidocFold fold = self->folds.contents[i];
+    if (!old_tree || in_ranges(&self->changed, fold.start_byte) ||
+        in_ranges(&self->changed, fold.end_byte)) {
+      array_push(&self->removed, fold);
+    } else {
+      self->folds.contents[kept++] = fold;
+    }
+  }
+  self->folds.size = kept;
+
+  array_clear(&self->added);
+  collect_folds(self, root);
+  qsort(self->added.contents, self->added.size, sizeof(TSAsciidocFold), compare_folds);
+  qsort(self->removed.contents, self->removed.size, sizeof(TSAsciidocFold), compare_folds);
+
+  array_clear(&self->scratch);
+  uint32_t i = 0, j = 0;
+  while (i < self->folds.size || j < self->added.size) {
+    if (j == self->added.size ||
+        (i < self->folds.size &&
+         compare_folds(&self->folds.contents[i], &self->added.contents[j]) <= 0)) {
+      array_push(&self->scratch, self->folds.contents[i++]);
+    } else {
+      array_push(&self->scratch, self->added.contents[j++]);
+    }
+  }
+  array_swap(&self->folds, &self->scratch);
+
+  cancel_unchanged(&self->removed, &self->added);
+}
+
+const TSAsciidocFold *ts_asciidoc_folds(const TSAsciidocFolds *self, uint32_t *count) {
+  *count = self->folds.size;
+  return self->folds.contents;
+}
+
+const TSAsciidocFold *ts_asciidoc_folds_added(const TSAsciidocFolds *self, uint32_t *count) {
+  *count = self->added.size;
+  return self->added.contents;
+}
+
+const TSAsciidocFold *ts_asciidoc_folds_removed(const TSAsciidocFolds *self, uint32_t *count) {
+  *count = self->removed.size;
+  return self->removed.contents;
+}
@@ -0,0 +1,346 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tree_sitter/tree-sitter-asciidoc-header.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "editor.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+// Bytes per read. Most headers fit in the first one.
+#define HEADER_READ_SIZE 1024
+
+// A document whose first blank line comes later than this has no header
+// worth the name; its first lines are parsed as if the header ended there.
+#ifndef ASCIIDOC_HEADER_MAX_BYTES
+#define ASCIIDOC_HEADER_MAX_BYTES (64 * 1024)
+#endif
+
+enum {
+  SYMBOL_HEADER = 1 << 0,
+  SYMBOL_ATTRIBUTE_ENTRY = 1 << 1,
+  SYMBOL_ATTRIBUTE_VALUE = 1 << 2,
+  SYMBOL_AUTHOR_NAME = 1 << 3,
+};
+
+static const char *const HEADER_SYMBOLS[] = {"document_header", NULL};
+static const char *const ATTRIBUTE_ENTRY_SYMBOLS[] = {"attribute_entry", NULL};
+static const char *const ATTRIBUTE_VALUE_SYMBOLS[] = {"attribute_value", NULL};
+static const char *const AUTHOR_NAME_SYMBOLS[] = {"author_name", NULL};
+
+struct TSAsciidocHeaderReader {
+  TSParser *parser;
+  uint8_t *symbol_flags;
+  uint32_t symbol_count;
+  TSFieldId title_field;
+  TSFieldId text_field;
+  TSFieldId author_field;
+  TSFieldId authors_field;
+  TSFieldId email_field;
+  TSFieldId address_field;
+  TSFieldId revision_field;
+  TSFieldId version_field;
+  TSFieldId date_field;
+  TSFieldId remark_field;
+  TSFieldId name_field;
+
+  Array(char) buffer;
+  Array(TSAsciidocSlice) author_names;
+  Array(TSAsciidocHeaderAttribute) attributes;
+  TSAsciidocHeader header;
+};
+
+static uint8_t symbol_flags(const TSAsciidocHeaderReader *self, TSNode node) {
+  TSSymbol symbol = ts_node_symbol(node);
+  return symbol < self->symbol_count ? self->symbol_flags[symbol] : 0;
+}
+
+TSAsciidocHeaderReader *ts_asciidoc_header_reader_new(void) {
+  const TSLanguage *language = tree_sitter_asciidoc();
+  TSAsciidocHeaderReader *self = calloc(1, sizeof(TSAsciidocHeaderReader));
+  self->parser = ts_parser_new();
+  ts_parser_set_language(self->parser, language);
+  self->symbol_count = ts_language_symbol_count(language);
+  self->symbol_flags = calloc(self->symbol_count, 1);
+  editor_mark_symbols(language, self->symbol_flags, HEADER_SYMBOLS, SYMBOL_HEADER);
+  editor_mark_symbols(language, self->symbol_flags, ATTRIBUTE_ENTRY_SYMBOLS,
+                      SYMBOL_ATTRIBUTE_ENTRY);
+  editor_mark_symbols(language, self->symbol_flags, ATTRIBUTE_VALUE_SYMBOLS,
+                      SYMBOL_ATTRIBUTE_VALUE);
+  editor_mark_symbols(language, self->symbol_flags, AUTHOR_NAME_SYMBOLS, SYMBOL_AUTHOR_NAME);
+  self->title_field = ts_language_field_id_for_name(language, "title", 5);
+  self->text_field = ts_language_field_id_for_name(language, "text", 4);
+  self->author_field = ts_language_field_id_for_name(language, "author", 6);
+  self->authors_field = ts_language_field_id_for_name(language, "authors", 7);
+  self->email_field = ts_language_field_id_for_name(language, "email", 5);
+  self->address_field = ts_language_field_id_for_name(language, "address", 7);
+  self->revision_field = ts_language_field_id_for_name(language, "revision", 8);
+  self->version_field = ts_language_field_id_for_name(language, "version", 7);
+  self->date_field = ts_language_field_id_for_name(language, "date", 4);
+  self->remark_field = ts_language_field_id_for_name(language, "remark", 6);
+  self->name_field = ts_language_field_id_for_name(language, "name", 4);
+  return self;
+}
+
+void ts_asciidoc_header_reader_delete(TSAsciidocHeaderReader *self) {
+  if (!self) {
+    return;
+  }
+  ts_parser_delete(self->parser);
+  array_delete(&self->buffer);
+  array_delete(&self->author_names);
+  array_delete(&self->attributes);
+  free(self->symbol_flags);
+  free(self);
+}
+
+// How far the search for the end of the header has got, kept between reads.
+typedef struct {
+  // Start of the incomplete last line, where the search resumes.
+  uint32_t line_start;
+  // Blank lines and comments before the header are skipped. Once its first
+  // line turns up, `header_start` and `header_row` are where it starts.
+  bool in_header;
+  uint32_t header_start;
+  uint32_t header_row;
+  // Length of the fence of the comment block being skipped, or 0.
+  uint32_t comment_fence;
+} HeaderScan;
+
+// Length of `line` if it is a `////` comment block fence, or 0.
+static uint32_t comment_fence_length(const char *line, uint32_t length) {
+  uint32_t i = 0;
+  while (i < length && line[i] == '/') {
+    i++;
+  }
+  return i >= 4 && i == length ? i : 0;
+}
+
+// Offset just past the first blank line of the header, or 0 if there is
+// none in the first `length` bytes. With `at_end`, those bytes are the whole
+// document and an incomplete last line counts as a line.
+static uint32_t find_header_end(const char *source, uint32_t length, bool at_end,
+                                HeaderScan *scan) {
+  uint32_t start = scan->line_start;
+  while (start < length) {
+    const char *newline = memchr(source + start, '\n', length - start);
+    if (!newline && !at_end) {
+      break;
+    }
+    uint32_t end = newline ? (uint32_t)(newline - source) + 1 : length;
+    uint32_t line_length = (newline ? end - 1 : end) - start;
+    if (line_length > 0 && source[start + line_length - 1] == '\r') {
+      line_length--;
+    }
+    uint32_t i = start;
+    while (i < start + line_length && (source[i] == ' ' || source[i] == '\t')) {
+      i++;
+    }
+    bool blank = i == start + line_length;
+    if (scan->in_header) {
+      if (blank) {
+        return end;
+      }
+    } else {
+      uint32_t fence = comment_fence_length(source + start, line_length);
+      if (scan->comment_fence > 0) {
+        if (fence == scan->comment_fence) {
+          scan->comment_fence = 0;
+        }
+      } else if (fence > 0) {
+        scan->comment_fence = fence;
+      } else if (!blank && !(line_length >= 2 && source[start] == '/' &&
+                             source[start + 1] == '/')) {
+        scan->in_header = true;
+        scan->header_start = start;
+      }
+      if (!scan->in_header) {
+        scan->header_row++;
+      }
+    }
+    start = end;
+  }
+  scan->line_start = start;
+  return 0;
+}
+
+static TSAsciidocSlice slice(TSNode node) {
+  uint32_t start = ts_node_start_byte(node);
+  return (TSAsciidocSlice){start, ts_node_end_byte(node) - start};
+}
+
+// The node's bytes without trailing whitespace and line ending.
+static TSAsciidocSlice trimmed_slice(const char *source, TSNode node) {
+  TSAsciidocSlice result = slice(node);
+  while (result.length > 0 && strchr(" \t\r\n", source[result.start_byte + result.length - 1])) {
+    result.length--;
+  }
+  return result;
+}
+
+static TSAsciidocSlice field_slice(TSNode node, TSFieldId field) {
+  TSNode child = ts_node_child_by_field_id(node, field);
+  return ts_node_is_null(child) ? (TSAsciidocSlice){0, 0} : slice(child);
+}
+
+static void read_author_line(TSAsciidocHeaderReader *self, const char *source, TSNode line) {
+  self->header.author_line = trimmed_slice(source, line);
+  TSNode list = ts_node_child_by_field_id(line, self->authors_field);
+  uint32_t count = ts_node_is_null(list) ? 0 : ts_node_named_child_count(list);
+  for (uint32_t i = 0; i < count; i++) {
+    TSNode child = ts_node_named_child(list, i);
+    if (symbol_flags(self, child) & SYMBOL_AUTHOR_NAME) {
+      array_push(&self->author_names, trimmed_slice(source, child));
+    }
+  }
+  TSNode email = ts_node_child_by_field_id(line, self->email_field);
+  if (!ts_node_is_null(email)) {
+    self->header.author_email = field_slice(email, self->address_field);
+  }
+}
+
+static void read_document_header(TSAsciidocHeaderReader *self, const char *source,
+                                 TSNode header) {
+  TSNode title = ts_node_child_by_field_id(header, self->title_field);
+  if (!ts_node_is_null(title)) {
+    TSNode text = ts_node_child_by_field_id(title, self->text_field);
+    self->header.has_title = true;
+    if (!ts_node_is_null(text)) {
+      self->header.title = trimmed_slice(source, text);
+    }
+  }
+
+  TSNode author = ts_node_child_by_field_id(header, self->author_field);
+  if (!ts_node_is_null(author)) {
+    read_author_line(self, source, author);
+  }
+
+  TSNode revision = ts_node_child_by_field_id(header, self->revision_field);
+  if (!ts_node_is_null(revision)) {
+    self->header.revision_line = trimmed_slice(source, revision);
+    self->header.revision_version = field_slice(revision, self->version_field);
+    self->header.revision_date = field_slice(revision, self->date_field);
+    TSNode remark = ts_node_child_by_field_id(revision, self->remark_field);
+    self->header.revision_remark =
+      ts_node_is_null(remark) ? (TSAsciidocSlice){0, 0} : trimmed_slice(source, remark);
+  }
+}
+
+static void read_attribute_entry(TSAsciidocHeaderReader *self, const char *source,
+                                 TSNode entry) {
+  TSAsciidocHeaderAttribute attribute = {.line = trimmed_slice(source, entry)};
+  TSNode name = ts_node_child_by_field_id(entry, self->name_field);
+  if (!ts_node_is_null(name)) {
+    attribute.name = slice(name);
+    if (attribute.name.length >= 2) {
+      attribute.name.start_byte++;
+      attribute.name.length -= 2;
+    }
+  }
+  uint32_t count = ts_node_named_child_count(entry);
+  for (uint32_t i = 0; i < count; i++) {
+    TSNode child = ts_node_named_child(entry, i);
+    if (symbol_flags(self, child) & SYMBOL_ATTRIBUTE_VALUE) {
+      attribute.value = trimmed_slice(source, child);
+      break;
+    }
+  }
+  array_push(&self->attributes, attribute);
+}
+
+// Parses the header, which ends at byte `length` of `source`, and fills in
+// the result.
+static const TSAsciidocHeader *extract(TSAsciidocHeaderReader *self, const char *source,
+                                       const HeaderScan *scan, uint32_t length,
+                                       bool truncated) {
+  array_clear(&self->author_names);
+  array_clear(&self->attributes);
+  memset(&self->header, 0, sizeof(self->header));
+  self->header.source = source;
+  self->header.source_length = length;
+  self->header.truncated = truncated;
+
+  if (scan->in_header && length > scan->header_start) {
+    // The grammar only reads a header at the start of the document, so the
+    // parse starts at the header's first line; node offsets stay those of
+    // `source`.
+    TSRange range = {
+      .start_point = {scan->header_row, 0},
+      .end_point = {UINT32_MAX, UINT32_MAX},
+      .start_byte = scan->header_start,
+      .end_byte = length,
+    };
+    ts_parser_set_included_ranges(self->parser, &range, 1);
+    TSTree *tree = ts_parser_parse_string(self->parser, NULL, source, length);
+    TSNode root = ts_tree_root_node(tree);
+    uint32_t count = ts_node_named_child_count(root);
+    for (uint32_t i = 0; i < count; i++) {
+      TSNode child = ts_node_named_child(root, i);
+      uint8_t flags = symbol_flags(self, child);
+      if (flags & SYMBOL_HEADER) {
+        read_document_header(self, source, child);
+      } else if (flags & SYMBOL_ATTRIBUTE_ENTRY) {
+        read_attribute_entry(self, source, child);
+      }
+    }
+    ts_tree_delete(tree);
+  }
+
+  self->header.author_names = self->author_names.contents;
+  self->header.author_count = self->author_names.size;
+  self->header.attributes = self->attributes.contents;
+  self->header.attribute_count = self->attributes.size;
+  return &self->header;
+}
+
+const TSAsciidocHeader *ts_asciidoc_header_parse(TSAsciidocHeaderReader *self,
+                                                 const char *source, uint32_t length) {
+  HeaderScan scan = {0};
+  uint32_t limit = length < ASCIIDOC_HEADER_MAX_BYTES ? length : ASCIIDOC_HEADER_MAX_BYTES;
+  bool whole = length <= ASCIIDOC_HEADER_MAX_BYTES;
+  uint32_t end = find_header_end(source, limit, whole, &scan);
+  if (end == 0 && !whole) {
+    return extract(self, source, &scan, scan.line_start, true);
+  }
+  return extract(self, source, &scan, end ? end : length, false);
+}
+
+const TSAsciidocHeader *ts_asciidoc_header_read_fd(TSAsciidocHeaderReader *self, int fd) {
+  array_clear(&self->buffer);
+  HeaderScan scan = {0};
+  for (;;) {
+    if (self->buffer.size >= ASCIIDOC_HEADER_MAX_BYTES) {
+      return extract(self, self->buffer.contents, &scan, scan.line_start, true);
+    }
+    array_reserve(&self->buffer, self->buffer.size + HEADER_READ_SIZE);
+    ssize_t count = read(fd, self->buffer.contents + self->buffer.size, HEADER_READ_SIZE);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return NULL;
+    }
+    bool at_end = count == 0;
+    self->buffer.size += (uint32_t)count;
+    uint32_t end = find_header_end(self->buffer.contents, self->buffer.size, at_end, &scan);
+    if (end > 0 || at_end) {
+      return extract(self, self->buffer.contents, &scan, end ? end : self->buffer.size, false);
+    }
+  }
+}
+
+const TSAsciidocHeader *ts_asciidoc_header_read(TSAsciidocHeaderReader *self, const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  const TSAsciidocHeader *header = ts_asciidoc_header_read_fd(self, fd);
+  int error = errno;
+  close(fd);
+  errno = error;
+  return header;
+}
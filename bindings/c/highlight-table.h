@@ -0,0 +1,141 @@
+// Generated by scripts/gen-highlight-table.js from queries/highlights.scm. Do not edit.
+
+static const char *const HIGHLIGHT_CAPTURE_NAMES[] = {
+  "comment",
+  "markup.heading",
+  "string",
+  "number",
+  "property",
+  "attribute",
+  "keyword",
+  "type",
+  "punctuation.bracket",
+  "constant",
+  "punctuation.delimiter",
+  "markup.list",
+  "none",
+  "markup.link.url",
+  "markup.link.label",
+  "punctuation.special",
+  "markup.link",
+  "definition.label",
+  "markup.bold",
+  "markup.italic",
+  "markup.raw",
+  "markup.superscript",
+  "markup.subscript",
+  "markup.highlight",
+  "function",
+  "markup.quote",
+};
+
+// {pattern, parent, field, node, named, capture}
+static const HighlightRule HIGHLIGHT_RULES[] = {
+  {0, NULL, NULL, "comment", true, 0},
+  {1, NULL, NULL, "document_title_marker", true, 1},
+  {2, NULL, NULL, "document_title_text", true, 1},
+  {3, NULL, NULL, "section_marker_2", true, 1},
+  {4, NULL, NULL, "section_marker_3", true, 1},
+  {5, NULL, NULL, "section_marker_4", true, 1},
+  {6, NULL, NULL, "section_marker_5", true, 1},
+  {7, NULL, NULL, "section_marker_6", true, 1},
+  {8, NULL, NULL, "title", true, 1},
+  {9, NULL, NULL, "block_title", true, 1},
+  {10, NULL, NULL, "author_name", true, 2},
+  {11, NULL, NULL, "author_email", true, 2},
+  {12, NULL, NULL, "revision_version", true, 3},
+  {13, NULL, NULL, "revision_date", true, 3},
+  {14, NULL, NULL, "revision_remark", true, 2},
+  {15, NULL, NULL, "attribute_name", true, 4},
+  {16, NULL, NULL, "attribute_value", true, 2},
+  {17, NULL, NULL, "source_block_attributes", true, 5},
+  {18, NULL, NULL, "source_attribute_keyword", true, 6},
+  {19, NULL, NULL, "source_language", true, 7},
+  {21, "attribute_substitution", NULL, "plain_text", true, 9},
+  {23, NULL, NULL, "admonition_label", true, 6},
+  {25, NULL, NULL, "unordered_list_marker", true, 11},
+  {26, NULL, NULL, "ordered_list_marker", true, 11},
+  {27, NULL, NULL, "checklist_marker", true, 11},
+  {28, NULL, NULL, "LIST_CONTINUATION", true, 11},
+  {29, NULL, NULL, "callout_marker", true, 11},
+  {30, NULL, NULL, "description_list", true, 12},
+  {31, NULL, NULL, "description_item_term", true, 11},
+  {32, NULL, NULL, "description_item_definition", true, 11},
+  {33, NULL, NULL, "callout_marker", true, 11},
+  {34, NULL, NULL, "auto_link", true, 13},
+  {37, NULL, NULL, "anchor", true, 16},
+  {38, NULL, NULL, "bibliography_entry", true, 16},
+  {40, NULL, NULL, "strong", true, 18},
+  {41, NULL, NULL, "emphasis", true, 19},
+  {42, NULL, NULL, "monospace", true, 20},
+  {43, NULL, NULL, "superscript", true, 21},
+  {44, NULL, NULL, "subscript", true, 22},
+  {45, NULL, NULL, "highlight", true, 23},
+  {46, NULL, NULL, "passthrough_triple_plus", true, 20},
+  {47, NULL, NULL, "role_attribute_list", true, 5},
+  {48, NULL, NULL, "plain_dot", true, 10},
+  {49, NULL, NULL, "macro_name", true, 24},
+  {50, NULL, NULL, "macro_body", true, 2},
+  {51, NULL, NULL, "macro_close", true, 8},
+  {52, "block_macro", NULL, "macro_name", true, 24},
+  {53, "inline_macro", NULL, "macro_name", true, 24},
+  {54, NULL, NULL, "index_term_macro", true, 6},
+  {55, NULL, NULL, "index_term2_macro", true, 6},
+  {56, NULL, NULL, "concealed_index_term", true, 6},
+  {57, NULL, NULL, "index_text", true, 2},
+  {58, NULL, NULL, "index_term_text", true, 2},
+  {59, NULL, NULL, "indexterm:", false, 6},
+  {60, NULL, NULL, "indexterm2:", false, 6},
+  {61, NULL, NULL, "(((", false, 15},
+  {62, NULL, NULL, ")))", false, 15},
+  {63, NULL, NULL, "ifdef_open", true, 6},
+  {64, NULL, NULL, "ifndef_open", true, 6},
+  {65, NULL, NULL, "ifeval_open", true, 6},
+  {66, NULL, NULL, "endif_directive", true, 6},
+  {67, NULL, NULL, "conditional_block", true, 6},
+  {68, NULL, NULL, "ifdef_block", true, 6},
+  {69, NULL, NULL, "ifndef_block", true, 6},
+  {70, NULL, NULL, "ifeval_block", true, 6},
+  {71, "fenced_code_block_open", NULL, "fenced_code_delimiter", true, 15},
+  {72, NULL, NULL, "fenced_code_block_language", true, 7},
+  {73, NULL, NULL, "fenced_code_block_content", true, 2},
+  {74, "fenced_code_block_close", NULL, "fenced_code_delimiter", true, 15},
+  {75, NULL, NULL, "block_quote_marker", true, 25},
+  {76, NULL, NULL, "thematic_break", true, 15},
+  {77, NULL, NULL, "table_attributes", true, 5},
+  {78, NULL, NULL, "block_attributes", true, 5},
+  {79, "table_cell", NULL, "|", false, 10},
+  {80, NULL, NULL, "cell_spec", true, 5},
+  {81, NULL, NULL, "plain_left_brace", true, 8},
+  {82, NULL, NULL, "plain_right_brace", true, 8},
+  {83, NULL, NULL, "plain_left_bracket", true, 8},
+  {84, NULL, NULL, "plain_right_bracket", true, 8},
+  {85, NULL, NULL, "plain_left_paren", true, 8},
+  {86, NULL, NULL, "plain_right_paren", true, 8},
+  {87, NULL, NULL, "plain_colon", true, 10},
+  {88, NULL, NULL, "plain_less_than", true, 8},
+  {89, NULL, NULL, "plain_greater_than", true, 8},
+  {90, NULL, NULL, "plain_caret", true, 15},
+  {91, NULL, NULL, "plain_dash", true, 10},
+  {92, NULL, NULL, "plain_double_quote", true, 15},
+  {93, NULL, NULL, "plain_quote", true, 15},
+  {94, NULL, NULL, "plain_underscore", true, 10},
+  {95, NULL, NULL, "plain_asterisk", true, 15},
+  {96, NULL, NULL, "hard_break", true, 15},
+};
+
+// Pattern index in the full query of each fallback pattern, in order.
+static const uint16_t HIGHLIGHT_FALLBACK_PATTERNS[6] = {
+  20, 22, 24, 35, 36, 39
+};
+
+#define HIGHLIGHT_FALLBACK_PATTERN_COUNT 6
+
+static const char HIGHLIGHT_FALLBACK_QUERY[] =
+  "(attribute_substitution\n  (plain_left_brace)  @punctuation.bracket\n  (plain_right_brace) @punctuation.bracket)\n"
+  "(attribute_substitution\n  (plain_text)  @constant\n  (plain_colon) @punctuation.delimiter\n  (plain_text)  @constant)\n"
+  "(inline_admonition\n  (admonition_label) @keyword\n  (plain_colon)       @punctuation.delimiter)\n"
+  "(explicit_link\n  (auto_link) @markup.link.url\n  (plain_left_bracket)  @punctuation.bracket\n  ((link_text) @markup.link.label)?\n  (plain_right_bracket) @punctuation.bracket)\n"
+  "(internal_xref\n  (internal_xref_open) @punctuation.special\n  (xref_target) @markup.link\n  ((plain_comma) @punctuation.delimiter (xref_text) @markup.link.label)?\n  (internal_xref_close) @punctuation.special)\n"
+  "(bibliography_entry\n  (bibliography_id) @definition.label\n  (bibliography_description) @string)\n"
+;
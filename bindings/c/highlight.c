@@ -0,0 +1,373 @@
+#include "tree_sitter/tree-sitter-asciidoc-highlight.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+typedef struct {
+  uint16_t pattern;
+  const char *parent;
+  const char *field;
+  const char *node;
+  bool named;
+  uint16_t capture;
+} HighlightRule;
+
+#include "highlight-table.h"
+
+#define CAPTURE_COUNT (sizeof(HIGHLIGHT_CAPTURE_NAMES) / sizeof(HIGHLIGHT_CAPTURE_NAMES[0]))
+#define RULE_COUNT (sizeof(HIGHLIGHT_RULES) / sizeof(HIGHLIGHT_RULES[0]))
+#define NO_PATTERN UINT16_MAX
+
+// A rule that applies to a node only under a given parent (and field).
+typedef struct {
+  TSSymbol parent;
+  TSFieldId field;
+  uint16_t capture;
+  uint16_t pattern;
+} ChildRule;
+
+// A capture found by the fallback query, keyed by node.
+typedef struct {
+  const void *id;
+  uint32_t start_byte;
+  uint16_t capture;
+  uint16_t pattern;
+} FallbackCapture;
+
+struct TSAsciidocHighlighter {
+  uint32_t symbol_count;
+  // Per symbol: the first bare-node rule, if any.
+  uint16_t *node_capture;
+  uint16_t *node_pattern;
+  // Per symbol: child rules in child_rules[child_rule_offsets[s]..[s + 1]).
+  uint32_t *child_rule_offsets;
+  ChildRule *child_rules;
+
+  TSQuery *fallback;
+  TSQueryCursor *cursor;
+  uint16_t *fallback_captures;
+  FallbackCapture *fallback_map;
+  uint32_t fallback_map_capacity;
+
+  TSSymbol *parents;
+  uint32_t parents_capacity;
+  TSAsciidocHighlightSpan *spans;
+  uint32_t span_count;
+  uint32_t span_capacity;
+};
+
+static bool symbol_matches(const TSLanguage *language, TSSymbol symbol, const char *name,
+                           bool named) {
+  TSSymbolType type = ts_language_symbol_type(language, symbol);
+  if (type != (named ? TSSymbolTypeRegular : TSSymbolTypeAnonymous)) {
+    return false;
+  }
+  return strcmp(ts_language_symbol_name(language, symbol), name) == 0;
+}
+
+static uint16_t capture_for_name(const char *name, uint32_t length) {
+  for (uint16_t i = 0; i < CAPTURE_COUNT; i++) {
+    if (strlen(HIGHLIGHT_CAPTURE_NAMES[i]) == length &&
+        memcmp(HIGHLIGHT_CAPTURE_NAMES[i], name, length) == 0) {
+      return i;
+    }
+  }
+  return UINT16_MAX;
+}
+
+// Resolves the generated rules against the language's symbol and field ids.
+// Names are matched against every symbol rather than looked up once, because
+// aliases can give several symbols the same name.
+static void build_rules(TSAsciidocHighlighter *self, const TSLanguage *language) {
+  uint32_t count = self->symbol_count;
+  self->node_capture = calloc(count, sizeof(uint16_t));
+  self->node_pattern = malloc(count * sizeof(uint16_t));
+  self->child_rule_offsets = calloc(count + 1, sizeof(uint32_t));
+  for (uint32_t s = 0; s < count; s++) {
+    self->node_pattern[s] = NO_PATTERN;
+  }
+
+  // Two passes over the child rules: count per symbol, then fill.
+  for (int pass = 0; pass < 2; pass++) {
+    uint32_t *cursor = pass ? calloc(count, sizeof(uint32_t)) : NULL;
+    for (size_t r = 0; r < RULE_COUNT; r++) {
+      const HighlightRule *rule = &HIGHLIGHT_RULES[r];
+      TSFieldId field = 0;
+      if (rule->field) {
+        uint32_t length = (uint32_t)strlen(rule->field);
+        field = ts_language_field_id_for_name(language, rule->field, length);
+        if (field == 0) {
+          continue;
+        }
+      }
+
+      for (TSSymbol s = 0; s < count; s++) {
+        if (!symbol_matches(language, s, rule->node, rule->named)) {
+          continue;
+        }
+        if (!rule->parent) {
+          if (pass == 0 && rule->pattern < self->node_pattern[s]) {
+            self->node_pattern[s] = rule->pattern;
+            self->node_capture[s] = rule->capture;
+          }
+          continue;
+        }
+        for (TSSymbol p = 0; p < count; p++) {
+          if (!symbol_matches(language, p, rule->parent, true)) {
+            continue;
+          }
+          if (pass == 0) {
+            self->child_rule_offsets[s + 1]++;
+          } else {
+            self->child_rules[self->child_rule_offsets[s] + cursor[s]++] = (ChildRule){
+              .parent = p,
+              .field = field,
+              .capture = rule->capture,
+              .pattern = rule->pattern,
+            };
+          }
+        }
+      }
+    }
+
+    if (pass == 0) {
+      for (uint32_t s = 0; s < count; s++) {
+        self->child_rule_offsets[s + 1] += self->child_rule_offsets[s];
+      }
+      self->child_rules = malloc((self->child_rule_offsets[count] + 1) * sizeof(ChildRule));
+    }
+    free(cursor);
+  }
+}
+
+TSAsciidocHighlighter *ts_asciidoc_highlighter_new(void) {
+  const TSLanguage *language = tree_sitter_asciidoc();
+  TSAsciidocHighlighter *self = calloc(1, sizeof(TSAsciidocHighlighter));
+  self->symbol_count = ts_language_symbol_count(language);
+  build_rules(self, language);
+
+  if (HIGHLIGHT_FALLBACK_PATTERN_COUNT > 0) {
+    uint32_t error_offset;
+    TSQueryError error_type;
+    self->fallback = ts_query_new(language, HIGHLIGHT_FALLBACK_QUERY,
+                                  (uint32_t)strlen(HIGHLIGHT_FALLBACK_QUERY), &error_offset,
+                                  &error_type);
+    if (!self->fallback) {
+      ts_asciidoc_highlighter_delete(self);
+      return NULL;
+    }
+
+    uint32_t capture_count = ts_query_capture_count(self->fallback);
+    self->fallback_captures = malloc((capture_count + 1) * sizeof(uint16_t));
+    for (uint32_t i = 0; i < capture_count; i++) {
+      uint32_t length;
+      const char *name = ts_query_capture_name_for_id(self->fallback, i, &length);
+      self->fallback_captures[i] = capture_for_name(name, length);
+    }
+    self->cursor = ts_query_cursor_new();
+  }
+
+  return self;
+}
+
+void ts_asciidoc_highlighter_delete(TSAsciidocHighlighter *self) {
+  if (!self) {
+    return;
+  }
+  if (self->cursor) {
+    ts_query_cursor_delete(self->cursor);
+  }
+  if (self->fallback) {
+    ts_query_delete(self->fallback);
+  }
+  free(self->fallback_captures);
+  free(self->fallback_map);
+  free(self->node_capture);
+  free(self->node_pattern);
+  free(self->child_rule_offsets);
+  free(self->child_rules);
+  free(self->parents);
+  free(self->spans);
+  free(self);
+}
+
+uint32_t ts_asciidoc_highlighter_capture_count(const TSAsciidocHighlighter *self) {
+  (void)self;
+  return CAPTURE_COUNT;
+}
+
+const char *ts_asciidoc_highlighter_capture_name(const TSAsciidocHighlighter *self,
+                                                 uint16_t capture) {
+  (void)self;
+  return capture < CAPTURE_COUNT ? HIGHLIGHT_CAPTURE_NAMES[capture] : NULL;
+}
+
+static uint32_t hash_node(const void *id, uint32_t start_byte) {
+  uint64_t hash = ((uint64_t)(uintptr_t)id ^ start_byte) * 0x9e3779b97f4a7c15ull;
+  return (uint32_t)(hash >> 32);
+}
+
+static FallbackCapture *fallback_slot(TSAsciidocHighlighter *self, const void *id,
+                                      uint32_t start_byte) {
+  uint32_t mask = self->fallback_map_capacity - 1;
+  uint32_t slot = hash_node(id, start_byte) & mask;
+  while (self->fallback_map[slot].id &&
+         (self->fallback_map[slot].id != id || self->fallback_map[slot].start_byte != start_byte)) {
+    slot = (slot + 1) & mask;
+  }
+  return &self->fallback_map[slot];
+}
+
+static void fallback_insert(TSAsciidocHighlighter *self, uint32_t *count, TSNode node,
+                            uint16_t capture, uint16_t pattern) {
+  if ((*count + 1) * 2 > self->fallback_map_capacity) {
+    uint32_t old_capacity = self->fallback_map_capacity;
+    FallbackCapture *old = self->fallback_map;
+    self->fallback_map_capacity = old_capacity ? old_capacity * 2 : 64;
+    self->fallback_map = calloc(self->fallback_map_capacity, sizeof(FallbackCapture));
+    for (uint32_t i = 0; i < old_capacity; i++) {
+      if (old[i].id) {
+        *fallback_slot(self, old[i].id, old[i].start_byte) = old[i];
+      }
+    }
+    free(old);
+  }
+
+  uint32_t start_byte = ts_node_start_byte(node);
+  FallbackCapture *slot = fallback_slot(self, node.id, start_byte);
+  if (!slot->id) {
+    *slot = (FallbackCapture){node.id, start_byte, capture, pattern};
+    (*count)++;
+  } else if (pattern < slot->pattern) {
+    slot->capture = capture;
+    slot->pattern = pattern;
+  }
+}
+
+// Runs the patterns the table cannot express and records their captures by
+// node. Returns the number of captured nodes.
+static uint32_t run_fallback(TSAsciidocHighlighter *self, TSNode node, uint32_t start_byte,
+                             uint32_t end_byte) {
+  if (self->fallback_map_capacity) {
+    memset(self->fallback_map, 0, self->fallback_map_capacity * sizeof(FallbackCapture));
+  }
+  if (!self->fallback) {
+    return 0;
+  }
+
+  uint32_t count = 0;
+  ts_query_cursor_set_byte_range(self->cursor, start_byte, end_byte);
+  ts_query_cursor_exec(self->cursor, self->fallback, node);
+
+  TSQueryMatch match;
+  uint32_t capture_index;
+  while (ts_query_cursor_next_capture(self->cursor, &match, &capture_index)) {
+    const TSQueryCapture *capture = &match.captures[capture_index];
+    uint16_t table_capture = self->fallback_captures[capture->index];
+    if (table_capture != UINT16_MAX) {
+      fallback_insert(self, &count, capture->node, table_capture,
+                      HIGHLIGHT_FALLBACK_PATTERNS[match.pattern_index]);
+    }
+  }
+  return count;
+}
+
+static void push_span(TSAsciidocHighlighter *self, TSAsciidocHighlightSpan span) {
+  if (self->span_count == self->span_capacity) {
+    self->span_capacity = self->span_capacity ? self->span_capacity * 2 : 256;
+    self->spans = realloc(self->spans, self->span_capacity * sizeof(TSAsciidocHighlightSpan));
+  }
+  self->spans[self->span_count++] = span;
+}
+
+static void push_parent(TSAsciidocHighlighter *self, uint32_t depth, TSSymbol symbol) {
+  if (depth >= self->parents_capacity) {
+    self->parents_capacity = self->parents_capacity ? self->parents_capacity * 2 : 64;
+    self->parents = realloc(self->parents, self->parents_capacity * sizeof(TSSymbol));
+  }
+  self->parents[depth] = symbol;
+}
+
+const TSAsciidocHighlightSpan *ts_asciidoc_highlight(TSAsciidocHighlighter *self, TSNode node,
+                                                     uint32_t start_byte, uint32_t end_byte,
+                                                     uint32_t *count) {
+  uint32_t fallback_count = run_fallback(self, node, start_byte, end_byte);
+  self->span_count = 0;
+
+  TSTreeCursor cursor = ts_tree_cursor_new(node);
+  uint32_t depth = 0;
+  push_parent(self, 0, UINT16_MAX);
+
+  for (;;) {
+    TSNode current = ts_tree_cursor_current_node(&cursor);
+    uint32_t node_start = ts_node_start_byte(current);
+    uint32_t node_end = ts_node_end_byte(current);
+
+    // Everything after this node starts at or beyond the window.
+    if (node_start >= end_byte && node_start > start_byte) {
+      break;
+    }
+
+    if (node_end > start_byte || (node_end == start_byte && node_start == node_end)) {
+      TSSymbol symbol = ts_node_symbol(current);
+      uint16_t capture = UINT16_MAX;
+      uint16_t pattern = NO_PATTERN;
+
+      if (symbol < self->symbol_count) {
+        pattern = self->node_pattern[symbol];
+        capture = self->node_capture[symbol];
+
+        uint32_t rule_end = self->child_rule_offsets[symbol + 1];
+        if (depth > 0 && rule_end > self->child_rule_offsets[symbol]) {
+          TSSymbol parent = self->parents[depth];
+          TSFieldId field = ts_tree_cursor_current_field_id(&cursor);
+          for (uint32_t i = self->child_rule_offsets[symbol]; i < rule_end; i++) {
+            const ChildRule *rule = &self->child_rules[i];
+            if (rule->parent == parent && (!rule->field || rule->field == field) &&
+                rule->pattern < pattern) {
+              pattern = rule->pattern;
+              capture = rule->capture;
+            }
+          }
+        }
+      }
+
+      if (fallback_count) {
+        const FallbackCapture *fallback = fallback_slot(self, current.id, node_start);
+        if (fallback->id && fallback->pattern < pattern) {
+          pattern = fallback->pattern;
+          capture = fallback->capture;
+        }
+      }
+
+      if (pattern != NO_PATTERN) {
+        push_span(self, (TSAsciidocHighlightSpan){node_start, node_end, capture, (uint16_t)depth});
+      }
+
+      // Children that end before the window are skipped without a visit.
+      if (ts_tree_cursor_goto_first_child_for_byte(&cursor, start_byte) >= 0) {
+        depth++;
+        push_parent(self, depth, symbol);
+        continue;
+      }
+    }
+
+    while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+      if (depth == 0 || !ts_tree_cursor_goto_parent(&cursor)) {
+        goto done;
+      }
+      depth--;
+    }
+    if (depth == 0) {
+      break;
+    }
+  }
+
+done:
+  ts_tree_cursor_delete(&cursor);
+  *count = self->span_count;
+  return self->spans;
+}
@@ -0,0 +1,628 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tree_sitter/tree-sitter-asciidoc-injection.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "editor.h"
+#include "tree_sitter/array.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+// Longest language name looked up; longer ones are used as written.
+#define MAX_LANGUAGE_NAME 32
+
+enum {
+  SYMBOL_LISTING = 1 << 0,
+  SYMBOL_FENCED = 1 << 1,
+  // Nodes that cannot contain a code block; not searched for one.
+  SYMBOL_LEAF = 1 << 2,
+};
+
+static const char *const LISTING_SYMBOLS[] = {"listing_block", NULL};
+
+static const char *const FENCED_SYMBOLS[] = {"fenced_code_block", NULL};
+
+static const char *const LEAF_SYMBOLS[] = {
+  "paragraph",      "block_content", "fenced_code_block_content", "title",
+  "attribute_entry", "comment",      "block_title",               "block_attributes",
+  NULL,
+};
+
+typedef struct {
+  const char *alias;
+  const char *name;
+} LanguageAlias;
+
+// Sorted by alias, for binary search. Canonical names follow the
+// tree-sitter-<name> grammar repositories.
+static const LanguageAlias LANGUAGE_ALIASES[] = {
+  {"adoc", "asciidoc"},
+  {"asciidoc", "asciidoc"},
+  {"bash", "bash"},
+  {"c", "c"},
+  {"c#", "c_sharp"},
+  {"c++", "cpp"},
+  {"cc", "cpp"},
+  {"clj", "clojure"},
+  {"clojure", "clojure"},
+  {"cmake", "cmake"},
+  {"console", "bash"},
+  {"cpp", "cpp"},
+  {"cs", "c_sharp"},
+  {"csharp", "c_sharp"},
+  {"css", "css"},
+  {"cxx", "cpp"},
+  {"diff", "diff"},
+  {"docker", "dockerfile"},
+  {"dockerfile", "dockerfile"},
+  {"elixir", "elixir"},
+  {"erl", "erlang"},
+  {"erlang", "erlang"},
+  {"ex", "elixir"},
+  {"exs", "elixir"},
+  {"go", "go"},
+  {"golang", "go"},
+  {"gradle", "groovy"},
+  {"graphql", "graphql"},
+  {"groovy", "groovy"},
+  {"h", "c"},
+  {"haskell", "haskell"},
+  {"hpp", "cpp"},
+  {"hs", "haskell"},
+  {"htm", "html"},
+  {"html", "html"},
+  {"ini", "ini"},
+  {"java", "java"},
+  {"javascript", "javascript"},
+  {"js", "javascript"},
+  {"json", "json"},
+  {"jsonc", "json"},
+  {"jsx", "javascript"},
+  {"kotlin", "kotlin"},
+  {"kt", "kotlin"},
+  {"kts", "kotlin"},
+  {"lua", "lua"},
+  {"make", "make"},
+  {"makefile", "make"},
+  {"markdown", "markdown"},
+  {"md", "markdown"},
+  {"mjs", "javascript"},
+  {"ml", "ocaml"},
+  {"nix", "nix"},
+  {"node", "javascript"},
+  {"ocaml", "ocaml"},
+  {"patch", "diff"},
+  {"perl", "perl"},
+  {"php", "php"},
+  {"pl", "perl"},
+  {"powershell", "powershell"},
+  {"ps1", "powershell"},
+  {"pwsh", "powershell"},
+  {"py", "python"},
+  {"python", "python"},
+  {"python3", "python"},
+  {"r", "r"},
+  {"rb", "ruby"},
+  {"rs", "rust"},
+  {"ruby", "ruby"},
+  {"rust", "rust"},
+  {"scala", "scala"},
+  {"scss", "scss"},
+  {"sh", "bash"},
+  {"shell", "bash"},
+  {"shell-session", "bash"},
+  {"sql", "sql"},
+  {"swift", "swift"},
+  {"toml", "toml"},
+  {"ts", "typescript"},
+  {"tsx", "tsx"},
+  {"typescript", "typescript"},
+  {"xml", "xml"},
+  {"yaml", "yaml"},
+  {"yml", "yaml"},
+  {"zig", "zig"},
+  {"zsh", "bash"},
+};
+
+#define LANGUAGE_ALIAS_COUNT (sizeof(LANGUAGE_ALIASES) / sizeof(LANGUAGE_ALIASES[0]))
+
+typedef struct {
+  // Interned, see `intern_name`.
+  const char *name;
+  const TSLanguage *language;
+} Grammar;
+
+typedef struct {
+  uint32_t start_byte;
+  uint32_t end_byte;
+  TSPoint start_point;
+  const char *language;
+  // Index into `grammars`, or UINT32_MAX if none is registered.
+  uint32_t grammar;
+  uint64_t hash;
+  TSTree *tree;
+} Injection;
+
+typedef struct {
+  TSAsciidocInjector *injector;
+  // One parser per grammar, created on first use.
+  Array(TSParser *) parsers;
+} Worker;
+
+typedef struct {
+  uint32_t grammar;
+  uint32_t size;
+  uint32_t injection;
+} Job;
+
+typedef Array(Injection) InjectionArray;
+
+struct TSAsciidocInjector {
+  uint8_t *symbol_flags;
+  uint32_t symbol_count;
+  TSFieldId attributes_field;
+  TSFieldId content_field;
+  TSFieldId language_field;
+  TSFieldId open_field;
+
+  Array(char *) names;
+  Array(Grammar) grammars;
+
+  InjectionArray injections;
+  InjectionArray previous;
+  Array(TSAsciidocInjection) results;
+
+  // Workers [0, thread_count) run on their own threads; the last one is the
+  // calling thread's.
+  Worker *workers;
+  pthread_t *threads;
+  uint32_t thread_count;
+
+  // Guards everything below, and the injections and the workers' parsers
+  // while a run is set up: a worker woken late for the previous run takes
+  // the lock before it looks at the jobs. Jobs are whole code blocks, so
+  // workers only take the lock between parses.
+  pthread_mutex_t mutex;
+  pthread_cond_t start;
+  pthread_cond_t done;
+  uint64_t generation;
+  bool shutting_down;
+  const char *source;
+  Array(Job) jobs;
+  uint32_t next_job;
+  uint32_t finished;
+};
+
+static uint8_t symbol_flags(const TSAsciidocInjector *self, TSSymbol symbol) {
+  return symbol < self->symbol_count ? self->symbol_flags[symbol] : 0;
+}
+
+static int compare_alias(const void *key, const void *entry) {
+  return strcmp(key, ((const LanguageAlias *)entry)->alias);
+}
+
+// Copies the name up to the first attribute separator, lowercased. Returns
+// false if it does not fit in MAX_LANGUAGE_NAME.
+static bool fold_name(const char *name, uint32_t length, char *buffer, uint32_t *folded) {
+  uint32_t size = 0;
+  for (uint32_t i = 0; i < length; i++) {
+    char c = name[i];
+    if (c == ',' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      break;
+    }
+    if (size == MAX_LANGUAGE_NAME) {
+      return false;
+    }
+    buffer[size++] = c >= 'A' && c <= 'Z' ? (char)(c - 'A' + 'a') : c;
+  }
+  buffer[size] = '\0';
+  *folded = size;
+  return true;
+}
+
+const char *ts_asciidoc_language_name(const char *name, uint32_t length) {
+  char buffer[MAX_LANGUAGE_NAME + 1];
+  uint32_t folded;
+  if (!fold_name(name, length, buffer, &folded) || folded == 0) {
+    return NULL;
+  }
+  const LanguageAlias *alias =
+    bsearch(buffer, LANGUAGE_ALIASES, LANGUAGE_ALIAS_COUNT, sizeof(LanguageAlias), compare_alias);
+  return alias ? alias->name : NULL;
+}
+
+// The canonical name for `name`, so that equal languages compare equal as
+// pointers. Names outside the alias table are kept lowercased.
+static const char *intern_name(TSAsciidocInjector *self, const char *name, uint32_t length) {
+  const char *canonical = ts_asciidoc_language_name(name, length);
+  if (canonical) {
+    return canonical;
+  }
+
+  char buffer[MAX_LANGUAGE_NAME + 1];
+  uint32_t folded;
+  if (!fold_name(name, length, buffer, &folded) || folded == 0) {
+    return NULL;
+  }
+  for (uint32_t i = 0; i < self->names.size; i++) {
+    if (strcmp(self->names.contents[i], buffer) == 0) {
+      return self->names.contents[i];
+    }
+  }
+  char *copy = strdup(buffer);
+  array_push(&self->names, copy);
+  return copy;
+}
+
+static uint32_t find_grammar(const TSAsciidocInjector *self, const char *name) {
+  for (uint32_t i = 0; i < self->grammars.size; i++) {
+    if (self->grammars.contents[i].name == name) {
+      return i;
+    }
+  }
+  return UINT32_MAX;
+}
+
+// FNV-1a; reuse needs the same bytes, not a strong hash.
+static uint64_t hash_bytes(const char *bytes, uint32_t length) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (uint32_t i = 0; i < length; i++) {
+    hash = (hash ^ (uint8_t)bytes[i]) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+static void parse_injection(Worker *worker, Injection *injection) {
+  TSAsciidocInjector *self = worker->injector;
+  const TSLanguage *language = self->grammars.contents[injection->grammar].language;
+  TSParser *parser = worker->parsers.contents[injection->grammar];
+  if (!parser) {
+    parser = ts_parser_new();
+    worker->parsers.contents[injection->grammar] = parser;
+  }
+  if (ts_parser_language(parser) != language) {
+    ts_parser_set_language(parser, language);
+  }
+  injection->tree = ts_parser_parse_string(parser, NULL, self->source + injection->start_byte,
+                                           injection->end_byte - injection->start_byte);
+}
+
+// Called with the mutex held; returns with it held.
+static void run_jobs(Worker *worker) {
+  TSAsciidocInjector *self = worker->injector;
+  while (self->next_job < self->jobs.size) {
+    Job *job = &self->jobs.contents[self->next_job++];
+    Injection *injection = &self->injections.contents[job->injection];
+    pthread_mutex_unlock(&self->mutex);
+    parse_injection(worker, injection);
+    pthread_mutex_lock(&self->mutex);
+    if (++self->finished == self->jobs.size) {
+      pthread_cond_broadcast(&self->done);
+    }
+  }
+}
+
+static void *worker_main(void *payload) {
+  Worker *worker = payload;
+  TSAsciidocInjector *self = worker->injector;
+  uint64_t generation = 0;
+  pthread_mutex_lock(&self->mutex);
+  for (;;) {
+    while (self->generation == generation && !self->shutting_down) {
+      pthread_cond_wait(&self->start, &self->mutex);
+    }
+    if (self->shutting_down) {
+      break;
+    }
+    generation = self->generation;
+    run_jobs(worker);
+  }
+  pthread_mutex_unlock(&self->mutex);
+  return NULL;
+}
+
+TSAsciidocInjector *ts_asciidoc_injector_new(uint32_t thread_count) {
+  const TSLanguage *language = tree_sitter_asciidoc();
+  TSAsciidocInjector *self = calloc(1, sizeof(TSAsciidocInjector));
+  self->symbol_count = ts_language_symbol_count(language);
+  self->symbol_flags = calloc(self->symbol_count, 1);
+  editor_mark_symbols(language, self->symbol_flags, LISTING_SYMBOLS, SYMBOL_LISTING);
+  editor_mark_symbols(language, self->symbol_flags, FENCED_SYMBOLS, SYMBOL_FENCED);
+  editor_mark_symbols(language, self->symbol_flags, LEAF_SYMBOLS, SYMBOL_LEAF);
+  self->attributes_field = ts_language_field_id_for_name(language, "attributes", 10);
+  self->content_field = ts_language_field_id_for_name(language, "content", 7);
+  self->language_field = ts_language_field_id_for_name(language, "language", 8);
+  self->open_field = ts_language_field_id_for_name(language, "open", 4);
+
+  pthread_mutex_init(&self->mutex, NULL);
+  pthread_cond_init(&self->start, NULL);
+  pthread_cond_init(&self->done, NULL);
+
+  self->workers = calloc(thread_count + 1, sizeof(Worker));
+  self->threads = calloc(thread_count + 1, sizeof(pthread_t));
+  for (uint32_t i = 0; i <= thread_count; i++) {
+    self->workers[i].injector = self;
+  }
+  // A pool that could not start every thread just runs with fewer.
+  while (self->thread_count < thread_count &&
+         pthread_create(&self->threads[self->thread_count], NULL, worker_main,
+                        &self->workers[self->thread_count]) == 0) {
+    self->thread_count++;
+  }
+  return self;
+}
+
+static void delete_trees(InjectionArray *injections) {
+  for (uint32_t i = 0; i < injections->size; i++) {
+    if (injections->contents[i].tree) {
+      ts_tree_delete(injections->contents[i].tree);
+    }
+  }
+  array_clear(injections);
+}
+
+void ts_asciidoc_injector_delete(TSAsciidocInjector *self) {
+  if (!self) {
+    return;
+  }
+  pthread_mutex_lock(&self->mutex);
+  self->shutting_down = true;
+  pthread_cond_broadcast(&self->start);
+  pthread_mutex_unlock(&self->mutex);
+  for (uint32_t i = 0; i < self->thread_count; i++) {
+    pthread_join(self->threads[i], NULL);
+  }
+
+  for (uint32_t i = 0; i <= self->thread_count; i++) {
+    Worker *worker = &self->workers[i];
+    for (uint32_t j = 0; j < worker->parsers.size; j++) {
+      if (worker->parsers.contents[j]) {
+        ts_parser_delete(worker->parsers.contents[j]);
+      }
+    }
+    array_delete(&worker->parsers);
+  }
+  free(self->workers);
+  free(self->threads);
+  pthread_cond_destroy(&self->done);
+  pthread_cond_destroy(&self->start);
+  pthread_mutex_destroy(&self->mutex);
+
+  delete_trees(&self->injections);
+  delete_trees(&self->previous);
+  array_delete(&self->injections);
+  array_delete(&self->previous);
+  array_delete(&self->results);
+  array_delete(&self->jobs);
+  for (uint32_t i = 0; i < self->names.size; i++) {
+    free(self->names.contents[i]);
+  }
+  array_delete(&self->names);
+  array_delete(&self->grammars);
+  free(self->symbol_flags);
+  free(self);
+}
+
+void ts_asciidoc_injector_add_language(TSAsciidocInjector *self, const char *name,
+                                       const TSLanguage *language) {
+  const char *interned = intern_name(self, name, (uint32_t)strlen(name));
+  if (!interned) {
+    return;
+  }
+  uint32_t index = find_grammar(self, interned);
+  if (index != UINT32_MAX) {
+    self->grammars.contents[index].language = language;
+  } else {
+    array_push(&self->grammars, ((Grammar){.name = interned, .language = language}));
+  }
+}
+
+// Records the injection for a code block, if it names a language and has
+// content.
+static void add_injection(TSAsciidocInjector *self, TSNode block, uint8_t flags) {
+  TSNode language_node;
+  if (flags & SYMBOL_LISTING) {
+    TSNode attributes = ts_node_child_by_field_id(block, self->attributes_field);
+    if (ts_node_is_null(attributes)) {
+      return;
+    }
+    language_node = ts_node_child_by_field_id(attributes, self->language_field);
+  } else {
+    TSNode open = ts_node_child_by_field_id(block, self->open_field);
+    if (ts_node_is_null(open)) {
+      return;
+    }
+    language_node = ts_node_child_by_field_id(open, self->language_field);
+  }
+  TSNode content = ts_node_child_by_field_id(block, self->content_field);
+  if (ts_node_is_null(language_node) || ts_node_is_null(content)) {
+    return;
+  }
+
+  uint32_t start = ts_node_start_byte(content);
+  uint32_t end = ts_node_end_byte(content);
+  uint32_t language_start = ts_node_start_byte(language_node);
+  const char *name = intern_name(self, self->source + language_start,
+                                 ts_node_end_byte(language_node) - language_start);
+  if (!name || start == end) {
+    return;
+  }
+  array_push(&self->injections, ((Injection){
+                                  .start_byte = start,
+                                  .end_byte = end,
+                                  .start_point = ts_node_start_point(content),
+                                  .language = name,
+                                  .grammar = find_grammar(self, name),
+                                  .hash = hash_bytes(self->source + start, end - start),
+                                }));
+}
+
+static void collect_injections(TSAsciidocInjector *self, TSNode root, uint32_t start_byte,
+                               uint32_t end_byte) {
+  TSTreeCursor cursor = ts_tree_cursor_new(root);
+  uint32_t depth = 0;
+  if (ts_tree_cursor_goto_first_child_for_byte(&cursor, start_byte) >= 0) {
+    depth = 1;
+  }
+  while (depth > 0) {
+    TSNode node = ts_tree_cursor_current_node(&cursor);
+    if (ts_node_start_byte(node) >= end_byte) {
+      // Later siblings start further on; resume from the parent's sibling.
+      ts_tree_cursor_goto_parent(&cursor);
+      depth--;
+    } else {
+      uint8_t flags = symbol_flags(self, ts_node_symbol(node));
+      if (ts_node_end_byte(node) <= start_byte) {
+        // Before the window.
+      } else if (flags & (SYMBOL_LISTING | SYMBOL_FENCED)) {
+        add_injection(self, node, flags);
+      } else if (!(flags & SYMBOL_LEAF) && ts_tree_cursor_goto_first_child(&cursor)) {
+        depth++;
+        continue;
+      }
+    }
+
+    while (depth > 0 && !ts_tree_cursor_goto_next_sibling(&cursor)) {
+      ts_tree_cursor_goto_parent(&cursor);
+      depth--;
+    }
+  }
+  ts_tree_cursor_delete(&cursor);
+}
+
+static int compare_previous(const void *a, const void *b) {
+  const Injection *x = a;
+  const Injection *y = b;
+  return (x->hash > y->hash) - (x->hash < y->hash);
+}
+
+// Takes the tree of an unchanged injection from the previous run.
+static TSTree *take_previous_tree(TSAsciidocInjector *self, const Injection *injection) {
+  const TSLanguage *language = self->grammars.contents[injection->grammar].language;
+  uint32_t low = 0, high = self->previous.size;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (self->previous.contents[mid].hash < injection->hash) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  for (uint32_t i = low; i < self->previous.size; i++) {
+    Injection *candidate = &self->previous.contents[i];
+    if (candidate->hash != injection->hash) {
+      break;
+    }
+    uint32_t size = candidate->end_byte - candidate->start_byte;
+    if (candidate->tree && candidate->language == injection->language &&
+        size == injection->end_byte - injection->start_byte &&
+        ts_tree_language(candidate->tree) == language) {
+      TSTree *tree = candidate->tree;
+      candidate->tree = NULL;
+      return tree;
+    }
+  }
+  return NULL;
+}
+
+// Groups jobs by grammar, so that a worker keeps using the same parser, and
+// within a grammar puts the largest first, so that no worker is left with a
+// big block at the end.
+static int compare_jobs(const void *a, const void *b) {
+  const Job *x = a;
+  const Job *y = b;
+  if (x->grammar != y->grammar) {
+    return (x->grammar > y->grammar) - (x->grammar < y->grammar);
+  }
+  return (x->size < y->size) - (x->size > y->size);
+}
+
+// Called with the mutex held; returns with it held once every job is done.
+static void run_pool(TSAsciidocInjector *self) {
+  for (uint32_t i = 0; i <= self->thread_count; i++) {
+    Worker *worker = &self->workers[i];
+    while (worker->parsers.size < self->grammars.size) {
+      array_push(&worker->parsers, NULL);
+    }
+  }
+
+  if (self->thread_count > 0 && self->jobs.size > 1) {
+    self->generation++;
+    pthread_cond_broadcast(&self->start);
+  }
+  run_jobs(&self->workers[self->thread_count]);
+  while (self->finished < self->jobs.size) {
+    pthread_cond_wait(&self->done, &self->mutex);
+  }
+}
+
+const TSAsciidocInjection *ts_asciidoc_injector_parse(TSAsciidocInjector *self,
+                                                      const TSTree *tree, const char *source,
+                                                      uint32_t start_byte, uint32_t end_byte,
+                                                      uint32_t *count) {
+  pthread_mutex_lock(&self->mutex);
+  array_swap(&self->previous, &self->injections);
+  qsort(self->previous.contents, self->previous.size, sizeof(Injection), compare_previous);
+
+  self->source = source;
+  collect_injections(self, ts_tree_root_node(tree), start_byte, end_byte);
+
+  array_clear(&self->jobs);
+  self->next_job = 0;
+  self->finished = 0;
+  for (uint32_t i = 0; i < self->injections.size; i++) {
+    Injection *injection = &self->injections.contents[i];
+    if (injection->grammar == UINT32_MAX) {
+      continue;
+    }
+    injection->tree = take_previous_tree(self, injection);
+    if (!injection->tree) {
+      array_push(&self->jobs, ((Job){
+                                .grammar = injection->grammar,
+                                .size = injection->end_byte - injection->start_byte,
+                                .injection = i,
+                              }));
+    }
+  }
+  delete_trees(&self->previous);
+  qsort(self->jobs.contents, self->jobs.size, sizeof(Job), compare_jobs);
+  if (self->jobs.size > 0) {
+    run_pool(self);
+  }
+  self->source = NULL;
+  pthread_mutex_unlock(&self->mutex);
+
+  array_clear(&self->results);
+  for (uint32_t i = 0; i < self->injections.size; i++) {
+    const Injection *injection = &self->injections.contents[i];
+    array_push(&self->results, ((TSAsciidocInjection){
+                                 .start_byte = injection->start_byte,
+                                 .end_byte = injection->end_byte,
+                                 .start_point = injection->start_point,
+                                 .language = injection->language,
+                                 .tree = injection->tree,
+                               }));
+  }
+  *count = self->results.size;
+  return self->results.contents;
+}
+
+const TSAsciidocInjection *ts_asciidoc_injector_find(const TSAsciidocInjector *self,
+                                                     uint32_t byte) {
+  uint32_t low = 0, high = self->results.size;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (self->results.contents[mid].end_byte <= byte) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low < self->results.size && self->results.contents[low].start_byte <= byte) {
+    return &self->results.contents[low];
+  }
+  return NULL;
+}
@@ -0,0 +1,55 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "mapping.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int asciidoc_mapping_open(AsciidocMapping *self, const char *path) {
+  *self = (AsciidocMapping){.data = ""};
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return errno;
+  }
+  struct stat info;
+  int error = 0;
+  if (fstat(fd, &info) != 0) {
+    error = errno;
+  } else if (!S_ISREG(info.st_mode)) {
+    error = S_ISDIR(info.st_mode) ? EISDIR : EINVAL;
+  } else if ((uint64_t)info.st_size > UINT32_MAX) {
+    error = EFBIG;
+  } else if (info.st_size > 0) {
+    void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      error = errno;
+    } else {
+      self->map = map;
+      self->data = map;
+      self->length = (uint32_t)info.st_size;
+    }
+  }
+  close(fd);
+  if (!error) {
+    asciidoc_mapping_advise(self, true);
+  }
+  return error;
+}
+
+void asciidoc_mapping_close(AsciidocMapping *self) {
+  if (self->map) {
+    munmap(self->map, self->length);
+  }
+  *self = (AsciidocMapping){.data = ""};
+}
+
+void asciidoc_mapping_advise(const AsciidocMapping *self, bool sequential) {
+  // Advice is a hint; a kernel that ignores it costs readahead, not results.
+  if (self->map) {
+    (void)posix_madvise(self->map, self->length,
+                        sequential ? POSIX_MADV_SEQUENTIAL : POSIX_MADV_NORMAL);
+  }
+}
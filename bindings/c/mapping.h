@@ -0,0 +1,39 @@
+#ifndef TREE_SITTER_ASCIIDOC_MAPPING_H_
+#define TREE_SITTER_ASCIIDOC_MAPPING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Read-only file mappings without the tree-sitter runtime: the part of
+// TSAsciidocMappedFile that the Node binding shares, so that which files are
+// mapped and how the mapping is advised are decided in one place. Not
+// installed.
+
+typedef struct {
+  const char *data;
+  uint32_t length;
+  // NULL for an empty file.
+  void *map;
+} AsciidocMapping;
+
+// Maps `path` read-only and advises the mapping for sequential reading.
+// Returns 0, or an errno value: EFBIG for files of 4 GiB or more, EISDIR or
+// EINVAL for anything but a regular file. Empty files are not mapped and
+// read as "".
+int asciidoc_mapping_open(AsciidocMapping *self, const char *path);
+
+void asciidoc_mapping_close(AsciidocMapping *self);
+
+// Sequential advice enlarges readahead for a front-to-back parse; normal
+// advice suits random lookups of node text afterwards.
+void asciidoc_mapping_advise(const AsciidocMapping *self, bool sequential);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_MAPPING_H_
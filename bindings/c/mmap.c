@@ -0,0 +1,83 @@
+#include "tree_sitter/tree-sitter-asciidoc-mmap.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include "mapping.h"
+
+struct TSAsciidocMappedFile {
+  AsciidocMapping mapping;
+};
+
+TSAsciidocMappedFile *ts_asciidoc_mapped_file_open(const char *path) {
+  TSAsciidocMappedFile *self = malloc(sizeof(TSAsciidocMappedFile));
+  if (!self) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  int error = asciidoc_mapping_open(&self->mapping, path);
+  if (error) {
+    free(self);
+    errno = error;
+    return NULL;
+  }
+  return self;
+}
+
+void ts_asciidoc_mapped_file_close(TSAsciidocMappedFile *self) {
+  if (!self) {
+    return;
+  }
+  asciidoc_mapping_close(&self->mapping);
+  free(self);
+}
+
+const char *ts_asciidoc_mapped_file_data(const TSAsciidocMappedFile *self) {
+  return self->mapping.data;
+}
+
+uint32_t ts_asciidoc_mapped_file_length(const TSAsciidocMappedFile *self) {
+  return self->mapping.length;
+}
+
+static const char *read_input(void *payload, uint32_t byte, TSPoint point,
+                              uint32_t *bytes_read) {
+  (void)point;
+  const TSAsciidocMappedFile *self = payload;
+  if (byte >= self->mapping.length) {
+    *bytes_read = 0;
+    return "";
+  }
+  *bytes_read = self->mapping.length - byte;
+  return self->mapping.data + byte;
+}
+
+TSInput ts_asciidoc_mapped_file_input(const TSAsciidocMappedFile *self) {
+  return (TSInput){
+    .payload = (void *)self,
+    .read = read_input,
+    .encoding = TSInputEncodingUTF8,
+  };
+}
+
+TSTree *ts_asciidoc_mapped_file_parse(const TSAsciidocMappedFile *self, TSParser *parser,
+                                      const TSTree *old_tree) {
+  asciidoc_mapping_advise(&self->mapping, true);
+  TSTree *tree = ts_parser_parse(parser, old_tree, ts_asciidoc_mapped_file_input(self));
+  asciidoc_mapping_advise(&self->mapping, false);
+  return tree;
+}
+
+const char *ts_asciidoc_mapped_file_node_text(const TSAsciidocMappedFile *self, TSNode node,
+                                              uint32_t *length) {
+  uint32_t start = ts_node_start_byte(node);
+  uint32_t end = ts_node_end_byte(node);
+  if (end > self->mapping.length) {
+    end = self->mapping.length;
+  }
+  if (start > end) {
+    start = end;
+  }
+  *length = end - start;
+  return self->mapping.data + start;
+}
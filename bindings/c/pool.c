@@ -0,0 +1,220 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tree_sitter/tree-sitter-asciidoc-pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tree_sitter/array.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+#ifndef ASCIIDOC_POOL_MAX_IDLE
+#define ASCIIDOC_POOL_MAX_IDLE 64
+#endif
+
+#ifndef ASCIIDOC_POOL_MAX_RETAINED_BYTES
+#define ASCIIDOC_POOL_MAX_RETAINED_BYTES (16u << 20)
+#endif
+
+struct TSAsciidocLease {
+  TSParser *parser;
+  TSQueryCursor *cursor;
+  // Largest document parsed since the parser was created.
+  uint32_t largest_bytes;
+};
+
+typedef struct {
+  char *name;
+  TSQuery *query;
+} NamedQuery;
+
+struct TSAsciidocPool {
+  pthread_mutex_t mutex;
+  Array(TSAsciidocLease *) idle;
+  Array(NamedQuery) queries;
+  uint32_t max_idle;
+  uint32_t max_retained_bytes;
+  uint64_t timeout_micros;
+  uint32_t match_limit;
+  TSAsciidocPoolStats stats;
+};
+
+static void lease_delete(TSAsciidocLease *lease) {
+  ts_parser_delete(lease->parser);
+  ts_query_cursor_delete(lease->cursor);
+  free(lease);
+}
+
+TSAsciidocPool *ts_asciidoc_pool_new(void) {
+  TSAsciidocPool *self = calloc(1, sizeof(TSAsciidocPool));
+  pthread_mutex_init(&self->mutex, NULL);
+  self->max_idle = ASCIIDOC_POOL_MAX_IDLE;
+  self->max_retained_bytes = ASCIIDOC_POOL_MAX_RETAINED_BYTES;
+  return self;
+}
+
+void ts_asciidoc_pool_delete(TSAsciidocPool *self) {
+  if (!self) {
+    return;
+  }
+  for (uint32_t i = 0; i < self->idle.size; i++) {
+    lease_delete(self->idle.contents[i]);
+  }
+  for (uint32_t i = 0; i < self->queries.size; i++) {
+    free(self->queries.contents[i].name);
+    ts_query_delete(self->queries.contents[i].query);
+  }
+  array_delete(&self->idle);
+  array_delete(&self->queries);
+  pthread_mutex_destroy(&self->mutex);
+  free(self);
+}
+
+void ts_asciidoc_pool_set_max_idle(TSAsciidocPool *self, uint32_t count) {
+  pthread_mutex_lock(&self->mutex);
+  self->max_idle = count;
+  pthread_mutex_unlock(&self->mutex);
+}
+
+void ts_asciidoc_pool_set_max_retained_bytes(TSAsciidocPool *self, uint32_t bytes) {
+  pthread_mutex_lock(&self->mutex);
+  self->max_retained_bytes = bytes;
+  pthread_mutex_unlock(&self->mutex);
+}
+
+void ts_asciidoc_pool_set_timeout_micros(TSAsciidocPool *self, uint64_t timeout_micros) {
+  pthread_mutex_lock(&self->mutex);
+  self->timeout_micros = timeout_micros;
+  pthread_mutex_unlock(&self->mutex);
+}
+
+void ts_asciidoc_pool_set_match_limit(TSAsciidocPool *self, uint32_t limit) {
+  pthread_mutex_lock(&self->mutex);
+  self->match_limit = limit;
+  pthread_mutex_unlock(&self->mutex);
+}
+
+static TSQuery *find_query(const TSAsciidocPool *self, const char *name) {
+  for (uint32_t i = 0; i < self->queries.size; i++) {
+    if (strcmp(self->queries.contents[i].name, name) == 0) {
+      return self->queries.contents[i].query;
+    }
+  }
+  return NULL;
+}
+
+bool ts_asciidoc_pool_add_query(TSAsciidocPool *self, const char *name, const char *source,
+                                uint32_t length, uint32_t *error_offset, TSQueryError *error_type) {
+  // Compiled outside the lock, which lookups of other queries would wait on.
+  TSQuery *query = ts_query_new(tree_sitter_asciidoc(), source, length, error_offset, error_type);
+  if (!query) {
+    return false;
+  }
+  pthread_mutex_lock(&self->mutex);
+  bool taken = find_query(self, name) != NULL;
+  if (!taken) {
+    size_t size = strlen(name) + 1;
+    NamedQuery entry = {malloc(size), query};
+    memcpy(entry.name, name, size);
+    array_push(&self->queries, entry);
+  }
+  pthread_mutex_unlock(&self->mutex);
+  if (taken) {
+    ts_query_delete(query);
+    *error_offset = 0;
+    *error_type = TSQueryErrorNone;
+    return false;
+  }
+  return true;
+}
+
+const TSQuery *ts_asciidoc_pool_query(TSAsciidocPool *self, const char *name) {
+  pthread_mutex_lock(&self->mutex);
+  const TSQuery *query = find_query(self, name);
+  pthread_mutex_unlock(&self->mutex);
+  return query;
+}
+
+TSAsciidocLease *ts_asciidoc_pool_checkout(TSAsciidocPool *self) {
+  pthread_mutex_lock(&self->mutex);
+  TSAsciidocLease *lease = self->idle.size > 0 ? array_pop(&self->idle) : NULL;
+  if (lease) {
+    self->stats.reused++;
+  } else {
+    self->stats.created++;
+  }
+  self->stats.checked_out++;
+  uint64_t timeout_micros = self->timeout_micros;
+  uint32_t match_limit = self->match_limit;
+  pthread_mutex_unlock(&self->mutex);
+
+  if (!lease) {
+    lease = calloc(1, sizeof(TSAsciidocLease));
+    lease->parser = ts_parser_new();
+    ts_parser_set_language(lease->parser, tree_sitter_asciidoc());
+    lease->cursor = ts_query_cursor_new();
+  }
+  ts_parser_set_timeout_micros(lease->parser, timeout_micros);
+  ts_query_cursor_set_match_limit(lease->cursor, match_limit ? match_limit : UINT32_MAX);
+  return lease;
+}
+
+void ts_asciidoc_pool_return(TSAsciidocPool *self, TSAsciidocLease *lease) {
+  if (!lease) {
+    return;
+  }
+  ts_parser_reset(lease->parser);
+  ts_parser_set_included_ranges(lease->parser, NULL, 0);
+  ts_parser_set_logger(lease->parser, (TSLogger){NULL, NULL});
+  ts_parser_set_cancellation_flag(lease->parser, NULL);
+
+  pthread_mutex_lock(&self->mutex);
+  self->stats.checked_out--;
+  bool keep = self->idle.size < self->max_idle &&
+              (self->max_retained_bytes == 0 || lease->largest_bytes <= self->max_retained_bytes);
+  if (keep) {
+    array_push(&self->idle, lease);
+  } else {
+    self->stats.discarded++;
+  }
+  pthread_mutex_unlock(&self->mutex);
+  if (!keep) {
+    lease_delete(lease);
+  }
+}
+
+TSParser *ts_asciidoc_lease_parser(TSAsciidocLease *self) {
+  return self->parser;
+}
+
+TSQueryCursor *ts_asciidoc_lease_cursor(TSAsciidocLease *self) {
+  return self->cursor;
+}
+
+static TSTree *record_size(TSAsciidocLease *self, TSTree *tree) {
+  if (tree) {
+    uint32_t bytes = ts_node_end_byte(ts_tree_root_node(tree));
+    if (bytes > self->largest_bytes) {
+      self->largest_bytes = bytes;
+    }
+  }
+  return tree;
+}
+
+TSTree *ts_asciidoc_lease_parse(TSAsciidocLease *self, const TSTree *old_tree, TSInput input) {
+  return record_size(self, ts_parser_parse(self->parser, old_tree, input));
+}
+
+TSTree *ts_asciidoc_lease_parse_string(TSAsciidocLease *self, const TSTree *old_tree,
+                                       const char *string, uint32_t length) {
+  return record_size(self, ts_parser_parse_string(self->parser, old_tree, string, length));
+}
+
+TSAsciidocPoolStats ts_asciidoc_pool_stats(TSAsciidocPool *self) {
+  pthread_mutex_lock(&self->mutex);
+  TSAsciidocPoolStats stats = self->stats;
+  stats.idle = self->idle.size;
+  pthread_mutex_unlock(&self->mutex);
+  return stats;
+}
@@ -0,0 +1,418 @@
+#include "tree_sitter/tree-sitter-asciidoc-semantic-tokens.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "editor.h"
+#include "tree_sitter/tree-sitter-asciidoc-highlight.h"
+
+typedef struct {
+  uint32_t start_byte;
+  uint32_t end_byte;
+  uint32_t line;
+  // The line the client last saw, before any edits moved the token.
+  uint32_t sent_line;
+  uint32_t column;
+  uint32_t length;
+  uint32_t type;
+} Token;
+
+typedef Array(Token) TokenArray;
+
+// A delta edit while it is built: the old tokens [old_start, old_end) are
+// replaced by the new tokens [new_start, new_end).
+typedef struct {
+  uint32_t old_start;
+  uint32_t old_end;
+  uint32_t new_start;
+  uint32_t new_end;
+} Splice;
+
+// Position while walking the source: `column` is in the output encoding.
+typedef struct {
+  uint32_t byte;
+  uint32_t line;
+  uint32_t column;
+} Cursor;
+
+struct TSAsciidocSemanticTokens {
+  TSAsciidocHighlighter *highlighter;
+  TSAsciidocPositionEncoding encoding;
+  const char **legend;
+  uint32_t legend_size;
+  uint16_t none_capture;
+
+  TokenArray tokens;
+  TokenArray previous;
+  // Ranges invalidated by edits since the last update, in new-tree bytes.
+  RangeArray pending;
+  RangeArray changed;
+
+  Array(const TSAsciidocHighlightSpan *) stack;
+  Array(Splice) splices;
+  Array(TSAsciidocSemanticTokensEdit) edits;
+  Array(uint32_t) edit_data;
+  Array(uint32_t) data;
+  bool data_valid;
+};
+
+TSAsciidocSemanticTokens *ts_asciidoc_semantic_tokens_new(TSAsciidocPositionEncoding encoding) {
+  TSAsciidocHighlighter *highlighter = ts_asciidoc_highlighter_new();
+  if (!highlighter) {
+    return NULL;
+  }
+  TSAsciidocSemanticTokens *self = calloc(1, sizeof(TSAsciidocSemanticTokens));
+  self->highlighter = highlighter;
+  self->encoding = encoding;
+  self->legend_size = ts_asciidoc_highlighter_capture_count(highlighter);
+  self->legend = calloc(self->legend_size, sizeof(const char *));
+  self->none_capture = UINT16_MAX;
+  for (uint16_t i = 0; i < self->legend_size; i++) {
+    self->legend[i] = ts_asciidoc_highlighter_capture_name(highlighter, i);
+    if (strcmp(self->legend[i], "none") == 0) {
+      self->none_capture = i;
+    }
+  }
+  return self;
+}
+
+void ts_asciidoc_semantic_tokens_delete(TSAsciidocSemanticTokens *self) {
+  if (!self) {
+    return;
+  }
+  ts_asciidoc_highlighter_delete(self->highlighter);
+  free(self->legend);
+  array_delete(&self->tokens);
+  array_delete(&self->previous);
+  array_delete(&self->pending);
+  array_delete(&self->changed);
+  array_delete(&self->stack);
+  array_delete(&self->splices);
+  array_delete(&self->edits);
+  array_delete(&self->edit_data);
+  array_delete(&self->data);
+  free(self);
+}
+
+const char *const *ts_asciidoc_semantic_tokens_legend(const TSAsciidocSemanticTokens *self,
+                                                      uint32_t *count) {
+  *count = self->legend_size;
+  return self->legend;
+}
+
+// Tokens after the edit move by whole lines, which keeps their columns
+// valid. Tokens on the edited lines are clamped into the edit so that they
+// stay sorted; the update replaces them, as those lines are pending. The
+// delta is computed against `sent_line`, which edits leave alone.
+void ts_asciidoc_semantic_tokens_edit(TSAsciidocSemanticTokens *self, const TSInputEdit *edit) {
+  editor_edit_ranges(&self->pending, edit);
+  for (uint32_t i = 0; i < self->tokens.size; i++) {
+    Token *token = &self->tokens.contents[i];
+    if (token->line > edit->old_end_point.row) {
+      token->line = token->line - edit->old_end_point.row + edit->new_end_point.row;
+    } else if (token->line >= edit->start_point.row) {
+      token->line = edit->start_point.row;
+    }
+    if (token->start_byte >= edit->old_end_byte) {
+      token->start_byte = token->start_byte - edit->old_end_byte + edit->new_end_byte;
+      token->end_byte = token->end_byte - edit->old_end_byte + edit->new_end_byte;
+    } else if (token->end_byte > edit->start_byte) {
+      token->start_byte = token->start_byte > edit->start_byte ? edit->start_byte
+                                                                : token->start_byte;
+      token->end_byte = edit->new_end_byte;
+    }
+  }
+}
+
+static uint32_t line_start(const char *source, uint32_t byte) {
+  while (byte > 0 && source[byte - 1] != '\n') {
+    byte--;
+  }
+  return byte;
+}
+
+static uint32_t next_line_start(const char *source, uint32_t length, uint32_t byte) {
+  const char *newline = memchr(source + byte, '\n', length - byte);
+  return newline ? (uint32_t)(newline - source) + 1 : length;
+}
+
+// The row of a line-start byte, counted from the start of the smallest
+// node containing it.
+static uint32_t row_for_byte(TSNode root, const char *source, uint32_t byte) {
+  TSNode node = ts_node_descendant_for_byte_range(root, byte, byte);
+  uint32_t start = ts_node_start_byte(node);
+  uint32_t row = ts_node_start_point(node).row;
+  if (start > byte) {
+    start = 0;
+    row = 0;
+  }
+  for (const char *at = source + start; (at = memchr(at, '\n', byte - (at - source)));) {
+    row++;
+    at++;
+  }
+  return row;
+}
+
+static void advance(const TSAsciidocSemanticTokens *self, Cursor *cursor, const char *source,
+                    uint32_t byte) {
+  for (; cursor->byte < byte; cursor->byte++) {
+    uint8_t c = (uint8_t)source[cursor->byte];
+    if (c == '\n') {
+      cursor->line++;
+      cursor->column = 0;
+    } else if (self->encoding == TSAsciidocPositionUTF8) {
+      cursor->column++;
+    } else if ((c & 0xc0) != 0x80) {
+      // One UTF-16 unit per code point, two beyond the BMP.
+      cursor->column += c >= 0xf0 ? 2 : 1;
+    }
+  }
+}
+
+// Adds [start, end) as tokens of `type`, one per line, without line endings.
+static void emit(TSAsciidocSemanticTokens *self, Cursor *cursor, const char *source,
+                 uint32_t start, uint32_t end, uint16_t type) {
+  if (type == self->none_capture) {
+    return;
+  }
+  advance(self, cursor, source, start);
+  while (cursor->byte < end) {
+    const char *newline = memchr(source + cursor->byte, '\n', end - cursor->byte);
+    uint32_t line_end = newline ? (uint32_t)(newline - source) : end;
+    uint32_t token_end = line_end;
+    if (newline && token_end > cursor->byte && source[token_end - 1] == '\r') {
+      token_end--;
+    }
+    if (token_end > cursor->byte) {
+      Token token = {
+        .start_byte = cursor->byte,
+        .end_byte = token_end,
+        .line = cursor->line,
+        .column = cursor->column,
+        .type = type,
+      };
+      advance(self, cursor, source, token_end);
+      token.length = cursor->column - token.column;
+      array_push(&self->tokens, token);
+    }
+    advance(self, cursor, source, newline ? line_end + 1 : end);
+  }
+}
+
+// Tokenizes the whole lines in [start, end). Nested spans cut holes in the
+// spans around them.
+static void tokenize(TSAsciidocSemanticTokens *self, TSNode root, const char *source,
+                     uint32_t start, uint32_t end) {
+  uint32_t count;
+  const TSAsciidocHighlightSpan *spans =
+    ts_asciidoc_highlight(self->highlighter, root, start, end, &count);
+  Cursor cursor = {.byte = start, .line = row_for_byte(root, source, start), .column = 0};
+  uint32_t position = start;
+
+  array_clear(&self->stack);
+  for (uint32_t i = 0; i <= count; i++) {
+    uint32_t next_start = i < count ? spans[i].start_byte : end;
+    if (next_start < start) {
+      next_start = start;
+    }
+    // Close the spans that end before the next one starts.
+    while (self->stack.size > 0) {
+      const TSAsciidocHighlightSpan *top = *array_back(&self->stack);
+      uint32_t top_end = top->end_byte < end ? top->end_byte : end;
+      if (top_end > next_start) {
+        break;
+      }
+      if (top_end > position) {
+        emit(self, &cursor, source, position, top_end, top->capture);
+        position = top_end;
+      }
+      self->stack.size--;
+    }
+    if (i == count || next_start >= end) {
+      break;
+    }
+    if (self->stack.size > 0 && next_start > position) {
+      emit(self, &cursor, source, position, next_start, (*array_back(&self->stack))->capture);
+    }
+    if (next_start > position) {
+      position = next_start;
+    }
+    array_push(&self->stack, &spans[i]);
+  }
+}
+
+static void encode_at(const Token *token, uint32_t token_line, const Token *previous,
+                      uint32_t previous_line, uint32_t *data) {
+  uint32_t column = previous && previous_line == token_line ? previous->column : 0;
+  data[0] = token_line - previous_line;
+  data[1] = token->column - column;
+  data[2] = token->length;
+  data[3] = token->type;
+  data[4] = 0;
+}
+
+static void encode(const Token *token, const Token *previous, uint32_t *data) {
+  encode_at(token, token->line, previous, previous ? previous->line : 0, data);
+}
+
+// The encoding the client holds for an old token.
+static void encode_sent(const Token *token, const Token *previous, uint32_t *data) {
+  encode_at(token, token->sent_line, previous, previous ? previous->sent_line : 0, data);
+}
+
+// Encodes the new tokens [start, end) relative to their predecessors.
+static void encode_range(TSAsciidocSemanticTokens *self, uint32_t start, uint32_t end) {
+  for (uint32_t i = start; i < end; i++) {
+    array_grow_by(&self->edit_data, 5);
+    encode(&self->tokens.contents[i], i > 0 ? &self->tokens.contents[i - 1] : NULL,
+           self->edit_data.contents + self->edit_data.size - 5);
+  }
+}
+
+static bool same_encoding(const TSAsciidocSemanticTokens *self, uint32_t old_index,
+                          uint32_t new_index) {
+  uint32_t old_data[5], new_data[5];
+  encode_sent(&self->previous.contents[old_index],
+              old_index > 0 ? &self->previous.contents[old_index - 1] : NULL, old_data);
+  encode(&self->tokens.contents[new_index],
+         new_index > 0 ? &self->tokens.contents[new_index - 1] : NULL, new_data);
+  return memcmp(old_data, new_data, sizeof(old_data)) == 0;
+}
+
+// Turns the splices into delta edits. Each splice also re-sends the token
+// after it, whose encoding is relative to the last replaced token; the
+// parts that encode the same as before are trimmed off.
+static void build_edits(TSAsciidocSemanticTokens *self) {
+  array_clear(&self->edits);
+  array_clear(&self->edit_data);
+  Array(uint32_t) offsets = array_new();
+
+  for (uint32_t i = 0; i < self->splices.size; i++) {
+    Splice splice = self->splices.contents[i];
+    // Merge splices that touch, so that edits never overlap.
+    while (i + 1 < self->splices.size &&
+           self->splices.contents[i + 1].old_start <= splice.old_end + 1) {
+      splice.old_end = self->splices.contents[++i].old_end;
+      splice.new_end = self->splices.contents[i].new_end;
+    }
+    if (splice.old_end < self->previous.size) {
+      splice.old_end++;
+      splice.new_end++;
+    }
+
+    while (splice.old_start < splice.old_end && splice.new_start < splice.new_end &&
+           same_encoding(self, splice.old_start, splice.new_start)) {
+      splice.old_start++;
+      splice.new_start++;
+    }
+    while (splice.old_end > splice.old_start && splice.new_end > splice.new_start &&
+           same_encoding(self, splice.old_end - 1, splice.new_end - 1)) {
+      splice.old_end--;
+      splice.new_end--;
+    }
+    if (splice.old_start == splice.old_end && splice.new_start == splice.new_end) {
+      continue;
+    }
+
+    array_push(&offsets, self->edit_data.size);
+    encode_range(self, splice.new_start, splice.new_end);
+    array_push(&self->edits, ((TSAsciidocSemanticTokensEdit){
+                               .start = splice.old_start * 5,
+                               .delete_count = (splice.old_end - splice.old_start) * 5,
+                               .data_count = (splice.new_end - splice.new_start) * 5,
+                             }));
+  }
+
+  // The data buffer may have moved while growing.
+  for (uint32_t i = 0; i < self->edits.size; i++) {
+    self->edits.contents[i].data = self->edit_data.contents + offsets.contents[i];
+  }
+  array_delete(&offsets);
+}
+
+void ts_asciidoc_semantic_tokens_update(TSAsciidocSemanticTokens *self, const TSTree *old_tree,
+                                        const TSTree *new_tree, const char *source,
+                                        uint32_t length) {
+  TSNode root = ts_tree_root_node(new_tree);
+  array_clear(&self->changed);
+  if (!old_tree) {
+    editor_add_range(&self->changed, 0, length);
+  } else {
+    uint32_t count;
+    TSRange *ranges = ts_tree_get_changed_ranges(old_tree, new_tree, &count);
+    for (uint32_t i = 0; i < count; i++) {
+      editor_add_range(&self->changed, ranges[i].start_byte, ranges[i].end_byte);
+    }
+    free(ranges);
+    array_push_all(&self->changed, &self->pending);
+  }
+  array_clear(&self->pending);
+
+  // Tokens are per line, so re-tokenize whole lines. That includes the line
+  // an edit ends on, whose tokens moved by an unknown number of columns.
+  for (uint32_t i = 0; i < self->changed.size; i++) {
+    TSRange *range = &self->changed.contents[i];
+    uint32_t start = range->start_byte < length ? range->start_byte : length;
+    uint32_t end = range->end_byte < length ? range->end_byte : length;
+    range->start_byte = line_start(source, start);
+    range->end_byte = next_line_start(source, length, end);
+  }
+  editor_merge_ranges(&self->changed);
+
+  array_swap(&self->tokens, &self->previous);
+  array_clear(&self->tokens);
+  array_clear(&self->splices);
+  const TokenArray *previous = &self->previous;
+  uint32_t old = 0;
+  for (uint32_t i = 0; i < self->changed.size; i++) {
+    const TSRange *range = &self->changed.contents[i];
+    while (old < previous->size && previous->contents[old].start_byte < range->start_byte) {
+      array_push(&self->tokens, previous->contents[old++]);
+    }
+    Splice splice = {.old_start = old, .new_start = self->tokens.size};
+    // At the end of the document, also drop tokens left there by deletions.
+    while (old < previous->size && (previous->contents[old].start_byte < range->end_byte ||
+                                    range->end_byte == length)) {
+      old++;
+    }
+    tokenize(self, root, source, range->start_byte, range->end_byte);
+    splice.old_end = old;
+    splice.new_end = self->tokens.size;
+    array_push(&self->splices, splice);
+  }
+  while (old < previous->size) {
+    array_push(&self->tokens, previous->contents[old++]);
+  }
+
+  if (old_tree) {
+    build_edits(self);
+  } else {
+    array_clear(&self->edits);
+    array_clear(&self->edit_data);
+  }
+  for (uint32_t i = 0; i < self->tokens.size; i++) {
+    self->tokens.contents[i].sent_line = self->tokens.contents[i].line;
+  }
+  self->data_valid = false;
+}
+
+const uint32_t *ts_asciidoc_semantic_tokens_data(TSAsciidocSemanticTokens *self, uint32_t *count) {
+  if (!self->data_valid) {
+    array_clear(&self->data);
+    array_reserve(&self->data, self->tokens.size * 5);
+    for (uint32_t i = 0; i < self->tokens.size; i++) {
+      encode(&self->tokens.contents[i], i > 0 ? &self->tokens.contents[i - 1] : NULL,
+             self->data.contents + i * 5);
+    }
+    self->data.size = self->tokens.size * 5;
+    self->data_valid = true;
+  }
+  *count = self->data.size;
+  return self->data.contents;
+}
+
+const TSAsciidocSemanticTokensEdit *ts_asciidoc_semantic_tokens_delta(
+  const TSAsciidocSemanticTokens *self, uint32_t *count) {
+  *count = self->edits.size;
+  return self->edits.contents;
+}
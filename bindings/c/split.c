@@ -0,0 +1,253 @@
+#include "split.h"
+
+#include <string.h>
+
+// Must match src/scanner.c.
+#ifndef ASCIIDOC_FENCE_LINE_BUDGET
+#define ASCIIDOC_FENCE_LINE_BUDGET 4096
+#endif
+
+typedef enum {
+  LINE_TEXT,
+  LINE_BLANK,
+  LINE_FENCE,
+  LINE_HEADING,
+  LINE_CONDITIONAL,
+  LINE_ENDIF,
+  LINE_ANCHOR,
+} LineKind;
+
+typedef struct {
+  LineKind kind;
+  char marker;
+  // Marker characters in a fence line; pipes for a table fence. Zero for a
+  // fenced code line with a language, which can only open a block.
+  uint32_t length;
+} Line;
+
+static bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool starts_with(const char *line, uint32_t length, const char *prefix) {
+  size_t size = strlen(prefix);
+  return length >= size && memcmp(line, prefix, size) == 0;
+}
+
+// `ifdef::name[]` and `ifndef::name[]`; with text between the brackets the
+// directive is a single-line one and opens no block.
+static bool is_block_directive(const char *line, uint32_t length, uint32_t prefix) {
+  if (length < prefix + 3 || line[length - 2] != '[' || line[length - 1] != ']') {
+    return false;
+  }
+  for (uint32_t i = prefix; i < length - 2; i++) {
+    if (line[i] == '[' || line[i] == ']' || line[i] == ':') {
+      return false;
+    }
+  }
+  return true;
+}
+
+static Line classify(const char *line, uint32_t length) {
+  uint32_t trimmed = length;
+  while (trimmed > 0 && is_space(line[trimmed - 1])) {
+    trimmed--;
+  }
+  if (trimmed == 0) {
+    return (Line){LINE_BLANK, 0, 0};
+  }
+
+  char c = line[0];
+  uint32_t run = 1;
+  while (run < length && line[run] == c) {
+    run++;
+  }
+
+  switch (c) {
+    case '=':
+      if (run >= 2 && run <= 6 && run < length && (line[run] == ' ' || line[run] == '\t')) {
+        return (Line){LINE_HEADING, c, run};
+      }
+      return (Line){run >= 4 && run == trimmed ? LINE_FENCE : LINE_TEXT, c, run};
+    case '-':
+      if (run == trimmed && (run == 2 || run >= 4)) {
+        return (Line){LINE_FENCE, c, run};
+      }
+      return (Line){LINE_TEXT, 0, 0};
+    case '.':
+    case '+':
+    case '_':
+    case '*':
+    case '/':
+      return (Line){run >= 4 && run == trimmed ? LINE_FENCE : LINE_TEXT, c, run};
+    case '`':
+      if (run >= 3 && line[1] == '`' && line[2] == '`') {
+        return (Line){LINE_FENCE, c, trimmed == 3 ? 3 : 0};
+      }
+      return (Line){LINE_TEXT, 0, 0};
+    case '|':
+      if (run <= 2 && trimmed == run + 3 && memcmp(line + run, "===", 3) == 0) {
+        return (Line){LINE_FENCE, c, run};
+      }
+      return (Line){LINE_TEXT, 0, 0};
+    case 'i':
+      if ((starts_with(line, trimmed, "ifdef::") && is_block_directive(line, trimmed, 7)) ||
+          (starts_with(line, trimmed, "ifndef::") && is_block_directive(line, trimmed, 8)) ||
+          (starts_with(line, trimmed, "ifeval::[") && line[trimmed - 1] == ']')) {
+        return (Line){LINE_CONDITIONAL, 0, 0};
+      }
+      return (Line){LINE_TEXT, 0, 0};
+    case '[':
+      if (trimmed > 4 && line[1] == '[' && line[trimmed - 2] == ']' && line[trimmed - 1] == ']') {
+        return (Line){LINE_ANCHOR, 0, 0};
+      }
+      return (Line){LINE_TEXT, 0, 0};
+    case 'e':
+      if (trimmed == 9 && starts_with(line, trimmed, "endif::[]")) {
+        return (Line){LINE_ENDIF, 0, 0};
+      }
+      return (Line){LINE_TEXT, 0, 0};
+    default:
+      return (Line){LINE_TEXT, 0, 0};
+  }
+}
+
+// Whether `line` closes `fence`. Verbatim blocks end at the first fence
+// with their marker, as the grammar's tokens do; compound blocks nest, so
+// their closing fence must have the length of the opening one.
+static bool closes(const Fence *fence, Line line) {
+  if (line.kind != LINE_FENCE || line.marker != fence->marker) {
+    return false;
+  }
+  switch (fence->marker) {
+    case '`':
+      return line.length == 3;
+    case '-':
+      return fence->verbatim ? line.length >= 4 : line.length == 2;
+    default:
+      return fence->verbatim || line.length == fence->length;
+  }
+}
+
+static Fence open_fence(Line line) {
+  Fence fence = {.marker = line.marker, .length = line.length};
+  switch (line.marker) {
+    case '-':
+      fence.verbatim = line.length >= 4;
+      fence.bounded = fence.verbatim;
+      break;
+    case '.':
+    case '+':
+    case '_':
+    case '|':
+      fence.verbatim = true;
+      fence.bounded = true;
+      break;
+    case '/':
+    case '`':
+      fence.verbatim = true;
+      break;
+    default:
+      break;
+  }
+  return fence;
+}
+
+// Follows scan_unclosed_fence in src/scanner.c one line at a time. Returns
+// true once the scanner would have ended the block before `line`, which then
+// belongs to the blocks after it; otherwise counts `line` as body.
+static bool bounded_block_ended(Fence *fence, Line line, char first) {
+  if (ASCIIDOC_FENCE_LINE_BUDGET > 0 && fence->lines == ASCIIDOC_FENCE_LINE_BUDGET) {
+    return true;
+  }
+  if (closes(fence, line)) {
+    return fence->past_heading && fence->opens_block;
+  }
+  if (line.kind == LINE_HEADING && !fence->past_heading) {
+    fence->past_heading = true;
+    if (ASCIIDOC_FENCE_LINE_BUDGET == 0) {
+      return true;
+    }
+  } else if (fence->past_heading &&
+             (line.kind == LINE_FENCE || line.kind == LINE_CONDITIONAL ||
+              line.kind == LINE_ENDIF)) {
+    fence->skipped = true;
+  }
+  fence->opens_block = line.kind == LINE_BLANK || first == '[' || first == '.';
+  fence->lines++;
+  return false;
+}
+
+void split_scanner_reset(SplitScanner *self) {
+  array_clear(&self->fences);
+  self->conditionals = 0;
+  self->row = 0;
+  self->block_start = 0;
+  self->block_row = 0;
+  self->after_blank = false;
+}
+
+void split_scanner_delete(SplitScanner *self) {
+  array_delete(&self->fences);
+}
+
+void split_scanner_rebase(SplitScanner *self, uint32_t shift) {
+  self->block_start = self->block_start > shift ? self->block_start - shift : 0;
+}
+
+// A heading is only safe where every block before it has ended. After a
+// paragraph line it may be read as more of the paragraph, and inside a
+// block or a conditional the section would end at the cut instead of at the
+// end of the block.
+//
+// The scanner ends a listing, literal, passthrough, quote or table block
+// without a reachable closing fence at the next heading or the line budget.
+// Past a heading, whether the block ended there is only known at the next
+// fence of its kind or at the budget, by which time the lines in between
+// were read as body. Split points among them are lost, and if a fence or a
+// conditional was among them, the rest of the document is kept in one
+// piece, never cut in the wrong place.
+bool split_scanner_line(SplitScanner *self, const char *text, uint32_t length, uint32_t start,
+                        uint32_t *split, uint32_t *row) {
+  Line line = classify(text, length);
+  Fence *top = self->fences.size > 0 ? array_back(&self->fences) : NULL;
+  if (top && top->bounded && bounded_block_ended(top, line, length > 0 ? text[0] : 0)) {
+    bool lost = top->past_heading && top->skipped;
+    self->fences.size--;
+    if (lost) {
+      // Never closed.
+      array_push(&self->fences, ((Fence){.verbatim = true}));
+    }
+    top = self->fences.size > 0 ? array_back(&self->fences) : NULL;
+  }
+  bool found = false;
+  if (top && closes(top, line)) {
+    self->fences.size--;
+  } else if (top && top->verbatim) {
+    // Body text.
+  } else if (line.kind == LINE_FENCE) {
+    if (line.marker != '`' || line.length == 3 || line.length == 0) {
+      array_push(&self->fences, open_fence(line));
+    }
+  } else if (line.kind == LINE_CONDITIONAL) {
+    self->conditionals++;
+  } else if (line.kind == LINE_ENDIF) {
+    if (self->conditionals > 0) {
+      self->conditionals--;
+    }
+  } else if (line.kind == LINE_HEADING && line.length == 2 && self->after_blank &&
+             self->fences.size == 0 && self->conditionals == 0 && self->block_start > 0) {
+    *split = self->block_start;
+    *row = self->block_row;
+    found = true;
+  }
+  if (line.kind == LINE_BLANK) {
+    self->after_blank = true;
+    self->block_start = start + length + 1;
+    self->block_row = self->row + 1;
+  } else if (line.kind != LINE_ANCHOR) {
+    self->after_blank = false;
+  }
+  self->row++;
+  return found;
+}
@@ -0,0 +1,61 @@
+#ifndef TREE_SITTER_ASCIIDOC_SPLIT_H_
+#define TREE_SITTER_ASCIIDOC_SPLIT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tree_sitter/array.h"
+
+// Finds the places where a document can be cut into pieces that parse on
+// their own into the same top-level blocks as the whole document: level 1
+// section headings after a blank line, outside every delimited block and
+// conditional. Lines are fed one at a time, so the document does not have
+// to be in memory at once. Shared by the chunked and streaming parsers.
+// Not installed.
+
+typedef struct {
+  char marker;
+  uint32_t length;
+  // The body is not parsed as blocks, so only the closing fence matters.
+  bool verbatim;
+  // A block the external scanner ends early when its closing fence is out
+  // of reach, see split_scanner_line.
+  bool bounded;
+  // Body lines so far, whether a section heading was among them, and
+  // whether the last one may come right before the fence of a new block.
+  uint32_t lines;
+  bool past_heading;
+  bool opens_block;
+  // A fence or conditional line after that heading.
+  bool skipped;
+} Fence;
+
+typedef struct {
+  Array(Fence) fences;
+  uint32_t conditionals;
+  uint32_t row;
+  // Start and row of the line after the last blank line, while that line
+  // and the ones after it are anchors.
+  uint32_t block_start;
+  uint32_t block_row;
+  bool after_blank;
+} SplitScanner;
+
+// Prepares the scanner for a new document, keeping its memory.
+void split_scanner_reset(SplitScanner *self);
+
+void split_scanner_delete(SplitScanner *self);
+
+// Moves the byte positions of the lines fed so far down by `shift`, for a
+// caller that counts from a later byte from now on. A split point that would
+// fall at or before the new byte 0 is no longer reported.
+void split_scanner_rebase(SplitScanner *self, uint32_t shift);
+
+// Feeds the line at byte `start` of the document, `length` bytes without its
+// line ending. Returns true if the document can be cut before this line or
+// before the anchor lines just above it, and sets `*split` and `*row` to
+// that position.
+bool split_scanner_line(SplitScanner *self, const char *line, uint32_t length, uint32_t start,
+                        uint32_t *split, uint32_t *row);
+
+#endif // TREE_SITTER_ASCIIDOC_SPLIT_H_
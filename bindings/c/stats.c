@@ -0,0 +1,171 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tree_sitter/tree-sitter-asciidoc-stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "tree_sitter/array.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+// sizeof(SubtreeHeapData) in the runtime on 64-bit hosts.
+#ifndef ASCIIDOC_STATS_HEAP_NODE_BYTES
+#define ASCIIDOC_STATS_HEAP_NODE_BYTES 80
+#endif
+
+#define SLOT_BYTES 8
+#define NO_KIND UINT32_MAX
+
+struct TSAsciidocStats {
+  const TSLanguage *language;
+  // Kind index of every symbol, NO_KIND for hidden ones.
+  uint32_t *kind_of_symbol;
+  uint32_t symbol_count;
+  TSAsciidocKindStats *kinds;
+  uint32_t kind_count;
+  TSAsciidocTreeStats totals;
+  Array(uint32_t) enclosing;
+};
+
+TSAsciidocStats *ts_asciidoc_stats_new(void) {
+  TSAsciidocStats *self = calloc(1, sizeof(TSAsciidocStats));
+  self->language = tree_sitter_asciidoc();
+  self->symbol_count = ts_language_symbol_count(self->language);
+  self->kind_of_symbol = malloc(self->symbol_count * sizeof(uint32_t));
+  // One more for ERROR, which is outside the symbol table.
+  self->kinds = calloc(self->symbol_count + 1, sizeof(TSAsciidocKindStats));
+
+  for (TSSymbol symbol = 0; symbol < self->symbol_count; symbol++) {
+    self->kind_of_symbol[symbol] = NO_KIND;
+    TSSymbolType type = ts_language_symbol_type(self->language, symbol);
+    if (type != TSSymbolTypeRegular && type != TSSymbolTypeAnonymous) {
+      continue;
+    }
+    // Aliases and tokens sharing a name with another symbol map to the
+    // first symbol of that name, as in node-types.json.
+    const char *name = ts_language_symbol_name(self->language, symbol);
+    bool named = type == TSSymbolTypeRegular;
+    TSSymbol first =
+      ts_language_symbol_for_name(self->language, name, (uint32_t)strlen(name), named);
+    if (first < symbol && self->kind_of_symbol[first] != NO_KIND) {
+      self->kind_of_symbol[symbol] = self->kind_of_symbol[first];
+      continue;
+    }
+    self->kind_of_symbol[symbol] = self->kind_count;
+    self->kinds[self->kind_count++] = (TSAsciidocKindStats){.kind = name, .named = named};
+  }
+  self->kinds[self->kind_count++] = (TSAsciidocKindStats){.kind = "ERROR", .named = true};
+  return self;
+}
+
+void ts_asciidoc_stats_delete(TSAsciidocStats *self) {
+  if (!self) {
+    return;
+  }
+  array_delete(&self->enclosing);
+  free(self->kinds);
+  free(self->kind_of_symbol);
+  free(self);
+}
+
+static uint32_t kind_of(const TSAsciidocStats *self, TSNode node) {
+  if (ts_node_is_error(node)) {
+    return self->kind_count - 1;
+  }
+  TSSymbol symbol = ts_node_symbol(node);
+  return symbol < self->symbol_count ? self->kind_of_symbol[symbol] : NO_KIND;
+}
+
+// Whether the runtime stores this leaf in its parent's child slot instead
+// of on the heap; see ts_subtree_can_inline.
+static bool is_inline_leaf(TSNode node, uint32_t padding_bytes, uint32_t padding_rows) {
+  TSPoint start = ts_node_start_point(node);
+  TSPoint end = ts_node_end_point(node);
+  return ts_node_symbol(node) <= UINT8_MAX && padding_bytes < 255 && padding_rows < 16 &&
+         start.row == end.row && end.column - start.column < 255;
+}
+
+TSAsciidocTreeStats ts_asciidoc_stats_add_tree(TSAsciidocStats *self, const TSTree *tree) {
+  TSAsciidocTreeStats stats = {0};
+  TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(tree));
+  array_clear(&self->enclosing);
+  uint32_t last_end_byte = 0;
+  uint32_t last_end_row = 0;
+  // Nearest kind other than ERROR among the ancestors, or NO_KIND.
+  uint32_t outer = NO_KIND;
+
+  for (;;) {
+    TSNode node = ts_tree_cursor_current_node(&cursor);
+    uint32_t kind = kind_of(self, node);
+    uint32_t start_byte = ts_node_start_byte(node);
+    uint32_t end_byte = ts_node_end_byte(node);
+    bool leaf = ts_node_child_count(node) == 0;
+
+    uint64_t memory = self->enclosing.size > 0 ? SLOT_BYTES : 0;
+    if (leaf) {
+      uint32_t padding_bytes = start_byte > last_end_byte ? start_byte - last_end_byte : 0;
+      uint32_t start_row = ts_node_start_point(node).row;
+      uint32_t padding_rows = start_row > last_end_row ? start_row - last_end_row : 0;
+      if (ts_node_is_error(node) || !is_inline_leaf(node, padding_bytes, padding_rows)) {
+        memory += ASCIIDOC_STATS_HEAP_NODE_BYTES;
+      }
+      last_end_byte = end_byte;
+      last_end_row = ts_node_end_point(node).row;
+    } else {
+      memory += ASCIIDOC_STATS_HEAP_NODE_BYTES;
+    }
+
+    stats.nodes++;
+    stats.memory_bytes += memory;
+    if (kind != NO_KIND) {
+      TSAsciidocKindStats *entry = &self->kinds[kind];
+      entry->count++;
+      entry->bytes += end_byte - start_byte;
+      entry->memory_bytes += memory;
+    }
+    bool is_error = ts_node_is_error(node);
+    bool is_missing = ts_node_is_missing(node);
+    stats.errors += is_error;
+    stats.missing += is_missing;
+    if ((is_error || is_missing) && outer != NO_KIND) {
+      self->kinds[outer].errors_within += is_error;
+      self->kinds[outer].missing_within += is_missing;
+    }
+
+    if (ts_tree_cursor_goto_first_child(&cursor)) {
+      array_push(&self->enclosing, outer);
+      if (!is_error && kind != NO_KIND) {
+        outer = kind;
+      }
+      continue;
+    }
+    while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+      if (!ts_tree_cursor_goto_parent(&cursor)) {
+        goto done;
+      }
+      outer = array_pop(&self->enclosing);
+    }
+  }
+
+done:
+  ts_tree_cursor_delete(&cursor);
+  stats.bytes = ts_node_end_byte(ts_tree_root_node(tree));
+  self->totals.nodes += stats.nodes;
+  self->totals.bytes += stats.bytes;
+  self->totals.memory_bytes += stats.memory_bytes;
+  self->totals.errors += stats.errors;
+  self->totals.missing += stats.missing;
+  return stats;
+}
+
+TSAsciidocTreeStats ts_asciidoc_stats_totals(const TSAsciidocStats *self) {
+  return self->totals;
+}
+
+uint32_t ts_asciidoc_stats_kind_count(const TSAsciidocStats *self) {
+  return self->kind_count;
+}
+
+TSAsciidocKindStats ts_asciidoc_stats_kind(const TSAsciidocStats *self, uint32_t index) {
+  return self->kinds[index];
+}
@@ -0,0 +1,326 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tree_sitter/tree-sitter-asciidoc-stream.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "split.h"
+#include "tree_sitter/array.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+#ifndef ASCIIDOC_STREAM_CHUNK_BYTES
+#define ASCIIDOC_STREAM_CHUNK_BYTES (64 * 1024)
+#endif
+
+#ifndef ASCIIDOC_STREAM_MIN_SEGMENT_BYTES
+#define ASCIIDOC_STREAM_MIN_SEGMENT_BYTES (256 * 1024)
+#endif
+
+// Long enough for a UTF-8 character that crosses a chunk boundary.
+#define SEAM_BYTES 8
+
+struct TSAsciidocStream {
+  TSAsciidocBlockCallback callback;
+  void *payload;
+  TSParser *parser;
+  SplitScanner scanner;
+
+  // Chunks in input order: chunks[0] holds the bytes from `base`. Released
+  // chunks are kept in `spare` for reuse.
+  Array(char *) chunks;
+  Array(char *) spare;
+  uint32_t base;
+  uint32_t length;
+  // Offset in the stream of byte 0. All the positions here count from it,
+  // and it moves up to `base` whenever chunks are released, so that they
+  // fit in 32 bits however long the stream gets.
+  uint64_t origin;
+
+  // Start of the first line not yet fed to the scanner, and where the
+  // search for its newline resumes.
+  uint32_t line_start;
+  uint32_t search_start;
+  // The segment being accumulated, and the end of the one being parsed.
+  uint32_t segment_start;
+  uint32_t segment_row;
+  uint32_t segment_end;
+
+  Array(char) line;
+  Array(char) text;
+  char seam[SEAM_BYTES];
+  TSAsciidocStreamStats stats;
+};
+
+TSAsciidocStream *ts_asciidoc_stream_new(TSAsciidocBlockCallback callback, void *payload) {
+  TSAsciidocStream *self = calloc(1, sizeof(TSAsciidocStream));
+  self->callback = callback;
+  self->payload = payload;
+  self->parser = ts_parser_new();
+  ts_parser_set_language(self->parser, tree_sitter_asciidoc());
+  return self;
+}
+
+void ts_asciidoc_stream_delete(TSAsciidocStream *self) {
+  if (!self) {
+    return;
+  }
+  for (uint32_t i = 0; i < self->chunks.size; i++) {
+    free(self->chunks.contents[i]);
+  }
+  for (uint32_t i = 0; i < self->spare.size; i++) {
+    free(self->spare.contents[i]);
+  }
+  array_delete(&self->chunks);
+  array_delete(&self->spare);
+  array_delete(&self->line);
+  array_delete(&self->text);
+  split_scanner_delete(&self->scanner);
+  ts_parser_delete(self->parser);
+  free(self);
+}
+
+static char *chunk_at(const TSAsciidocStream *self, uint32_t byte) {
+  return self->chunks.contents[(byte - self->base) / ASCIIDOC_STREAM_CHUNK_BYTES] +
+         (byte - self->base) % ASCIIDOC_STREAM_CHUNK_BYTES;
+}
+
+// Bytes from `byte` to the end of its chunk or to `end`, whichever is first.
+static uint32_t contiguous(const TSAsciidocStream *self, uint32_t byte, uint32_t end) {
+  uint32_t available =
+    ASCIIDOC_STREAM_CHUNK_BYTES - (byte - self->base) % ASCIIDOC_STREAM_CHUNK_BYTES;
+  return available < end - byte ? available : end - byte;
+}
+
+// Copies [start, end) out of the chunks. The range must not be released.
+static void copy_range(const TSAsciidocStream *self, uint32_t start, uint32_t end, char *out) {
+  while (start < end) {
+    uint32_t size = contiguous(self, start, end);
+    memcpy(out, chunk_at(self, start), size);
+    out += size;
+    start += size;
+  }
+}
+
+static const char *read_input(void *payload, uint32_t byte, TSPoint point,
+                              uint32_t *bytes_read) {
+  (void)point;
+  TSAsciidocStream *self = payload;
+  if (byte < self->base || byte >= self->segment_end) {
+    *bytes_read = 0;
+    return "";
+  }
+  uint32_t size = contiguous(self, byte, self->segment_end);
+  // The lexer rereads a character cut off by the end of a chunk from its
+  // first byte, so it has to come back whole.
+  if (size < 4 && byte + size < self->segment_end) {
+    size = self->segment_end - byte < SEAM_BYTES ? self->segment_end - byte : SEAM_BYTES;
+    copy_range(self, byte, byte + size, self->seam);
+    *bytes_read = size;
+    return self->seam;
+  }
+  *bytes_read = size;
+  return chunk_at(self, byte);
+}
+
+// Parses [segment_start, end), delivers its top-level blocks and releases
+// the chunks that only hold bytes before `end`.
+static void deliver(TSAsciidocStream *self, uint32_t end, TSPoint end_point) {
+  if (end > self->segment_start) {
+    TSRange range = {
+      .start_point = {self->segment_row, 0},
+      .end_point = end_point,
+      .start_byte = self->segment_start,
+      .end_byte = end,
+    };
+    ts_parser_set_included_ranges(self->parser, &range, 1);
+    self->segment_end = end;
+    TSInput input = {.payload = self, .read = read_input, .encoding = TSInputEncodingUTF8};
+    TSTree *tree = ts_parser_parse(self->parser, NULL, input);
+    TSNode root = ts_tree_root_node(tree);
+    uint32_t count = ts_node_named_child_count(root);
+    for (uint32_t i = 0; i < count; i++) {
+      TSNode block = ts_node_named_child(root, i);
+      self->stats.blocks++;
+      if (ts_node_has_error(block)) {
+        self->stats.error_blocks++;
+      }
+      if (self->callback) {
+        self->callback(self->payload, self, block);
+      }
+    }
+    ts_tree_delete(tree);
+    self->stats.segments++;
+    if (end - self->segment_start > self->stats.largest_segment) {
+      self->stats.largest_segment = end - self->segment_start;
+    }
+  }
+
+  self->segment_start = end;
+  self->segment_row = end_point.row;
+  while (self->chunks.size > 0 && self->base + ASCIIDOC_STREAM_CHUNK_BYTES <= end) {
+    array_push(&self->spare, self->chunks.contents[0]);
+    array_erase(&self->chunks, 0);
+    self->base += ASCIIDOC_STREAM_CHUNK_BYTES;
+  }
+}
+
+// Makes the first byte held byte 0.
+static void rebase(TSAsciidocStream *self) {
+  uint32_t shift = self->base;
+  self->origin += shift;
+  self->base = 0;
+  self->length -= shift;
+  self->line_start -= shift;
+  self->search_start -= shift;
+  self->segment_start -= shift;
+  self->segment_end -= shift;
+  split_scanner_rebase(&self->scanner, shift);
+}
+
+// Feeds the complete lines written since the last call to the scanner and
+// delivers a segment at each split point far enough from the last one.
+static void scan_lines(TSAsciidocStream *self) {
+  while (self->search_start < self->length) {
+    uint32_t size = contiguous(self, self->search_start, self->length);
+    const char *from = chunk_at(self, self->search_start);
+    const char *newline = memchr(from, '\n', size);
+    if (!newline) {
+      self->search_start += size;
+      continue;
+    }
+
+    uint32_t end = self->search_start + (uint32_t)(newline - from);
+    const char *line;
+    if (end - self->line_start <= contiguous(self, self->line_start, end)) {
+      line = chunk_at(self, self->line_start);
+    } else {
+      array_reserve(&self->line, end - self->line_start);
+      copy_range(self, self->line_start, end, self->line.contents);
+      line = self->line.contents;
+    }
+
+    uint32_t split, row;
+    bool cut = split_scanner_line(&self->scanner, line, end - self->line_start, self->line_start,
+                                  &split, &row) &&
+               split - self->segment_start >= ASCIIDOC_STREAM_MIN_SEGMENT_BYTES;
+    if (cut) {
+      deliver(self, split, (TSPoint){row, 0});
+    }
+    self->line_start = end + 1;
+    self->search_start = end + 1;
+    if (cut) {
+      rebase(self);
+    }
+  }
+}
+
+static void update_peak(TSAsciidocStream *self) {
+  uint64_t buffered =
+    (uint64_t)(self->chunks.size + self->spare.size) * ASCIIDOC_STREAM_CHUNK_BYTES;
+  if (buffered > self->stats.peak_buffered_bytes) {
+    self->stats.peak_buffered_bytes = buffered;
+  }
+}
+
+// Room at the end of the input for at least one more byte.
+static char *tail(TSAsciidocStream *self, uint32_t *room) {
+  uint32_t used = self->length - self->base;
+  if (used == self->chunks.size * ASCIIDOC_STREAM_CHUNK_BYTES) {
+    char *chunk =
+      self->spare.size > 0 ? array_pop(&self->spare) : malloc(ASCIIDOC_STREAM_CHUNK_BYTES);
+    array_push(&self->chunks, chunk);
+    update_peak(self);
+  }
+  *room = ASCIIDOC_STREAM_CHUNK_BYTES - used % ASCIIDOC_STREAM_CHUNK_BYTES;
+  if (*room > UINT32_MAX - self->length) {
+    *room = UINT32_MAX - self->length;
+  }
+  return self->chunks.contents[used / ASCIIDOC_STREAM_CHUNK_BYTES] +
+         used % ASCIIDOC_STREAM_CHUNK_BYTES;
+}
+
+bool ts_asciidoc_stream_write(TSAsciidocStream *self, const char *data, uint32_t length) {
+  while (length > 0) {
+    uint32_t room;
+    char *destination = tail(self, &room);
+    if (room == 0) {
+      return false;
+    }
+    uint32_t size = room < length ? room : length;
+    memcpy(destination, data, size);
+    self->length += size;
+    self->stats.bytes += size;
+    data += size;
+    length -= size;
+    scan_lines(self);
+  }
+  return true;
+}
+
+bool ts_asciidoc_stream_read_fd(TSAsciidocStream *self, int fd) {
+  for (;;) {
+    uint32_t room;
+    char *destination = tail(self, &room);
+    if (room == 0) {
+      ts_asciidoc_stream_finish(self);
+      errno = EFBIG;
+      return false;
+    }
+    ssize_t count = read(fd, destination, room);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int error = errno;
+      ts_asciidoc_stream_finish(self);
+      errno = error;
+      return false;
+    }
+    if (count == 0) {
+      break;
+    }
+    self->length += (uint32_t)count;
+    self->stats.bytes += (uint64_t)count;
+    scan_lines(self);
+  }
+  ts_asciidoc_stream_finish(self);
+  return true;
+}
+
+void ts_asciidoc_stream_finish(TSAsciidocStream *self) {
+  deliver(self, self->length, (TSPoint){self->scanner.row, self->length - self->line_start});
+
+  while (self->chunks.size > 0) {
+    array_push(&self->spare, array_pop(&self->chunks));
+  }
+  self->base = 0;
+  self->length = 0;
+  self->origin = 0;
+  self->line_start = 0;
+  self->search_start = 0;
+  self->segment_start = 0;
+  self->segment_row = 0;
+  split_scanner_reset(&self->scanner);
+}
+
+const char *ts_asciidoc_stream_text(TSAsciidocStream *self, uint32_t start_byte,
+                                    uint32_t end_byte) {
+  if (start_byte < self->base || end_byte > self->length || start_byte > end_byte) {
+    return NULL;
+  }
+  array_reserve(&self->text, end_byte - start_byte + 1);
+  copy_range(self, start_byte, end_byte, self->text.contents);
+  self->text.contents[end_byte - start_byte] = '\0';
+  return self->text.contents;
+}
+
+uint64_t ts_asciidoc_stream_origin(const TSAsciidocStream *self) {
+  return self->origin;
+}
+
+TSAsciidocStreamStats ts_asciidoc_stream_stats(const TSAsciidocStream *self) {
+  return self->stats;
+}
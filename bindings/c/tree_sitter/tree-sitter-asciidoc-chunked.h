@@ -0,0 +1,103 @@
+#ifndef TREE_SITTER_ASCIIDOC_CHUNKED_H_
+#define TREE_SITTER_ASCIIDOC_CHUNKED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parallel parsing of very large documents.
+//
+// A level 1 section heading (`== Title`) at the start of a line ends every
+// block before it, so the document can be cut there and the pieces parsed
+// on their own. A prescan walks the lines of the document once, keeping
+// track of open delimited blocks, comment blocks and conditional
+// directives, and records the headings that come after a blank line
+// outside all of them. A listing, literal, passthrough, quote or table
+// block whose closing fence the external scanner cannot reach ends at the
+// next section heading or the scanner's line budget, as it does in the
+// tree. Where the prescan only learns that past the heading, it gives up
+// the split points in between rather than risk a wrong one.
+//
+// The split points are grouped into chunks of at least the minimum chunk
+// size, and the chunks are parsed on a worker pool. Each chunk is parsed
+// from the whole source with its byte range as the parser's only included
+// range, so its nodes carry absolute byte offsets and points. The chunk
+// trees together form a chunked tree: the top-level blocks of all chunks
+// in document order, which are the top-level blocks a serial parse of the
+// same source produces.
+//
+// Link with -pthread.
+
+typedef struct TSAsciidocChunkedParser TSAsciidocChunkedParser;
+typedef struct TSAsciidocChunkedTree TSAsciidocChunkedTree;
+
+typedef struct {
+  const TSTree *tree;
+  uint32_t start_byte;
+  uint32_t end_byte;
+  TSPoint start_point;
+  TSPoint end_point;
+} TSAsciidocChunk;
+
+// Creates a parser that parses on `thread_count` worker threads plus the
+// calling thread. Zero parses every chunk on the calling thread.
+TSAsciidocChunkedParser *ts_asciidoc_chunked_parser_new(uint32_t thread_count);
+
+void ts_asciidoc_chunked_parser_delete(TSAsciidocChunkedParser *self);
+
+// Split points closer together than `bytes` are merged into one chunk. The
+// default, ASCIIDOC_CHUNK_MIN_BYTES, keeps chunks large enough that
+// starting a parse is noise; 1 cuts at every split point.
+void ts_asciidoc_chunked_parser_set_min_chunk_bytes(TSAsciidocChunkedParser *self,
+                                                    uint32_t bytes);
+
+// Runs the prescan alone and returns the byte offsets of all split points
+// in ascending order. The array belongs to the parser and stays valid until
+// its next call.
+const uint32_t *ts_asciidoc_chunked_parser_split_points(TSAsciidocChunkedParser *self,
+                                                        const char *source, uint32_t length,
+                                                        uint32_t *count);
+
+// Parses `source` in chunks. The result is owned by the caller and does not
+// refer to `source` or to the parser.
+TSAsciidocChunkedTree *ts_asciidoc_chunked_parser_parse(TSAsciidocChunkedParser *self,
+                                                        const char *source, uint32_t length);
+
+void ts_asciidoc_chunked_tree_delete(TSAsciidocChunkedTree *self);
+
+uint32_t ts_asciidoc_chunked_tree_chunk_count(const TSAsciidocChunkedTree *self);
+
+TSAsciidocChunk ts_asciidoc_chunked_tree_chunk(const TSAsciidocChunkedTree *self, uint32_t index);
+
+// The chunk containing `byte`; the last chunk for the end of the document.
+uint32_t ts_asciidoc_chunked_tree_chunk_for_byte(const TSAsciidocChunkedTree *self,
+                                                 uint32_t byte);
+
+// The named top-level blocks of the document, across all chunks: what
+// ts_node_named_child_count and ts_node_named_child return for the root of
+// a serial parse.
+uint32_t ts_asciidoc_chunked_tree_child_count(const TSAsciidocChunkedTree *self);
+
+TSNode ts_asciidoc_chunked_tree_child(const TSAsciidocChunkedTree *self, uint32_t index);
+
+// The smallest named node spanning [start, end), looked up in the chunk
+// containing `start`. A range that crosses a chunk boundary yields that
+// chunk's root.
+TSNode ts_asciidoc_chunked_tree_descendant_for_byte_range(const TSAsciidocChunkedTree *self,
+                                                          uint32_t start, uint32_t end);
+
+bool ts_asciidoc_chunked_tree_has_error(const TSAsciidocChunkedTree *self);
+
+// The S-expression of the whole document, equal to ts_node_string of the
+// root of a serial parse. Free it with free().
+char *ts_asciidoc_chunked_tree_string(const TSAsciidocChunkedTree *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_CHUNKED_H_
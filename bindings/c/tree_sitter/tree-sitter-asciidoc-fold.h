@@ -0,0 +1,60 @@
+#ifndef TREE_SITTER_ASCIIDOC_FOLD_H_
+#define TREE_SITTER_ASCIIDOC_FOLD_H_
+
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Incremental fold ranges.
+//
+// Keeps the fold ranges of a document, one per node of a kind captured in
+// queries/folds.scm, sorted by start with enclosing folds first. As with
+// TSAsciidocViewport, edits are applied alongside ts_tree_edit. After a
+// reparse, `ts_asciidoc_folds_update` rebuilds only the folds whose start or
+// end lies in a changed range, and reports what was added and removed.
+// Folds that only moved because of an edit are not reported, since a host
+// moves its own markers with the text.
+
+typedef struct TSAsciidocFolds TSAsciidocFolds;
+
+typedef struct {
+  uint32_t start_byte;
+  uint32_t end_byte;
+  TSPoint start_point;
+  // Usually column 0 of the line after the fold, as block nodes include
+  // their final line ending. A line-based editor folds through the line
+  // before.
+  TSPoint end_point;
+  TSSymbol symbol;
+} TSAsciidocFold;
+
+TSAsciidocFolds *ts_asciidoc_folds_new(void);
+
+void ts_asciidoc_folds_delete(TSAsciidocFolds *self);
+
+// Moves the folds for an edit. Call it alongside ts_tree_edit.
+void ts_asciidoc_folds_edit(TSAsciidocFolds *self, const TSInputEdit *edit);
+
+// Brings the folds in line with `new_tree`. Pass the edited `old_tree` that
+// `new_tree` was parsed from, or NULL to start from scratch.
+void ts_asciidoc_folds_update(TSAsciidocFolds *self, const TSTree *old_tree,
+                              const TSTree *new_tree);
+
+// Every fold, ordered by start byte, then by end byte descending. Folds
+// spanning a single line are left out.
+const TSAsciidocFold *ts_asciidoc_folds(const TSAsciidocFolds *self, uint32_t *count);
+
+// Folds added and removed by the last update, in the same order, in
+// `new_tree` coordinates.
+const TSAsciidocFold *ts_asciidoc_folds_added(const TSAsciidocFolds *self, uint32_t *count);
+
+const TSAsciidocFold *ts_asciidoc_folds_removed(const TSAsciidocFolds *self, uint32_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_FOLD_H_
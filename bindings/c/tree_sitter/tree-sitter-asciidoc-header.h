@@ -0,0 +1,90 @@
+#ifndef TREE_SITTER_ASCIIDOC_HEADER_H_
+#define TREE_SITTER_ASCIIDOC_HEADER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Document header extraction without a full parse.
+//
+// The header of an AsciiDoc document starts at its first line that is not
+// blank or a comment, and ends at the next blank line. A reader reads a file
+// in small chunks until it sees that line and parses only the header, so
+// the cost depends on the size of the header, not of the document. The results are slices of those bytes: the document title,
+// the author line with each author's name and the email address, the
+// revision line with its version, date and remark, and the attribute
+// entries that follow the header lines.
+//
+// A reader holds a parser and its buffers and is meant to be reused for
+// many files, one reader per thread.
+
+typedef struct TSAsciidocHeaderReader TSAsciidocHeaderReader;
+
+// `length` bytes at `start_byte` of `TSAsciidocHeader.source`. Absent parts
+// of the header have a length of 0.
+typedef struct {
+  uint32_t start_byte;
+  uint32_t length;
+} TSAsciidocSlice;
+
+typedef struct {
+  // Without the surrounding colons; `!name` or `name!` unset an attribute.
+  TSAsciidocSlice name;
+  TSAsciidocSlice value;
+  TSAsciidocSlice line;
+} TSAsciidocHeaderAttribute;
+
+typedef struct {
+  // The bytes the slices point into: the start of the document up to and
+  // including the blank line that ends the header. Not NUL-terminated.
+  const char *source;
+  uint32_t source_length;
+  // False for a document that does not start with a `= Title` line after
+  // any blank lines and comments. Its leading attribute entries are still
+  // reported.
+  bool has_title;
+  TSAsciidocSlice title;
+  TSAsciidocSlice author_line;
+  const TSAsciidocSlice *author_names;
+  uint32_t author_count;
+  // The address, without the angle brackets.
+  TSAsciidocSlice author_email;
+  TSAsciidocSlice revision_line;
+  TSAsciidocSlice revision_version;
+  TSAsciidocSlice revision_date;
+  TSAsciidocSlice revision_remark;
+  const TSAsciidocHeaderAttribute *attributes;
+  uint32_t attribute_count;
+  // True if the header did not end within ASCIIDOC_HEADER_MAX_BYTES; the
+  // slices then cover the complete lines read up to that limit.
+  bool truncated;
+} TSAsciidocHeader;
+
+TSAsciidocHeaderReader *ts_asciidoc_header_reader_new(void);
+
+void ts_asciidoc_header_reader_delete(TSAsciidocHeaderReader *self);
+
+// The results of the functions below belong to the reader and stay valid
+// until its next call.
+
+// Reads the header of the file at `path`. Returns NULL and sets errno if the
+// file cannot be read.
+const TSAsciidocHeader *ts_asciidoc_header_read(TSAsciidocHeaderReader *self, const char *path);
+
+// Reads the header from an open file descriptor, from its current offset.
+// The descriptor is left open, positioned past the bytes read.
+const TSAsciidocHeader *ts_asciidoc_header_read_fd(TSAsciidocHeaderReader *self, int fd);
+
+// Extracts the header of a document already in memory. The slices point
+// into `source`, which must outlive the result.
+const TSAsciidocHeader *ts_asciidoc_header_parse(TSAsciidocHeaderReader *self,
+                                                 const char *source, uint32_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_HEADER_H_
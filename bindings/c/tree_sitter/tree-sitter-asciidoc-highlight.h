@@ -0,0 +1,54 @@
+#ifndef TREE_SITTER_ASCIIDOC_HIGHLIGHT_H_
+#define TREE_SITTER_ASCIIDOC_HIGHLIGHT_H_
+
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Syntax highlighting without a full query run.
+//
+// Most patterns in queries/highlights.scm are compiled ahead of time into a
+// table keyed by node symbol, parent symbol and field. Highlighting is then a
+// single tree-cursor walk, and the query engine only runs the few patterns the
+// table cannot express. Where several patterns capture the same node, the one
+// that comes first in highlights.scm wins, as in tree-sitter's highlighter.
+
+typedef struct TSAsciidocHighlighter TSAsciidocHighlighter;
+
+typedef struct {
+  uint32_t start_byte;
+  uint32_t end_byte;
+  // Index into the capture names, see `ts_asciidoc_highlighter_capture_name`.
+  uint16_t capture;
+  // Nesting depth relative to the node passed to `ts_asciidoc_highlight`.
+  uint16_t depth;
+} TSAsciidocHighlightSpan;
+
+// Creates a highlighter for `tree_sitter_asciidoc()`. Returns NULL if the
+// fallback query does not compile against the linked grammar.
+TSAsciidocHighlighter *ts_asciidoc_highlighter_new(void);
+
+void ts_asciidoc_highlighter_delete(TSAsciidocHighlighter *self);
+
+uint32_t ts_asciidoc_highlighter_capture_count(const TSAsciidocHighlighter *self);
+
+// Capture name, such as "markup.heading", or NULL for an out-of-range index.
+const char *ts_asciidoc_highlighter_capture_name(const TSAsciidocHighlighter *self,
+                                                 uint16_t capture);
+
+// Highlights the descendants of `node` that intersect [start_byte, end_byte).
+// Spans are in document order, outer spans before the spans nested in them.
+// The returned array belongs to the highlighter and stays valid until its
+// next call.
+const TSAsciidocHighlightSpan *ts_asciidoc_highlight(TSAsciidocHighlighter *self, TSNode node,
+                                                     uint32_t start_byte, uint32_t end_byte,
+                                                     uint32_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_HIGHLIGHT_H_
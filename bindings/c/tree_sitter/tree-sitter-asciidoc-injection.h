@@ -0,0 +1,70 @@
+#ifndef TREE_SITTER_ASCIIDOC_INJECTION_H_
+#define TREE_SITTER_ASCIIDOC_INJECTION_H_
+
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Native injection driver.
+//
+// Finds every `[source,LANG]` listing block and fenced code block with a
+// language in an AsciiDoc tree, and parses their content with the grammar
+// registered for that language. Language names go through a fixed alias
+// table first, so `js`, `jsx` and `node` all use the "javascript" grammar.
+// Blocks are grouped by language and parsed on a small worker pool; each
+// worker keeps one TSParser per language for as long as the injector lives.
+// An injection whose content and language are unchanged since the previous
+// run keeps its tree instead of being reparsed.
+//
+// Injected trees are parsed from the content bytes alone, so their node
+// offsets and points are relative to the injection's start. Link with
+// -pthread.
+
+typedef struct TSAsciidocInjector TSAsciidocInjector;
+
+typedef struct {
+  uint32_t start_byte;
+  uint32_t end_byte;
+  TSPoint start_point;
+  // Canonical language name, such as "javascript". Owned by the injector.
+  const char *language;
+  // NULL when no grammar is registered for the language. Owned by the
+  // injector; copy it with ts_tree_copy to keep it past the next run.
+  const TSTree *tree;
+} TSAsciidocInjection;
+
+// Creates an injector that parses on `thread_count` worker threads plus the
+// calling thread. Zero parses everything on the calling thread.
+TSAsciidocInjector *ts_asciidoc_injector_new(uint32_t thread_count);
+
+void ts_asciidoc_injector_delete(TSAsciidocInjector *self);
+
+// Registers the grammar used for `name`, which is normalized first.
+// Registering a name again replaces its grammar.
+void ts_asciidoc_injector_add_language(TSAsciidocInjector *self, const char *name,
+                                       const TSLanguage *language);
+
+// Canonical name for a language alias, matched case-insensitively, or NULL
+// if the alias table does not know it.
+const char *ts_asciidoc_language_name(const char *name, uint32_t length);
+
+// Parses the injections of `tree` that intersect [start_byte, end_byte).
+// `source` is the text `tree` was parsed from. Injections are returned in
+// document order; the array and its trees stay valid until the next run.
+const TSAsciidocInjection *ts_asciidoc_injector_parse(TSAsciidocInjector *self,
+                                                      const TSTree *tree, const char *source,
+                                                      uint32_t start_byte, uint32_t end_byte,
+                                                      uint32_t *count);
+
+// The injection from the last run containing `byte`, or NULL.
+const TSAsciidocInjection *ts_asciidoc_injector_find(const TSAsciidocInjector *self,
+                                                     uint32_t byte);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_INJECTION_H_
@@ -0,0 +1,62 @@
+#ifndef TREE_SITTER_ASCIIDOC_MMAP_H_
+#define TREE_SITTER_ASCIIDOC_MMAP_H_
+
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Parsing files straight from a read-only memory mapping.
+//
+// Reading a file into a heap buffer before parsing keeps two copies of its
+// bytes alive: the page cache and the buffer. A mapped file has only the
+// first, which the kernel can drop and fault back in again under memory
+// pressure. The TSInput returned here hands the parser pointers into the
+// mapping, and node text is read from the same pages, so no step of a parse
+// copies the document.
+//
+// The mapping is advised POSIX_MADV_SEQUENTIAL when it is opened, which
+// enlarges readahead for the single front-to-back pass of a parse, and
+// returned to normal advice once ts_asciidoc_mapped_file_parse is done,
+// because lookups of node text afterwards are random. Offsets are 32-bit,
+// as in tree-sitter, so files of 4 GiB and more are refused.
+//
+// A mapping reflects later changes to the file; one truncated while it is
+// mapped raises SIGBUS when the missing pages are read. Files that other
+// processes rewrite in place are better read into memory.
+
+typedef struct TSAsciidocMappedFile TSAsciidocMappedFile;
+
+// Maps `path` read-only. Returns NULL and sets errno on failure, EFBIG for
+// files of 4 GiB or more. Empty files are not mapped and read as "".
+TSAsciidocMappedFile *ts_asciidoc_mapped_file_open(const char *path);
+
+// Unmaps the file. Trees parsed from it stay valid; their node text does not.
+void ts_asciidoc_mapped_file_close(TSAsciidocMappedFile *self);
+
+// The mapped bytes. They are not NUL-terminated.
+const char *ts_asciidoc_mapped_file_data(const TSAsciidocMappedFile *self);
+
+uint32_t ts_asciidoc_mapped_file_length(const TSAsciidocMappedFile *self);
+
+// A UTF-8 TSInput that returns the rest of the mapping from the requested
+// byte on, for callers that set up the parse themselves.
+TSInput ts_asciidoc_mapped_file_input(const TSAsciidocMappedFile *self);
+
+// Parses the file with `parser`, which must have the asciidoc language set.
+// `old_tree` is an edited tree of an earlier version of the file, or NULL.
+TSTree *ts_asciidoc_mapped_file_parse(const TSAsciidocMappedFile *self, TSParser *parser,
+                                      const TSTree *old_tree);
+
+// A pointer to the text of `node` inside the mapping, and its length in
+// `length`. Not NUL-terminated. `node` must come from a tree of this file.
+const char *ts_asciidoc_mapped_file_node_text(const TSAsciidocMappedFile *self, TSNode node,
+                                              uint32_t *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_MMAP_H_
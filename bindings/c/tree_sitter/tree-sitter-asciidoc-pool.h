@@ -0,0 +1,98 @@
+#ifndef TREE_SITTER_ASCIIDOC_POOL_H_
+#define TREE_SITTER_ASCIIDOC_POOL_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A thread-safe pool of configured parsers and query cursors, with queries
+// compiled once and shared.
+//
+// A service that creates a TSParser, sets its language and compiles its
+// queries for every request spends a noticeable share of each request on
+// setup and teardown. The pool hands out leases instead: a parser with the
+// asciidoc language and the pool's timeout already set, and a query cursor
+// with the pool's match limit. A lease belongs to the thread that checked it
+// out until that thread returns it. Queries added to the pool are compiled
+// once; a TSQuery is immutable while it runs, so any number of threads can
+// execute the same one with their own cursors.
+//
+// On return the parser is reset, so a parse cut short by the timeout or a
+// cancellation flag does not resume on the next request, and its included
+// ranges, logger and cancellation flag are cleared. A parser keeps the
+// buffers it grew for the largest document it parsed. One whose largest
+// document, as seen by ts_asciidoc_lease_parse, exceeds the pool's retained
+// byte limit is deleted on return instead of kept, along with its cursor,
+// and so is any lease returned while the pool already holds its maximum of
+// idle leases.
+
+typedef struct TSAsciidocPool TSAsciidocPool;
+typedef struct TSAsciidocLease TSAsciidocLease;
+
+// A pool that keeps up to ASCIIDOC_POOL_MAX_IDLE idle leases, parsers that
+// parsed up to ASCIIDOC_POOL_MAX_RETAINED_BYTES, and sets no timeout or
+// match limit.
+TSAsciidocPool *ts_asciidoc_pool_new(void);
+
+// Deletes the idle leases and the queries. Every lease must have been
+// returned.
+void ts_asciidoc_pool_delete(TSAsciidocPool *self);
+
+// Settings apply to the leases checked out after the call.
+void ts_asciidoc_pool_set_max_idle(TSAsciidocPool *self, uint32_t count);
+// 0 keeps every parser whatever it parsed.
+void ts_asciidoc_pool_set_max_retained_bytes(TSAsciidocPool *self, uint32_t bytes);
+// 0 for no timeout.
+void ts_asciidoc_pool_set_timeout_micros(TSAsciidocPool *self, uint64_t timeout_micros);
+// 0 for tree-sitter's default, no limit.
+void ts_asciidoc_pool_set_match_limit(TSAsciidocPool *self, uint32_t limit);
+
+// Compiles `source` and shares it under `name`. Returns false on a query
+// error, reported as by ts_query_new, and also when `name` is taken; the
+// query already under that name may be in use and is kept, and
+// `error_type` is set to TSQueryErrorNone.
+bool ts_asciidoc_pool_add_query(TSAsciidocPool *self, const char *name, const char *source,
+                                uint32_t length, uint32_t *error_offset, TSQueryError *error_type);
+
+// The query added under `name`, or NULL. Valid until the pool is deleted.
+const TSQuery *ts_asciidoc_pool_query(TSAsciidocPool *self, const char *name);
+
+// Takes an idle lease, or creates one if there is none.
+TSAsciidocLease *ts_asciidoc_pool_checkout(TSAsciidocPool *self);
+
+// Gives a lease back. Trees parsed with it stay valid.
+void ts_asciidoc_pool_return(TSAsciidocPool *self, TSAsciidocLease *lease);
+
+TSParser *ts_asciidoc_lease_parser(TSAsciidocLease *self);
+
+TSQueryCursor *ts_asciidoc_lease_cursor(TSAsciidocLease *self);
+
+// Parses with the lease's parser and records the size of the document for
+// the retained byte limit. Returns NULL if the timeout or a cancellation
+// flag stopped the parse.
+TSTree *ts_asciidoc_lease_parse(TSAsciidocLease *self, const TSTree *old_tree, TSInput input);
+
+TSTree *ts_asciidoc_lease_parse_string(TSAsciidocLease *self, const TSTree *old_tree,
+                                       const char *string, uint32_t length);
+
+typedef struct {
+  // Leases created, and checkouts served by an idle one.
+  uint64_t created;
+  uint64_t reused;
+  // Leases deleted on return, over the idle or the retained byte limit.
+  uint64_t discarded;
+  uint32_t idle;
+  uint32_t checked_out;
+} TSAsciidocPoolStats;
+
+TSAsciidocPoolStats ts_asciidoc_pool_stats(TSAsciidocPool *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_POOL_H_
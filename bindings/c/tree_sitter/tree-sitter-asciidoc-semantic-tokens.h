@@ -0,0 +1,74 @@
+#ifndef TREE_SITTER_ASCIIDOC_SEMANTIC_TOKENS_H_
+#define TREE_SITTER_ASCIIDOC_SEMANTIC_TOKENS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LSP semantic tokens.
+//
+// Produces the `data` array of a `textDocument/semanticTokens/full` response
+// from `ts_asciidoc_highlight`. The token types are the capture names of
+// queries/highlights.scm, in legend order; spans captured as "none" are
+// left out, and nested captures win over the ones around them. Tokens never
+// span lines and never overlap.
+//
+// The token list is cached. Edits are applied alongside ts_tree_edit, and
+// an update re-highlights only the lines touched by the edits and by
+// ts_tree_get_changed_ranges. The update also produces the edits of a
+// `semanticTokens/full/delta` response against the previous token array.
+
+typedef struct TSAsciidocSemanticTokens TSAsciidocSemanticTokens;
+
+typedef enum {
+  TSAsciidocPositionUTF16,
+  TSAsciidocPositionUTF8,
+} TSAsciidocPositionEncoding;
+
+typedef struct {
+  // Indices into the previous `data` array.
+  uint32_t start;
+  uint32_t delete_count;
+  const uint32_t *data;
+  uint32_t data_count;
+} TSAsciidocSemanticTokensEdit;
+
+// Columns and lengths are counted in the given encoding, as negotiated with
+// the client through `positionEncoding`. Returns NULL if the highlighter
+// cannot be created, see `ts_asciidoc_highlighter_new`.
+TSAsciidocSemanticTokens *ts_asciidoc_semantic_tokens_new(TSAsciidocPositionEncoding encoding);
+
+void ts_asciidoc_semantic_tokens_delete(TSAsciidocSemanticTokens *self);
+
+// The token type legend, for the server capabilities.
+const char *const *ts_asciidoc_semantic_tokens_legend(const TSAsciidocSemanticTokens *self,
+                                                      uint32_t *count);
+
+// Moves the cached tokens for an edit. Call it alongside ts_tree_edit.
+void ts_asciidoc_semantic_tokens_edit(TSAsciidocSemanticTokens *self, const TSInputEdit *edit);
+
+// Brings the tokens in line with `new_tree`, parsed from `source`. Pass the
+// edited `old_tree` that `new_tree` was parsed from, or NULL to tokenize the
+// whole document.
+void ts_asciidoc_semantic_tokens_update(TSAsciidocSemanticTokens *self, const TSTree *old_tree,
+                                        const TSTree *new_tree, const char *source,
+                                        uint32_t length);
+
+// The full `data` array: five integers per token.
+const uint32_t *ts_asciidoc_semantic_tokens_data(TSAsciidocSemanticTokens *self, uint32_t *count);
+
+// Edits turning the `data` array before the last update into the current
+// one, in ascending order. Only valid against the array the client holds:
+// if it missed an update, send the full array instead.
+const TSAsciidocSemanticTokensEdit *ts_asciidoc_semantic_tokens_delta(
+  const TSAsciidocSemanticTokens *self, uint32_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_SEMANTIC_TOKENS_H_
@@ -0,0 +1,73 @@
+#ifndef TREE_SITTER_ASCIIDOC_STATS_H_
+#define TREE_SITTER_ASCIIDOC_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Per node kind statistics over any number of parsed trees.
+//
+// The kinds are the grammar's visible node kinds, named and anonymous, the
+// ones listed in src/node-types.json, plus ERROR. Aliases count as the kind
+// they are aliased to, so a kind appears once however many rules produce
+// it. For each kind the statistics hold the number of nodes, the bytes they
+// cover and an estimate of the tree memory they take, and the ERROR and
+// MISSING nodes found inside nodes of that kind.
+//
+// The memory estimate follows the runtime's subtree layout on 64-bit hosts:
+// every node takes an 8-byte slot in its parent's child array, and all but
+// short single-line leaves, which fit in that slot, also take a heap
+// subtree of ASCIIDOC_STATS_HEAP_NODE_BYTES. Hidden nodes are not visible
+// through the tree API, so their slots are not counted. The figure is for
+// comparing kinds with each other, not an exact measure of a tree's size.
+//
+// A TSAsciidocStats is not thread-safe; give each thread its own.
+
+typedef struct TSAsciidocStats TSAsciidocStats;
+
+typedef struct {
+  // As ts_node_type reports it; valid for the life of the language.
+  const char *kind;
+  bool named;
+  uint64_t count;
+  uint64_t bytes;
+  uint64_t memory_bytes;
+  // ERROR and MISSING nodes whose nearest enclosing node other than an
+  // ERROR is of this kind.
+  uint64_t errors_within;
+  uint64_t missing_within;
+} TSAsciidocKindStats;
+
+typedef struct {
+  uint64_t nodes;
+  uint64_t bytes;
+  uint64_t memory_bytes;
+  uint64_t errors;
+  uint64_t missing;
+} TSAsciidocTreeStats;
+
+TSAsciidocStats *ts_asciidoc_stats_new(void);
+
+void ts_asciidoc_stats_delete(TSAsciidocStats *self);
+
+// Adds the nodes of `tree`, which must have been parsed with the asciidoc
+// language, and returns the statistics of that tree alone.
+TSAsciidocTreeStats ts_asciidoc_stats_add_tree(TSAsciidocStats *self, const TSTree *tree);
+
+// Totals over every tree added so far.
+TSAsciidocTreeStats ts_asciidoc_stats_totals(const TSAsciidocStats *self);
+
+// The kinds, in symbol order, ERROR last. Kinds without nodes are included.
+uint32_t ts_asciidoc_stats_kind_count(const TSAsciidocStats *self);
+
+TSAsciidocKindStats ts_asciidoc_stats_kind(const TSAsciidocStats *self, uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_STATS_H_
@@ -0,0 +1,88 @@
+#ifndef TREE_SITTER_ASCIIDOC_STREAM_H_
+#define TREE_SITTER_ASCIIDOC_STREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming parser for documents read from pipes.
+//
+// Input is copied into a ring of fixed-size chunks as it arrives, and its
+// lines are fed to the same split point scan as the chunked parser: a
+// level 1 section heading after a blank line, outside every block and
+// conditional, ends all the blocks before it. Whenever such a heading turns
+// up, the bytes before it are parsed through a TSInput that reads straight
+// from the chunks, with those bytes as the parser's only included range.
+// Each named top-level block of the result is handed to the callback, with
+// points counted from the start of the stream. Then the tree is deleted and
+// the chunks before the heading go back to the ring.
+//
+// Memory therefore follows the largest section (at least
+// ASCIIDOC_STREAM_MIN_SEGMENT_BYTES, which keeps short sections from being
+// parsed one at a time), not the whole input. A document without level 1
+// sections is held and parsed in one piece when the input ends.
+//
+// Byte offsets are 32-bit, as in tree-sitter. So that a stream can be longer
+// than 4 GiB, they count from ts_asciidoc_stream_origin, which moves past
+// the released chunks after every piece. Only the input held at once, the
+// piece being read and what follows it, is limited to 4 GiB.
+
+typedef struct TSAsciidocStream TSAsciidocStream;
+
+// Called once per named top-level block, in document order. `block` and the
+// text returned by ts_asciidoc_stream_text are only valid during the call.
+typedef void (*TSAsciidocBlockCallback)(void *payload, TSAsciidocStream *stream, TSNode block);
+
+TSAsciidocStream *ts_asciidoc_stream_new(TSAsciidocBlockCallback callback, void *payload);
+
+void ts_asciidoc_stream_delete(TSAsciidocStream *self);
+
+// Appends input. Complete sections are parsed and delivered before it
+// returns. Returns false once the input held reaches 4 GiB.
+bool ts_asciidoc_stream_write(TSAsciidocStream *self, const char *data, uint32_t length);
+
+// Reads `fd` until end of file, reading directly into the chunks, and
+// finishes the stream. Returns false and sets errno on a read error, or to
+// EFBIG once the input held reaches 4 GiB; what was read up to then is still
+// delivered.
+bool ts_asciidoc_stream_read_fd(TSAsciidocStream *self, int fd);
+
+// Parses and delivers whatever is left. The stream can then be reused for
+// a new document.
+void ts_asciidoc_stream_finish(TSAsciidocStream *self);
+
+// The bytes [start_byte, end_byte) of the block being delivered, or of any
+// input not yet released, copied into a buffer owned by the stream. Offsets
+// count from ts_asciidoc_stream_origin, as node offsets do. Valid until the
+// next call; NULL if the range has been released.
+const char *ts_asciidoc_stream_text(TSAsciidocStream *self, uint32_t start_byte,
+                                    uint32_t end_byte);
+
+// The offset in the stream that the byte offsets of delivered blocks count
+// from: a block starts at the origin plus ts_node_start_byte. It changes
+// between pieces, so read it in the callback.
+uint64_t ts_asciidoc_stream_origin(const TSAsciidocStream *self);
+
+// Totals since the stream was created.
+typedef struct {
+  uint64_t bytes;
+  // Pieces parsed, and the size of the largest.
+  uint32_t segments;
+  uint32_t largest_segment;
+  uint32_t blocks;
+  uint32_t error_blocks;
+  // Most chunk memory allocated at once, spare chunks included.
+  uint64_t peak_buffered_bytes;
+} TSAsciidocStreamStats;
+
+TSAsciidocStreamStats ts_asciidoc_stream_stats(const TSAsciidocStream *self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_STREAM_H_
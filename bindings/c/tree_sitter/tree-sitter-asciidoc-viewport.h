@@ -0,0 +1,75 @@
+#ifndef TREE_SITTER_ASCIIDOC_VIEWPORT_H_
+#define TREE_SITTER_ASCIIDOC_VIEWPORT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Viewport-bounded highlighting and injections.
+//
+// A viewport keeps a sorted index of a document's block-level nodes, with
+// sections flattened into their heading lines, plus a separate index of its
+// listing and fenced code blocks. Edits are applied with the same
+// TSInputEdit passed to ts_tree_edit. After a reparse,
+// `ts_asciidoc_viewport_update` re-indexes only the ranges reported by
+// ts_tree_get_changed_ranges. Queries then run over the visible byte window,
+// widened only by the code blocks that cross it, which an injected parser
+// needs to see whole. For highlights, pass the window straight to
+// `ts_asciidoc_highlight`.
+
+typedef struct TSAsciidocViewport TSAsciidocViewport;
+
+typedef struct {
+  uint32_t start_byte;
+  uint32_t end_byte;
+  TSSymbol symbol;
+  // The entry covers a section's anchor and heading line, not the whole section.
+  bool heading;
+} TSAsciidocBlock;
+
+TSAsciidocViewport *ts_asciidoc_viewport_new(void);
+
+void ts_asciidoc_viewport_delete(TSAsciidocViewport *self);
+
+// Shifts the index for an edit. Call it alongside ts_tree_edit.
+void ts_asciidoc_viewport_edit(TSAsciidocViewport *self, const TSInputEdit *edit);
+
+// Brings the index in line with `new_tree`. Pass the edited `old_tree` that
+// `new_tree` was parsed from, or NULL to index `new_tree` from scratch.
+void ts_asciidoc_viewport_update(TSAsciidocViewport *self, const TSTree *old_tree,
+                                 const TSTree *new_tree);
+
+// Byte ranges re-indexed by the last update, merged and in order. Cached
+// highlights in these ranges are stale.
+const TSRange *ts_asciidoc_viewport_changed_ranges(const TSAsciidocViewport *self,
+                                                   uint32_t *count);
+
+// Index entries intersecting [start_byte, end_byte), in document order.
+const TSAsciidocBlock *ts_asciidoc_viewport_blocks(const TSAsciidocViewport *self,
+                                                   uint32_t start_byte, uint32_t end_byte,
+                                                   uint32_t *count);
+
+// Listing and fenced code blocks intersecting [start_byte, end_byte).
+const TSAsciidocBlock *ts_asciidoc_viewport_code_blocks(const TSAsciidocViewport *self,
+                                                        uint32_t start_byte, uint32_t end_byte,
+                                                        uint32_t *count);
+
+// Widens [start_byte, end_byte) to cover every code block crossing it.
+void ts_asciidoc_viewport_injection_range(const TSAsciidocViewport *self, uint32_t *start_byte,
+                                          uint32_t *end_byte);
+
+// Runs `query` on `tree` for the window only. With `injections` set, the
+// window is first widened by `ts_asciidoc_viewport_injection_range`.
+void ts_asciidoc_viewport_exec(const TSAsciidocViewport *self, TSQueryCursor *cursor,
+                               const TSQuery *query, const TSTree *tree, uint32_t start_byte,
+                               uint32_t end_byte, bool injections);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_VIEWPORT_H_
@@ -0,0 +1,98 @@
+#ifndef TREE_SITTER_ASCIIDOC_XREF_H_
+#define TREE_SITTER_ASCIIDOC_XREF_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tree_sitter/api.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Workspace index of anchors, cross references and attributes.
+//
+// Collects the definitions and references that queries/locals.scm marks in a
+// single file: anchors and bibliography ids, `<<target>>` cross references,
+// attribute entries and `{name}` references. All documents of a workspace
+// go into one index, saved as a sorted, compact file that is opened with
+// mmap. Lookups binary-search the mapped file directly, so opening a saved
+// index does not read or parse anything.
+//
+// `ts_asciidoc_xref_index_update` replaces one file's entries. Updated files
+// are kept in memory and searched alongside the mapped file until the next
+// save, which writes them back into a single sorted file.
+
+typedef struct TSAsciidocXrefIndex TSAsciidocXrefIndex;
+
+typedef enum {
+  // Anchors, bibliography entries and cross references.
+  TSAsciidocXrefLabel,
+  // Attribute entries and attribute references.
+  TSAsciidocXrefAttribute,
+} TSAsciidocXrefNamespace;
+
+typedef enum {
+  TSAsciidocXrefAnchor,
+  TSAsciidocXrefBibliography,
+  TSAsciidocXrefAttributeEntry,
+  // References; the kinds above are definitions.
+  TSAsciidocXrefCrossReference,
+  TSAsciidocXrefAttributeReference,
+} TSAsciidocXrefKind;
+
+typedef struct {
+  // NUL-terminated. Owned by the index.
+  const char *name;
+  const char *path;
+  uint32_t start_byte;
+  TSPoint start_point;
+  TSAsciidocXrefKind kind;
+} TSAsciidocXrefEntry;
+
+TSAsciidocXrefIndex *ts_asciidoc_xref_index_new(void);
+
+// Maps an index written by `ts_asciidoc_xref_index_save`. Returns NULL if
+// the file is missing, was written by an incompatible version, or holds an
+// offset or index outside itself, as a truncated or corrupt file does.
+TSAsciidocXrefIndex *ts_asciidoc_xref_index_open(const char *path);
+
+void ts_asciidoc_xref_index_delete(TSAsciidocXrefIndex *self);
+
+// Replaces the entries of the document at `path` with those in `tree`,
+// parsed from `source`. A NULL `tree` removes the document.
+void ts_asciidoc_xref_index_update(TSAsciidocXrefIndex *self, const char *path,
+                                   const TSTree *tree, const char *source);
+
+// Writes the index to `path`, replacing it atomically. Returns false and
+// sets errno on failure.
+bool ts_asciidoc_xref_index_save(TSAsciidocXrefIndex *self, const char *path);
+
+uint32_t ts_asciidoc_xref_index_document_count(const TSAsciidocXrefIndex *self);
+
+// The results of the functions below belong to the index and stay valid
+// until its next call.
+
+// Definitions of `name`, for go-to-definition.
+const TSAsciidocXrefEntry *ts_asciidoc_xref_definitions(TSAsciidocXrefIndex *self,
+                                                        TSAsciidocXrefNamespace name_space,
+                                                        const char *name, uint32_t length,
+                                                        uint32_t *count);
+
+// References to `name`.
+const TSAsciidocXrefEntry *ts_asciidoc_xref_references(TSAsciidocXrefIndex *self,
+                                                       TSAsciidocXrefNamespace name_space,
+                                                       const char *name, uint32_t length,
+                                                       uint32_t *count);
+
+// The first definition of each name starting with `prefix`, ordered by
+// name, at most `limit` of them.
+const TSAsciidocXrefEntry *ts_asciidoc_xref_complete(TSAsciidocXrefIndex *self,
+                                                     TSAsciidocXrefNamespace name_space,
+                                                     const char *prefix, uint32_t length,
+                                                     uint32_t limit, uint32_t *count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TREE_SITTER_ASCIIDOC_XREF_H_
@@ -0,0 +1,351 @@
+#include "tree_sitter/tree-sitter-asciidoc-viewport.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "editor.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+enum {
+  // `section` and `section_level_N`: indexed as a heading plus their children.
+  SYMBOL_SECTION = 1 << 0,
+  SYMBOL_CODE_BLOCK = 1 << 1,
+  // Nodes that cannot contain a code block; not searched for one.
+  SYMBOL_LEAF = 1 << 2,
+};
+
+static const char *const SECTION_SYMBOLS[] = {
+  "section",         "section_level_2", "section_level_3", "section_level_4",
+  "section_level_5", "section_level_6", NULL,
+};
+
+static const char *const CODE_BLOCK_SYMBOLS[] = {"listing_block", "fenced_code_block", NULL};
+
+static const char *const LEAF_SYMBOLS[] = {
+  "paragraph",      "block_content", "fenced_code_block_content", "title",
+  "attribute_entry", "comment",      "block_title",               "block_attributes",
+  NULL,
+};
+
+typedef Array(TSAsciidocBlock) BlockArray;
+
+struct TSAsciidocViewport {
+  uint8_t *symbol_flags;
+  uint32_t symbol_count;
+  TSFieldId title_field;
+
+  BlockArray blocks;
+  BlockArray code_blocks;
+
+  // Ranges invalidated by edits since the last update, in new-tree bytes.
+  RangeArray pending;
+  RangeArray changed;
+
+  BlockArray new_blocks;
+  BlockArray new_code_blocks;
+  BlockArray scratch;
+};
+
+static uint8_t symbol_flags(const TSAsciidocViewport *self, TSSymbol symbol) {
+  return symbol < self->symbol_count ? self->symbol_flags[symbol] : 0;
+}
+
+TSAsciidocViewport *ts_asciidoc_viewport_new(void) {
+  const TSLanguage *language = tree_sitter_asciidoc();
+  TSAsciidocViewport *self = calloc(1, sizeof(TSAsciidocViewport));
+  self->symbol_count = ts_language_symbol_count(language);
+  self->symbol_flags = calloc(self->symbol_count, 1);
+  editor_mark_symbols(language, self->symbol_flags, SECTION_SYMBOLS, SYMBOL_SECTION);
+  editor_mark_symbols(language, self->symbol_flags, CODE_BLOCK_SYMBOLS, SYMBOL_CODE_BLOCK);
+  editor_mark_symbols(language, self->symbol_flags, LEAF_SYMBOLS, SYMBOL_LEAF);
+  self->title_field = ts_language_field_id_for_name(language, "title", 5);
+  return self;
+}
+
+void ts_asciidoc_viewport_delete(TSAsciidocViewport *self) {
+  if (!self) {
+    return;
+  }
+  array_delete(&self->blocks);
+  array_delete(&self->code_blocks);
+  array_delete(&self->pending);
+  array_delete(&self->changed);
+  array_delete(&self->new_blocks);
+  array_delete(&self->new_code_blocks);
+  array_delete(&self->scratch);
+  free(self->symbol_flags);
+  free(self);
+}
+
+// Shifts entries after the edit and drops the ones it touches, recording
+// their new extent as pending.
+static void edit_blocks(BlockArray *blocks, RangeArray *pending, const TSInputEdit *edit) {
+  uint32_t write = 0;
+  for (uint32_t read = 0; read < blocks->size; read++) {
+    TSAsciidocBlock block = blocks->contents[read];
+    if (block.end_byte < edit->start_byte) {
+      blocks->contents[write++] = block;
+    } else if (block.start_byte > edit->old_end_byte) {
+      block.start_byte = block.start_byte - edit->old_end_byte + edit->new_end_byte;
+      block.end_byte = block.end_byte - edit->old_end_byte + edit->new_end_byte;
+      blocks->contents[write++] = block;
+    } else {
+      uint32_t start = block.start_byte < edit->start_byte ? block.start_byte : edit->start_byte;
+      uint32_t end = block.end_byte > edit->old_end_byte
+                       ? block.end_byte - edit->old_end_byte + edit->new_end_byte
+                       : edit->new_end_byte;
+      editor_add_range(pending, start, end);
+    }
+  }
+  blocks->size = write;
+}
+
+void ts_asciidoc_viewport_edit(TSAsciidocViewport *self, const TSInputEdit *edit) {
+  editor_edit_ranges(&self->pending, edit);
+  edit_blocks(&self->blocks, &self->pending, edit);
+  edit_blocks(&self->code_blocks, &self->pending, edit);
+}
+
+// Adds the code blocks in the subtree under the cursor.
+static void collect_code_blocks(TSAsciidocViewport *self, TSTreeCursor *cursor) {
+  uint32_t depth = 0;
+  for (;;) {
+    TSNode node = ts_tree_cursor_current_node(cursor);
+    uint8_t flags = symbol_flags(self, ts_node_symbol(node));
+    if (flags & SYMBOL_CODE_BLOCK) {
+      array_push(&self->new_code_blocks, ((TSAsciidocBlock){
+                                           .start_byte = ts_node_start_byte(node),
+                                           .end_byte = ts_node_end_byte(node),
+                                           .symbol = ts_node_symbol(node),
+                                         }));
+    } else if (!(flags & SYMBOL_LEAF) && ts_tree_cursor_goto_first_child(cursor)) {
+      depth++;
+      continue;
+    }
+
+    while (depth > 0 && !ts_tree_cursor_goto_next_sibling(cursor)) {
+      ts_tree_cursor_goto_parent(cursor);
+      depth--;
+    }
+    if (depth == 0) {
+      return;
+    }
+  }
+}
+
+// Indexes the children of the node under the cursor (the root or a section)
+// that touch [start, end], recursing into sections.
+static void collect_blocks(TSAsciidocViewport *self, TSTreeCursor *cursor, uint32_t start,
+                           uint32_t end) {
+  TSNode parent = ts_tree_cursor_current_node(cursor);
+  uint32_t heading_end = 0;
+  if (symbol_flags(self, ts_node_symbol(parent)) & SYMBOL_SECTION && self->title_field) {
+    TSNode title = ts_node_child_by_field_id(parent, self->title_field);
+    if (!ts_node_is_null(title)) {
+      heading_end = ts_node_end_byte(title);
+      if (editor_touches(ts_node_start_byte(parent), heading_end, start, end)) {
+        array_push(&self->new_blocks, ((TSAsciidocBlock){
+                                        .start_byte = ts_node_start_byte(parent),
+                                        .end_byte = heading_end,
+                                        .symbol = ts_node_symbol(parent),
+                                        .heading = true,
+                                      }));
+      }
+    }
+  }
+
+  if (ts_tree_cursor_goto_first_child_for_byte(cursor, start > 0 ? start - 1 : 0) < 0) {
+    return;
+  }
+
+  do {
+    TSNode node = ts_tree_cursor_current_node(cursor);
+    uint32_t node_start = ts_node_start_byte(node);
+    uint32_t node_end = ts_node_end_byte(node);
+    if (node_start > end) {
+      break;
+    }
+    if (node_end <= heading_end || !editor_touches(node_start, node_end, start, end)) {
+      continue;
+    }
+
+    TSSymbol symbol = ts_node_symbol(node);
+    if (symbol_flags(self, symbol) & SYMBOL_SECTION) {
+      collect_blocks(self, cursor, start, end);
+      continue;
+    }
+
+    array_push(&self->new_blocks, ((TSAsciidocBlock){
+                                    .start_byte = node_start,
+                                    .end_byte = node_end,
+                                    .symbol = symbol,
+                                  }));
+    collect_code_blocks(self, cursor);
+  } while (ts_tree_cursor_goto_next_sibling(cursor));
+
+  ts_tree_cursor_goto_parent(cursor);
+}
+
+static int compare_blocks(const void *a, const void *b) {
+  const TSAsciidocBlock *x = a;
+  const TSAsciidocBlock *y = b;
+  if (x->start_byte != y->start_byte) {
+    return (x->start_byte > y->start_byte) - (x->start_byte < y->start_byte);
+  }
+  return (x->end_byte > y->end_byte) - (x->end_byte < y->end_byte);
+}
+
+// Replaces the entries of `blocks` that touch `ranges` with `fresh`, keeping
+// the array sorted. `fresh` entries may reach beyond the ranges, so they
+// displace whatever old entries they overlap too.
+static void splice_blocks(BlockArray *blocks, BlockArray *fresh, const RangeArray *ranges,
+                          BlockArray *scratch) {
+  qsort(fresh->contents, fresh->size, sizeof(TSAsciidocBlock), compare_blocks);
+
+  uint32_t unique = 0;
+  for (uint32_t i = 0; i < fresh->size; i++) {
+    if (unique == 0 || compare_blocks(&fresh->contents[i], &fresh->contents[unique - 1]) != 0) {
+      fresh->contents[unique++] = fresh->contents[i];
+    }
+  }
+  fresh->size = unique;
+
+  array_clear(scratch);
+  uint32_t range = 0, next = 0;
+  for (uint32_t i = 0; i < blocks->size; i++) {
+    TSAsciidocBlock *block = &blocks->contents[i];
+    while (range < ranges->size && ranges->contents[range].end_byte < block->start_byte) {
+      range++;
+    }
+    if (range < ranges->size && editor_touches(block->start_byte, block->end_byte,
+                                               ranges->contents[range].start_byte,
+                                               ranges->contents[range].end_byte)) {
+      continue;
+    }
+
+    while (next < fresh->size && fresh->contents[next].end_byte <= block->start_byte) {
+      array_push(scratch, fresh->contents[next++]);
+    }
+    if (next < fresh->size && fresh->contents[next].start_byte < block->end_byte) {
+      continue;
+    }
+    array_push(scratch, *block);
+  }
+  while (next < fresh->size) {
+    array_push(scratch, fresh->contents[next++]);
+  }
+
+  array_swap(blocks, scratch);
+}
+
+void ts_asciidoc_viewport_update(TSAsciidocViewport *self, const TSTree *old_tree,
+                                 const TSTree *new_tree) {
+  TSNode root = ts_tree_root_node(new_tree);
+  array_clear(&self->changed);
+
+  if (!old_tree) {
+    array_clear(&self->blocks);
+    array_clear(&self->code_blocks);
+    editor_add_range(&self->changed, 0, ts_node_end_byte(root));
+  } else {
+    uint32_t count;
+    TSRange *ranges = ts_tree_get_changed_ranges(old_tree, new_tree, &count);
+    for (uint32_t i = 0; i < count; i++) {
+      editor_add_range(&self->changed, ranges[i].start_byte, ranges[i].end_byte);
+    }
+    free(ranges);
+    array_push_all(&self->changed, &self->pending);
+  }
+  array_clear(&self->pending);
+  editor_merge_ranges(&self->changed);
+
+  array_clear(&self->new_blocks);
+  array_clear(&self->new_code_blocks);
+  TSTreeCursor cursor = ts_tree_cursor_new(root);
+  for (uint32_t i = 0; i < self->changed.size; i++) {
+    const TSRange *range = &self->changed.contents[i];
+    collect_blocks(self, &cursor, range->start_byte, range->end_byte);
+    ts_tree_cursor_reset(&cursor, root);
+  }
+  ts_tree_cursor_delete(&cursor);
+
+  splice_blocks(&self->blocks, &self->new_blocks, &self->changed, &self->scratch);
+  splice_blocks(&self->code_blocks, &self->new_code_blocks, &self->changed, &self->scratch);
+
+  // Report what was actually re-indexed, including blocks that grew past
+  // the changed ranges.
+  for (uint32_t i = 0; i < self->new_blocks.size; i++) {
+    editor_add_range(&self->changed, self->new_blocks.contents[i].start_byte,
+              self->new_blocks.contents[i].end_byte);
+  }
+  editor_merge_ranges(&self->changed);
+}
+
+const TSRange *ts_asciidoc_viewport_changed_ranges(const TSAsciidocViewport *self,
+                                                   uint32_t *count) {
+  *count = self->changed.size;
+  return self->changed.contents;
+}
+
+// First entry ending after `start_byte`. Entries are disjoint, so their end
+// bytes are sorted too.
+static uint32_t first_block_after(const BlockArray *blocks, uint32_t start_byte) {
+  uint32_t low = 0, high = blocks->size;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (blocks->contents[mid].end_byte <= start_byte) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+static const TSAsciidocBlock *blocks_in_window(const BlockArray *blocks, uint32_t start_byte,
+                                               uint32_t end_byte, uint32_t *count) {
+  uint32_t first = first_block_after(blocks, start_byte);
+  uint32_t last = first;
+  while (last < blocks->size && blocks->contents[last].start_byte < end_byte) {
+    last++;
+  }
+  *count = last - first;
+  return blocks->contents + first;
+}
+
+const TSAsciidocBlock *ts_asciidoc_viewport_blocks(const TSAsciidocViewport *self,
+                                                   uint32_t start_byte, uint32_t end_byte,
+                                                   uint32_t *count) {
+  return blocks_in_window(&self->blocks, start_byte, end_byte, count);
+}
+
+const TSAsciidocBlock *ts_asciidoc_viewport_code_blocks(const TSAsciidocViewport *self,
+                                                        uint32_t start_byte, uint32_t end_byte,
+                                                        uint32_t *count) {
+  return blocks_in_window(&self->code_blocks, start_byte, end_byte, count);
+}
+
+void ts_asciidoc_viewport_injection_range(const TSAsciidocViewport *self, uint32_t *start_byte,
+                                          uint32_t *end_byte) {
+  uint32_t count;
+  const TSAsciidocBlock *code =
+    blocks_in_window(&self->code_blocks, *start_byte, *end_byte, &count);
+  if (count > 0) {
+    if (code[0].start_byte < *start_byte) {
+      *start_byte = code[0].start_byte;
+    }
+    if (code[count - 1].end_byte > *end_byte) {
+      *end_byte = code[count - 1].end_byte;
+    }
+  }
+}
+
+void ts_asciidoc_viewport_exec(const TSAsciidocViewport *self, TSQueryCursor *cursor,
+                               const TSQuery *query, const TSTree *tree, uint32_t start_byte,
+                               uint32_t end_byte, bool injections) {
+  if (injections) {
+    ts_asciidoc_viewport_injection_range(self, &start_byte, &end_byte);
+  }
+  ts_query_cursor_set_byte_range(cursor, start_byte, end_byte);
+  ts_query_cursor_exec(cursor, query, ts_tree_root_node(tree));
+}
@@ -0,0 +1,774 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "tree_sitter/tree-sitter-asciidoc-xref.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "editor.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+// On-disk layout, in native byte order; the magic number doubles as a byte
+// order check. The header is followed by the documents, the names sorted by
+// namespace and bytes, the entries grouped by name and the string table.
+// Every string is NUL-terminated so it can be returned in place.
+#define XREF_MAGIC 0x52584441u // "ADXR"
+#define XREF_VERSION 1u
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t document_count;
+  uint32_t name_count;
+  uint32_t entry_count;
+  uint32_t string_size;
+  uint32_t documents_offset;
+  uint32_t names_offset;
+  uint32_t entries_offset;
+  uint32_t strings_offset;
+} FileHeader;
+
+typedef struct {
+  uint32_t path;
+} FileDocument;
+
+typedef struct {
+  uint32_t string;
+  uint32_t length;
+  uint32_t name_space;
+  // The name's entries: its definitions, then its references, each ordered
+  // by document and offset.
+  uint32_t first_entry;
+  uint32_t definition_count;
+  uint32_t reference_count;
+} FileName;
+
+typedef struct {
+  uint32_t document;
+  uint32_t start_byte;
+  uint32_t row;
+  uint32_t column;
+  uint32_t kind;
+} FileEntry;
+
+enum {
+  SYMBOL_ANCHOR = 1 << 0,
+  SYMBOL_BIBLIOGRAPHY = 1 << 1,
+  SYMBOL_ATTRIBUTE_ENTRY = 1 << 2,
+  SYMBOL_ATTRIBUTE_REFERENCE = 1 << 3,
+  SYMBOL_CROSS_REFERENCE = 1 << 4,
+};
+
+static const char *const ANCHOR_SYMBOLS[] = {"anchor", NULL};
+static const char *const BIBLIOGRAPHY_SYMBOLS[] = {"bibliography_entry", NULL};
+static const char *const ATTRIBUTE_ENTRY_SYMBOLS[] = {"attribute_entry", NULL};
+static const char *const ATTRIBUTE_REFERENCE_SYMBOLS[] = {"attribute_substitution", NULL};
+static const char *const CROSS_REFERENCE_SYMBOLS[] = {"internal_xref", NULL};
+
+typedef Array(char) StringArray;
+
+// An entry of a document updated since the index was opened.
+typedef struct {
+  // Offset of the NUL-terminated name in the document's strings.
+  uint32_t name;
+  uint32_t length;
+  uint32_t start_byte;
+  TSPoint start_point;
+  TSAsciidocXrefKind kind;
+} LocalEntry;
+
+typedef struct {
+  char *path;
+  StringArray strings;
+  Array(LocalEntry) entries;
+  bool removed;
+} Document;
+
+// An entry gathered for `ts_asciidoc_xref_index_save`.
+typedef struct {
+  const char *name;
+  uint32_t length;
+  uint32_t name_space;
+  uint32_t document;
+  uint32_t start_byte;
+  TSPoint start_point;
+  TSAsciidocXrefKind kind;
+} SaveEntry;
+
+struct TSAsciidocXrefIndex {
+  uint8_t *symbol_flags;
+  uint32_t symbol_count;
+  TSSymbol plain_text_symbol;
+  TSFieldId id_field;
+  TSFieldId name_field;
+  TSFieldId target_field;
+
+  // The mapped file, if any.
+  void *map;
+  size_t map_size;
+  const FileHeader *header;
+  const FileDocument *documents;
+  const FileName *names;
+  const FileEntry *entries;
+  const char *strings;
+  // Mapped documents superseded by an update.
+  bool *replaced;
+
+  Array(Document) updated;
+  Array(TSAsciidocXrefEntry) results;
+};
+
+static uint8_t symbol_flags(const TSAsciidocXrefIndex *self, TSSymbol symbol) {
+  return symbol < self->symbol_count ? self->symbol_flags[symbol] : 0;
+}
+
+static inline bool is_definition(TSAsciidocXrefKind kind) {
+  return kind <= TSAsciidocXrefAttributeEntry;
+}
+
+static inline TSAsciidocXrefNamespace kind_namespace(TSAsciidocXrefKind kind) {
+  return kind == TSAsciidocXrefAttributeEntry || kind == TSAsciidocXrefAttributeReference
+           ? TSAsciidocXrefAttribute
+           : TSAsciidocXrefLabel;
+}
+
+static int compare_names(uint32_t name_space, const char *name, uint32_t length,
+                         uint32_t other_space, const char *other, uint32_t other_length) {
+  if (name_space != other_space) {
+    return (name_space > other_space) - (name_space < other_space);
+  }
+  int order = memcmp(name, other, length < other_length ? length : other_length);
+  if (order != 0) {
+    return order;
+  }
+  return (length > other_length) - (length < other_length);
+}
+
+TSAsciidocXrefIndex *ts_asciidoc_xref_index_new(void) {
+  const TSLanguage *language = tree_sitter_asciidoc();
+  TSAsciidocXrefIndex *self = calloc(1, sizeof(TSAsciidocXrefIndex));
+  self->symbol_count = ts_language_symbol_count(language);
+  self->symbol_flags = calloc(self->symbol_count, 1);
+  editor_mark_symbols(language, self->symbol_flags, ANCHOR_SYMBOLS, SYMBOL_ANCHOR);
+  editor_mark_symbols(language, self->symbol_flags, BIBLIOGRAPHY_SYMBOLS, SYMBOL_BIBLIOGRAPHY);
+  editor_mark_symbols(language, self->symbol_flags, ATTRIBUTE_ENTRY_SYMBOLS,
+                      SYMBOL_ATTRIBUTE_ENTRY);
+  editor_mark_symbols(language, self->symbol_flags, ATTRIBUTE_REFERENCE_SYMBOLS,
+                      SYMBOL_ATTRIBUTE_REFERENCE);
+  editor_mark_symbols(language, self->symbol_flags, CROSS_REFERENCE_SYMBOLS,
+                      SYMBOL_CROSS_REFERENCE);
+  self->plain_text_symbol = ts_language_symbol_for_name(language, "plain_text", 10, true);
+  self->id_field = ts_language_field_id_for_name(language, "id", 2);
+  self->name_field = ts_language_field_id_for_name(language, "name", 4);
+  self->target_field = ts_language_field_id_for_name(language, "target", 6);
+  return self;
+}
+
+static void unmap(TSAsciidocXrefIndex *self) {
+  if (self->map) {
+    munmap(self->map, self->map_size);
+  }
+  free(self->replaced);
+  self->map = NULL;
+  self->map_size = 0;
+  self->header = NULL;
+  self->replaced = NULL;
+}
+
+static bool section_fits(size_t size, uint32_t offset, uint32_t count, size_t element) {
+  return offset % 4 == 0 && offset <= size && (size - offset) / element >= count;
+}
+
+// Whether every offset, index and count in the file stays inside it, so
+// that lookups can use them without further checks. One pass over the
+// documents, names and entries; the strings end with a NUL, checked before.
+static bool contents_valid(const FileHeader *header, const char *bytes) {
+  const FileDocument *documents = (const FileDocument *)(bytes + header->documents_offset);
+  const FileName *names = (const FileName *)(bytes + header->names_offset);
+  const FileEntry *entries = (const FileEntry *)(bytes + header->entries_offset);
+  const char *strings = bytes + header->strings_offset;
+
+  for (uint32_t i = 0; i < header->document_count; i++) {
+    if (documents[i].path >= header->string_size) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < header->name_count; i++) {
+    const FileName *name = &names[i];
+    if (name->string >= header->string_size ||
+        name->length >= header->string_size - name->string ||
+        strings[name->string + name->length] != '\0' ||
+        name->name_space > TSAsciidocXrefAttribute ||
+        (uint64_t)name->first_entry + name->definition_count + name->reference_count >
+          header->entry_count) {
+      return false;
+    }
+  }
+  for (uint32_t i = 0; i < header->entry_count; i++) {
+    if (entries[i].document >= header->document_count ||
+        entries[i].kind > TSAsciidocXrefAttributeReference) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Maps `path` in place of the current file. Leaves the index unchanged on
+// failure.
+static bool map_file(TSAsciidocXrefIndex *self, const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(FileHeader)) {
+    close(fd);
+    return false;
+  }
+  size_t size = (size_t)info.st_size;
+  void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+
+  const FileHeader *header = map;
+  const char *bytes = map;
+  if (header->magic != XREF_MAGIC || header->version != XREF_VERSION ||
+      !section_fits(size, header->documents_offset, header->document_count,
+                    sizeof(FileDocument)) ||
+      !section_fits(size, header->names_offset, header->name_count, sizeof(FileName)) ||
+      !section_fits(size, header->entries_offset, header->entry_count, sizeof(FileEntry)) ||
+      header->strings_offset > size || size - header->strings_offset < header->string_size ||
+      header->string_size == 0 || bytes[header->strings_offset + header->string_size - 1] ||
+      !contents_valid(header, bytes)) {
+    munmap(map, size);
+    return false;
+  }
+
+  unmap(self);
+  self->map = map;
+  self->map_size = size;
+  self->header = header;
+  self->documents = (const FileDocument *)(bytes + header->documents_offset);
+  self->names = (const FileName *)(bytes + header->names_offset);
+  self->entries = (const FileEntry *)(bytes + header->entries_offset);
+  self->strings = bytes + header->strings_offset;
+  self->replaced = calloc(header->document_count + 1, sizeof(bool));
+  return true;
+}
+
+TSAsciidocXrefIndex *ts_asciidoc_xref_index_open(const char *path) {
+  TSAsciidocXrefIndex *self = ts_asciidoc_xref_index_new();
+  if (!map_file(self, path)) {
+    ts_asciidoc_xref_index_delete(self);
+    return NULL;
+  }
+  return self;
+}
+
+static void clear_updated(TSAsciidocXrefIndex *self) {
+  for (uint32_t i = 0; i < self->updated.size; i++) {
+    Document *document = &self->updated.contents[i];
+    free(document->path);
+    array_delete(&document->strings);
+    array_delete(&document->entries);
+  }
+  array_clear(&self->updated);
+}
+
+void ts_asciidoc_xref_index_delete(TSAsciidocXrefIndex *self) {
+  if (!self) {
+    return;
+  }
+  unmap(self);
+  clear_updated(self);
+  array_delete(&self->updated);
+  array_delete(&self->results);
+  free(self->symbol_flags);
+  free(self);
+}
+
+uint32_t ts_asciidoc_xref_index_document_count(const TSAsciidocXrefIndex *self) {
+  uint32_t count = 0;
+  if (self->header) {
+    for (uint32_t i = 0; i < self->header->document_count; i++) {
+      count += !self->replaced[i];
+    }
+  }
+  for (uint32_t i = 0; i < self->updated.size; i++) {
+    count += !self->updated.contents[i].removed;
+  }
+  return count;
+}
+
+// Appends a NUL-terminated copy of the string and returns its offset.
+static uint32_t add_string(StringArray *strings, const char *string, uint32_t length) {
+  uint32_t offset = strings->size;
+  array_reserve(strings, strings->size + length + 1);
+  memcpy(strings->contents + strings->size, string, length);
+  strings->size += length;
+  strings->contents[strings->size++] = '\0';
+  return offset;
+}
+
+static void add_entry(Document *document, TSNode node, const char *source,
+                      TSAsciidocXrefKind kind) {
+  uint32_t start = ts_node_start_byte(node);
+  uint32_t end = ts_node_end_byte(node);
+  TSPoint point = ts_node_start_point(node);
+
+  switch (kind) {
+    case TSAsciidocXrefAttributeEntry:
+      // `:name:`
+      if (end - start >= 2) {
+        start++;
+        end--;
+        point.column++;
+      }
+      break;
+    case TSAsciidocXrefCrossReference:
+      // `<<other.adoc#id>>` refers to `id`; a bare document reference has
+      // no label.
+      for (uint32_t i = end; i > start; i--) {
+        if (source[i - 1] == '#') {
+          point.column += i - start;
+          start = i;
+          break;
+        }
+      }
+      if (end - start > 5 && memcmp(source + end - 5, ".adoc", 5) == 0) {
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+  while (start < end && (source[start] == ' ' || source[start] == '\t')) {
+    start++;
+    point.column++;
+  }
+  while (end > start && (source[end - 1] == ' ' || source[end - 1] == '\t')) {
+    end--;
+  }
+  if (start == end) {
+    return;
+  }
+
+  array_push(&document->entries, ((LocalEntry){
+                                    .name = add_string(&document->strings, source + start,
+                                                       end - start),
+                                    .length = end - start,
+                                    .start_byte = start,
+                                    .start_point = point,
+                                    .kind = kind,
+                                  }));
+}
+
+// The name inside `{name}`, `{counter:name}` or `{set:name:value}`: the
+// second plain_text, after the `counter` or `set` directive, or the only
+// one. A `{set:name:value}` value is the third and is not looked at.
+static TSNode attribute_reference_name(const TSAsciidocXrefIndex *self, TSNode node) {
+  TSNode names[2] = {{{0}, 0, 0}, {{0}, 0, 0}};
+  uint32_t found = 0;
+  uint32_t count = ts_node_child_count(node);
+  for (uint32_t i = 0; i < count && found < 2; i++) {
+    TSNode child = ts_node_child(node, i);
+    if (ts_node_symbol(child) == self->plain_text_symbol) {
+      names[found++] = child;
+    }
+  }
+  return found == 2 ? names[1] : names[0];
+}
+
+static void collect_entries(TSAsciidocXrefIndex *self, Document *document, const TSTree *tree,
+                            const char *source) {
+  TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(tree));
+  for (;;) {
+    TSNode node = ts_tree_cursor_current_node(&cursor);
+    uint8_t flags = symbol_flags(self, ts_node_symbol(node));
+    TSNode name = {{0}, 0, 0};
+    TSAsciidocXrefKind kind = TSAsciidocXrefAnchor;
+    if (flags & SYMBOL_ANCHOR) {
+      name = ts_node_child_by_field_id(node, self->id_field);
+    } else if (flags & SYMBOL_BIBLIOGRAPHY) {
+      name = ts_node_child_by_field_id(node, self->id_field);
+      kind = TSAsciidocXrefBibliography;
+    } else if (flags & SYMBOL_ATTRIBUTE_ENTRY) {
+      name = ts_node_child_by_field_id(node, self->name_field);
+      kind = TSAsciidocXrefAttributeEntry;
+    } else if (flags & SYMBOL_ATTRIBUTE_REFERENCE) {
+      name = attribute_reference_name(self, node);
+      kind = TSAsciidocXrefAttributeReference;
+    } else if (flags & SYMBOL_CROSS_REFERENCE) {
+      name = ts_node_child_by_field_id(node, self->target_field);
+      kind = TSAsciidocXrefCrossReference;
+    }
+
+    if (flags) {
+      if (!ts_node_is_null(name)) {
+        add_entry(document, name, source, kind);
+      }
+    } else if (ts_tree_cursor_goto_first_child(&cursor)) {
+      continue;
+    }
+    while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+      if (!ts_tree_cursor_goto_parent(&cursor)) {
+        ts_tree_cursor_delete(&cursor);
+        return;
+      }
+    }
+  }
+}
+
+void ts_asciidoc_xref_index_update(TSAsciidocXrefIndex *self, const char *path,
+                                   const TSTree *tree, const char *source) {
+  if (self->header) {
+    for (uint32_t i = 0; i < self->header->document_count; i++) {
+      if (strcmp(self->strings + self->documents[i].path, path) == 0) {
+        self->replaced[i] = true;
+        break;
+      }
+    }
+  }
+
+  Document *document = NULL;
+  for (uint32_t i = 0; i < self->updated.size; i++) {
+    if (strcmp(self->updated.contents[i].path, path) == 0) {
+      document = &self->updated.contents[i];
+      break;
+    }
+  }
+  if (!document) {
+    array_push(&self->updated, ((Document){.path = strdup(path)}));
+    document = array_back(&self->updated);
+  }
+  array_clear(&document->strings);
+  array_clear(&document->entries);
+  document->removed = !tree;
+  if (tree) {
+    collect_entries(self, document, tree, source);
+  }
+}
+
+static int compare_save_entries(const void *a, const void *b) {
+  const SaveEntry *x = a;
+  const SaveEntry *y = b;
+  int order = compare_names(x->name_space, x->name, x->length, y->name_space, y->name, y->length);
+  if (order != 0) {
+    return order;
+  }
+  bool x_reference = !is_definition(x->kind), y_reference = !is_definition(y->kind);
+  if (x_reference != y_reference) {
+    return x_reference - y_reference;
+  }
+  if (x->document != y->document) {
+    return (x->document > y->document) - (x->document < y->document);
+  }
+  return (x->start_byte > y->start_byte) - (x->start_byte < y->start_byte);
+}
+
+static bool write_all(FILE *file, const void *data, size_t size) {
+  return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+bool ts_asciidoc_xref_index_save(TSAsciidocXrefIndex *self, const char *path) {
+  StringArray strings = array_new();
+  Array(FileDocument) documents = array_new();
+  Array(SaveEntry) gathered = array_new();
+
+  // Renumber the documents that survive and gather their entries.
+  uint32_t mapped_documents = self->header ? self->header->document_count : 0;
+  uint32_t *renumber = malloc((mapped_documents + 1) * sizeof(uint32_t));
+  for (uint32_t i = 0; i < mapped_documents; i++) {
+    if (!self->replaced[i]) {
+      const char *document_path = self->strings + self->documents[i].path;
+      renumber[i] = documents.size;
+      array_push(&documents, ((FileDocument){
+                               add_string(&strings, document_path, strlen(document_path)),
+                             }));
+    }
+  }
+  for (uint32_t i = 0; self->header && i < self->header->name_count; i++) {
+    const FileName *name = &self->names[i];
+    uint32_t end = name->first_entry + name->definition_count + name->reference_count;
+    for (uint32_t j = name->first_entry; j < end; j++) {
+      const FileEntry *entry = &self->entries[j];
+      if (!self->replaced[entry->document]) {
+        array_push(&gathered, ((SaveEntry){
+                                .name = self->strings + name->string,
+                                .length = name->length,
+                                .name_space = name->name_space,
+                                .document = renumber[entry->document],
+                                .start_byte = entry->start_byte,
+                                .start_point = {entry->row, entry->column},
+                                .kind = (TSAsciidocXrefKind)entry->kind,
+                              }));
+      }
+    }
+  }
+  free(renumber);
+  for (uint32_t i = 0; i < self->updated.size; i++) {
+    const Document *document = &self->updated.contents[i];
+    if (document->removed) {
+      continue;
+    }
+    for (uint32_t j = 0; j < document->entries.size; j++) {
+      const LocalEntry *entry = &document->entries.contents[j];
+      array_push(&gathered, ((SaveEntry){
+                              .name = document->strings.contents + entry->name,
+                              .length = entry->length,
+                              .name_space = kind_namespace(entry->kind),
+                              .document = documents.size,
+                              .start_byte = entry->start_byte,
+                              .start_point = entry->start_point,
+                              .kind = entry->kind,
+                            }));
+    }
+    array_push(&documents, ((FileDocument){
+                             add_string(&strings, document->path, strlen(document->path)),
+                           }));
+  }
+  qsort(gathered.contents, gathered.size, sizeof(SaveEntry), compare_save_entries);
+
+  Array(FileName) names = array_new();
+  Array(FileEntry) entries = array_new();
+  const SaveEntry *previous = NULL;
+  for (uint32_t i = 0; i < gathered.size; i++) {
+    const SaveEntry *entry = &gathered.contents[i];
+    if (!previous || compare_names(previous->name_space, previous->name, previous->length,
+                                   entry->name_space, entry->name, entry->length) != 0) {
+      array_push(&names, ((FileName){
+                           .string = add_string(&strings, entry->name, entry->length),
+                           .length = entry->length,
+                           .name_space = entry->name_space,
+                           .first_entry = entries.size,
+                         }));
+      previous = entry;
+    }
+    FileName *name = array_back(&names);
+    if (is_definition(entry->kind)) {
+      name->definition_count++;
+    } else {
+      name->reference_count++;
+    }
+    array_push(&entries, ((FileEntry){
+                           .document = entry->document,
+                           .start_byte = entry->start_byte,
+                           .row = entry->start_point.row,
+                           .column = entry->start_point.column,
+                           .kind = entry->kind,
+                         }));
+  }
+  if (strings.size == 0) {
+    array_push(&strings, '\0');
+  }
+
+  FileHeader header = {
+    .magic = XREF_MAGIC,
+    .version = XREF_VERSION,
+    .document_count = documents.size,
+    .name_count = names.size,
+    .entry_count = entries.size,
+    .string_size = strings.size,
+  };
+  header.documents_offset = sizeof(FileHeader);
+  header.names_offset = header.documents_offset + documents.size * sizeof(FileDocument);
+  header.entries_offset = header.names_offset + names.size * sizeof(FileName);
+  header.strings_offset = header.entries_offset + entries.size * sizeof(FileEntry);
+
+  // Write next to the target and rename, so that readers never map a
+  // partial file.
+  size_t path_length = strlen(path);
+  char *temporary = malloc(path_length + 5);
+  memcpy(temporary, path, path_length);
+  memcpy(temporary + path_length, ".tmp", 5);
+  FILE *file = fopen(temporary, "wb");
+  bool ok = file && write_all(file, &header, sizeof(header)) &&
+            write_all(file, documents.contents, documents.size * sizeof(FileDocument)) &&
+            write_all(file, names.contents, names.size * sizeof(FileName)) &&
+            write_all(file, entries.contents, entries.size * sizeof(FileEntry)) &&
+            write_all(file, strings.contents, strings.size);
+  if (file && fclose(file) != 0) {
+    ok = false;
+  }
+  ok = ok && rename(temporary, path) == 0;
+  int error = errno;
+  if (!ok) {
+    unlink(temporary);
+  }
+  free(temporary);
+
+  array_delete(&gathered);
+  array_delete(&names);
+  array_delete(&entries);
+  array_delete(&documents);
+  array_delete(&strings);
+
+  // Continue from the saved file, with nothing held in memory.
+  if (ok && map_file(self, path)) {
+    clear_updated(self);
+  }
+  errno = error;
+  return ok;
+}
+
+static void push_mapped_entry(TSAsciidocXrefIndex *self, const FileName *name,
+                              const FileEntry *entry) {
+  array_push(&self->results, ((TSAsciidocXrefEntry){
+                               .name = self->strings + name->string,
+                               .path = self->strings + self->documents[entry->document].path,
+                               .start_byte = entry->start_byte,
+                               .start_point = {entry->row, entry->column},
+                               .kind = (TSAsciidocXrefKind)entry->kind,
+                             }));
+}
+
+static void push_local_entry(TSAsciidocXrefIndex *self, const Document *document,
+                             const LocalEntry *entry) {
+  array_push(&self->results, ((TSAsciidocXrefEntry){
+                               .name = document->strings.contents + entry->name,
+                               .path = document->path,
+                               .start_byte = entry->start_byte,
+                               .start_point = entry->start_point,
+                               .kind = entry->kind,
+                             }));
+}
+
+// Index of the first mapped name not ordered before (name_space, name).
+static uint32_t lower_bound(const TSAsciidocXrefIndex *self, uint32_t name_space,
+                            const char *name, uint32_t length) {
+  uint32_t low = 0, high = self->header ? self->header->name_count : 0;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    const FileName *candidate = &self->names[mid];
+    if (compare_names(candidate->name_space, self->strings + candidate->string,
+                      candidate->length, name_space, name, length) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+static const TSAsciidocXrefEntry *lookup(TSAsciidocXrefIndex *self,
+                                         TSAsciidocXrefNamespace name_space, const char *name,
+                                         uint32_t length, bool definitions, uint32_t *count) {
+  array_clear(&self->results);
+
+  uint32_t index = lower_bound(self, name_space, name, length);
+  if (self->header && index < self->header->name_count) {
+    const FileName *found = &self->names[index];
+    if (compare_names(found->name_space, self->strings + found->string, found->length,
+                      name_space, name, length) == 0) {
+      uint32_t start = definitions ? found->first_entry
+                                   : found->first_entry + found->definition_count;
+      uint32_t end = start + (definitions ? found->definition_count : found->reference_count);
+      for (uint32_t i = start; i < end; i++) {
+        if (!self->replaced[self->entries[i].document]) {
+          push_mapped_entry(self, found, &self->entries[i]);
+        }
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < self->updated.size; i++) {
+    const Document *document = &self->updated.contents[i];
+    for (uint32_t j = 0; j < document->entries.size; j++) {
+      const LocalEntry *entry = &document->entries.contents[j];
+      if (is_definition(entry->kind) == definitions &&
+          kind_namespace(entry->kind) == name_space &&
+          compare_names(0, document->strings.contents + entry->name, entry->length, 0, name,
+                        length) == 0) {
+        push_local_entry(self, document, entry);
+      }
+    }
+  }
+
+  *count = self->results.size;
+  return self->results.contents;
+}
+
+const TSAsciidocXrefEntry *ts_asciidoc_xref_definitions(TSAsciidocXrefIndex *self,
+                                                        TSAsciidocXrefNamespace name_space,
+                                                        const char *name, uint32_t length,
+                                                        uint32_t *count) {
+  return lookup(self, name_space, name, length, true, count);
+}
+
+const TSAsciidocXrefEntry *ts_asciidoc_xref_references(TSAsciidocXrefIndex *self,
+                                                       TSAsciidocXrefNamespace name_space,
+                                                       const char *name, uint32_t length,
+                                                       uint32_t *count) {
+  return lookup(self, name_space, name, length, false, count);
+}
+
+static int compare_results(const void *a, const void *b) {
+  return strcmp(((const TSAsciidocXrefEntry *)a)->name, ((const TSAsciidocXrefEntry *)b)->name);
+}
+
+const TSAsciidocXrefEntry *ts_asciidoc_xref_complete(TSAsciidocXrefIndex *self,
+                                                     TSAsciidocXrefNamespace name_space,
+                                                     const char *prefix, uint32_t length,
+                                                     uint32_t limit, uint32_t *count) {
+  array_clear(&self->results);
+
+  // Mapped names are sorted, so the matches are one run. Stopping after
+  // `limit` of them is safe: any later one would be cut below anyway.
+  uint32_t name_count = self->header ? self->header->name_count : 0;
+  uint32_t mapped = 0;
+  for (uint32_t i = lower_bound(self, name_space, prefix, length);
+       i < name_count && mapped < limit; i++) {
+    const FileName *name = &self->names[i];
+    if (name->name_space != name_space || name->length < length ||
+        memcmp(self->strings + name->string, prefix, length) != 0) {
+      break;
+    }
+    for (uint32_t j = name->first_entry; j < name->first_entry + name->definition_count; j++) {
+      if (!self->replaced[self->entries[j].document]) {
+        push_mapped_entry(self, name, &self->entries[j]);
+        mapped++;
+        break;
+      }
+    }
+  }
+
+  for (uint32_t i = 0; i < self->updated.size; i++) {
+    const Document *document = &self->updated.contents[i];
+    for (uint32_t j = 0; j < document->entries.size; j++) {
+      const LocalEntry *entry = &document->entries.contents[j];
+      if (is_definition(entry->kind) && kind_namespace(entry->kind) == name_space &&
+          entry->length >= length &&
+          memcmp(document->strings.contents + entry->name, prefix, length) == 0) {
+        push_local_entry(self, document, entry);
+      }
+    }
+  }
+
+  // Updated documents are few, so sorting the merged list stays cheap.
+  if (self->updated.size > 0) {
+    qsort(self->results.contents, self->results.size, sizeof(TSAsciidocXrefEntry),
+          compare_results);
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < self->results.size; i++) {
+      if (unique == 0 ||
+          strcmp(self->results.contents[i].name, self->results.contents[unique - 1].name) != 0) {
+        self->results.contents[unique++] = self->results.contents[i];
+      }
+    }
+    self->results.size = unique;
+  }
+  if (self->results.size > limit) {
+    self->results.size = limit;
+  }
+
+  *count = self->results.size;
+  return self->results.contents;
+}
@@ -1,7 +1,11 @@
 package tree_sitter_asciidoc_test
 
 import (
+	"context"
+	"errors"
+	"strings"
 	"testing"
+	"time"
 
 	tree_sitter "github.com/tree-sitter/go-tree-sitter"
 	tree_sitter_asciidoc "github.com/louiss0/tree-sitter-asciidoc/bindings/go"
@@ -13,3 +17,32 @@ func TestCanLoadGrammar(t *testing.T) {
 		t.Errorf("Error loading Tree-Sitter-Asciidoc grammar")
 	}
 }
+
+func TestParseWithBudget(t *testing.T) {
+	parser := tree_sitter.NewParser()
+	defer parser.Close()
+	parser.SetLanguage(tree_sitter.NewLanguage(tree_sitter_asciidoc.Language()))
+	source := []byte("= Title\n\n" + strings.Repeat("A paragraph.\n\n", 2000))
+
+	tree, err := tree_sitter_asciidoc.ParseWithBudget(context.Background(), parser, source, nil,
+		tree_sitter_asciidoc.ParseBudget{MaxBytes: 1000, Partial: true})
+	if err != nil || tree.RootNode().EndByte() > 1000 {
+		t.Fatalf("expected a tree of the first 1000 bytes, got %v", err)
+	}
+	tree.Close()
+
+	ctx, cancel := context.WithCancel(context.Background())
+	cancel()
+	_, err = tree_sitter_asciidoc.ParseWithBudget(ctx, parser, source, nil,
+		tree_sitter_asciidoc.ParseBudget{})
+	if !errors.Is(err, context.Canceled) {
+		t.Fatalf("expected a cancellation, got %v", err)
+	}
+
+	tree, err = tree_sitter_asciidoc.ParseWithBudget(context.Background(), parser, source, nil,
+		tree_sitter_asciidoc.ParseBudget{Timeout: time.Minute})
+	if err != nil || tree.RootNode().EndByte() != uint(len(source)) {
+		t.Fatalf("expected a full tree, got %v", err)
+	}
+	tree.Close()
+}
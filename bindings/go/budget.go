@@ -0,0 +1,140 @@
+package tree_sitter_asciidoc
+
+import (
+	"bytes"
+	"context"
+	"errors"
+	"fmt"
+	"time"
+
+	tree_sitter "github.com/tree-sitter/go-tree-sitter"
+)
+
+// budgetChunk is the most input handed to the parser per read, so that a
+// budget is checked at least this often.
+const budgetChunk = 16 * 1024
+
+// ParseBudget limits a call to ParseWithBudget. Zero values mean no limit.
+type ParseBudget struct {
+	// Timeout is the time allowed for the parse.
+	Timeout time.Duration
+	// MaxBytes limits the parse to the lines within the first MaxBytes bytes.
+	MaxBytes int
+	// Progress is called as the parser reads its input, with the byte it
+	// has reached. Returning false stops the parse.
+	Progress func(offset int, elapsed time.Duration) bool
+	// Partial asks for the tree of the prefix parsed so far when a budget
+	// runs out, instead of a BudgetError.
+	Partial bool
+}
+
+// BudgetError is returned by ParseWithBudget when a budget runs out.
+// errors.Is matches a timeout against context.DeadlineExceeded and a
+// cancellation against context.Canceled.
+type BudgetError struct {
+	// Reason is "timeout", "bytes" or "cancelled".
+	Reason string
+	// Offset is the input byte the parse had reached.
+	Offset int
+}
+
+func (e *BudgetError) Error() string {
+	switch e.Reason {
+	case "timeout":
+		return fmt.Sprintf("parse stopped at byte %d: time budget exhausted", e.Offset)
+	case "bytes":
+		return fmt.Sprintf("parse stopped at byte %d: byte budget exhausted", e.Offset)
+	default:
+		return fmt.Sprintf("parse stopped at byte %d: cancelled", e.Offset)
+	}
+}
+
+func (e *BudgetError) Unwrap() error {
+	switch e.Reason {
+	case "timeout":
+		return context.DeadlineExceeded
+	case "cancelled":
+		return context.Canceled
+	}
+	return nil
+}
+
+// ParseWithBudget parses source with a parser for this language within the
+// limits of budget and ctx; the end of ctx counts as a timeout if its
+// deadline passed and as a cancellation otherwise.
+//
+// When a budget runs out, the input ends at the next chunk boundary. With
+// budget.Partial the parser closes whatever is open there and the tree of
+// that prefix is returned. Otherwise the parse is halted through its progress
+// callback and a *BudgetError is returned. A partial parse that stops
+// reading input is halted the same way once twice the timeout has passed.
+func ParseWithBudget(ctx context.Context, parser *tree_sitter.Parser, source []byte,
+	oldTree *tree_sitter.Tree, budget ParseBudget) (*tree_sitter.Tree, error) {
+	length := len(source)
+	if budget.MaxBytes > 0 && length > budget.MaxBytes {
+		if !budget.Partial {
+			return nil, &BudgetError{Reason: "bytes"}
+		}
+		length = bytes.LastIndexByte(source[:budget.MaxBytes], '\n') + 1
+	}
+
+	start := time.Now()
+	cutoff, handedOut := length, 0
+	reason := ""
+	read := func(offset int, _ tree_sitter.Point) []byte {
+		if offset >= cutoff {
+			return nil
+		}
+		if reason == "" {
+			elapsed := time.Since(start)
+			switch {
+			case budget.Timeout > 0 && elapsed > budget.Timeout:
+				reason = "timeout"
+			case ctx.Err() != nil:
+				reason = "cancelled"
+				if errors.Is(ctx.Err(), context.DeadlineExceeded) {
+					reason = "timeout"
+				}
+			case budget.Progress != nil && !budget.Progress(offset, elapsed):
+				reason = "cancelled"
+			}
+			if reason != "" {
+				// Bytes already handed to the parser must read the same when
+				// asked for again.
+				cutoff = max(offset, handedOut)
+				if offset >= cutoff {
+					return nil
+				}
+			}
+		}
+		end := min(offset+budgetChunk, cutoff)
+		handedOut = max(handedOut, end)
+		return source[offset:end]
+	}
+
+	halted := false
+	options := &tree_sitter.ParseOptions{
+		ProgressCallback: func(tree_sitter.ParseState) bool {
+			if reason != "" && !budget.Partial {
+				halted = true
+			} else if budget.Timeout > 0 && time.Since(start) > 2*budget.Timeout {
+				halted = true
+			}
+			return halted
+		},
+	}
+	tree := parser.ParseWithOptions(read, oldTree, options)
+	if tree == nil {
+		// Otherwise the next parse would resume this one.
+		parser.Reset()
+		if reason == "" {
+			reason = "timeout"
+		}
+		return nil, &BudgetError{Reason: reason, Offset: handedOut}
+	}
+	if reason != "" && !budget.Partial {
+		tree.Close()
+		return nil, &BudgetError{Reason: reason, Offset: cutoff}
+	}
+	return tree, nil
+}
@@ -1,5 +1,14 @@
 #include <napi.h>
 
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include "mapping.h"
+#endif
+
 typedef struct TSLanguage TSLanguage;
 
 extern "C" TSLanguage *tree_sitter_asciidoc();
@@ -9,10 +18,80 @@ const napi_type_tag LANGUAGE_TYPE_TAG = {
     0x8AF2E5212AD58ABF, 0xD5006CAD83ABBA16
 };
 
+static Napi::Error FileError(Napi::Env env, const std::string &path, int error) {
+    auto result = Napi::Error::New(env, path + ": " + std::strerror(error));
+    result.Set("errno", Napi::Number::New(env, error));
+    result.Set("path", Napi::String::New(env, path));
+    return result;
+}
+
+#ifndef _WIN32
+
+// mapFile(path): a read-only Buffer over a memory mapping of the file, so
+// that parsing it does not keep a second copy of the document on the heap.
+// The mapping is made by bindings/c/mapping.c, which also backs
+// TSAsciidocMappedFile, and unmapped when the Buffer is collected.
+static Napi::Value MapFile(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        throw Napi::TypeError::New(env, "mapFile: path must be a string");
+    }
+    std::string path = info[0].As<Napi::String>();
+
+    auto *mapping = new AsciidocMapping;
+    int error = asciidoc_mapping_open(mapping, path.c_str());
+    if (error) {
+        delete mapping;
+        throw FileError(env, path, error);
+    }
+    if (mapping->length == 0) {
+        delete mapping;
+        return Napi::Buffer<char>::New(env, 0);
+    }
+    return Napi::Buffer<char>::New(
+        env, const_cast<char *>(mapping->data), mapping->length,
+        [](Napi::Env, char *, AsciidocMapping *mapping) {
+            asciidoc_mapping_close(mapping);
+            delete mapping;
+        },
+        mapping);
+}
+
+#else
+
+// Without mmap the file is read into the Buffer, which keeps the API the
+// same on every platform.
+static Napi::Value MapFile(const Napi::CallbackInfo &info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsString()) {
+        throw Napi::TypeError::New(env, "mapFile: path must be a string");
+    }
+    std::string path = info[0].As<Napi::String>();
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw FileError(env, path, errno);
+    }
+    std::string contents;
+    char chunk[65536];
+    size_t count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        contents.append(chunk, count);
+    }
+    bool failed = std::ferror(file);
+    std::fclose(file);
+    if (failed) {
+        throw FileError(env, path, EIO);
+    }
+    return Napi::Buffer<char>::Copy(env, contents.data(), contents.size());
+}
+
+#endif
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     auto language = Napi::External<TSLanguage>::New(env, tree_sitter_asciidoc());
     language.TypeTag(&LANGUAGE_TYPE_TAG);
     exports["language"] = language;
+    exports["mapFile"] = Napi::Function::New(env, MapFile, "mapFile");
     return exports;
 }
 
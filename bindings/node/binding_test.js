@@ -1,4 +1,6 @@
 const assert = require("node:assert");
+const fs = require("node:fs");
+const path = require("node:path");
 const { test } = require("node:test");
 
 const Parser = require("tree-sitter");
@@ -7,3 +9,31 @@ test("can load grammar", () => {
   const parser = new Parser();
   assert.doesNotThrow(() => parser.setLanguage(require(".")));
 });
+
+test("parses a mapped file like its contents", () => {
+  const binding = require(".");
+  const file = path.join(__dirname, "..", "..", "asciidoc-syntax-reference.adoc");
+  const parser = new Parser();
+  parser.setLanguage(binding);
+  assert.ok(binding.mapFile(file).equals(fs.readFileSync(file)));
+  const expected = parser.parse(fs.readFileSync(file, "utf8"));
+  const tree = binding.parseFile(parser, file);
+  assert.strictEqual(tree.rootNode.toString(), expected.rootNode.toString());
+  const last = tree.rootNode.lastNamedChild;
+  assert.strictEqual(last.text, expected.rootNode.lastNamedChild.text);
+});
+
+test("parses within a budget", () => {
+  const binding = require(".");
+  const parser = new Parser();
+  parser.setLanguage(binding);
+  const source = "= Title\n\n" + "A paragraph.\n\n".repeat(2000);
+  const tree = binding.parseWithBudget(parser, source, { maxBytes: 1000, partial: true });
+  assert.ok(tree.rootNode.endIndex <= 1000);
+  assert.throws(
+    () => binding.parseWithBudget(parser, source, { progress: () => false }),
+    binding.ParseBudgetError,
+  );
+  const full = binding.parseWithBudget(parser, source, { timeoutMicros: 60e6 });
+  assert.strictEqual(full.rootNode.endIndex, source.length);
+});
@@ -18,9 +18,58 @@ type NodeInfo =
       children: ChildNode[];
     });
 
+type Point = {
+  row: number;
+  column: number;
+};
+
+type Input = (index: number, position?: Point) => string | null;
+
+type ParseBudget<Tree> = {
+  /** Time allowed for the parse, in microseconds. */
+  timeoutMicros?: number;
+  /** Only the lines within the first `maxBytes` UTF-8 bytes are parsed. */
+  maxBytes?: number;
+  /** Called as the parser reads its input; returning `false` stops the parse. */
+  progress?: (state: { index: number; elapsedMicros: number }) => boolean | void;
+  /** Return the tree of the prefix parsed so far instead of throwing. */
+  partial?: boolean;
+  oldTree?: Tree | null;
+};
+
+declare class ParseBudgetError extends Error {
+  code: "ETIMEDOUT" | "EFBIG" | "ECANCELED";
+  reason: "timeout" | "bytes" | "cancelled";
+  /** Input index (UTF-16 code units) the parse had reached. */
+  index: number;
+}
+
+type BudgetParser<Tree> = {
+  parse(input: Input, oldTree?: Tree | null, options?: object): Tree;
+  getTimeoutMicros(): number;
+  setTimeoutMicros(timeout: number): void;
+  reset(): void;
+};
+
 type Language = {
   language: unknown;
   nodeTypeInfo: NodeInfo[];
+  /** A read-only Buffer over a memory mapping of the file at `path`. */
+  mapFile(path: string): Buffer;
+  /** Parses the file at `path` from a memory mapping with a tree-sitter `Parser`. */
+  parseFile<Tree>(
+    parser: { parse(input: Input, oldTree?: Tree | null, options?: object): Tree },
+    path: string,
+    oldTree?: Tree | null,
+    options?: object,
+  ): Tree;
+  /** Parses `source` within a time or byte budget, see ParseBudget. */
+  parseWithBudget<Tree>(
+    parser: BudgetParser<Tree>,
+    source: string | Buffer,
+    budget?: ParseBudget<Tree>,
+  ): Tree;
+  ParseBudgetError: typeof ParseBudgetError;
 };
 
 declare const language: Language;
@@ -9,3 +9,161 @@ module.exports =
 try {
   module.exports.nodeTypeInfo = require("../../src/node-types.json");
 } catch (_) {}
+
+// node-tree-sitter reads callback input in UTF-16 code units, so the mapping
+// is decoded a chunk at a time on demand. `starts` and `indices` hold the
+// byte offset and UTF-16 index of every chunk decoded so far; a parse reads
+// them in order, and node text is looked up from the nearest one.
+const CHUNK_BYTES = 64 * 1024;
+
+function mappedInput(buffer) {
+  const starts = [0];
+  const indices = [0];
+  return (index) => {
+    let low = 0;
+    let high = indices.length;
+    while (high - low > 1) {
+      const middle = (low + high) >> 1;
+      if (indices[middle] <= index) low = middle;
+      else high = middle;
+    }
+    for (let k = low; starts[k] < buffer.length; k++) {
+      const start = starts[k];
+      let end = Math.min(start + CHUNK_BYTES, buffer.length);
+      // Do not cut a UTF-8 sequence in two.
+      let boundary = end;
+      while (boundary > start && boundary < buffer.length && (buffer[boundary] & 0xc0) === 0x80) {
+        boundary--;
+      }
+      if (boundary > start) end = boundary;
+      const text = buffer.toString("utf8", start, end);
+      if (index < indices[k] + text.length) {
+        return text.slice(index - indices[k]);
+      }
+      if (k + 1 === starts.length) {
+        starts.push(end);
+        indices.push(indices[k] + text.length);
+      }
+    }
+    return null;
+  };
+}
+
+/**
+ * Parses a file from a memory mapping (see `mapFile`) instead of a string
+ * holding all of it. The tree keeps the mapping alive, and its nodes' text is
+ * decoded from the mapping when asked for.
+ */
+module.exports.parseFile = (parser, path, oldTree, options) =>
+  parser.parse(mappedInput(module.exports.mapFile(path)), oldTree, options);
+
+/** Thrown by `parseWithBudget` when a budget runs out and `partial` is not set. */
+class ParseBudgetError extends Error {
+  constructor(reason, index) {
+    super(`parse stopped at index ${index}: ${BUDGET_MESSAGES[reason]}`);
+    this.name = "ParseBudgetError";
+    this.code = BUDGET_CODES[reason];
+    // "timeout", "bytes" or "cancelled"
+    this.reason = reason;
+    // Input index (UTF-16 code units) the parse had reached.
+    this.index = index;
+  }
+}
+
+const BUDGET_MESSAGES = {
+  timeout: "time budget exhausted",
+  bytes: "byte budget exhausted",
+  cancelled: "cancelled by the progress callback",
+};
+
+const BUDGET_CODES = { timeout: "ETIMEDOUT", bytes: "EFBIG", cancelled: "ECANCELED" };
+
+// Input is handed out in chunks this long (UTF-16 code units), so the
+// budget is checked at least this often.
+const BUDGET_CHUNK = 16 * 1024;
+
+// The document cut after its last line break at or before `maxBytes`
+// UTF-8 bytes, or null if it fits.
+function cutToBytes(source, maxBytes) {
+  const buffer = typeof source === "string" ? null : source;
+  if (buffer ? buffer.length <= maxBytes : source.length * 3 <= maxBytes) return null;
+  const bytes = buffer || Buffer.from(source, "utf8");
+  if (bytes.length <= maxBytes) return null;
+  const newline = bytes.lastIndexOf(0x0a, maxBytes - 1);
+  const prefix = bytes.subarray(0, newline + 1);
+  return buffer ? prefix : prefix.toString("utf8");
+}
+
+/**
+ * Parses `source` (a string, or a Buffer such as one from `mapFile`) with a
+ * budget:
+ *
+ * - `timeoutMicros`: time allowed for the parse;
+ * - `maxBytes`: only the lines within the first `maxBytes` UTF-8 bytes are
+ *   parsed;
+ * - `progress({ index, elapsedMicros })`: called as the parser reads its
+ *   input; returning `false` stops the parse.
+ *
+ * When a budget runs out, the input ends at the next chunk boundary and the
+ * parser closes whatever is open there. With `partial: true` the resulting
+ * tree of the prefix is returned; otherwise a `ParseBudgetError` is thrown.
+ * As a ceiling for a parse that stops reading input, the parser's own
+ * timeout is set to twice `timeoutMicros`; when that fires, the error is
+ * thrown whatever `partial` says.
+ */
+function parseWithBudget(parser, source, options = {}) {
+  const { timeoutMicros = 0, maxBytes = 0, progress, partial = false, oldTree } = options;
+  if (maxBytes > 0) {
+    const prefix = cutToBytes(source, maxBytes);
+    if (prefix !== null) {
+      if (!partial) throw new ParseBudgetError("bytes", 0);
+      source = prefix;
+    }
+  }
+
+  const read =
+    typeof source === "string"
+      ? (index) => (index < source.length ? source.slice(index, index + BUDGET_CHUNK) : null)
+      : mappedInput(source);
+  const start = process.hrtime.bigint();
+  let cutoff = Infinity;
+  let handedOut = 0;
+  let reason = null;
+  const input = (index) => {
+    if (index >= cutoff) return null;
+    if (!reason) {
+      const elapsedMicros = Number((process.hrtime.bigint() - start) / 1000n);
+      if (timeoutMicros > 0 && elapsedMicros > timeoutMicros) reason = "timeout";
+      else if (progress && progress({ index, elapsedMicros }) === false) reason = "cancelled";
+      if (reason) {
+        // Text already handed to the parser must read the same when asked for again.
+        cutoff = Math.max(index, handedOut);
+        if (index >= cutoff) return null;
+      }
+    }
+    let text = read(index);
+    if (text && text.length > BUDGET_CHUNK) text = text.slice(0, BUDGET_CHUNK);
+    if (text && index + text.length > cutoff) text = text.slice(0, cutoff - index);
+    if (text) handedOut = Math.max(handedOut, index + text.length);
+    return text || null;
+  };
+
+  const previousTimeout = parser.getTimeoutMicros();
+  if (timeoutMicros > 0) parser.setTimeoutMicros(timeoutMicros * 2);
+  let tree;
+  try {
+    tree = parser.parse(input, oldTree);
+  } finally {
+    parser.setTimeoutMicros(previousTimeout);
+  }
+  if (!tree) {
+    // Otherwise the next parse would resume this one.
+    parser.reset();
+    throw new ParseBudgetError("timeout", handedOut);
+  }
+  if (reason && !partial) throw new ParseBudgetError(reason, cutoff);
+  return tree;
+}
+
+module.exports.ParseBudgetError = ParseBudgetError;
+module.exports.parseWithBudget = parseWithBudget;
@@ -1,3 +1,4 @@
+from pathlib import Path
 from unittest import TestCase
 
 import tree_sitter
@@ -10,3 +11,23 @@ class TestLanguage(TestCase):
             tree_sitter.Language(tree_sitter_asciidoc.language())
         except Exception:
             self.fail("Error loading Tree-Sitter-Asciidoc grammar")
+
+    def test_parses_mapped_file_like_its_contents(self):
+        path = Path(__file__).parents[3] / "asciidoc-syntax-reference.adoc"
+        parser = tree_sitter.Parser(tree_sitter.Language(tree_sitter_asciidoc.language()))
+        expected = parser.parse(path.read_bytes())
+        with tree_sitter_asciidoc.MappedFile(str(path)) as mapped:
+            tree = mapped.parse(parser)
+            self.assertEqual(str(tree.root_node), str(expected.root_node))
+            node = tree.root_node.named_children[-1]
+            self.assertEqual(mapped.node_text(node), expected.root_node.named_children[-1].text)
+
+    def test_parse_with_budget_returns_a_prefix_or_raises(self):
+        parser = tree_sitter.Parser(tree_sitter.Language(tree_sitter_asciidoc.language()))
+        source = b"= Title\n\n" + b"A paragraph.\n\n" * 2000
+        tree = tree_sitter_asciidoc.parse_with_budget(parser, source, max_bytes=1000, partial=True)
+        self.assertLessEqual(tree.root_node.end_byte, 1000)
+        with self.assertRaises(tree_sitter_asciidoc.ParseBudgetError):
+            tree_sitter_asciidoc.parse_with_budget(parser, source, progress=lambda byte, _: False)
+        tree = tree_sitter_asciidoc.parse_with_budget(parser, source, timeout=60)
+        self.assertEqual(tree.root_node.end_byte, len(source))
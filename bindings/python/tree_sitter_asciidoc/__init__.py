@@ -1,9 +1,208 @@
 """This is my parser for Asciidoc"""
 
+import errno as _errno
+import mmap as _mmap
+import os as _os
+import stat as _stat
+import time as _time
+import warnings as _warnings
 from importlib.resources import files as _files
 
 from ._binding import language
 
+# Offsets are 32-bit, as in tree-sitter.
+_MAX_MAPPED_BYTES = 0xFFFFFFFF
+
+# Bytes handed to the parser per read callback.
+_CHUNK_BYTES = 64 * 1024
+
+# Bytes handed to the parser per read callback under a budget, so that the
+# budget is checked at least this often.
+_BUDGET_CHUNK_BYTES = 16 * 1024
+
+_BUDGET_MESSAGES = {
+    "timeout": "time budget exhausted",
+    "bytes": "byte budget exhausted",
+    "cancelled": "cancelled by the progress callback",
+}
+
+
+class MappedFile:
+    """A file mapped read-only for parsing without a heap copy of its bytes.
+
+    The parser reads the mapping through a callback a chunk at a time, and
+    node text is sliced out of it, so only the page cache holds the whole
+    document. Files are refused and advised as by ``bindings/c/mapping.c``:
+    anything but a regular file, or 4 GiB and more, raises ``OSError``, and
+    the mapping is advised for sequential access when opened and while a
+    parse runs where the platform supports it.
+    """
+
+    def __init__(self, path):
+        self._map = None
+        with open(path, "rb") as file:
+            info = _os.fstat(file.fileno())
+            if not _stat.S_ISREG(info.st_mode):
+                raise OSError(_errno.EINVAL, _os.strerror(_errno.EINVAL), path)
+            if info.st_size > _MAX_MAPPED_BYTES:
+                raise OSError(_errno.EFBIG, _os.strerror(_errno.EFBIG), path)
+            if info.st_size > 0:
+                self._map = _mmap.mmap(file.fileno(), 0, access=_mmap.ACCESS_READ)
+        self._advise("MADV_SEQUENTIAL")
+
+    def __len__(self):
+        return len(self._map) if self._map is not None else 0
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc_info):
+        self.close()
+
+    def close(self):
+        if self._map is not None:
+            self._map.close()
+            self._map = None
+
+    def _advise(self, name):
+        advice = getattr(_mmap, name, None)
+        if self._map is not None and advice is not None and hasattr(self._map, "madvise"):
+            self._map.madvise(advice)
+
+    def read(self, byte, point=None):
+        """The read callback for ``Parser.parse``."""
+        if self._map is None:
+            return b""
+        return self._map[byte:byte + _CHUNK_BYTES]
+
+    def parse(self, parser, old_tree=None):
+        """Parses the file with a ``tree_sitter.Parser`` for this language."""
+        self._advise("MADV_SEQUENTIAL")
+        try:
+            if old_tree is None:
+                return parser.parse(self.read)
+            return parser.parse(self.read, old_tree)
+        finally:
+            self._advise("MADV_NORMAL")
+
+    def node_text(self, node):
+        """The bytes of ``node``, which must come from a tree of this file."""
+        if self._map is None:
+            return b""
+        return self._map[node.start_byte:node.end_byte]
+
+
+class ParseBudgetError(Exception):
+    """Raised by ``parse_with_budget`` when a budget runs out.
+
+    ``reason`` is ``"timeout"``, ``"bytes"`` or ``"cancelled"``, and
+    ``byte`` the input offset the parse had reached.
+    """
+
+    def __init__(self, reason, byte):
+        super().__init__(f"parse stopped at byte {byte}: {_BUDGET_MESSAGES[reason]}")
+        self.reason = reason
+        self.byte = byte
+
+
+def _budget_reader(source):
+    """A read callback over ``source`` and its length in bytes."""
+    if isinstance(source, MappedFile):
+        return source.read, len(source)
+    if isinstance(source, str):
+        source = source.encode("utf8")
+    view = memoryview(source).cast("B")
+    return (lambda byte, point=None: bytes(view[byte:byte + _BUDGET_CHUNK_BYTES])), len(view)
+
+
+def _last_line_end(source, limit):
+    """The end of the last line that ends within the first ``limit`` bytes."""
+    if isinstance(source, MappedFile):
+        data = source._map
+    elif isinstance(source, str):
+        data = source.encode("utf8")
+    elif hasattr(source, "rfind"):
+        data = source
+    else:
+        data = bytes(source)
+    return data.rfind(b"\n", 0, limit) + 1
+
+
+def parse_with_budget(parser, source, *, timeout=None, max_bytes=None, progress=None,
+                      partial=False, old_tree=None):
+    """Parses ``source`` with a ``tree_sitter.Parser`` within a budget.
+
+    ``source`` is ``str``, a bytes-like object or a ``MappedFile``.
+    ``timeout`` is the time allowed in seconds, ``max_bytes`` limits the
+    parse to the lines within that many bytes, and ``progress(byte,
+    elapsed)`` is called as the parser reads its input and stops the parse
+    by returning ``False``.
+
+    When a budget runs out, the input ends at the next chunk boundary and the
+    parser closes whatever is open there. With ``partial=True`` the tree of
+    that prefix is returned; otherwise ``ParseBudgetError`` is raised. As a
+    ceiling for a parse that stops reading input, the parser's own timeout is
+    set to twice ``timeout`` where the installed py-tree-sitter supports it;
+    when that fires, ``ParseBudgetError`` is raised whatever ``partial`` says.
+    """
+    read, length = _budget_reader(source)
+    if max_bytes is not None and length > max_bytes:
+        if not partial:
+            raise ParseBudgetError("bytes", 0)
+        length = _last_line_end(source, max_bytes)
+
+    start = _time.monotonic()
+    state = {"cutoff": length, "handed_out": 0, "reason": None}
+
+    def budgeted_read(byte, point=None):
+        if byte >= state["cutoff"]:
+            return b""
+        if state["reason"] is None:
+            elapsed = _time.monotonic() - start
+            if timeout is not None and elapsed > timeout:
+                state["reason"] = "timeout"
+            elif progress is not None and progress(byte, elapsed) is False:
+                state["reason"] = "cancelled"
+            if state["reason"] is not None:
+                # Bytes already handed to the parser must read the same
+                # when asked for again.
+                state["cutoff"] = max(byte, state["handed_out"])
+                if byte >= state["cutoff"]:
+                    return b""
+        chunk = read(byte, point)[:min(_BUDGET_CHUNK_BYTES, state["cutoff"] - byte)]
+        state["handed_out"] = max(state["handed_out"], byte + len(chunk))
+        return chunk
+
+    ceiling = timeout is not None and hasattr(parser, "timeout_micros")
+    if ceiling:
+        with _warnings.catch_warnings():
+            _warnings.simplefilter("ignore", DeprecationWarning)
+            previous = parser.timeout_micros
+            parser.timeout_micros = int(timeout * 2e6)
+    try:
+        if old_tree is None:
+            tree = parser.parse(budgeted_read)
+        else:
+            tree = parser.parse(budgeted_read, old_tree)
+    except ValueError:
+        # Older py-tree-sitter raises when the parser's timeout fires.
+        if not ceiling:
+            raise
+        tree = None
+    finally:
+        if ceiling:
+            with _warnings.catch_warnings():
+                _warnings.simplefilter("ignore", DeprecationWarning)
+                parser.timeout_micros = previous
+
+    if tree is None:
+        # Otherwise the next parse would resume this one.
+        parser.reset()
+        raise ParseBudgetError("timeout", state["handed_out"])
+    if state["reason"] is not None and not partial:
+        raise ParseBudgetError(state["reason"], state["cutoff"])
+    return tree
+
 
 def _get_query(name, file):
     query = _files(f"{__package__}.queries") / file
@@ -28,6 +227,9 @@ def __getattr__(name):
 
 __all__ = [
     "language",
+    "MappedFile",
+    "ParseBudgetError",
+    "parse_with_budget",
     # "HIGHLIGHTS_QUERY",
     # "INJECTIONS_QUERY",
     # "LOCALS_QUERY",
@@ -1,4 +1,5 @@
-from typing import Final
+import os
+from typing import Any, Callable, Final, Literal, Optional, Union
 
 # NOTE: uncomment these to include any queries that this grammar contains:
 
@@ -8,3 +9,29 @@ from typing import Final
 # TAGS_QUERY: Final[str]
 
 def language() -> object: ...
+
+class MappedFile:
+    def __init__(self, path: str | bytes | os.PathLike[str]) -> None: ...
+    def __len__(self) -> int: ...
+    def __enter__(self) -> MappedFile: ...
+    def __exit__(self, *exc_info: object) -> None: ...
+    def close(self) -> None: ...
+    def read(self, byte: int, point: Any = None) -> bytes: ...
+    def parse(self, parser: Any, old_tree: Optional[Any] = None) -> Any: ...
+    def node_text(self, node: Any) -> bytes: ...
+
+class ParseBudgetError(Exception):
+    reason: Literal["timeout", "bytes", "cancelled"]
+    byte: int
+    def __init__(self, reason: str, byte: int) -> None: ...
+
+def parse_with_budget(
+    parser: Any,
+    source: Union[str, bytes, bytearray, memoryview, MappedFile],
+    *,
+    timeout: Optional[float] = None,
+    max_bytes: Optional[int] = None,
+    progress: Optional[Callable[[int, float], Optional[bool]]] = None,
+    partial: bool = False,
+    old_tree: Optional[Any] = None,
+) -> Any: ...
@@ -0,0 +1,137 @@
+//! Parsing within a time or byte budget.
+//!
+//! [`parse_with_budget`] hands the source to the parser in chunks and checks
+//! the budget before each one. When a budget runs out the input ends there:
+//! with [`ParseBudget::partial`] the parser closes whatever is open and the
+//! tree of the prefix is returned, otherwise the parse is halted from its
+//! progress callback and a [`BudgetError`] is returned. A partial parse that
+//! stops reading input is halted the same way once twice the timeout has
+//! passed.
+
+use std::cell::Cell;
+use std::fmt;
+use std::time::{Duration, Instant};
+
+use tree_sitter::{ParseOptions, ParseState, Parser, Point, Tree};
+
+/// The most input handed to the parser per read.
+const CHUNK: usize = 16 * 1024;
+
+/// Limits for [`parse_with_budget`]. The default has none.
+#[derive(Default)]
+pub struct ParseBudget<'a> {
+    /// Time allowed for the parse.
+    pub timeout: Option<Duration>,
+    /// Parse only the lines within the first `max_bytes` bytes.
+    pub max_bytes: Option<usize>,
+    /// Called as the parser reads its input, with the byte it has reached
+    /// and the time spent. Returning `false` stops the parse.
+    pub progress: Option<&'a mut dyn FnMut(usize, Duration) -> bool>,
+    /// Return the tree of the prefix parsed so far when a budget runs out,
+    /// instead of an error.
+    pub partial: bool,
+}
+
+/// Why a parse stopped early.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum BudgetReason {
+    Timeout,
+    Bytes,
+    Cancelled,
+}
+
+/// A budget ran out; `offset` is the input byte the parse had reached.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct BudgetError {
+    pub reason: BudgetReason,
+    pub offset: usize,
+}
+
+impl fmt::Display for BudgetError {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        let what = match self.reason {
+            BudgetReason::Timeout => "time budget exhausted",
+            BudgetReason::Bytes => "byte budget exhausted",
+            BudgetReason::Cancelled => "cancelled",
+        };
+        write!(f, "parse stopped at byte {}: {what}", self.offset)
+    }
+}
+
+impl std::error::Error for BudgetError {}
+
+/// Parses `source` with `parser`, which must have this language set, within
+/// the limits of `budget`.
+pub fn parse_with_budget(
+    parser: &mut Parser,
+    source: &[u8],
+    old_tree: Option<&Tree>,
+    mut budget: ParseBudget<'_>,
+) -> Result<Tree, BudgetError> {
+    let mut length = source.len();
+    if let Some(max_bytes) = budget.max_bytes.filter(|&max_bytes| length > max_bytes) {
+        if !budget.partial {
+            return Err(BudgetError {
+                reason: BudgetReason::Bytes,
+                offset: 0,
+            });
+        }
+        length = source[..max_bytes]
+            .iter()
+            .rposition(|&byte| byte == b'\n')
+            .map_or(0, |newline| newline + 1);
+    }
+
+    let start = Instant::now();
+    let cutoff = Cell::new(length);
+    let handed_out = Cell::new(0);
+    let reason = Cell::new(None);
+    let mut read = |offset: usize, _: Point| {
+        if offset >= cutoff.get() {
+            return &source[..0];
+        }
+        if reason.get().is_none() {
+            let elapsed = start.elapsed();
+            if budget.timeout.is_some_and(|timeout| elapsed > timeout) {
+                reason.set(Some(BudgetReason::Timeout));
+            } else if let Some(progress) = budget.progress.as_mut() {
+                if !progress(offset, elapsed) {
+                    reason.set(Some(BudgetReason::Cancelled));
+                }
+            }
+            if reason.get().is_some() {
+                // Bytes already handed to the parser must read the same when
+                // asked for again.
+                cutoff.set(offset.max(handed_out.get()));
+                if offset >= cutoff.get() {
+                    return &source[..0];
+                }
+            }
+        }
+        let end = (offset + CHUNK).min(cutoff.get());
+        handed_out.set(handed_out.get().max(end));
+        &source[offset..end]
+    };
+
+    let partial = budget.partial;
+    let ceiling = budget.timeout.map(|timeout| timeout * 2);
+    let mut halt = |_: &ParseState| -> bool {
+        (reason.get().is_some() && !partial) || ceiling.is_some_and(|c| start.elapsed() > c)
+    };
+    let options = ParseOptions::new().progress_callback(&mut halt);
+    let Some(tree) = parser.parse_with_options(&mut read, old_tree, Some(options)) else {
+        // Otherwise the next parse would resume this one.
+        parser.reset();
+        return Err(BudgetError {
+            reason: reason.get().unwrap_or(BudgetReason::Timeout),
+            offset: handed_out.get(),
+        });
+    };
+    match reason.get() {
+        Some(reason) if !partial => Err(BudgetError {
+            reason,
+            offset: cutoff.get(),
+        }),
+        _ => Ok(tree),
+    }
+}
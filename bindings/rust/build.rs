@@ -7,6 +7,24 @@ fn main() {
     #[cfg(target_env = "msvc")]
     c_config.flag("-utf-8");
 
+    // Opt-in release build of the parser, see PERFORMANCE.md. The objects end up in a
+    // static library that rustc links without LTO, so only -O3 and the profile apply.
+    println!("cargo:rerun-if-env-changed=ASCIIDOC_RELEASE");
+    println!("cargo:rerun-if-env-changed=ASCIIDOC_PGO_PROFILE");
+    if std::env::var_os("ASCIIDOC_RELEASE").is_some() {
+        c_config.opt_level(3);
+    }
+    if let Some(profile) = std::env::var_os("ASCIIDOC_PGO_PROFILE") {
+        if c_config.get_compiler().is_like_clang() {
+            let profile = std::path::Path::new(&profile);
+            println!("cargo:rerun-if-changed={}", profile.display());
+            c_config.flag(format!("-fprofile-use={}", profile.display()));
+            c_config.flag("-Wno-profile-instr-unprofiled");
+        } else {
+            println!("cargo:warning=ASCIIDOC_PGO_PROFILE needs clang (CC=clang); ignored");
+        }
+    }
+
     let parser_path = src_dir.join("parser.c");
     c_config.file(&parser_path);
     println!("cargo:rerun-if-changed={}", parser_path.to_str().unwrap());
@@ -20,6 +20,9 @@
 
 use tree_sitter_language::LanguageFn;
 
+#[cfg(feature = "budget")]
+pub mod budget;
+
 extern "C" {
     fn tree_sitter_asciidoc() -> *const ();
 }
@@ -48,4 +51,33 @@ mod tests {
             .set_language(&super::LANGUAGE.into())
             .expect("Error loading Tree-Sitter-Asciidoc parser");
     }
+
+    #[cfg(feature = "budget")]
+    #[test]
+    fn test_parse_with_budget() {
+        use super::budget::{parse_with_budget, BudgetReason, ParseBudget};
+
+        let mut parser = tree_sitter::Parser::new();
+        parser.set_language(&super::LANGUAGE.into()).unwrap();
+        let source = format!("= Title\n\n{}", "A paragraph.\n\n".repeat(2000));
+
+        let budget = ParseBudget {
+            max_bytes: Some(1000),
+            partial: true,
+            ..Default::default()
+        };
+        let tree = parse_with_budget(&mut parser, source.as_bytes(), None, budget).unwrap();
+        assert!(tree.root_node().end_byte() <= 1000);
+
+        let mut stop = |_: usize, _: std::time::Duration| false;
+        let budget = ParseBudget {
+            progress: Some(&mut stop),
+            ..Default::default()
+        };
+        let error = parse_with_budget(&mut parser, source.as_bytes(), None, budget).unwrap_err();
+        assert_eq!(error.reason, BudgetReason::Cancelled);
+
+        let tree = parse_with_budget(&mut parser, source.as_bytes(), None, Default::default());
+        assert_eq!(tree.unwrap().root_node().end_byte(), source.len());
+    }
 }
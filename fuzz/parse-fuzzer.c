@@ -0,0 +1,99 @@
+// libFuzzer and AFL++ harness for the whole parser, src/parser.c with
+// src/scanner.c, looking for slow inputs as well as crashes.
+//
+// Every input is parsed once as is and once repeated (see fuzz/slow.h). An
+// input that looks slow is measured again, best of three, to rule out a
+// descheduled process; if it is still slow it is written to
+// $ASCIIDOC_FUZZ_SLOW_DIR (default: the current directory) as
+// slow-<hash>.adoc and reported on stderr. With ASCIIDOC_FUZZ_SLOW_ABORT=1
+// a slow input aborts instead, which lets libFuzzer's -minimize_crash shrink
+// it to a fixture for test/slow.
+//
+// ASCIIDOC_FUZZ_NS_PER_BYTE, ASCIIDOC_FUZZ_MAX_EXPONENT and
+// ASCIIDOC_FUZZ_REPEAT (0 skips the repeated parse) override the limits.
+//
+// Build: make fuzz (FUZZ_CC=afl-clang-fast for AFL++)
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "slow.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+static TSParser *parser;
+static SlowLimits limits;
+static const char *slow_dir;
+static bool abort_on_slow;
+
+static double env_double(const char *name, double fallback) {
+  const char *value = getenv(name);
+  return value && *value ? atof(value) : fallback;
+}
+
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+  (void)argc;
+  (void)argv;
+  parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+  limits = slow_default_limits();
+  limits.max_ns_per_byte = env_double("ASCIIDOC_FUZZ_NS_PER_BYTE", limits.max_ns_per_byte);
+  limits.max_exponent = env_double("ASCIIDOC_FUZZ_MAX_EXPONENT", limits.max_exponent);
+  limits.repeat = (uint32_t)env_double("ASCIIDOC_FUZZ_REPEAT", limits.repeat);
+  slow_dir = getenv("ASCIIDOC_FUZZ_SLOW_DIR");
+  if (!slow_dir || !*slow_dir) {
+    slow_dir = ".";
+  }
+  const char *abort_value = getenv("ASCIIDOC_FUZZ_SLOW_ABORT");
+  abort_on_slow = abort_value && *abort_value && *abort_value != '0';
+  return 0;
+}
+
+// FNV-1a, to give each slow input a stable file name.
+static uint64_t hash(const uint8_t *data, size_t size) {
+  uint64_t h = 0xcbf29ce484222325u;
+  for (size_t i = 0; i < size; i++) {
+    h = (h ^ data[i]) * 0x100000001b3u;
+  }
+  return h;
+}
+
+static void record(const uint8_t *data, size_t size, const SlowMeasurement *measurement) {
+  char path[4096];
+  snprintf(path, sizeof(path), "%s/slow-%016llx.adoc", slow_dir,
+           (unsigned long long)hash(data, size));
+  FILE *file = fopen(path, "wb");
+  if (file) {
+    fwrite(data, 1, size, file);
+    fclose(file);
+  }
+  fprintf(stderr, "slow input: %zu bytes, %.0f ns/byte, growth exponent %.2f -> %s\n", size,
+          measurement->ns_per_byte, measurement->exponent, file ? path : "(not written)");
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  if (!parser) {
+    LLVMFuzzerInitialize(NULL, NULL);
+  }
+  if (size > UINT32_MAX) {
+    return 0;
+  }
+  SlowMeasurement measurement;
+  if (!slow_measure(parser, (const char *)data, (uint32_t)size, &limits, &measurement)) {
+    return 0;
+  }
+  SlowLimits confirm = limits;
+  confirm.runs = 3;
+  if (!slow_measure(parser, (const char *)data, (uint32_t)size, &confirm, &measurement)) {
+    return 0;
+  }
+  record(data, size, &measurement);
+  if (abort_on_slow) {
+    abort();
+  }
+  return 0;
+}
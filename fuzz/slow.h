@@ -0,0 +1,122 @@
+#ifndef TREE_SITTER_ASCIIDOC_FUZZ_SLOW_H_
+#define TREE_SITTER_ASCIIDOC_FUZZ_SLOW_H_
+
+// Slow-input detection shared by the fuzzer (fuzz/parse-fuzzer.c) and the
+// fixture check (tools/slow-check.c), so that an input the fuzzer records
+// fails the fixture check by the same measure.
+//
+// An input is slow when either:
+//
+//   - its parse takes more than `max_ns_per_byte` per byte, counting inputs
+//     shorter than `min_bytes` as `min_bytes` long so that the fixed cost of
+//     a parse does not flag every tiny input, or
+//   - the input repeated `repeat` times takes so much longer to parse that
+//     the growth exponent, log(t_repeated / t) / log(repeat), exceeds
+//     `max_exponent`. A linear parse has an exponent near 1, a quadratic one
+//     near 2. Repeated parses under `min_repeated_ns` are not judged, being
+//     too short to time reliably.
+//
+// Each time is the best of `runs` parses.
+//
+// Header-only; include it in a single translation unit.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <tree_sitter/api.h>
+
+#ifndef ASCIIDOC_SLOW_MAX_NS_PER_BYTE
+#define ASCIIDOC_SLOW_MAX_NS_PER_BYTE 5000.0
+#endif
+
+#ifndef ASCIIDOC_SLOW_MAX_EXPONENT
+#define ASCIIDOC_SLOW_MAX_EXPONENT 1.5
+#endif
+
+// Repeated inputs longer than this are not parsed.
+#define SLOW_MAX_REPEATED_BYTES (4u << 20)
+
+typedef struct {
+  double max_ns_per_byte;
+  double max_exponent;
+  uint32_t repeat;
+  uint32_t min_bytes;
+  uint64_t min_repeated_ns;
+  uint32_t runs;
+} SlowLimits;
+
+typedef struct {
+  uint64_t ns;
+  uint64_t repeated_ns;
+  double ns_per_byte;
+  // 0 when the repeated parse was not judged.
+  double exponent;
+  bool too_slow_per_byte;
+  bool superlinear;
+} SlowMeasurement;
+
+static inline SlowLimits slow_default_limits(void) {
+  return (SlowLimits){
+    .max_ns_per_byte = ASCIIDOC_SLOW_MAX_NS_PER_BYTE,
+    .max_exponent = ASCIIDOC_SLOW_MAX_EXPONENT,
+    .repeat = 4,
+    .min_bytes = 256,
+    .min_repeated_ns = 200000,
+    .runs = 1,
+  };
+}
+
+static inline uint64_t slow_now_ns(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static inline uint64_t slow_time_parse(TSParser *parser, const char *data, uint32_t length,
+                                       uint32_t runs) {
+  uint64_t best = UINT64_MAX;
+  for (uint32_t run = 0; run < (runs ? runs : 1); run++) {
+    uint64_t begin = slow_now_ns();
+    TSTree *tree = ts_parser_parse_string(parser, NULL, data, length);
+    uint64_t elapsed = slow_now_ns() - begin;
+    ts_tree_delete(tree);
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+// Measures `data` against `limits` and returns whether it is slow.
+static inline bool slow_measure(TSParser *parser, const char *data, uint32_t length,
+                                const SlowLimits *limits, SlowMeasurement *result) {
+  memset(result, 0, sizeof(*result));
+  result->ns = slow_time_parse(parser, data, length, limits->runs);
+  uint32_t counted = length > limits->min_bytes ? length : limits->min_bytes;
+  result->ns_per_byte = (double)result->ns / counted;
+  result->too_slow_per_byte = result->ns_per_byte > limits->max_ns_per_byte;
+
+  if (limits->repeat > 1 && length > 0 &&
+      (uint64_t)length * limits->repeat <= SLOW_MAX_REPEATED_BYTES) {
+    uint32_t repeated_length = length * limits->repeat;
+    char *repeated = malloc(repeated_length);
+    if (repeated) {
+      for (uint32_t i = 0; i < limits->repeat; i++) {
+        memcpy(repeated + (size_t)i * length, data, length);
+      }
+      result->repeated_ns = slow_time_parse(parser, repeated, repeated_length, limits->runs);
+      free(repeated);
+      if (result->repeated_ns >= limits->min_repeated_ns) {
+        uint64_t single = result->ns ? result->ns : 1;
+        result->exponent = log((double)result->repeated_ns / single) / log(limits->repeat);
+        result->superlinear = result->exponent > limits->max_exponent;
+      }
+    }
+  }
+  return result->too_slow_per_byte || result->superlinear;
+}
+
+#endif // TREE_SITTER_ASCIIDOC_FUZZ_SLOW_H_
@@ -2,4 +2,4 @@ module github.com/louiss0/tree-sitter-asciidoc
 
 go 1.22
 
-require github.com/tree-sitter/go-tree-sitter v0.24.0
+require github.com/tree-sitter/go-tree-sitter v0.25.0
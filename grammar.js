@@ -25,6 +25,16 @@ module.exports = grammar({
     $._plain_hash,
     $._highlight_open,
     $._highlight_close,
+    // Error containment for delimited blocks without a closing fence, see
+    // scan_unclosed_fence in src/scanner.c
+    $._unclosed_listing_open,
+    $._unclosed_literal_open,
+    $._unclosed_passthrough_open,
+    $._unclosed_quote_open,
+    $._unclosed_table_open,
+    $._unclosed_line,
+    $._fence_limit,
+    $._error_sentinel,
   ],
 
   extras: ($) => [$.comment],
@@ -432,9 +442,21 @@ module.exports = grammar({
             field("attributes", alias($._attribute_list_with_line_ending, $.block_attributes)),
           ),
         ),
-        field("open", alias(token(prec(55, /-{4,}[ \t]*\r?\n/)), $.listing_open)),
-        optional(field("content", $.block_content)),
-        field("close", alias(token(prec(55, /-{4,}[ \t]*\r?\n/)), $.listing_close)),
+        choice(
+          seq(
+            field("open", alias(token(prec(55, /-{4,}[ \t]*\r?\n/)), $.listing_open)),
+            optional(field("content", $.block_content)),
+            field("close", alias(token(prec(55, /-{4,}[ \t]*\r?\n/)), $.listing_close)),
+          ),
+          // No closing fence within the scanner's reach: the block ends at the
+          // next section heading or the line budget instead of pairing with a
+          // fence further down.
+          seq(
+            field("open", alias($._unclosed_listing_open, $.listing_open)),
+            optional(field("content", alias($._unclosed_block_content, $.block_content))),
+            $._fence_limit,
+          ),
+        ),
       ),
 
     fenced_code_block: ($) =>
@@ -486,9 +508,18 @@ module.exports = grammar({
         optional(
           field("attributes", alias($._attribute_list_with_line_ending, $.block_attributes)),
         ),
-        field("open", alias(token(prec(45, /_{4,}[ \t]*\r?\n/)), $.asciidoc_blockquote_open)),
-        optional(field("content", $.block_content)),
-        field("close", alias(token(prec(45, /_{4,}[ \t]*\r?\n/)), $.asciidoc_blockquote_close)),
+        choice(
+          seq(
+            field("open", alias(token(prec(45, /_{4,}[ \t]*\r?\n/)), $.asciidoc_blockquote_open)),
+            optional(field("content", $.block_content)),
+            field("close", alias(token(prec(45, /_{4,}[ \t]*\r?\n/)), $.asciidoc_blockquote_close)),
+          ),
+          seq(
+            field("open", alias($._unclosed_quote_open, $.asciidoc_blockquote_open)),
+            optional(field("content", alias($._unclosed_block_content, $.block_content))),
+            $._fence_limit,
+          ),
+        ),
       ),
 
     // Literal blocks
@@ -498,9 +529,18 @@ module.exports = grammar({
         optional(
           field("attributes", alias($._attribute_list_with_line_ending, $.block_attributes)),
         ),
-        field("open", alias(token(prec(50, /\.{4,}[ \t]*\r?\n/)), $.literal_open)),
-        optional(field("content", $.block_content)),
-        field("close", alias(token(prec(50, /\.{4,}[ \t]*\r?\n/)), $.literal_close)),
+        choice(
+          seq(
+            field("open", alias(token(prec(50, /\.{4,}[ \t]*\r?\n/)), $.literal_open)),
+            optional(field("content", $.block_content)),
+            field("close", alias(token(prec(50, /\.{4,}[ \t]*\r?\n/)), $.literal_close)),
+          ),
+          seq(
+            field("open", alias($._unclosed_literal_open, $.literal_open)),
+            optional(field("content", alias($._unclosed_block_content, $.block_content))),
+            $._fence_limit,
+          ),
+        ),
       ),
 
     // Sidebar blocks
@@ -522,9 +562,18 @@ module.exports = grammar({
         optional(
           field("attributes", alias($._attribute_list_with_line_ending, $.block_attributes)),
         ),
-        field("open", alias(token(prec(35, /\+{4,}[ \t]*\r?\n/)), $.passthrough_open)),
-        optional(field("content", $.block_content)),
-        field("close", alias(token(prec(35, /\+{4,}[ \t]*\r?\n/)), $.passthrough_close)),
+        choice(
+          seq(
+            field("open", alias(token(prec(35, /\+{4,}[ \t]*\r?\n/)), $.passthrough_open)),
+            optional(field("content", $.block_content)),
+            field("close", alias(token(prec(35, /\+{4,}[ \t]*\r?\n/)), $.passthrough_close)),
+          ),
+          seq(
+            field("open", alias($._unclosed_passthrough_open, $.passthrough_open)),
+            optional(field("content", alias($._unclosed_block_content, $.block_content))),
+            $._fence_limit,
+          ),
+        ),
       ),
 
     thematic_break: ($) => $._thematic_break,
@@ -797,6 +846,11 @@ module.exports = grammar({
 
     content_line: ($) => seq($.DELIMITED_BLOCK_CONTENT_LINE, $._line_ending),
 
+    // Lines of a block without a closing fence, each let in by the scanner
+    // and parsed as in a closed block
+    _unclosed_block_content: ($) =>
+      repeat1(seq($._unclosed_line, choice($.content_line, $._blank_line))),
+
     DELIMITED_BLOCK_CONTENT_LINE: ($) => token(prec(1, /[^\r\n]+/)),
 
     // LISTS
@@ -1534,10 +1588,17 @@ module.exports = grammar({
       ),
 
     _table_block_body: ($) =>
-      seq(
-        field("open", alias(token(prec(200, /\|{1,2}={3}[ \t]*\r?\n/)), $.table_open)),
-        optional(field("content", $.table_content)),
-        field("close", alias(token(prec(200, /\|{1,2}={3}[ \t]*\r?\n/)), $.table_close)),
+      choice(
+        seq(
+          field("open", alias(token(prec(200, /\|{1,2}={3}[ \t]*\r?\n/)), $.table_open)),
+          optional(field("content", $.table_content)),
+          field("close", alias(token(prec(200, /\|{1,2}={3}[ \t]*\r?\n/)), $.table_close)),
+        ),
+        seq(
+          field("open", alias($._unclosed_table_open, $.table_open)),
+          optional(field("content", alias($._unclosed_table_content, $.table_content))),
+          $._fence_limit,
+        ),
       ),
 
     // Table content does not admit metadata - only rows or blank lines;
@@ -1553,6 +1614,18 @@ module.exports = grammar({
         ),
       ),
 
+    _unclosed_table_content: ($) =>
+      repeat1(
+        seq(
+          $._unclosed_line,
+          choice(
+            field("row", $.table_row),
+            alias($.table_free_line, $.content_line),
+            alias($._blank_line, $.content_line),
+          ),
+        ),
+      ),
+
     table_row: ($) => prec(4, seq(field("cells", repeat1($.table_cell)), $._line_ending)),
 
     // Table cells - distinguish cells with specs from regular cells
@@ -1,60 +1,83 @@
 #!/usr/bin/env bash
-# Workaround script to run tree-sitter tests in batches on Windows
-# to avoid segfault when running all tests at once
-
-echo "Running tree-sitter tests in batches..."
-echo "========================================"
-
-total_pass=0
-total_fail=0
-failed_files=()
-
-for test_file in test/corpus/*.txt; do
-    filename=$(basename "$test_file")
-    echo -n "Testing $filename... "
-    
-    # Run test and capture output and exit code
-    output=$(timeout 10 tree-sitter test --file-name "$filename" 2>&1)
-    exit_code=$?
-    
-    # Check for segfault (exit code 139) or timeout (exit code 124)
-    if [ $exit_code -eq 139 ]; then
-        echo "✗ (SEGFAULT)"
-        ((total_fail++))
-        failed_files+=("$filename (segfault)")
-    elif [ $exit_code -eq 124 ]; then
-        echo "✗ (TIMEOUT)"
-        ((total_fail++))
-        failed_files+=("$filename (timeout)")
-    elif [ $exit_code -ne 0 ]; then
-        # Check if there are actual test failures in the output
-        if echo "$output" | grep -q "failure"; then
-            echo "✗ (test failures)"
+# Runs the test corpus with tools/corpus-test, which loads the grammar once and
+# parses every example in parallel. Extra arguments are passed to make, e.g.
+# CORPUS_FILES=test/corpus/24_tables.txt.
+#
+# tools/corpus-test links against the tree-sitter runtime library, found with
+# pkg-config, and the Makefile does not support Windows. Without them the
+# corpus runs through the tree-sitter CLI instead, one file at a time, which
+# also works around the CLI crashing on Windows when it runs every test at
+# once.
+
+has_native_toolchain() {
+    case "$(uname -s)" in
+        MINGW* | MSYS* | CYGWIN*) return 1 ;;
+    esac
+    command -v make >/dev/null 2>&1 &&
+        command -v pkg-config >/dev/null 2>&1 &&
+        pkg-config --exists tree-sitter
+}
+
+run_cli_batches() {
+    echo "Running tree-sitter tests in batches..."
+    echo "========================================"
+
+    total_pass=0
+    total_fail=0
+    failed_files=()
+
+    for test_file in test/corpus/*.txt; do
+        filename=$(basename "$test_file")
+        echo -n "Testing $filename... "
+
+        # Run test and capture output and exit code
+        output=$(timeout 10 tree-sitter test --file-name "$filename" 2>&1)
+        exit_code=$?
+
+        # Check for segfault (exit code 139) or timeout (exit code 124)
+        if [ $exit_code -eq 139 ]; then
+            echo "✗ (SEGFAULT)"
             ((total_fail++))
-            failed_files+=("$filename (test failures)")
-        else
-            echo "✗ (error)"
+            failed_files+=("$filename (segfault)")
+        elif [ $exit_code -eq 124 ]; then
+            echo "✗ (TIMEOUT)"
             ((total_fail++))
-            failed_files+=("$filename (error)")
+            failed_files+=("$filename (timeout)")
+        elif [ $exit_code -ne 0 ]; then
+            # Check if there are actual test failures in the output
+            if echo "$output" | grep -q "failure"; then
+                echo "✗ (test failures)"
+                ((total_fail++))
+                failed_files+=("$filename (test failures)")
+            else
+                echo "✗ (error)"
+                ((total_fail++))
+                failed_files+=("$filename (error)")
+            fi
+        else
+            echo "✓"
+            ((total_pass++))
         fi
+    done
+
+    echo ""
+    echo "========================================"
+    echo "Results: $total_pass passed, $total_fail failed"
+
+    if [ ${#failed_files[@]} -gt 0 ]; then
+        echo ""
+        echo "Failed test files:"
+        for file in "${failed_files[@]}"; do
+            echo "  - $file"
+        done
+        exit 1
     else
-        echo "✓"
-        ((total_pass++))
+        echo "All tests passed!"
+        exit 0
     fi
-done
+}
 
-echo ""
-echo "========================================"
-echo "Results: $total_pass passed, $total_fail failed"
-
-if [ ${#failed_files[@]} -gt 0 ]; then
-    echo ""
-    echo "Failed test files:"
-    for file in "${failed_files[@]}"; do
-        echo "  - $file"
-    done
-    exit 1
-else
-    echo "All tests passed!"
-    exit 0
+if has_native_toolchain; then
+    exec make test-corpus "$@"
 fi
+run_cli_batches
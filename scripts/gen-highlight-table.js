@@ -0,0 +1,270 @@
+#!/usr/bin/env node
+/**
+ * @file Static highlight table generator
+ *
+ * Compiles the simple patterns of `queries/highlights.scm` into the C table in
+ * `bindings/c/highlight-table.h`, which `ts_asciidoc_highlight` applies in a
+ * single tree-cursor walk. A pattern compiles when it captures either:
+ *
+ * - a bare node, as in `(comment) @comment` or `"indexterm:" @keyword`;
+ * - one child of an uncaptured parent, with or without a field, as in
+ *   `(table_cell "|" @punctuation.delimiter)`.
+ *
+ * Everything else falls back to the query engine. That covers predicates, quantifiers,
+ * alternations, wildcards, anchors, multi-child patterns and nodes with several captures.
+ * The fallback patterns are written out as a smaller query string.
+ *
+ * Usage: node scripts/gen-highlight-table.js [--check] [queries/highlights.scm] [output.h]
+ */
+
+const fs = require("node:fs");
+const path = require("node:path");
+
+const root = path.join(__dirname, "..");
+
+function tokenize(source) {
+  const tokens = [];
+  const pattern =
+    /\s+|;[^\n]*|"(?:[^"\\]|\\.)*"|[()[\]]|[?*+]|@[\w.-]+|#[\w!?-]+|![\w]+|[\w.-]+:|[\w.-]+|\./gy;
+  let match;
+  while (pattern.lastIndex < source.length) {
+    const start = pattern.lastIndex;
+    match = pattern.exec(source);
+    if (!match) {
+      throw new Error(`unexpected character at offset ${start}: ${source[start]}`);
+    }
+    const text = match[0];
+    if (/^\s/.test(text) || text.startsWith(";")) {
+      continue;
+    }
+    tokens.push({ text, start, end: pattern.lastIndex });
+  }
+  return tokens;
+}
+
+/**
+ * Parses one pattern into `{ kind, name, named, field, children, captures,
+ * quantifier, complex }`. `complex` marks anything the table cannot express.
+ */
+function parsePattern(tokens, state) {
+  const token = tokens[state.index++];
+  const node = { children: [], captures: [], field: null, complex: false };
+
+  if (token.text.endsWith(":") && !token.text.startsWith('"')) {
+    const child = parsePattern(tokens, state);
+    child.field = token.text.slice(0, -1);
+    return child;
+  }
+
+  if (token.text === "(") {
+    const head = tokens[state.index];
+    if (head.text === "(" || head.text === "[" || head.text.startsWith('"')) {
+      // Grouping: `((a) (b))`.
+      node.kind = "group";
+      node.complex = true;
+    } else {
+      state.index++;
+      node.kind = "node";
+      node.name = head.text;
+      node.named = true;
+      if (head.text === "_") {
+        node.complex = true;
+      }
+    }
+    while (tokens[state.index].text !== ")") {
+      const next = tokens[state.index].text;
+      if (next.startsWith("#") || next.startsWith("!") || next === ".") {
+        node.complex = true;
+        state.index++;
+        if (next.startsWith("#")) {
+          // Predicate arguments up to the closing parenthesis of `(#pred ...)`.
+          while (tokens[state.index].text !== ")") {
+            state.index++;
+          }
+        }
+        continue;
+      }
+      node.children.push(parsePattern(tokens, state));
+    }
+    state.index++;
+  } else if (token.text === "[") {
+    node.kind = "alternation";
+    node.complex = true;
+    while (tokens[state.index].text !== "]") {
+      node.children.push(parsePattern(tokens, state));
+    }
+    state.index++;
+  } else if (token.text.startsWith('"')) {
+    node.kind = "node";
+    node.name = JSON.parse(token.text);
+    node.named = false;
+  } else if (token.text === "_") {
+    node.kind = "node";
+    node.name = "_";
+    node.complex = true;
+  } else {
+    throw new Error(`unexpected token ${token.text} at offset ${token.start}`);
+  }
+
+  while (state.index < tokens.length) {
+    const next = tokens[state.index].text;
+    if (next === "?" || next === "*" || next === "+") {
+      node.quantifier = next;
+      state.index++;
+    } else if (next.startsWith("@")) {
+      node.captures.push(next.slice(1));
+      state.index++;
+    } else {
+      break;
+    }
+  }
+
+  return node;
+}
+
+function isSimpleLeaf(node) {
+  return (
+    node.kind === "node" && !node.complex && !node.quantifier && node.children.length === 0
+  );
+}
+
+/**
+ * Returns `{ parent, field, node, named, capture }`, or null when the pattern
+ * needs the query engine.
+ */
+function compile(pattern) {
+  if (pattern.kind !== "node" || pattern.complex || pattern.quantifier || pattern.field) {
+    return null;
+  }
+
+  if (pattern.children.length === 0) {
+    if (pattern.captures.length !== 1) {
+      return null;
+    }
+    return {
+      parent: null,
+      field: null,
+      node: pattern.name,
+      named: pattern.named,
+      capture: pattern.captures[0],
+    };
+  }
+
+  const [child] = pattern.children;
+  if (
+    pattern.children.length !== 1 ||
+    pattern.captures.length !== 0 ||
+    !pattern.named ||
+    !isSimpleLeaf(child) ||
+    child.captures.length !== 1
+  ) {
+    return null;
+  }
+  return {
+    parent: pattern.name,
+    field: child.field,
+    node: child.name,
+    named: child.named,
+    capture: child.captures[0],
+  };
+}
+
+function collectCaptures(pattern, names) {
+  for (const capture of pattern.captures) {
+    if (!names.includes(capture)) {
+      names.push(capture);
+    }
+  }
+  for (const child of pattern.children) {
+    collectCaptures(child, names);
+  }
+}
+
+function cString(value) {
+  return value === null ? "NULL" : JSON.stringify(value);
+}
+
+function generate(source, queryPath) {
+  const tokens = tokenize(source);
+  const state = { index: 0 };
+  const captures = [];
+  const rules = [];
+  const fallback = [];
+
+  for (let patternIndex = 0; state.index < tokens.length; patternIndex++) {
+    const start = tokens[state.index].start;
+    const pattern = parsePattern(tokens, state);
+    const end = tokens[state.index - 1].end;
+    collectCaptures(pattern, captures);
+
+    const rule = compile(pattern);
+    if (rule) {
+      rules.push({ ...rule, pattern: patternIndex });
+    } else {
+      fallback.push({ pattern: patternIndex, text: source.slice(start, end) });
+    }
+  }
+
+  const lines = [
+    `// Generated by scripts/gen-highlight-table.js from ${queryPath}. Do not edit.`,
+    "",
+    "static const char *const HIGHLIGHT_CAPTURE_NAMES[] = {",
+    ...captures.map((name) => `  ${cString(name)},`),
+    "};",
+    "",
+    "// {pattern, parent, field, node, named, capture}",
+    "static const HighlightRule HIGHLIGHT_RULES[] = {",
+    ...rules.map(
+      (rule) =>
+        `  {${rule.pattern}, ${cString(rule.parent)}, ${cString(rule.field)}, ` +
+        `${cString(rule.node)}, ${rule.named}, ${captures.indexOf(rule.capture)}},`,
+    ),
+    "};",
+    "",
+    "// Pattern index in the full query of each fallback pattern, in order.",
+    `static const uint16_t HIGHLIGHT_FALLBACK_PATTERNS[${Math.max(fallback.length, 1)}] = {`,
+    `  ${fallback.map((entry) => entry.pattern).join(", ")}`,
+    "};",
+    "",
+    `#define HIGHLIGHT_FALLBACK_PATTERN_COUNT ${fallback.length}`,
+    "",
+    "static const char HIGHLIGHT_FALLBACK_QUERY[] =",
+    ...(fallback.length
+      ? fallback.map((entry) => `  ${JSON.stringify(entry.text + "\n")}`)
+      : ['  ""']),
+    ";",
+    "",
+  ];
+
+  return {
+    header: lines.join("\n"),
+    summary: `${rules.length} patterns compiled, ${fallback.length} left to the query engine`,
+  };
+}
+
+function main() {
+  const args = process.argv.slice(2);
+  const check = args[0] === "--check";
+  if (check) {
+    args.shift();
+  }
+  const queryPath = args[0] || "queries/highlights.scm";
+  const output = path.resolve(root, args[1] || "bindings/c/highlight-table.h");
+
+  const source = fs.readFileSync(path.resolve(root, queryPath), "utf8");
+  const { header, summary } = generate(source, queryPath);
+  if (check) {
+    const current = fs.existsSync(output) ? fs.readFileSync(output, "utf8") : "";
+    if (current !== header) {
+      const file = path.relative(root, output);
+      console.error(`${file} is out of date; run npm run generate:highlights`);
+      process.exit(1);
+    }
+    return;
+  }
+
+  fs.writeFileSync(output, header);
+  console.log(`${path.relative(root, output)}: ${summary}`);
+}
+
+main();
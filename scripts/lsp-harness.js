@@ -0,0 +1,317 @@
+#!/usr/bin/env node
+/**
+ * @file Stdio test harness for the native language server
+ *
+ * Starts `server/asciidoc-language-server`, drives it through a scripted session and checks
+ * the answers: document symbols and folding ranges of a small document, debounced
+ * diagnostics for a burst of keystrokes, and a clean shutdown. A second pass opens a
+ * generated document of 20k lines and reports the time from a keystroke to its
+ * diagnostics, the symbol request latency and how many parses were incremental or
+ * cancelled.
+ *
+ * Usage: node scripts/lsp-harness.js [--server path] [--lines N] [--debounce MS]
+ */
+
+const assert = require("node:assert/strict");
+const path = require("node:path");
+const { spawn } = require("node:child_process");
+
+const root = path.join(__dirname, "..");
+
+const SAMPLE = [
+  "= Harness Document",
+  "Jane Doe <jane@example.com>",
+  "",
+  "== Introduction",
+  "",
+  "Some text.",
+  "",
+  "=== Details",
+  "",
+  "More text.",
+  "",
+  "== Usage",
+  "",
+  "----",
+  "code",
+  "----",
+  "",
+].join("\n");
+
+function parseArgs(argv) {
+  const options = {
+    server: path.join(root, "server", "asciidoc-language-server"),
+    lines: 20000,
+    debounce: 50,
+  };
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg === "--server") {
+      options.server = path.resolve(argv[++i]);
+    } else if (arg === "--lines") {
+      options.lines = Number(argv[++i]);
+    } else if (arg === "--debounce") {
+      options.debounce = Number(argv[++i]);
+    } else {
+      console.error(
+        "usage: node scripts/lsp-harness.js [--server path] [--lines N] [--debounce MS]",
+      );
+      process.exit(2);
+    }
+  }
+  return options;
+}
+
+/** A JSON-RPC client over the server's stdio, with Content-Length framing. */
+class Client {
+  constructor(server, debounce) {
+    this.child = spawn(server, ["--verbose", "--debounce", String(debounce)], {
+      stdio: ["pipe", "pipe", "pipe"],
+    });
+    this.nextId = 1;
+    this.pending = new Map();
+    this.notifications = [];
+    this.waiters = [];
+    this.log = "";
+    this.buffer = Buffer.alloc(0);
+    this.child.stdout.on("data", (chunk) => this.receive(chunk));
+    this.child.stderr.on("data", (chunk) => (this.log += chunk));
+    this.exited = new Promise((resolve) => this.child.on("exit", (code) => resolve(code)));
+  }
+
+  receive(chunk) {
+    this.buffer = Buffer.concat([this.buffer, chunk]);
+    for (;;) {
+      const headerEnd = this.buffer.indexOf("\r\n\r\n");
+      if (headerEnd < 0) {
+        return;
+      }
+      const length = Number(/Content-Length: (\d+)/i.exec(this.buffer.subarray(0, headerEnd))[1]);
+      if (this.buffer.length < headerEnd + 4 + length) {
+        return;
+      }
+      const body = this.buffer.subarray(headerEnd + 4, headerEnd + 4 + length).toString("utf8");
+      this.buffer = this.buffer.subarray(headerEnd + 4 + length);
+      this.dispatch(JSON.parse(body));
+    }
+  }
+
+  dispatch(message) {
+    if (message.id !== undefined && this.pending.has(message.id)) {
+      const { resolve, reject } = this.pending.get(message.id);
+      this.pending.delete(message.id);
+      if (message.error) {
+        reject(new Error(`${message.error.code}: ${message.error.message}`));
+      } else {
+        resolve(message.result);
+      }
+      return;
+    }
+    this.notifications.push(message);
+    this.waiters = this.waiters.filter((waiter) => !waiter(message));
+  }
+
+  send(message) {
+    const body = Buffer.from(JSON.stringify({ jsonrpc: "2.0", ...message }), "utf8");
+    this.child.stdin.write(`Content-Length: ${body.length}\r\n\r\n`);
+    this.child.stdin.write(body);
+  }
+
+  request(method, params) {
+    const id = this.nextId++;
+    this.send({ id, method, params });
+    return new Promise((resolve, reject) => this.pending.set(id, { resolve, reject }));
+  }
+
+  notify(method, params) {
+    this.send({ method, params });
+  }
+
+  /** Resolves with the diagnostics published for `uri` at `version`. */
+  diagnostics(uri, version) {
+    const matches = (message) =>
+      message.method === "textDocument/publishDiagnostics" &&
+      message.params.uri === uri &&
+      message.params.version === version;
+    const found = this.notifications.find(matches);
+    if (found) {
+      return Promise.resolve(found.params.diagnostics);
+    }
+    return new Promise((resolve) => {
+      this.waiters.push((message) => {
+        if (!matches(message)) {
+          return false;
+        }
+        resolve(message.params.diagnostics);
+        return true;
+      });
+    });
+  }
+
+  published(uri) {
+    return this.notifications.filter(
+      (message) =>
+        message.method === "textDocument/publishDiagnostics" && message.params.uri === uri,
+    );
+  }
+
+  async close() {
+    await this.request("shutdown", null);
+    this.notify("exit", null);
+    return this.exited;
+  }
+}
+
+function insert(uri, version, line, character, text) {
+  const position = { line, character };
+  return {
+    textDocument: { uri, version },
+    contentChanges: [{ range: { start: position, end: position }, text }],
+  };
+}
+
+function generateDocument(lines) {
+  const out = ["= Generated Document", ""];
+  for (let section = 1; out.length < lines; section++) {
+    out.push(`== Section ${section}`, "");
+    for (let paragraph = 0; paragraph < 4 && out.length < lines; paragraph++) {
+      out.push(`Paragraph ${paragraph} with *bold* and _emphasis_ and a <<ref-${section}>>.`, "");
+    }
+    out.push(`=== Subsection ${section}`, "", "----", `code ${section}`, "----", "");
+  }
+  return out.join("\n") + "\n";
+}
+
+async function checkSample(options) {
+  const client = new Client(options.server, options.debounce);
+  const init = await client.request("initialize", {
+    processId: process.pid,
+    capabilities: {},
+    rootUri: null,
+  });
+  assert.equal(init.capabilities.textDocumentSync.change, 2);
+  assert.equal(init.capabilities.positionEncoding, "utf-16");
+  client.notify("initialized", {});
+
+  const uri = "file:///harness/sample.adoc";
+  client.notify("textDocument/didOpen", {
+    textDocument: { uri, languageId: "asciidoc", version: 1, text: SAMPLE },
+  });
+  assert.deepEqual(await client.diagnostics(uri, 1), []);
+
+  const symbols = await client.request("textDocument/documentSymbol", { textDocument: { uri } });
+  assert.equal(symbols.length, 1);
+  assert.equal(symbols[0].name, "Harness Document");
+  assert.deepEqual(
+    symbols[0].children.map((symbol) => symbol.name),
+    ["Introduction", "Usage"],
+  );
+  assert.deepEqual(
+    symbols[0].children[0].children.map((symbol) => symbol.name),
+    ["Details"],
+  );
+  assert.deepEqual(symbols[0].children[1].selectionRange.start, { line: 11, character: 3 });
+
+  const folds = await client.request("textDocument/foldingRange", { textDocument: { uri } });
+  const starts = folds.map((fold) => fold.startLine);
+  for (const line of [3, 7, 11, 13]) {
+    assert.ok(starts.includes(line), `folding range at line ${line + 1}`);
+  }
+
+  // A burst of keystrokes inside the debounce window is parsed once.
+  const word = "Typed quickly, one character at a time.";
+  let version = 1;
+  for (let i = 0; i < word.length; i++) {
+    client.notify("textDocument/didChange", insert(uri, ++version, 5, 10 + i, word[i]));
+  }
+  assert.deepEqual(await client.diagnostics(uri, version), []);
+  const burst = client.published(uri).filter((message) => message.params.version > 1);
+  assert.ok(burst.length < word.length / 4, `${burst.length} parses for ${word.length} changes`);
+
+  // A request right after a change waits for the parse of that change.
+  client.notify("textDocument/didChange", insert(uri, ++version, 11, 8, " Guide"));
+  const renamed = await client.request("textDocument/documentSymbol", { textDocument: { uri } });
+  assert.equal(renamed[0].children[1].name, "Usage Guide");
+
+  // Characters outside the BMP take two UTF-16 code units.
+  client.notify("textDocument/didChange", insert(uri, ++version, 3, 3, "\u{1F600} "));
+  client.notify("textDocument/didChange", insert(uri, ++version, 3, 6, "New "));
+  const emoji = await client.request("textDocument/documentSymbol", { textDocument: { uri } });
+  assert.equal(emoji[0].children[0].name, "\u{1F600} New Introduction");
+
+  client.notify("textDocument/didChange", insert(uri, ++version, 13, 0, "----\nunclosed\n"));
+  const unclosed = await client.diagnostics(uri, version);
+  for (const diagnostic of unclosed) {
+    assert.equal(diagnostic.severity, 1);
+    assert.ok(diagnostic.range.start.line >= 13);
+  }
+
+  client.notify("textDocument/didChange", {
+    textDocument: { uri, version: ++version },
+    contentChanges: [{ text: SAMPLE }],
+  });
+  assert.deepEqual(await client.diagnostics(uri, version), []);
+
+  client.notify("textDocument/didClose", { textDocument: { uri } });
+  const missing = await client.request("textDocument/documentSymbol", { textDocument: { uri } });
+  assert.equal(missing, null);
+  assert.equal(await client.close(), 0);
+  console.log(
+    `sample: ok (${burst.length} parses for ${word.length} keystrokes, ` +
+      `${unclosed.length} diagnostics for an unclosed fence)`,
+  );
+}
+
+async function measureLarge(options) {
+  const client = new Client(options.server, options.debounce);
+  await client.request("initialize", { processId: process.pid, capabilities: {}, rootUri: null });
+  client.notify("initialized", {});
+
+  const uri = "file:///harness/large.adoc";
+  const text = generateDocument(options.lines);
+  let start = performance.now();
+  client.notify("textDocument/didOpen", {
+    textDocument: { uri, languageId: "asciidoc", version: 1, text },
+  });
+  await client.diagnostics(uri, 1);
+  const open = performance.now() - start;
+
+  // Type a sentence into the middle of the document, then time the last
+  // keystroke to its diagnostics, less the debounce window.
+  const line = Math.floor(options.lines / 2);
+  const sentence = "Inserted while typing. ";
+  let version = 1;
+  for (let i = 0; i < sentence.length; i++) {
+    client.notify("textDocument/didChange", insert(uri, ++version, line, i, sentence[i]));
+  }
+  start = performance.now();
+  await client.diagnostics(uri, version);
+  const keystroke = performance.now() - start - options.debounce;
+
+  client.notify("textDocument/didChange", insert(uri, ++version, line, 0, "x"));
+  start = performance.now();
+  const symbols = await client.request("textDocument/documentSymbol", { textDocument: { uri } });
+  const symbol = performance.now() - start;
+  assert.ok(symbols[0].children.length > 100);
+
+  assert.equal(await client.close(), 0);
+  const count = (pattern) => (client.log.match(pattern) || []).length;
+  console.log(
+    `large (${options.lines} lines, ${(text.length / 1024).toFixed(0)} KiB): ` +
+      `open ${open.toFixed(1)} ms, keystroke to diagnostics ${keystroke.toFixed(1)} ms, ` +
+      `symbols after edit ${symbol.toFixed(1)} ms; ` +
+      `${count(/, incremental,/g)} incremental, ${count(/, full,/g)} full, ` +
+      `${count(/^cancelled/gm)} cancelled parses`,
+  );
+}
+
+async function main() {
+  const options = parseArgs(process.argv.slice(2));
+  await checkSample(options);
+  await measureLarge(options);
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
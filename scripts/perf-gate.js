@@ -0,0 +1,310 @@
+#!/usr/bin/env node
+/**
+ * @file Parse-performance regression gate
+ *
+ * Builds the parser and `tools/bench`, runs the benchmark over a fixed corpus and
+ * compares MB/s, node count, max GLR stack versions and peak RSS per file with the
+ * baseline in `test/perf/baseline.json`. Exits non-zero when any file regresses
+ * beyond the configured thresholds, or when the baseline has no measurements
+ * unless --allow-empty is given.
+ *
+ * Usage: node scripts/perf-gate.js [--update] [--record] [--no-build] [--allow-empty]
+ *                                  [--baseline file]
+ *                                  [--iterations N] [--max-slowdown PCT]
+ *                                  [--max-node-growth PCT] [--max-rss-growth PCT]
+ *                                  [--max-stack-growth N]
+ */
+
+const fs = require("node:fs");
+const path = require("node:path");
+const { execFileSync } = require("node:child_process");
+
+const root = path.join(__dirname, "..");
+const SCHEMA_VERSION = 1;
+
+const DEFAULT_THRESHOLDS = {
+  max_slowdown_pct: 10,
+  max_node_growth_pct: 1,
+  max_rss_growth_pct: 20,
+  max_stack_versions_growth: 0,
+};
+
+const DEFAULT_CORPUS = {
+  seed: 1,
+  mixed_size: "4M",
+  construct_size: "256K",
+  files: [
+    "examples/mixed-code-blocks.adoc",
+    "examples/sample.adoc",
+    "asciidoc-syntax-reference.adoc",
+  ],
+};
+
+function parseArgs(argv) {
+  const options = {
+    baseline: path.join(root, "test", "perf", "baseline.json"),
+    history: path.join(root, "test", "perf", "history.jsonl"),
+    update: false,
+    record: false,
+    allowEmpty: false,
+    build: true,
+    iterations: 5,
+    thresholds: {},
+  };
+
+  const thresholdFlags = {
+    "--max-slowdown": "max_slowdown_pct",
+    "--max-node-growth": "max_node_growth_pct",
+    "--max-rss-growth": "max_rss_growth_pct",
+    "--max-stack-growth": "max_stack_versions_growth",
+  };
+
+  for (let i = 0; i < argv.length; i++) {
+    const arg = argv[i];
+    if (arg in thresholdFlags) {
+      options.thresholds[thresholdFlags[arg]] = Number(argv[++i]);
+    } else if (arg === "--baseline") {
+      options.baseline = path.resolve(argv[++i]);
+    } else if (arg === "--iterations") {
+      options.iterations = Number(argv[++i]);
+    } else if (arg === "--update") {
+      options.update = true;
+    } else if (arg === "--record") {
+      options.record = true;
+    } else if (arg === "--allow-empty") {
+      options.allowEmpty = true;
+    } else if (arg === "--no-build") {
+      options.build = false;
+    } else {
+      throw new Error(`unknown argument: ${arg}`);
+    }
+  }
+
+  return options;
+}
+
+function run(command, args, options = {}) {
+  return execFileSync(command, args, { cwd: root, encoding: "utf8", ...options });
+}
+
+function loadBaseline(file) {
+  if (!fs.existsSync(file)) {
+    return { schema_version: SCHEMA_VERSION, files: {} };
+  }
+  const baseline = JSON.parse(fs.readFileSync(file, "utf8"));
+  if (baseline.schema_version !== SCHEMA_VERSION) {
+    throw new Error(
+      `${path.relative(root, file)} has schema_version ${baseline.schema_version}, ` +
+        `expected ${SCHEMA_VERSION}; regenerate it with --update`,
+    );
+  }
+  return baseline;
+}
+
+function build() {
+  const ts = process.env.TS || "tree-sitter";
+  if (ts === "tree-sitter") {
+    run("npx", ["tree-sitter", "generate"], { stdio: "inherit" });
+  } else {
+    run(ts, ["generate"], { stdio: "inherit" });
+  }
+  run("make", ["tools/bench", "tools/gen-corpus"], { stdio: "inherit" });
+}
+
+function generateCorpus(corpus) {
+  const dir = path.join("bench-corpus", "gate");
+  fs.mkdirSync(path.join(root, dir), { recursive: true });
+
+  const generator = path.join(root, "tools", "gen-corpus");
+  const files = [...corpus.files];
+  const mixed = path.join(dir, "mixed.adoc");
+  run(generator, ["--seed", String(corpus.seed), "--size", corpus.mixed_size, "-o", mixed]);
+  files.push(mixed);
+
+  for (const construct of run(generator, ["--list"]).trim().split("\n")) {
+    const file = path.join(dir, `${construct}.adoc`);
+    run(generator, [
+      "--seed",
+      String(corpus.seed),
+      "--size",
+      corpus.construct_size,
+      "--only",
+      construct,
+      "-o",
+      file,
+    ]);
+    files.push(file);
+  }
+
+  return files;
+}
+
+function measure(files, iterations) {
+  const output = run(path.join(root, "tools", "bench"), [
+    "--json",
+    "--isolate",
+    "--stack",
+    "--calibrate",
+    "--iterations",
+    String(iterations),
+    ...files,
+  ]);
+  const report = JSON.parse(output);
+  const results = {};
+  for (const file of report.files) {
+    results[file.file] = {
+      bytes: file.bytes,
+      mb_per_s: file.mb_per_s,
+      nodes: file.nodes,
+      max_stack_versions: file.max_stack_versions,
+      peak_rss_kb: file.peak_rss_kb,
+    };
+  }
+  return { calibration: report.calibration_mb_per_s, files: results };
+}
+
+function percentChange(current, previous) {
+  return previous ? ((current - previous) / previous) * 100 : 0;
+}
+
+function compare(baseline, current, thresholds) {
+  const failures = [];
+  const rows = [];
+
+  for (const [file, base] of Object.entries(baseline.files)) {
+    const now = current.files[file];
+    if (!now) {
+      failures.push(`${file}: missing from current run`);
+      continue;
+    }
+
+    // Throughput is compared relative to each machine's calibration loop.
+    const speed = percentChange(
+      now.mb_per_s / current.calibration,
+      base.mb_per_s / baseline.calibration_mb_per_s,
+    );
+    const nodes = percentChange(now.nodes, base.nodes);
+    const rss = percentChange(now.peak_rss_kb, base.peak_rss_kb);
+    const stack = now.max_stack_versions - base.max_stack_versions;
+    rows.push({ file, speed, nodes, rss, stack });
+
+    if (-speed > thresholds.max_slowdown_pct) {
+      failures.push(
+        `${file}: throughput ${speed.toFixed(1)}% (limit -${thresholds.max_slowdown_pct}%)`,
+      );
+    }
+    if (nodes > thresholds.max_node_growth_pct) {
+      failures.push(
+        `${file}: node count +${nodes.toFixed(1)}% (limit +${thresholds.max_node_growth_pct}%)`,
+      );
+    }
+    if (rss > thresholds.max_rss_growth_pct) {
+      failures.push(
+        `${file}: peak RSS +${rss.toFixed(1)}% (limit +${thresholds.max_rss_growth_pct}%)`,
+      );
+    }
+    if (stack > thresholds.max_stack_versions_growth) {
+      failures.push(
+        `${file}: max stack versions ${base.max_stack_versions} -> ${now.max_stack_versions}`,
+      );
+    }
+  }
+
+  return { rows, failures };
+}
+
+function printRows(rows) {
+  const signed = (value) => `${value >= 0 ? "+" : ""}${value.toFixed(1)}%`;
+  const header = ["speed", "nodes", "RSS", "versions"].map((name) => name.padStart(9));
+  console.log(["file".padEnd(44), ...header].join(" "));
+  for (const row of rows) {
+    console.log(
+      [
+        row.file.padEnd(44),
+        signed(row.speed).padStart(9),
+        signed(row.nodes).padStart(9),
+        signed(row.rss).padStart(9),
+        `${row.stack >= 0 ? "+" : ""}${row.stack}`.padStart(9),
+      ].join(" "),
+    );
+  }
+}
+
+function commitId() {
+  try {
+    return run("git", ["rev-parse", "HEAD"]).trim();
+  } catch (_) {
+    return null;
+  }
+}
+
+function main() {
+  const options = parseArgs(process.argv.slice(2));
+  const baseline = loadBaseline(options.baseline);
+  const thresholds = { ...DEFAULT_THRESHOLDS, ...baseline.thresholds, ...options.thresholds };
+  const corpus = { ...DEFAULT_CORPUS, ...baseline.corpus };
+  const empty = Object.keys(baseline.files).length === 0;
+
+  // A gate without measurements would pass whatever the parser does.
+  if (empty && !options.update && !options.allowEmpty) {
+    throw new Error(
+      `${path.relative(root, options.baseline)} has no measurements; ` +
+        "bootstrap it with `npm run perf:baseline` and commit it " +
+        "(PERFORMANCE.md, Regression gate), or pass --allow-empty",
+    );
+  }
+
+  if (options.build) {
+    build();
+  }
+  const current = measure(generateCorpus(corpus), options.iterations);
+  const commit = commitId();
+
+  if (options.record) {
+    const entry = {
+      commit,
+      date: new Date().toISOString(),
+      calibration_mb_per_s: current.calibration,
+      files: current.files,
+    };
+    fs.appendFileSync(options.history, JSON.stringify(entry) + "\n");
+  }
+
+  if (options.update) {
+    const updated = {
+      schema_version: SCHEMA_VERSION,
+      commit,
+      date: new Date().toISOString(),
+      thresholds,
+      corpus,
+      calibration_mb_per_s: current.calibration,
+      files: current.files,
+    };
+    fs.writeFileSync(options.baseline, JSON.stringify(updated, null, 2) + "\n");
+    console.log(`updated ${path.relative(root, options.baseline)}`);
+    return;
+  }
+
+  if (empty) {
+    console.log(`${path.relative(root, options.baseline)} has no measurements; run with --update`);
+    return;
+  }
+
+  const { rows, failures } = compare(baseline, current, thresholds);
+  printRows(rows);
+  if (failures.length) {
+    console.error(`\nperformance regressions against ${baseline.commit ?? "baseline"}:`);
+    for (const failure of failures) {
+      console.error(`  ${failure}`);
+    }
+    process.exit(1);
+  }
+  console.log("\nno regressions");
+}
+
+try {
+  main();
+} catch (error) {
+  console.error(error.message);
+  process.exit(1);
+}
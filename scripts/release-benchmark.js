@@ -0,0 +1,131 @@
+#!/usr/bin/env node
+/**
+ * @file Stock versus LTO+PGO release build of the parser library
+ *
+ * Runs two builds of `tools/bench`, one linked against the stock library and one
+ * against the release library (`make release`), over the same files in alternating
+ * rounds so that drift in machine load hits both alike. Reports the best MB/s of
+ * each build per file, the speedup and its geometric mean, and fails if the two
+ * builds disagree on any node count. `make bench-release` builds both and runs this.
+ *
+ * Usage: node scripts/release-benchmark.js --stock bench --tuned bench [--rounds N]
+ *                                          [--iterations N] [--json] file...
+ */
+
+const path = require("node:path");
+const { execFileSync } = require("node:child_process");
+
+const root = path.join(__dirname, "..");
+
+function parseArgs(argv) {
+  const options = { stock: null, tuned: null, rounds: 3, iterations: 3, json: false, files: [] };
+
+  for (let i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+      case "--stock":
+        options.stock = path.resolve(argv[++i]);
+        break;
+      case "--tuned":
+        options.tuned = path.resolve(argv[++i]);
+        break;
+      case "--rounds":
+        options.rounds = Math.max(1, Number(argv[++i]));
+        break;
+      case "--iterations":
+        options.iterations = Math.max(1, Number(argv[++i]));
+        break;
+      case "--json":
+        options.json = true;
+        break;
+      default:
+        if (argv[i].startsWith("--")) {
+          throw new Error(`unknown argument: ${argv[i]}`);
+        }
+        options.files.push(argv[i]);
+    }
+  }
+
+  if (!options.stock || !options.tuned || options.files.length === 0) {
+    throw new Error("usage: release-benchmark.js --stock bench --tuned bench file...");
+  }
+  return options;
+}
+
+function measure(bench, files, iterations) {
+  const output = execFileSync(bench, ["--json", "--iterations", String(iterations), ...files], {
+    cwd: root,
+    encoding: "utf8",
+  });
+  return JSON.parse(output).files;
+}
+
+function main() {
+  const options = parseArgs(process.argv.slice(2));
+  const best = { stock: new Map(), tuned: new Map() };
+
+  for (let round = 0; round < options.rounds; round++) {
+    for (const build of ["stock", "tuned"]) {
+      for (const file of measure(options[build], options.files, options.iterations)) {
+        const previous = best[build].get(file.file);
+        if (!previous || file.mb_per_s > previous.mb_per_s) {
+          best[build].set(file.file, file);
+        }
+      }
+    }
+  }
+
+  const results = [];
+  let logSum = 0;
+  let mismatches = 0;
+  for (const [file, stock] of best.stock) {
+    const tuned = best.tuned.get(file);
+    const speedup = tuned.mb_per_s / stock.mb_per_s;
+    logSum += Math.log(speedup);
+    if (tuned.nodes !== stock.nodes) {
+      mismatches++;
+    }
+    results.push({
+      file,
+      bytes: stock.bytes,
+      stock_mb_per_s: stock.mb_per_s,
+      tuned_mb_per_s: tuned.mb_per_s,
+      speedup,
+      nodes: stock.nodes,
+      tuned_nodes: tuned.nodes,
+    });
+  }
+  const geomean = Math.exp(logSum / results.length);
+
+  if (options.json) {
+    console.log(JSON.stringify({ rounds: options.rounds, geomean_speedup: geomean, results }));
+  } else {
+    console.log(
+      ["file".padEnd(40), "bytes".padStart(12), "stock MB/s".padStart(12), "tuned MB/s".padStart(12),
+        "speedup".padStart(8)].join(" "),
+    );
+    for (const row of results) {
+      console.log(
+        [
+          row.file.padEnd(40),
+          String(row.bytes).padStart(12),
+          row.stock_mb_per_s.toFixed(2).padStart(12),
+          row.tuned_mb_per_s.toFixed(2).padStart(12),
+          `${row.speedup.toFixed(3)}x`.padStart(8),
+        ].join(" "),
+      );
+    }
+    console.log(`\ngeometric mean speedup: ${geomean.toFixed(3)}x over ${results.length} files`);
+  }
+
+  if (mismatches > 0) {
+    console.error(`${mismatches} files parse to a different node count in the release build`);
+    process.exit(1);
+  }
+}
+
+try {
+  main();
+} catch (error) {
+  console.error(error.message);
+  process.exit(1);
+}
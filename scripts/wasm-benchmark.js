@@ -0,0 +1,205 @@
+#!/usr/bin/env node
+/**
+ * @file Headless throughput benchmark for the WebAssembly build of the grammar
+ *
+ * Reports runtime/grammar load time, grammar compile time and parse MB/s for
+ * `examples/*.adoc` plus a large synthetic document, and compares every input
+ * against the native Node binding when it is installed.
+ *
+ * Usage: node scripts/wasm-benchmark.js [--wasm file] [--size MB] [--iterations N]
+ *                                       [--input file]... [--json]
+ */
+
+const fs = require("node:fs");
+const path = require("node:path");
+const { performance } = require("node:perf_hooks");
+
+const root = path.join(__dirname, "..");
+
+function parseArgs(argv) {
+  const options = {
+    wasm: path.join(root, "tree-sitter-asciidoc.wasm"),
+    size: 8,
+    iterations: 5,
+    inputs: [],
+    json: false,
+  };
+
+  for (let i = 0; i < argv.length; i++) {
+    switch (argv[i]) {
+      case "--wasm":
+        options.wasm = path.resolve(argv[++i]);
+        break;
+      case "--size":
+        options.size = Number(argv[++i]);
+        break;
+      case "--iterations":
+        options.iterations = Math.max(1, Number(argv[++i]));
+        break;
+      case "--input":
+        options.inputs.push(path.resolve(argv[++i]));
+        break;
+      case "--json":
+        options.json = true;
+        break;
+      default:
+        throw new Error(`unknown argument: ${argv[i]}`);
+    }
+  }
+
+  return options;
+}
+
+function loadInputs(options) {
+  const examples = path.join(root, "examples");
+  const files = options.inputs.length
+    ? options.inputs
+    : fs
+        .readdirSync(examples)
+        .filter((name) => name.endsWith(".adoc"))
+        .sort()
+        .map((name) => path.join(examples, name));
+
+  const inputs = files.map((file) => ({
+    name: path.relative(root, file),
+    text: fs.readFileSync(file, "utf8"),
+  }));
+
+  // Synthetic document: the examples repeated until the requested size is reached,
+  // separated by blank lines so every copy starts at a block boundary.
+  if (options.size > 0) {
+    const seed = inputs.map((input) => input.text).join("\n\n") + "\n\n";
+    const target = options.size * 1e6;
+    const copies = Math.max(1, Math.ceil(target / Buffer.byteLength(seed)));
+    inputs.push({ name: `synthetic (${options.size} MB)`, text: seed.repeat(copies) });
+  }
+
+  return inputs;
+}
+
+function median(values) {
+  const sorted = [...values].sort((a, b) => a - b);
+  return sorted[Math.floor(sorted.length / 2)];
+}
+
+function measureParse(parse, text, iterations) {
+  const samples = [];
+  for (let i = 0; i < iterations; i++) {
+    const start = performance.now();
+    const tree = parse(text);
+    samples.push(performance.now() - start);
+    if (tree && typeof tree.delete === "function") {
+      tree.delete();
+    }
+  }
+  return median(samples);
+}
+
+async function loadWasm(file) {
+  const TreeSitter = require("web-tree-sitter");
+  const Parser = TreeSitter.Parser ?? TreeSitter;
+  const Language = TreeSitter.Language ?? Parser.Language;
+  const bytes = fs.readFileSync(file);
+
+  // Compile on its own first so the grammar's compile cost is visible separately
+  // from instantiation and runtime start-up.
+  const compileStart = performance.now();
+  await WebAssembly.compile(bytes);
+  const compileMs = performance.now() - compileStart;
+
+  const loadStart = performance.now();
+  await Parser.init();
+  const language = await Language.load(bytes);
+  const loadMs = performance.now() - loadStart;
+
+  const parser = new Parser();
+  parser.setLanguage(language);
+
+  return {
+    bytes: bytes.length,
+    compileMs,
+    loadMs,
+    parse: (text) => parser.parse(text),
+  };
+}
+
+function loadNative() {
+  try {
+    const Parser = require("tree-sitter");
+    const parser = new Parser();
+    parser.setLanguage(require(root));
+    return (text) => parser.parse(text, null, { bufferSize: 1 << 20 });
+  } catch (_) {
+    return null;
+  }
+}
+
+function throughput(bytes, ms) {
+  return bytes / 1e6 / (ms / 1000);
+}
+
+async function main() {
+  const options = parseArgs(process.argv.slice(2));
+  if (!fs.existsSync(options.wasm)) {
+    throw new Error(`${path.relative(root, options.wasm)} not found; run \`make wasm\` first`);
+  }
+
+  const inputs = loadInputs(options);
+  const wasm = await loadWasm(options.wasm);
+  const native = loadNative();
+
+  const results = inputs.map((input) => {
+    const bytes = Buffer.byteLength(input.text);
+    const wasmMs = measureParse(wasm.parse, input.text, options.iterations);
+    const nativeMs = native ? measureParse(native, input.text, options.iterations) : null;
+    return {
+      input: input.name,
+      bytes,
+      wasm_ms: wasmMs,
+      wasm_mb_per_s: throughput(bytes, wasmMs),
+      native_ms: nativeMs,
+      native_mb_per_s: nativeMs === null ? null : throughput(bytes, nativeMs),
+    };
+  });
+
+  const report = {
+    wasm: path.relative(root, options.wasm),
+    wasm_bytes: wasm.bytes,
+    compile_ms: wasm.compileMs,
+    load_ms: wasm.loadMs,
+    iterations: options.iterations,
+    results,
+  };
+
+  if (options.json) {
+    console.log(JSON.stringify(report, null, 2));
+    return;
+  }
+
+  console.log(`module:  ${report.wasm} (${(report.wasm_bytes / 1024).toFixed(1)} KiB)`);
+  console.log(`compile: ${report.compile_ms.toFixed(2)} ms`);
+  console.log(`load:    ${report.load_ms.toFixed(2)} ms (runtime init + Language.load)`);
+  console.log("");
+  console.log(
+    ["input".padEnd(36), "bytes".padStart(12), "wasm MB/s".padStart(12), "native MB/s".padStart(12)]
+      .join(" "),
+  );
+  for (const row of results) {
+    console.log(
+      [
+        row.input.padEnd(36),
+        String(row.bytes).padStart(12),
+        row.wasm_mb_per_s.toFixed(2).padStart(12),
+        (row.native_mb_per_s === null ? "n/a" : row.native_mb_per_s.toFixed(2)).padStart(12),
+      ].join(" "),
+    );
+  }
+  if (!native) {
+    console.log("\nnative binding not available; run `npm install` to compare against it");
+  }
+}
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exit(1);
+});
@@ -0,0 +1,172 @@
+#include "analysis.h"
+
+#include <cstring>
+#include <string>
+
+namespace asciidoc_lsp {
+
+namespace {
+
+// LSP SymbolKind and DiagnosticSeverity values.
+const int SYMBOL_KIND_FILE = 1;
+const int SYMBOL_KIND_STRING = 15;
+const int SEVERITY_ERROR = 1;
+
+const char SECTION_PREFIX[] = "section_level_";
+
+// Blocks that never hold sections, so the symbol walk can skip their
+// inline content.
+const char *const LEAF_BLOCKS[] = {
+  "paragraph",         "attribute_entry",  "unordered_list", "ordered_list",
+  "description_list",  "callout_list",     "listing_block",  "literal_block",
+  "fenced_code_block", "passthrough_block", "table_block",   "block_macro",
+  "document_header",
+};
+
+bool is_leaf_block(const char *type) {
+  for (const char *leaf : LEAF_BLOCKS) {
+    if (strcmp(type, leaf) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string node_text(const Document &document, TSNode node) {
+  uint32_t start = ts_node_start_byte(node);
+  uint32_t end = ts_node_end_byte(node);
+  while (end > start && strchr(" \t\r\n", document.text()[end - 1])) {
+    end--;
+  }
+  return document.text().substr(start, end - start);
+}
+
+Json node_range(const Document &document, TSNode node, PositionEncoding encoding) {
+  return document.range(ts_node_start_byte(node), ts_node_end_byte(node), encoding);
+}
+
+void collect_sections(const Document &document, TSNode node, Json &children,
+                      PositionEncoding encoding);
+
+Json section_symbol(const Document &document, TSNode section, PositionEncoding encoding) {
+  TSNode title = ts_node_child_by_field_name(section, "title", 5);
+  const char *type = ts_node_type(section);
+  // `== Title` is a level 1 section.
+  int level = type[sizeof(SECTION_PREFIX) - 1] - '1';
+  Json symbol = Json::object();
+  std::string name = ts_node_is_null(title) ? std::string() : node_text(document, title);
+  symbol.set("name", name.empty() ? std::string("(untitled)") : name);
+  symbol.set("detail", "level " + std::to_string(level));
+  symbol.set("kind", SYMBOL_KIND_STRING);
+  symbol.set("range", node_range(document, section, encoding));
+  symbol.set("selectionRange", node_range(document, ts_node_is_null(title) ? section : title,
+                                          encoding));
+  Json children = Json::array();
+  collect_sections(document, section, children, encoding);
+  symbol.set("children", std::move(children));
+  return symbol;
+}
+
+void collect_sections(const Document &document, TSNode node, Json &children,
+                      PositionEncoding encoding) {
+  uint32_t count = ts_node_named_child_count(node);
+  for (uint32_t i = 0; i < count; i++) {
+    TSNode child = ts_node_named_child(node, i);
+    const char *type = ts_node_type(child);
+    if (strncmp(type, SECTION_PREFIX, sizeof(SECTION_PREFIX) - 1) == 0) {
+      children.push(section_symbol(document, child, encoding));
+    } else if (!is_leaf_block(type) && ts_node_named_child_count(child) > 0) {
+      collect_sections(document, child, children, encoding);
+    }
+  }
+}
+
+}  // namespace
+
+Json document_symbols(const Document &document, PositionEncoding encoding) {
+  TSNode root = ts_tree_root_node(document.tree());
+  Json sections = Json::array();
+  collect_sections(document, root, sections, encoding);
+
+  TSNode header = ts_node_named_child(root, 0);
+  if (ts_node_is_null(header) || strcmp(ts_node_type(header), "document_header") != 0) {
+    return sections;
+  }
+  TSNode title = ts_node_child_by_field_name(header, "title", 5);
+  TSNode text = ts_node_is_null(title) ? title : ts_node_child_by_field_name(title, "text", 4);
+  if (ts_node_is_null(text)) {
+    return sections;
+  }
+  Json symbol = Json::object();
+  symbol.set("name", node_text(document, text));
+  symbol.set("detail", "level 0");
+  symbol.set("kind", SYMBOL_KIND_FILE);
+  symbol.set("range", node_range(document, root, encoding));
+  symbol.set("selectionRange", node_range(document, text, encoding));
+  symbol.set("children", std::move(sections));
+  Json symbols = Json::array();
+  symbols.push(std::move(symbol));
+  return symbols;
+}
+
+Json folding_ranges(const Document &document) {
+  uint32_t count;
+  const TSAsciidocFold *folds = ts_asciidoc_folds(document.folds(), &count);
+  Json ranges = Json::array();
+  for (uint32_t i = 0; i < count; i++) {
+    // Block nodes end at column 0 of the next line; fold through the line
+    // before.
+    uint32_t end_line = folds[i].end_point.row;
+    if (folds[i].end_point.column == 0 && end_line > 0) {
+      end_line--;
+    }
+    if (end_line <= folds[i].start_point.row) {
+      continue;
+    }
+    Json range = Json::object();
+    range.set("startLine", folds[i].start_point.row);
+    range.set("endLine", end_line);
+    ranges.push(std::move(range));
+  }
+  return ranges;
+}
+
+Json syntax_diagnostics(const Document &document, PositionEncoding encoding, uint32_t limit) {
+  Json diagnostics = Json::array();
+  TSTreeCursor cursor = ts_tree_cursor_new(ts_tree_root_node(document.tree()));
+  while (diagnostics.size() < limit) {
+    TSNode node = ts_tree_cursor_current_node(&cursor);
+    std::string message;
+    if (ts_node_is_error(node)) {
+      message = "Syntax error";
+    } else if (ts_node_is_missing(node)) {
+      message = ts_node_is_named(node) ? std::string("Missing ") + ts_node_type(node)
+                                       : std::string("Missing \"") + ts_node_type(node) + "\"";
+    }
+    if (!message.empty()) {
+      Json diagnostic = Json::object();
+      diagnostic.set("range", node_range(document, node, encoding));
+      diagnostic.set("severity", SEVERITY_ERROR);
+      diagnostic.set("source", "asciidoc");
+      diagnostic.set("message", std::move(message));
+      diagnostics.push(std::move(diagnostic));
+    } else if (ts_node_has_error(node) && ts_tree_cursor_goto_first_child(&cursor)) {
+      continue;
+    }
+    // Errors are reported once, not for each node inside them.
+    bool done = false;
+    while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+      if (!ts_tree_cursor_goto_parent(&cursor)) {
+        done = true;
+        break;
+      }
+    }
+    if (done) {
+      break;
+    }
+  }
+  ts_tree_cursor_delete(&cursor);
+  return diagnostics;
+}
+
+}  // namespace asciidoc_lsp
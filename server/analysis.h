@@ -0,0 +1,26 @@
+#ifndef ASCIIDOC_LSP_ANALYSIS_H_
+#define ASCIIDOC_LSP_ANALYSIS_H_
+
+#include <cstdint>
+
+#include "document.h"
+#include "json.h"
+
+namespace asciidoc_lsp {
+
+// Responses computed from a document's current tree. The document must be
+// parsed.
+
+// `DocumentSymbol[]`: the document title, if any, holding the sections,
+// nested by level.
+Json document_symbols(const Document &document, PositionEncoding encoding);
+
+// `FoldingRange[]`, from the document's incremental folds.
+Json folding_ranges(const Document &document);
+
+// `Diagnostic[]`: one per ERROR node and per MISSING node, at most `limit`.
+Json syntax_diagnostics(const Document &document, PositionEncoding encoding, uint32_t limit);
+
+}  // namespace asciidoc_lsp
+
+#endif // ASCIIDOC_LSP_ANALYSIS_H_
@@ -0,0 +1,178 @@
+#include "document.h"
+
+#include <algorithm>
+
+namespace asciidoc_lsp {
+
+namespace {
+
+// The length of the UTF-8 sequence starting with `lead`, and the number of
+// UTF-16 code units it takes.
+uint32_t utf8_length(unsigned char lead) {
+  if (lead < 0x80) {
+    return 1;
+  }
+  if (lead >= 0xF0) {
+    return 4;
+  }
+  if (lead >= 0xE0) {
+    return 3;
+  }
+  return lead >= 0xC0 ? 2 : 1;
+}
+
+}  // namespace
+
+Document::Document(std::string uri, int64_t version, std::string text)
+    : uri_(std::move(uri)),
+      text_(std::move(text)),
+      folds_(ts_asciidoc_folds_new()),
+      version_(version) {
+  line_starts_.push_back(0);
+  for (uint32_t i = 0; i < text_.size(); i++) {
+    if (text_[i] == '\n') {
+      line_starts_.push_back(i + 1);
+    }
+  }
+}
+
+Document::~Document() {
+  if (tree_) {
+    ts_tree_delete(tree_);
+  }
+  ts_asciidoc_folds_delete(folds_);
+}
+
+bool Document::apply_change(const Json &change, PositionEncoding encoding) {
+  const Json &text = change["text"];
+  if (!text.is_string()) {
+    return false;
+  }
+
+  if (!change.has("range")) {
+    // A full replacement; the next parse starts from scratch.
+    replace(0, static_cast<uint32_t>(text_.size()), text.string());
+    if (tree_) {
+      ts_tree_delete(tree_);
+      tree_ = nullptr;
+    }
+    return true;
+  }
+
+  const Json &range = change["range"];
+  uint32_t start = offset(range["start"], encoding);
+  uint32_t end = std::max(start, offset(range["end"], encoding));
+  TSInputEdit edit;
+  edit.start_byte = start;
+  edit.old_end_byte = end;
+  edit.start_point = point(start);
+  edit.old_end_point = point(end);
+  replace(start, end, text.string());
+  edit.new_end_byte = start + static_cast<uint32_t>(text.string().size());
+  edit.new_end_point = point(edit.new_end_byte);
+  if (tree_) {
+    ts_tree_edit(tree_, &edit);
+    ts_asciidoc_folds_edit(folds_, &edit);
+  }
+  return true;
+}
+
+void Document::replace(uint32_t start, uint32_t end, const std::string &text) {
+  uint32_t start_row = point(start).row;
+  uint32_t end_row = point(end).row;
+  int64_t delta = static_cast<int64_t>(text.size()) - (end - start);
+  text_.replace(start, end - start, text);
+
+  std::vector<uint32_t> inserted;
+  for (uint32_t i = 0; i < text.size(); i++) {
+    if (text[i] == '\n') {
+      inserted.push_back(start + i + 1);
+    }
+  }
+  auto first = line_starts_.begin() + start_row + 1;
+  auto last = line_starts_.erase(first, line_starts_.begin() + end_row + 1);
+  last = line_starts_.insert(last, inserted.begin(), inserted.end()) +
+         static_cast<std::ptrdiff_t>(inserted.size());
+  for (; last != line_starts_.end(); ++last) {
+    *last = static_cast<uint32_t>(*last + delta);
+  }
+}
+
+void Document::set_tree(TSTree *tree, int64_t version) {
+  ts_asciidoc_folds_update(folds_, tree_, tree);
+  if (tree_) {
+    ts_tree_delete(tree_);
+  }
+  tree_ = tree;
+  parsed_version_ = version;
+  urgent = false;
+}
+
+uint32_t Document::line_end(uint32_t row) const {
+  uint32_t end = row + 1 < line_starts_.size() ? line_starts_[row + 1] - 1
+                                               : static_cast<uint32_t>(text_.size());
+  if (end > line_starts_[row] && text_[end - 1] == '\r') {
+    end--;
+  }
+  return end;
+}
+
+uint32_t Document::offset(const Json &position, PositionEncoding encoding) const {
+  double line = position["line"].number();
+  if (line < 0) {
+    return 0;
+  }
+  if (line >= line_starts_.size()) {
+    return static_cast<uint32_t>(text_.size());
+  }
+  uint32_t row = static_cast<uint32_t>(line);
+  uint32_t start = line_starts_[row];
+  uint32_t end = line_end(row);
+  double character = std::max(0.0, position["character"].number());
+  if (encoding == PositionEncoding::UTF8) {
+    return std::min(end, start + static_cast<uint32_t>(std::min(character, 4294967295.0)));
+  }
+
+  uint32_t offset = start;
+  uint32_t units = 0;
+  while (offset < end && units < character) {
+    uint32_t length = utf8_length(static_cast<unsigned char>(text_[offset]));
+    units += length == 4 ? 2 : 1;
+    offset = std::min(end, offset + length);
+  }
+  return offset;
+}
+
+TSPoint Document::point(uint32_t offset) const {
+  auto next = std::upper_bound(line_starts_.begin(), line_starts_.end(), offset);
+  uint32_t row = static_cast<uint32_t>(next - line_starts_.begin()) - 1;
+  return {row, offset - line_starts_[row]};
+}
+
+Json Document::position(uint32_t offset, PositionEncoding encoding) const {
+  offset = std::min(offset, static_cast<uint32_t>(text_.size()));
+  TSPoint point = this->point(offset);
+  uint32_t character = point.column;
+  if (encoding == PositionEncoding::UTF16) {
+    character = 0;
+    uint32_t i = line_starts_[point.row];
+    while (i < offset) {
+      uint32_t length = utf8_length(static_cast<unsigned char>(text_[i]));
+      character += length == 4 ? 2 : 1;
+      i += length;
+    }
+  }
+  Json result = Json::object();
+  result.set("line", point.row);
+  result.set("character", character);
+  return result;
+}
+
+Json Document::range(uint32_t start, uint32_t end, PositionEncoding encoding) const {
+  Json result = Json::object();
+  result.set("start", position(start, encoding));
+  result.set("end", position(end, encoding));
+  return result;
+}
+
+}  // namespace asciidoc_lsp
@@ -0,0 +1,80 @@
+#ifndef ASCIIDOC_LSP_DOCUMENT_H_
+#define ASCIIDOC_LSP_DOCUMENT_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <tree_sitter/api.h>
+#include <vector>
+
+#include "json.h"
+#include "tree_sitter/tree-sitter-asciidoc-fold.h"
+
+namespace asciidoc_lsp {
+
+enum class PositionEncoding { UTF16, UTF8 };
+
+// An open document: its text, a line index for LSP positions and the last
+// tree parsed from it.
+//
+// The tree is always in the coordinates of the current text: every change
+// is applied to it with ts_tree_edit, so it is ready to be passed as the old
+// tree of the next parse, however many changes went in since the last one.
+// All members are guarded by the server lock.
+class Document {
+ public:
+  Document(std::string uri, int64_t version, std::string text);
+  ~Document();
+
+  Document(const Document &) = delete;
+  Document &operator=(const Document &) = delete;
+
+  // Applies one `TextDocumentContentChangeEvent`. Returns false if it is
+  // malformed.
+  bool apply_change(const Json &change, PositionEncoding encoding);
+
+  // Replaces the tree with `tree`, parsed from the text as of `version`.
+  void set_tree(TSTree *tree, int64_t version);
+
+  bool parsed() const { return tree_ && parsed_version_ == version_; }
+
+  uint32_t offset(const Json &position, PositionEncoding encoding) const;
+  Json position(uint32_t offset, PositionEncoding encoding) const;
+  Json range(uint32_t start, uint32_t end, PositionEncoding encoding) const;
+  TSPoint point(uint32_t offset) const;
+  uint32_t line_count() const { return static_cast<uint32_t>(line_starts_.size()); }
+
+  const std::string &uri() const { return uri_; }
+  const std::string &text() const { return text_; }
+  const TSTree *tree() const { return tree_; }
+  const TSAsciidocFolds *folds() const { return folds_; }
+  int64_t version() const { return version_; }
+  void set_version(int64_t version) { version_ = version; }
+
+  // When the oldest change not parsed yet came in, and when the document is
+  // due for a parse: the debounce window after the latest change, so a burst
+  // of changes is parsed once, but no later than the maximum wait after the
+  // oldest one, so continuous typing cannot hold parsing off.
+  std::chrono::steady_clock::time_point pending_since;
+  std::chrono::steady_clock::time_point deadline;
+  // Set by requests that need the current tree; skips the debounce window.
+  bool urgent = false;
+  bool closed = false;
+
+ private:
+  void replace(uint32_t start, uint32_t end, const std::string &text);
+  uint32_t line_end(uint32_t row) const;
+
+  std::string uri_;
+  std::string text_;
+  // Byte offset of the start of each line.
+  std::vector<uint32_t> line_starts_;
+  TSTree *tree_ = nullptr;
+  TSAsciidocFolds *folds_;
+  int64_t version_;
+  int64_t parsed_version_ = -1;
+};
+
+}  // namespace asciidoc_lsp
+
+#endif // ASCIIDOC_LSP_DOCUMENT_H_
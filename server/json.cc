@@ -0,0 +1,399 @@
+#include "json.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace asciidoc_lsp {
+
+namespace {
+
+const Json NULL_VALUE;
+const std::string EMPTY_STRING;
+
+class Reader {
+ public:
+  explicit Reader(const std::string &text) : text_(text) {}
+
+  bool read_document(Json &out) {
+    if (!read_value(out)) {
+      return false;
+    }
+    skip_whitespace();
+    return position_ == text_.size();
+  }
+
+ private:
+  void skip_whitespace() {
+    while (position_ < text_.size()) {
+      char c = text_[position_];
+      if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+        break;
+      }
+      position_++;
+    }
+  }
+
+  bool consume(const char *literal) {
+    size_t length = strlen(literal);
+    if (text_.compare(position_, length, literal) != 0) {
+      return false;
+    }
+    position_ += length;
+    return true;
+  }
+
+  bool read_value(Json &out) {
+    skip_whitespace();
+    if (position_ == text_.size()) {
+      return false;
+    }
+    switch (text_[position_]) {
+      case '{':
+        return read_object(out);
+      case '[':
+        return read_array(out);
+      case '"': {
+        std::string value;
+        if (!read_string(value)) {
+          return false;
+        }
+        out = Json(std::move(value));
+        return true;
+      }
+      case 't':
+        out = Json(true);
+        return consume("true");
+      case 'f':
+        out = Json(false);
+        return consume("false");
+      case 'n':
+        out = Json();
+        return consume("null");
+      default:
+        return read_number(out);
+    }
+  }
+
+  bool read_number(Json &out) {
+    const char *start = text_.c_str() + position_;
+    if (*start != '-' && (*start < '0' || *start > '9')) {
+      return false;
+    }
+    char *end;
+    double value = strtod(start, &end);
+    if (end == start) {
+      return false;
+    }
+    position_ += static_cast<size_t>(end - start);
+    out = Json(value);
+    return true;
+  }
+
+  bool read_hex4(uint32_t &value) {
+    if (position_ + 4 > text_.size()) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+      char c = text_[position_++];
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= static_cast<uint32_t>(c - '0');
+      } else if (c >= 'a' && c <= 'f') {
+        value |= static_cast<uint32_t>(c - 'a' + 10);
+      } else if (c >= 'A' && c <= 'F') {
+        value |= static_cast<uint32_t>(c - 'A' + 10);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void append_utf8(std::string &out, uint32_t code_point) {
+    if (code_point < 0x80) {
+      out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+      out += static_cast<char>(0xC0 | (code_point >> 6));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+      out += static_cast<char>(0xE0 | (code_point >> 12));
+      out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (code_point >> 18));
+      out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+  }
+
+  bool read_string(std::string &out) {
+    position_++;
+    for (;;) {
+      // Copy unescaped runs in one go; the document text is one long string.
+      size_t run = position_;
+      while (run < text_.size() && text_[run] != '"' && text_[run] != '\\') {
+        run++;
+      }
+      out.append(text_, position_, run - position_);
+      position_ = run;
+      if (position_ == text_.size()) {
+        return false;
+      }
+      if (text_[position_++] == '"') {
+        return true;
+      }
+      if (position_ == text_.size()) {
+        return false;
+      }
+      char escape = text_[position_++];
+      switch (escape) {
+        case '"':
+        case '\\':
+        case '/':
+          out += escape;
+          break;
+        case 'b':
+          out += '\b';
+          break;
+        case 'f':
+          out += '\f';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u': {
+          uint32_t code_point;
+          if (!read_hex4(code_point)) {
+            return false;
+          }
+          if (code_point >= 0xD800 && code_point < 0xDC00 && consume("\\u")) {
+            uint32_t low;
+            if (!read_hex4(low) || low < 0xDC00 || low >= 0xE000) {
+              return false;
+            }
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+          }
+          append_utf8(out, code_point);
+          break;
+        }
+        default:
+          return false;
+      }
+    }
+  }
+
+  bool read_array(Json &out) {
+    position_++;
+    out = Json::array();
+    skip_whitespace();
+    if (consume("]")) {
+      return true;
+    }
+    for (;;) {
+      Json item;
+      if (!read_value(item)) {
+        return false;
+      }
+      out.push(std::move(item));
+      skip_whitespace();
+      if (consume("]")) {
+        return true;
+      }
+      if (!consume(",")) {
+        return false;
+      }
+    }
+  }
+
+  bool read_object(Json &out) {
+    position_++;
+    out = Json::object();
+    skip_whitespace();
+    if (consume("}")) {
+      return true;
+    }
+    for (;;) {
+      skip_whitespace();
+      std::string key;
+      if (position_ == text_.size() || text_[position_] != '"' || !read_string(key)) {
+        return false;
+      }
+      skip_whitespace();
+      if (!consume(":")) {
+        return false;
+      }
+      Json value;
+      if (!read_value(value)) {
+        return false;
+      }
+      out.set(key.c_str(), std::move(value));
+      skip_whitespace();
+      if (consume("}")) {
+        return true;
+      }
+      if (!consume(",")) {
+        return false;
+      }
+    }
+  }
+
+  const std::string &text_;
+  size_t position_ = 0;
+};
+
+void dump_string(const std::string &value, std::string &out) {
+  out += '"';
+  for (unsigned char c : value) {
+    switch (c) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        if (c < 0x20) {
+          char escape[8];
+          snprintf(escape, sizeof(escape), "\\u%04x", c);
+          out += escape;
+        } else {
+          out += static_cast<char>(c);
+        }
+    }
+  }
+  out += '"';
+}
+
+}  // namespace
+
+Json Json::array() {
+  Json value;
+  value.type_ = Type::Array;
+  return value;
+}
+
+Json Json::object() {
+  Json value;
+  value.type_ = Type::Object;
+  return value;
+}
+
+bool Json::parse(const std::string &text, Json &out) {
+  return Reader(text).read_document(out);
+}
+
+const std::string &Json::string() const {
+  return type_ == Type::String ? string_ : EMPTY_STRING;
+}
+
+size_t Json::size() const {
+  if (type_ == Type::Array) {
+    return items_.size();
+  }
+  return type_ == Type::Object ? members_.size() : 0;
+}
+
+const Json &Json::operator[](const char *key) const {
+  for (const auto &member : members_) {
+    if (member.first == key) {
+      return member.second;
+    }
+  }
+  return NULL_VALUE;
+}
+
+const Json &Json::operator[](size_t index) const {
+  return index < items_.size() ? items_[index] : NULL_VALUE;
+}
+
+bool Json::has(const char *key) const {
+  for (const auto &member : members_) {
+    if (member.first == key) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Json &Json::set(const char *key, Json value) {
+  members_.emplace_back(key, std::move(value));
+  return *this;
+}
+
+Json &Json::push(Json value) {
+  items_.push_back(std::move(value));
+  return *this;
+}
+
+std::string Json::dump() const {
+  std::string out;
+  dump(out);
+  return out;
+}
+
+void Json::dump(std::string &out) const {
+  switch (type_) {
+    case Type::Null:
+      out += "null";
+      break;
+    case Type::Bool:
+      out += bool_ ? "true" : "false";
+      break;
+    case Type::Number: {
+      char buffer[32];
+      if (std::floor(number_) == number_ && std::fabs(number_) < 9007199254740992.0) {
+        snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(number_));
+      } else {
+        snprintf(buffer, sizeof(buffer), "%.17g", number_);
+      }
+      out += buffer;
+      break;
+    }
+    case Type::String:
+      dump_string(string_, out);
+      break;
+    case Type::Array:
+      out += '[';
+      for (size_t i = 0; i < items_.size(); i++) {
+        if (i > 0) {
+          out += ',';
+        }
+        items_[i].dump(out);
+      }
+      out += ']';
+      break;
+    case Type::Object:
+      out += '{';
+      for (size_t i = 0; i < members_.size(); i++) {
+        if (i > 0) {
+          out += ',';
+        }
+        dump_string(members_[i].first, out);
+        out += ':';
+        members_[i].second.dump(out);
+      }
+      out += '}';
+      break;
+  }
+}
+
+}  // namespace asciidoc_lsp
@@ -0,0 +1,71 @@
+#ifndef ASCIIDOC_LSP_JSON_H_
+#define ASCIIDOC_LSP_JSON_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace asciidoc_lsp {
+
+// A JSON value, just enough for JSON-RPC. Objects keep their members in
+// insertion order and look them up linearly, as protocol messages are small
+// apart from the document text itself.
+class Json {
+ public:
+  enum class Type { Null, Bool, Number, String, Array, Object };
+
+  Json() = default;
+  Json(std::nullptr_t) {}
+  Json(bool value) : type_(Type::Bool), bool_(value) {}
+  Json(double value) : type_(Type::Number), number_(value) {}
+  Json(int value) : type_(Type::Number), number_(value) {}
+  Json(int64_t value) : type_(Type::Number), number_(static_cast<double>(value)) {}
+  Json(uint32_t value) : type_(Type::Number), number_(value) {}
+  Json(const char *value) : type_(Type::String), string_(value) {}
+  Json(std::string value) : type_(Type::String), string_(std::move(value)) {}
+
+  static Json array();
+  static Json object();
+
+  // Returns false on malformed input or trailing garbage.
+  static bool parse(const std::string &text, Json &out);
+
+  Type type() const { return type_; }
+  bool is_null() const { return type_ == Type::Null; }
+  bool is_number() const { return type_ == Type::Number; }
+  bool is_string() const { return type_ == Type::String; }
+  bool is_array() const { return type_ == Type::Array; }
+  bool is_object() const { return type_ == Type::Object; }
+
+  // The accessors below return a default for values of another type.
+  bool boolean() const { return type_ == Type::Bool && bool_; }
+  double number() const { return type_ == Type::Number ? number_ : 0; }
+  const std::string &string() const;
+  // Array length or member count.
+  size_t size() const;
+
+  // A null value for missing members and out of range indices.
+  const Json &operator[](const char *key) const;
+  const Json &operator[](size_t index) const;
+  bool has(const char *key) const;
+
+  Json &set(const char *key, Json value);
+  Json &push(Json value);
+
+  std::string dump() const;
+  void dump(std::string &out) const;
+
+ private:
+  Type type_ = Type::Null;
+  bool bool_ = false;
+  double number_ = 0;
+  std::string string_;
+  std::vector<Json> items_;
+  std::vector<std::pair<std::string, Json>> members_;
+};
+
+}  // namespace asciidoc_lsp
+
+#endif // ASCIIDOC_LSP_JSON_H_
@@ -0,0 +1,40 @@
+// AsciiDoc language server over stdio.
+//
+// Usage: asciidoc-language-server [--debounce MS] [--max-wait MS] [--max-diagnostics N]
+//                                 [--verbose]
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "server.h"
+
+static int usage() {
+  fputs("usage: asciidoc-language-server [--debounce MS] [--max-wait MS] [--max-diagnostics N]"
+        " [--verbose]\n",
+        stderr);
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  asciidoc_lsp::Options options;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--debounce") == 0 && i + 1 < argc) {
+      options.debounce = std::chrono::milliseconds(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--max-wait") == 0 && i + 1 < argc) {
+      options.max_wait = std::chrono::milliseconds(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--max-diagnostics") == 0 && i + 1 < argc) {
+      options.max_diagnostics = static_cast<uint32_t>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      options.verbose = true;
+    } else {
+      return usage();
+    }
+  }
+
+  // A client that goes away should end the loop through EOF, not a signal.
+  signal(SIGPIPE, SIG_IGN);
+  asciidoc_lsp::Server server(stdin, stdout, options);
+  return server.run();
+}
@@ -0,0 +1,377 @@
+#include "server.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+
+#include "analysis.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+namespace asciidoc_lsp {
+
+namespace {
+
+// JSON-RPC and LSP error codes.
+const int PARSE_ERROR = -32700;
+const int INVALID_REQUEST = -32600;
+const int METHOD_NOT_FOUND = -32601;
+const int SERVER_NOT_INITIALIZED = -32002;
+
+// LSP TextDocumentSyncKind.Incremental.
+const int SYNC_INCREMENTAL = 2;
+
+double milliseconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+    .count();
+}
+
+}  // namespace
+
+Server::Server(FILE *input, FILE *output, Options options)
+    : input_(input), output_(output), options_(options) {
+  worker_ = std::thread(&Server::parse_documents, this);
+}
+
+Server::~Server() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+    __atomic_store_n(&cancel_, 1, __ATOMIC_RELAXED);
+  }
+  work_.notify_all();
+  worker_.join();
+}
+
+int Server::run() {
+  std::string body;
+  while (!exiting_ && read_message(body)) {
+    Json message;
+    if (!Json::parse(body, message) || !message.is_object()) {
+      respond_error(Json(), PARSE_ERROR, "Parse error");
+      continue;
+    }
+    handle(message);
+  }
+  return exiting_ && shutdown_ ? 0 : 1;
+}
+
+void Server::handle(const Json &message) {
+  const std::string &method = message["method"].string();
+  const Json &id = message["id"];
+  const Json &params = message["params"];
+  bool request = message.has("id");
+  if (method.empty()) {
+    // A response; the server sends no requests.
+    return;
+  }
+  if (method == "exit") {
+    exiting_ = true;
+    return;
+  }
+  if (!initialized_ && method != "initialize") {
+    if (request) {
+      respond_error(id, SERVER_NOT_INITIALIZED, "Server not initialized");
+    }
+    return;
+  }
+  if (shutdown_ && request) {
+    respond_error(id, INVALID_REQUEST, "Server is shutting down");
+    return;
+  }
+
+  if (method == "initialize") {
+    respond(id, initialize(params));
+  } else if (method == "shutdown") {
+    shutdown_ = true;
+    respond(id, Json());
+  } else if (method == "textDocument/didOpen") {
+    did_open(params);
+  } else if (method == "textDocument/didChange") {
+    did_change(params);
+  } else if (method == "textDocument/didClose") {
+    did_close(params);
+  } else if (method == "textDocument/documentSymbol") {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::shared_ptr<Document> document = parsed_document(params, lock);
+    Json result = document ? document_symbols(*document, encoding_) : Json();
+    lock.unlock();
+    respond(id, std::move(result));
+  } else if (method == "textDocument/foldingRange") {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::shared_ptr<Document> document = parsed_document(params, lock);
+    Json result = document ? folding_ranges(*document) : Json();
+    lock.unlock();
+    respond(id, std::move(result));
+  } else if (request) {
+    respond_error(id, METHOD_NOT_FOUND, "Method not found");
+  }
+}
+
+Json Server::initialize(const Json &params) {
+  initialized_ = true;
+  const Json &encodings = params["capabilities"]["general"]["positionEncodings"];
+  for (size_t i = 0; i < encodings.size(); i++) {
+    if (encodings[i].string() == "utf-8") {
+      encoding_ = PositionEncoding::UTF8;
+    }
+  }
+  const Json &debounce = params["initializationOptions"]["debounceMs"];
+  if (debounce.is_number() && debounce.number() >= 0) {
+    options_.debounce = std::chrono::milliseconds(static_cast<int64_t>(debounce.number()));
+  }
+  const Json &max_wait = params["initializationOptions"]["maxWaitMs"];
+  if (max_wait.is_number() && max_wait.number() >= 0) {
+    options_.max_wait = std::chrono::milliseconds(static_cast<int64_t>(max_wait.number()));
+  }
+
+  Json sync = Json::object();
+  sync.set("openClose", true);
+  sync.set("change", SYNC_INCREMENTAL);
+  Json capabilities = Json::object();
+  capabilities.set("positionEncoding", encoding_ == PositionEncoding::UTF8 ? "utf-8" : "utf-16");
+  capabilities.set("textDocumentSync", std::move(sync));
+  capabilities.set("documentSymbolProvider", true);
+  capabilities.set("foldingRangeProvider", true);
+  Json info = Json::object();
+  info.set("name", "asciidoc-language-server");
+  info.set("version", "0.1.0");
+  Json result = Json::object();
+  result.set("capabilities", std::move(capabilities));
+  result.set("serverInfo", std::move(info));
+  return result;
+}
+
+void Server::did_open(const Json &params) {
+  const Json &item = params["textDocument"];
+  const std::string &uri = item["uri"].string();
+  auto document = std::make_shared<Document>(
+    uri, static_cast<int64_t>(item["version"].number()), item["text"].string());
+  document->pending_since = std::chrono::steady_clock::now();
+  document->deadline = document->pending_since;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &slot = documents_[uri];
+    if (slot) {
+      slot->closed = true;
+      cancel_parse(slot.get());
+    }
+    slot = std::move(document);
+  }
+  work_.notify_one();
+}
+
+void Server::did_change(const Json &params) {
+  const Json &identifier = params["textDocument"];
+  const Json &changes = params["contentChanges"];
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = documents_.find(identifier["uri"].string());
+    if (entry == documents_.end()) {
+      return;
+    }
+    Document &document = *entry->second;
+    auto now = std::chrono::steady_clock::now();
+    if (document.parsed()) {
+      document.pending_since = now;
+    }
+    for (size_t i = 0; i < changes.size(); i++) {
+      document.apply_change(changes[i], encoding_);
+    }
+    document.set_version(static_cast<int64_t>(identifier["version"].number()));
+    document.deadline =
+      std::min(now + options_.debounce, document.pending_since + options_.max_wait);
+    cancel_parse(&document);
+  }
+  work_.notify_one();
+}
+
+void Server::did_close(const Json &params) {
+  std::string uri = params["textDocument"]["uri"].string();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = documents_.find(uri);
+    if (entry == documents_.end()) {
+      return;
+    }
+    entry->second->closed = true;
+    cancel_parse(entry->second.get());
+    documents_.erase(entry);
+  }
+  Json cleared = Json::object();
+  cleared.set("uri", std::move(uri));
+  cleared.set("diagnostics", Json::array());
+  notify("textDocument/publishDiagnostics", std::move(cleared));
+}
+
+std::shared_ptr<Document> Server::parsed_document(const Json &params,
+                                                  std::unique_lock<std::mutex> &lock) {
+  auto entry = documents_.find(params["textDocument"]["uri"].string());
+  if (entry == documents_.end()) {
+    return nullptr;
+  }
+  std::shared_ptr<Document> document = entry->second;
+  if (!document->parsed()) {
+    document->urgent = true;
+    work_.notify_one();
+    parsed_.wait(lock, [&] { return document->parsed() || document->closed; });
+  }
+  return document->closed ? nullptr : document;
+}
+
+void Server::cancel_parse(const Document *document) {
+  if (parsing_ == document) {
+    __atomic_store_n(&cancel_, 1, __ATOMIC_RELAXED);
+  }
+}
+
+void Server::parse_documents() {
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+  ts_parser_set_cancellation_flag(parser, &cancel_);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopping_) {
+    // Requests waiting on a tree first, then the oldest expired window.
+    auto now = std::chrono::steady_clock::now();
+    auto wake = std::chrono::steady_clock::time_point::max();
+    std::shared_ptr<Document> next;
+    for (auto &entry : documents_) {
+      Document &document = *entry.second;
+      if (document.parsed()) {
+        continue;
+      }
+      if (document.urgent) {
+        next = entry.second;
+        break;
+      }
+      if (document.deadline > now) {
+        wake = std::min(wake, document.deadline);
+      } else if (!next || document.deadline < next->deadline) {
+        next = entry.second;
+      }
+    }
+    if (!next) {
+      if (wake == std::chrono::steady_clock::time_point::max()) {
+        work_.wait(lock);
+      } else {
+        work_.wait_until(lock, wake);
+      }
+      continue;
+    }
+
+    // Parse a snapshot outside the lock. The copy of the tree carries every
+    // edit so far; the document's own tree keeps taking edits meanwhile.
+    std::string text = next->text();
+    int64_t version = next->version();
+    TSTree *old_tree = next->tree() ? ts_tree_copy(next->tree()) : nullptr;
+    parsing_ = next.get();
+    __atomic_store_n(&cancel_, 0, __ATOMIC_RELAXED);
+    lock.unlock();
+
+    auto start = std::chrono::steady_clock::now();
+    TSTree *tree =
+      ts_parser_parse_string(parser, old_tree, text.data(), static_cast<uint32_t>(text.size()));
+    double elapsed = milliseconds_since(start);
+    bool incremental = old_tree != nullptr;
+    if (old_tree) {
+      ts_tree_delete(old_tree);
+    }
+
+    lock.lock();
+    parsing_ = nullptr;
+    if (!tree) {
+      // Cancelled by a change. The next parse starts over from the
+      // document's tree.
+      ts_parser_reset(parser);
+      if (options_.verbose) {
+        fprintf(stderr, "cancelled %s@%lld after %.2f ms\n", next->uri().c_str(),
+                static_cast<long long>(version), elapsed);
+      }
+      continue;
+    }
+    if (next->closed || next->version() != version) {
+      ts_tree_delete(tree);
+      continue;
+    }
+    next->set_tree(tree, version);
+    if (options_.verbose) {
+      fprintf(stderr, "parsed %s@%lld: %zu bytes, %s, %.2f ms\n", next->uri().c_str(),
+              static_cast<long long>(version), text.size(), incremental ? "incremental" : "full",
+              elapsed);
+    }
+    // Sent outside the lock, so a slow client does not hold up changes.
+    Json diagnostics = diagnostics_params(*next);
+    parsed_.notify_all();
+    lock.unlock();
+    notify("textDocument/publishDiagnostics", std::move(diagnostics));
+    lock.lock();
+  }
+  ts_parser_delete(parser);
+}
+
+Json Server::diagnostics_params(const Document &document) {
+  Json params = Json::object();
+  params.set("uri", document.uri());
+  params.set("version", document.version());
+  params.set("diagnostics", syntax_diagnostics(document, encoding_, options_.max_diagnostics));
+  return params;
+}
+
+bool Server::read_message(std::string &body) {
+  long length = -1;
+  char line[256];
+  for (;;) {
+    if (!fgets(line, sizeof(line), input_)) {
+      return false;
+    }
+    if (strcmp(line, "\r\n") == 0 || strcmp(line, "\n") == 0) {
+      break;
+    }
+    if (strncasecmp(line, "Content-Length:", 15) == 0) {
+      length = strtol(line + 15, nullptr, 10);
+    }
+  }
+  if (length < 0) {
+    return false;
+  }
+  body.resize(static_cast<size_t>(length));
+  return fread(&body[0], 1, body.size(), input_) == body.size();
+}
+
+void Server::send(const Json &message) {
+  std::string body = message.dump();
+  std::lock_guard<std::mutex> lock(output_mutex_);
+  fprintf(output_, "Content-Length: %zu\r\n\r\n", body.size());
+  fwrite(body.data(), 1, body.size(), output_);
+  fflush(output_);
+}
+
+void Server::respond(const Json &id, Json result) {
+  Json message = Json::object();
+  message.set("jsonrpc", "2.0");
+  message.set("id", id);
+  message.set("result", std::move(result));
+  send(message);
+}
+
+void Server::respond_error(const Json &id, int code, const char *text) {
+  Json error = Json::object();
+  error.set("code", code);
+  error.set("message", text);
+  Json message = Json::object();
+  message.set("jsonrpc", "2.0");
+  message.set("id", id);
+  message.set("error", std::move(error));
+  send(message);
+}
+
+void Server::notify(const char *method, Json params) {
+  Json message = Json::object();
+  message.set("jsonrpc", "2.0");
+  message.set("method", method);
+  message.set("params", std::move(params));
+  send(message);
+}
+
+}  // namespace asciidoc_lsp
@@ -0,0 +1,98 @@
+#ifndef ASCIIDOC_LSP_SERVER_H_
+#define ASCIIDOC_LSP_SERVER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "document.h"
+#include "json.h"
+
+namespace asciidoc_lsp {
+
+struct Options {
+  // Quiet period after a change before the document is reparsed, so a
+  // burst of keystrokes costs one parse.
+  std::chrono::milliseconds debounce{75};
+  // Longest a change waits for its parse while changes keep coming.
+  std::chrono::milliseconds max_wait{500};
+  uint32_t max_diagnostics = 200;
+  // Log each parse to stderr.
+  bool verbose = false;
+};
+
+// A language server speaking JSON-RPC over a pair of streams.
+//
+// The calling thread reads messages and applies document changes, editing
+// each document's tree in place. A worker thread parses the documents whose
+// debounce window has expired, reusing the edited tree, and publishes their
+// diagnostics. A change to the document being parsed cancels the parse
+// through ts_parser_set_cancellation_flag; the document is parsed again
+// once the new burst of changes is over, or once its oldest unparsed change
+// has waited the maximum time. Requests that need a current tree
+// skip the debounce window and wait for the parse.
+class Server {
+ public:
+  Server(FILE *input, FILE *output, Options options);
+  ~Server();
+
+  Server(const Server &) = delete;
+  Server &operator=(const Server &) = delete;
+
+  // Serves requests until `exit` or the end of the input. Returns the
+  // process exit status.
+  int run();
+
+ private:
+  void handle(const Json &message);
+  Json initialize(const Json &params);
+  void did_open(const Json &params);
+  void did_change(const Json &params);
+  void did_close(const Json &params);
+
+  // The document named in `params`, parsed up to its current version, or
+  // NULL if it is not open.
+  std::shared_ptr<Document> parsed_document(const Json &params,
+                                            std::unique_lock<std::mutex> &lock);
+  void cancel_parse(const Document *document);
+  void parse_documents();
+  Json diagnostics_params(const Document &document);
+
+  bool read_message(std::string &body);
+  void send(const Json &message);
+  void respond(const Json &id, Json result);
+  void respond_error(const Json &id, int code, const char *message);
+  void notify(const char *method, Json params);
+
+  FILE *input_;
+  FILE *output_;
+  Options options_;
+  PositionEncoding encoding_ = PositionEncoding::UTF16;
+  bool initialized_ = false;
+  bool shutdown_ = false;
+  bool exiting_ = false;
+
+  // Guards the documents and the worker state.
+  std::mutex mutex_;
+  std::condition_variable work_;
+  std::condition_variable parsed_;
+  std::map<std::string, std::shared_ptr<Document>> documents_;
+  const Document *parsing_ = nullptr;
+  // Polled by the parser. Written with atomic stores.
+  size_t cancel_ = 0;
+  bool stopping_ = false;
+  std::thread worker_;
+
+  std::mutex output_mutex_;
+};
+
+}  // namespace asciidoc_lsp
+
+#endif // ASCIIDOC_LSP_SERVER_H_
@@ -1,7 +1,9 @@
+#include "tree_sitter/alloc.h"
 #include "tree_sitter/parser.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 
 enum TokenType {
   _LIST_CONTINUATION,
@@ -16,23 +18,204 @@ enum TokenType {
   _PLAIN_HASH,
   _HIGHLIGHT_OPEN,
   _HIGHLIGHT_CLOSE,
+  _UNCLOSED_LISTING_OPEN,
+  _UNCLOSED_LITERAL_OPEN,
+  _UNCLOSED_PASSTHROUGH_OPEN,
+  _UNCLOSED_QUOTE_OPEN,
+  _UNCLOSED_TABLE_OPEN,
+  _UNCLOSED_LINE,
+  _FENCE_LIMIT,
+  _ERROR_SENTINEL,
 };
 
+// How far below an opening fence the scanner looks for its closing fence,
+// in lines. Past this many lines, a fence no longer closes the block: the
+// block ends there. 0 lifts the limit, leaving only the section heading rule
+// of scan_unclosed_fence.
+#ifndef ASCIIDOC_FENCE_LINE_BUDGET
+#define ASCIIDOC_FENCE_LINE_BUDGET 4096
+#endif
+
+typedef struct {
+  // Lines left in the body of a block without a closing fence.
+  uint32_t unclosed_lines;
+} Scanner;
+
 static inline void advance(TSLexer *lexer) { lexer->advance(lexer, false); }
 
 static inline void skip(TSLexer *lexer) { lexer->advance(lexer, true); }
 
 static inline bool is_digit(int32_t c) { return c >= '0' && c <= '9'; }
 
-static bool scan_unordered_or_thematic(TSLexer *lexer, const bool *valid_symbols, unsigned indent) {
+static bool scan_line_ending(TSLexer *lexer) {
+  while (lexer->lookahead == ' ' || lexer->lookahead == '\t') {
+    advance(lexer);
+  }
+  if (lexer->lookahead == '\r') {
+    advance(lexer);
+  }
+  if (lexer->lookahead != '\n') {
+    return false;
+  }
+  advance(lexer);
+  return true;
+}
+
+// `|===` or `||===`, the lexer being past the first pipe.
+static bool scan_table_delimiter(TSLexer *lexer) {
+  if (lexer->lookahead == '|') {
+    advance(lexer);
+  }
+  for (int i = 0; i < 3; i++) {
+    if (lexer->lookahead != '=') {
+      return false;
+    }
+    advance(lexer);
+  }
+  return true;
+}
+
+static bool scan_closing_fence(TSLexer *lexer, int32_t marker) {
+  advance(lexer);
+  if (marker == '|') {
+    return scan_table_delimiter(lexer) && scan_line_ending(lexer);
+  }
+  unsigned count = 1;
+  while (lexer->lookahead == marker) {
+    advance(lexer);
+    count++;
+  }
+  return count >= 4 && scan_line_ending(lexer);
+}
+
+static bool scan_section_heading(TSLexer *lexer) {
+  unsigned level = 0;
+  while (lexer->lookahead == '=' && level < 7) {
+    advance(lexer);
+    level++;
+  }
+  return level >= 2 && level <= 6 && (lexer->lookahead == ' ' || lexer->lookahead == '\t');
+}
+
+// Called past the delimiter of an opening fence. Looks for the closing
+// fence within the next ASCIIDOC_FENCE_LINE_BUDGET lines and returns false
+// if there is one, leaving the fence to the grammar's own tokens. Otherwise
+// the fence opens `symbol`, a block whose body ends at the next section
+// heading, at the line budget or at the end of the file; scan_unclosed_body
+// lets its lines in one at a time and then ends the block with _FENCE_LIMIT.
+// Typing an opening fence above other blocks thus leaves the rest of the
+// document as it was, and the lookahead of each fence is bounded, so an edit
+// below the fence does not re-scan to the end of the file.
+//
+// A section heading does not end the search outright, since a closed block
+// may hold lines such as `== Example`. Past a heading, a fence still closes
+// the block if the line above it is body text; after a blank line, a block
+// attribute list or a block title it is taken to open the next block, and
+// the search stops there. A closed block that holds a heading and whose
+// closing fence follows a blank line is read as unclosed.
+//
+// Any section heading ends the body, not only those at the level of the
+// enclosing section, which the scanner does not track. A deeper heading
+// belongs to the enclosing section either way.
+static bool scan_unclosed_fence(Scanner *scanner, TSLexer *lexer, int32_t marker,
+                                enum TokenType symbol) {
+  if (!scan_line_ending(lexer)) {
+    return false;
+  }
+  lexer->mark_end(lexer);
+
+  uint32_t lines = 0;
+  uint32_t heading = UINT32_MAX;
+  bool opens_block = false;
+  while (!lexer->eof(lexer) &&
+         (ASCIIDOC_FENCE_LINE_BUDGET == 0 || lines < ASCIIDOC_FENCE_LINE_BUDGET)) {
+    int32_t first = lexer->lookahead;
+    if (first == marker && scan_closing_fence(lexer, marker)) {
+      if (heading == UINT32_MAX || !opens_block) {
+        return false;
+      }
+      break;
+    }
+    if (first == '=' && heading == UINT32_MAX && scan_section_heading(lexer)) {
+      heading = lines;
+      if (ASCIIDOC_FENCE_LINE_BUDGET == 0) {
+        break;
+      }
+    }
+    bool blank = first == ' ' || first == '\t' || first == '\r' || first == '\n';
+    if (first == ' ' || first == '\t') {
+      while (lexer->lookahead == ' ' || lexer->lookahead == '\t') {
+        advance(lexer);
+      }
+      blank = lexer->lookahead == '\r' || lexer->lookahead == '\n' || lexer->eof(lexer);
+    }
+    opens_block = blank || first == '[' || first == '.';
+    while (lexer->lookahead != '\n' && !lexer->eof(lexer)) {
+      advance(lexer);
+    }
+    // A last line without a line ending is left to the blocks after the
+    // limit, as the body's content lines need one.
+    if (lexer->eof(lexer)) {
+      break;
+    }
+    advance(lexer);
+    lines++;
+  }
+
+  scanner->unclosed_lines = heading < lines ? heading : lines;
+  lexer->result_symbol = symbol;
+  return true;
+}
+
+static bool scan_unclosed_body(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols) {
+  // Zero-width: the line itself is lexed as in a closed block.
+  if (scanner->unclosed_lines > 0 && !lexer->eof(lexer)) {
+    if (!valid_symbols[_UNCLOSED_LINE]) {
+      return false;
+    }
+    scanner->unclosed_lines--;
+    lexer->result_symbol = _UNCLOSED_LINE;
+    lexer->mark_end(lexer);
+    return true;
+  }
+
+  if (!valid_symbols[_FENCE_LIMIT]) {
+    return false;
+  }
+  scanner->unclosed_lines = 0;
+  lexer->result_symbol = _FENCE_LIMIT;
+  lexer->mark_end(lexer);
+  return true;
+}
+
+static bool wants_unclosed_fence(const bool *valid_symbols, enum TokenType symbol,
+                                 unsigned indent) {
+  return indent == 0 && valid_symbols[symbol] && !valid_symbols[_ERROR_SENTINEL];
+}
+
+static bool scan_table_fence(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols,
+                             unsigned indent) {
+  if (!wants_unclosed_fence(valid_symbols, _UNCLOSED_TABLE_OPEN, indent)) {
+    return false;
+  }
+  advance(lexer);
+  return scan_table_delimiter(lexer) &&
+         scan_unclosed_fence(scanner, lexer, '|', _UNCLOSED_TABLE_OPEN);
+}
+
+static bool scan_unordered_or_thematic(Scanner *scanner, TSLexer *lexer,
+                                       const bool *valid_symbols, unsigned indent) {
+  int32_t marker = lexer->lookahead;
   bool wants_list =
     valid_symbols[_UNORDERED_LIST_MARKER] || valid_symbols[_INDENTED_UNORDERED_LIST_MARKER];
+  enum TokenType fence = marker == '-' ? _UNCLOSED_LISTING_OPEN : _UNCLOSED_QUOTE_OPEN;
+  bool wants_fence =
+    (marker == '-' || marker == '_') && wants_unclosed_fence(valid_symbols, fence, indent);
 
-  if (!valid_symbols[_THEMATIC_BREAK] && !wants_list) {
+  if (!valid_symbols[_THEMATIC_BREAK] && !wants_list && !wants_fence) {
     return false;
   }
 
-  int32_t marker = lexer->lookahead;
   if (marker != '*' && marker != '-' && marker != '_' && marker != '\'') {
     return false;
   }
@@ -49,6 +232,10 @@ static bool scan_unordered_or_thematic(TSLexer *lexer, const bool *valid_symbols
     return false;
   }
 
+  if (wants_fence && marker_count >= 4) {
+    return scan_unclosed_fence(scanner, lexer, marker, fence);
+  }
+
   bool has_space = false;
   while (lexer->lookahead == ' ' || lexer->lookahead == '\t') {
     advance(lexer);
@@ -167,7 +354,8 @@ static bool scan_block_quote_marker(TSLexer *lexer, const bool *valid_symbols, u
   return true;
 }
 
-static bool scan_dot_marker(TSLexer *lexer, const bool *valid_symbols, unsigned indent) {
+static bool scan_dot_marker(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols,
+                            unsigned indent) {
   if (lexer->lookahead != '.') {
     return false;
   }
@@ -176,13 +364,26 @@ static bool scan_dot_marker(TSLexer *lexer, const bool *valid_symbols, unsigned
     valid_symbols[_ORDERED_LIST_MARKER] || valid_symbols[_INDENTED_ORDERED_LIST_MARKER];
   bool wants_block_title = valid_symbols[_BLOCK_TITLE];
   bool wants_plain_dot = valid_symbols[_PLAIN_DOT];
+  // A plain dot ends after the first dot, which the lookahead for a closing
+  // fence would move past.
+  bool wants_fence =
+    !wants_plain_dot && wants_unclosed_fence(valid_symbols, _UNCLOSED_LITERAL_OPEN, indent);
 
-  if (!wants_list && !wants_block_title && !wants_plain_dot) {
+  if (!wants_list && !wants_block_title && !wants_plain_dot && !wants_fence) {
     return false;
   }
 
   advance(lexer);
 
+  if (wants_fence && lexer->lookahead == '.') {
+    unsigned count = 1;
+    while (lexer->lookahead == '.') {
+      advance(lexer);
+      count++;
+    }
+    return count >= 4 && scan_unclosed_fence(scanner, lexer, '.', _UNCLOSED_LITERAL_OPEN);
+  }
+
   if (wants_list && (lexer->lookahead == ' ' || lexer->lookahead == '\t')) {
     while (lexer->lookahead == ' ' || lexer->lookahead == '\t') {
       advance(lexer);
@@ -235,8 +436,10 @@ static bool scan_dot_marker(TSLexer *lexer, const bool *valid_symbols, unsigned
   return false;
 }
 
-static bool scan_list_continuation(TSLexer *lexer, const bool *valid_symbols) {
-  if (!valid_symbols[_LIST_CONTINUATION] || lexer->lookahead != '+') {
+static bool scan_list_continuation(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols,
+                                   unsigned indent) {
+  bool wants_fence = wants_unclosed_fence(valid_symbols, _UNCLOSED_PASSTHROUGH_OPEN, indent);
+  if ((!valid_symbols[_LIST_CONTINUATION] && !wants_fence) || lexer->lookahead != '+') {
     return false;
   }
 
@@ -246,6 +449,13 @@ static bool scan_list_continuation(TSLexer *lexer, const bool *valid_symbols) {
     count++;
   }
 
+  if (count >= 4) {
+    return wants_fence && scan_unclosed_fence(scanner, lexer, '+', _UNCLOSED_PASSTHROUGH_OPEN);
+  }
+  if (!valid_symbols[_LIST_CONTINUATION]) {
+    return false;
+  }
+
   while (lexer->lookahead == ' ' || lexer->lookahead == '\t') {
     skip(lexer);
   }
@@ -318,19 +528,38 @@ static bool scan_hash_marker(TSLexer *lexer, const bool *valid_symbols) {
 }
 
 void *tree_sitter_asciidoc_external_scanner_create(void) {
-  return NULL;
+  return ts_calloc(1, sizeof(Scanner));
 }
 
 unsigned tree_sitter_asciidoc_external_scanner_serialize(void *payload, char *buffer) {
-  return 0;
+  Scanner *scanner = payload;
+  // Most states carry no count; an empty state lets the parser share them.
+  if (scanner->unclosed_lines == 0) {
+    return 0;
+  }
+  memcpy(buffer, &scanner->unclosed_lines, sizeof(scanner->unclosed_lines));
+  return sizeof(scanner->unclosed_lines);
 }
 
-void tree_sitter_asciidoc_external_scanner_deserialize(void *payload, const char *buffer, unsigned length) {}
+void tree_sitter_asciidoc_external_scanner_deserialize(void *payload, const char *buffer, unsigned length) {
+  Scanner *scanner = payload;
+  scanner->unclosed_lines = 0;
+  if (length == sizeof(scanner->unclosed_lines)) {
+    memcpy(&scanner->unclosed_lines, buffer, sizeof(scanner->unclosed_lines));
+  }
+}
 
-void tree_sitter_asciidoc_external_scanner_destroy(void *payload) {}
+void tree_sitter_asciidoc_external_scanner_destroy(void *payload) {
+  ts_free(payload);
+}
 
 bool tree_sitter_asciidoc_external_scanner_scan(void *payload, TSLexer *lexer, const bool *valid_symbols) {
-  (void)payload;
+  Scanner *scanner = payload;
+
+  if (!valid_symbols[_ERROR_SENTINEL] &&
+      (valid_symbols[_UNCLOSED_LINE] || valid_symbols[_FENCE_LIMIT])) {
+    return scan_unclosed_body(scanner, lexer, valid_symbols);
+  }
 
   if (lexer->eof(lexer)) {
     return false;
@@ -356,7 +585,7 @@ bool tree_sitter_asciidoc_external_scanner_scan(void *payload, TSLexer *lexer, c
 
     int32_t marker = lexer->lookahead;
     if (marker == '*' || marker == '-' || marker == '_' || marker == '\'') {
-      return scan_unordered_or_thematic(lexer, valid_symbols, indent);
+      return scan_unordered_or_thematic(scanner, lexer, valid_symbols, indent);
     }
 
     if (marker == '>') {
@@ -364,11 +593,15 @@ bool tree_sitter_asciidoc_external_scanner_scan(void *payload, TSLexer *lexer, c
     }
 
     if (marker == '.') {
-      return scan_dot_marker(lexer, valid_symbols, indent);
+      return scan_dot_marker(scanner, lexer, valid_symbols, indent);
     }
 
     if (marker == '+') {
-      return scan_list_continuation(lexer, valid_symbols);
+      return scan_list_continuation(scanner, lexer, valid_symbols, indent);
+    }
+
+    if (marker == '|') {
+      return scan_table_fence(scanner, lexer, valid_symbols, indent);
     }
 
     if (is_digit(marker)) {
@@ -0,0 +1,384 @@
+// Parallel parse of every AsciiDoc file under a set of directories.
+//
+// Walks the given directories (hidden entries such as .git are skipped and
+// symbolic links are not followed), sorts the files by size and deals them
+// out, largest first, to one queue per worker thread. A worker parses its
+// own queue from the largest file down with a parser of its own; one that
+// runs dry steals the smallest file from the queue with the most bytes
+// left, so a few large files cannot leave the other threads idle at the end.
+// Files are read through TSAsciidocMappedFile.
+//
+// Prints one JSON object per file as soon as it is parsed, in completion
+// order: the path, bytes, parse time, node count and the number of ERROR
+// and MISSING nodes, or the reason the file could not be read. A summary
+// goes to stderr. --fail-on-error also exits with status 1 when any file
+// has a syntax error.
+//
+// Usage: adoc-parse [--threads N] [--ext EXT,...] [--fail-on-error] dir-or-file...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <tree_sitter/api.h>
+#include <unistd.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-mmap.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+#define DEFAULT_EXTENSIONS ".adoc,.asciidoc,.asc"
+
+typedef struct {
+  char *path;
+  uint64_t size;
+} File;
+
+typedef struct {
+  File *contents;
+  size_t size;
+  size_t capacity;
+} FileList;
+
+// Files [head, tail) of `files`, largest first. The owner takes from the
+// head and thieves from the tail.
+typedef struct {
+  pthread_mutex_t mutex;
+  File *files;
+  size_t head;
+  size_t tail;
+  uint64_t bytes;
+} Queue;
+
+typedef struct Pool Pool;
+
+typedef struct {
+  Pool *pool;
+  uint32_t index;
+  TSParser *parser;
+  uint32_t stolen;
+} Worker;
+
+struct Pool {
+  Queue *queues;
+  Worker *workers;
+  uint32_t count;
+
+  pthread_mutex_t totals_mutex;
+  uint64_t bytes;
+  uint32_t files;
+  uint32_t failed;
+  uint32_t with_errors;
+};
+
+static void file_list_push(FileList *list, char *path, uint64_t size) {
+  if (list->size == list->capacity) {
+    list->capacity = list->capacity ? list->capacity * 2 : 256;
+    list->contents = realloc(list->contents, list->capacity * sizeof(File));
+  }
+  list->contents[list->size++] = (File){path, size};
+}
+
+static bool has_extension(const char *name, const char *extensions) {
+  const char *dot = strrchr(name, '.');
+  if (!dot) {
+    return false;
+  }
+  size_t length = strlen(dot);
+  for (const char *start = extensions; *start;) {
+    const char *end = strchr(start, ',');
+    size_t size = end ? (size_t)(end - start) : strlen(start);
+    if (size == length && strncmp(start, dot, size) == 0) {
+      return true;
+    }
+    if (!end) {
+      break;
+    }
+    start = end + 1;
+  }
+  return false;
+}
+
+static char *join_path(const char *directory, const char *name) {
+  size_t length = strlen(directory);
+  bool slash = length > 0 && directory[length - 1] == '/';
+  char *path = malloc(length + strlen(name) + 2);
+  sprintf(path, slash ? "%s%s" : "%s/%s", directory, name);
+  return path;
+}
+
+static void walk(const char *directory, const char *extensions, FileList *files) {
+  DIR *dir = opendir(directory);
+  if (!dir) {
+    fprintf(stderr, "%s: %s\n", directory, strerror(errno));
+    return;
+  }
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    if (entry->d_name[0] == '.') {
+      continue;
+    }
+    char *path = join_path(directory, entry->d_name);
+    struct stat info;
+    if (lstat(path, &info) != 0) {
+      fprintf(stderr, "%s: %s\n", path, strerror(errno));
+      free(path);
+    } else if (S_ISDIR(info.st_mode)) {
+      walk(path, extensions, files);
+      free(path);
+    } else if (S_ISREG(info.st_mode) && has_extension(entry->d_name, extensions)) {
+      file_list_push(files, path, (uint64_t)info.st_size);
+    } else {
+      free(path);
+    }
+  }
+  closedir(dir);
+}
+
+static int compare_size_descending(const void *a, const void *b) {
+  uint64_t x = ((const File *)a)->size;
+  uint64_t y = ((const File *)b)->size;
+  return (x < y) - (x > y);
+}
+
+// ERROR and MISSING nodes under `root`. Subtrees without errors are skipped.
+static uint32_t count_error_nodes(TSNode root) {
+  if (!ts_node_has_error(root)) {
+    return 0;
+  }
+  uint32_t count = 0;
+  TSTreeCursor cursor = ts_tree_cursor_new(root);
+  for (;;) {
+    TSNode node = ts_tree_cursor_current_node(&cursor);
+    if (ts_node_is_error(node) || ts_node_is_missing(node)) {
+      count++;
+    }
+    if (ts_node_has_error(node) && ts_tree_cursor_goto_first_child(&cursor)) {
+      continue;
+    }
+    while (!ts_tree_cursor_goto_next_sibling(&cursor)) {
+      if (!ts_tree_cursor_goto_parent(&cursor)) {
+        ts_tree_cursor_delete(&cursor);
+        return count;
+      }
+    }
+  }
+}
+
+static void parse_file(Worker *worker, const File *file) {
+  Pool *pool = worker->pool;
+  TSAsciidocMappedFile *mapped = ts_asciidoc_mapped_file_open(file->path);
+  if (!mapped) {
+    const char *reason = strerror(errno);
+    flockfile(stdout);
+    printf("{\"path\": ");
+    tool_json_string(stdout, file->path);
+    printf(", \"error\": ");
+    tool_json_string(stdout, reason);
+    printf("}\n");
+    funlockfile(stdout);
+    pthread_mutex_lock(&pool->totals_mutex);
+    pool->failed++;
+    pthread_mutex_unlock(&pool->totals_mutex);
+    return;
+  }
+
+  uint64_t begin = tool_now_ns();
+  TSTree *tree = ts_asciidoc_mapped_file_parse(mapped, worker->parser, NULL);
+  uint64_t elapsed = tool_now_ns() - begin;
+  TSNode root = ts_tree_root_node(tree);
+  uint32_t nodes = ts_node_descendant_count(root);
+  uint32_t error_nodes = count_error_nodes(root);
+  uint32_t length = ts_asciidoc_mapped_file_length(mapped);
+  ts_tree_delete(tree);
+  ts_asciidoc_mapped_file_close(mapped);
+
+  flockfile(stdout);
+  printf("{\"path\": ");
+  tool_json_string(stdout, file->path);
+  printf(", \"bytes\": %u, \"parse_ms\": %.3f, \"nodes\": %u, \"error_nodes\": %u}\n", length,
+         elapsed / 1e6, nodes, error_nodes);
+  funlockfile(stdout);
+
+  pthread_mutex_lock(&pool->totals_mutex);
+  pool->files++;
+  pool->bytes += length;
+  if (error_nodes > 0) {
+    pool->with_errors++;
+  }
+  pthread_mutex_unlock(&pool->totals_mutex);
+}
+
+static bool take_own(Queue *queue, File *file) {
+  pthread_mutex_lock(&queue->mutex);
+  bool found = queue->head < queue->tail;
+  if (found) {
+    *file = queue->files[queue->head++];
+    queue->bytes -= file->size;
+  }
+  pthread_mutex_unlock(&queue->mutex);
+  return found;
+}
+
+// Takes the smallest file of the queue with the most bytes left. That queue
+// may have been emptied by the time it is locked again; the scan then
+// starts over.
+static bool steal(Worker *worker, File *file) {
+  Pool *pool = worker->pool;
+  for (;;) {
+    Queue *victim = NULL;
+    uint64_t most = 0;
+    for (uint32_t i = 0; i < pool->count; i++) {
+      Queue *queue = &pool->queues[i];
+      pthread_mutex_lock(&queue->mutex);
+      uint64_t bytes = queue->head < queue->tail ? queue->bytes + 1 : 0;
+      pthread_mutex_unlock(&queue->mutex);
+      if (i != worker->index && bytes > most) {
+        victim = queue;
+        most = bytes;
+      }
+    }
+    if (!victim) {
+      return false;
+    }
+    pthread_mutex_lock(&victim->mutex);
+    bool found = victim->head < victim->tail;
+    if (found) {
+      *file = victim->files[--victim->tail];
+      victim->bytes -= file->size;
+    }
+    pthread_mutex_unlock(&victim->mutex);
+    if (found) {
+      worker->stolen++;
+      return true;
+    }
+  }
+}
+
+static void *worker_main(void *payload) {
+  Worker *worker = payload;
+  worker->parser = ts_parser_new();
+  ts_parser_set_language(worker->parser, tree_sitter_asciidoc());
+  File file;
+  while (take_own(&worker->pool->queues[worker->index], &file) || steal(worker, &file)) {
+    parse_file(worker, &file);
+  }
+  ts_parser_delete(worker->parser);
+  worker->parser = NULL;
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  uint32_t thread_count = online > 0 ? (uint32_t)online : 1;
+  const char *extensions = DEFAULT_EXTENSIONS;
+  bool fail_on_error = false;
+
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "--threads") == 0 && first + 1 < argc) {
+      int value = atoi(argv[++first]);
+      thread_count = value > 0 ? (uint32_t)value : 1;
+    } else if (strcmp(argv[first], "--ext") == 0 && first + 1 < argc) {
+      extensions = argv[++first];
+    } else if (strcmp(argv[first], "--fail-on-error") == 0) {
+      fail_on_error = true;
+    } else {
+      break;
+    }
+  }
+  if (first >= argc || argv[first][0] == '-') {
+    fputs("usage: adoc-parse [--threads N] [--ext EXT,...] [--fail-on-error] dir-or-file...\n",
+          stderr);
+    return 2;
+  }
+
+  uint64_t begin = tool_now_ns();
+  FileList files = {0};
+  bool ok = true;
+  for (int i = first; i < argc; i++) {
+    struct stat info;
+    if (stat(argv[i], &info) != 0) {
+      fprintf(stderr, "%s: %s\n", argv[i], strerror(errno));
+      ok = false;
+    } else if (S_ISDIR(info.st_mode)) {
+      walk(argv[i], extensions, &files);
+    } else {
+      // Files named on the command line are parsed whatever their extension.
+      char *path = malloc(strlen(argv[i]) + 1);
+      strcpy(path, argv[i]);
+      file_list_push(&files, path, (uint64_t)info.st_size);
+    }
+  }
+  if (files.size > 0) {
+    qsort(files.contents, files.size, sizeof(File), compare_size_descending);
+  }
+  uint64_t walk_ns = tool_now_ns() - begin;
+
+  if (thread_count > files.size) {
+    thread_count = files.size > 0 ? (uint32_t)files.size : 1;
+  }
+  Pool pool = {.count = thread_count};
+  pool.queues = calloc(thread_count, sizeof(Queue));
+  pool.workers = calloc(thread_count, sizeof(Worker));
+  pthread_mutex_init(&pool.totals_mutex, NULL);
+
+  // Dealing the sorted files round-robin gives every queue a share of the
+  // large ones, in descending order.
+  size_t per_queue = files.size / thread_count + 1;
+  for (uint32_t i = 0; i < thread_count; i++) {
+    pthread_mutex_init(&pool.queues[i].mutex, NULL);
+    pool.queues[i].files = malloc(per_queue * sizeof(File));
+    pool.workers[i] = (Worker){.pool = &pool, .index = i};
+  }
+  for (size_t i = 0; i < files.size; i++) {
+    Queue *queue = &pool.queues[i % thread_count];
+    queue->files[queue->tail++] = files.contents[i];
+    queue->bytes += files.contents[i].size;
+  }
+
+  pthread_t *threads = calloc(thread_count, sizeof(pthread_t));
+  uint32_t started = 1;
+  while (started < thread_count &&
+         pthread_create(&threads[started], NULL, worker_main, &pool.workers[started]) == 0) {
+    started++;
+  }
+  // The calling thread is worker 0. Queues whose thread did not start are
+  // emptied by stealing.
+  worker_main(&pool.workers[0]);
+  for (uint32_t i = 1; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  uint64_t elapsed = tool_now_ns() - begin;
+
+  uint32_t stolen = 0;
+  for (uint32_t i = 0; i < thread_count; i++) {
+    stolen += pool.workers[i].stolen;
+    pthread_mutex_destroy(&pool.queues[i].mutex);
+    free(pool.queues[i].files);
+  }
+  double seconds = elapsed / 1e9;
+  fprintf(stderr,
+          "%u files, %.1f MB in %.2f s (walk %.2f s) on %u threads: %.0f files/s, %.1f MB/s\n"
+          "%u with syntax errors, %u unreadable, %u stolen\n",
+          pool.files, pool.bytes / 1e6, seconds, walk_ns / 1e9, started, pool.files / seconds,
+          pool.bytes / 1e6 / seconds, pool.with_errors, pool.failed, stolen);
+
+  for (size_t i = 0; i < files.size; i++) {
+    free(files.contents[i].path);
+  }
+  free(files.contents);
+  free(threads);
+  free(pool.queues);
+  free(pool.workers);
+  pthread_mutex_destroy(&pool.totals_mutex);
+  ok = ok && pool.failed == 0 && !(fail_on_error && pool.with_errors > 0);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,332 @@
+// Parse throughput benchmark for the static grammar library.
+//
+// Parses each file from scratch `--iterations` times and reports the median
+// parse time, MB/s, node count, nodes/s and cost per byte, followed by the
+// process's peak RSS. Run on the per-construct documents written by
+// `make bench` to get the cost of each construct in isolation.
+//
+// --isolate parses every file in its own child process so the reported peak
+// RSS belongs to that file alone. --stack makes one extra, untimed parse with
+// a logger attached to record the largest number of GLR stack versions.
+// --calibrate adds a machine speed reference (see `calibrate`) that
+// scripts/perf-gate.js uses to compare results from different machines.
+// --mmap parses each file from a memory mapping (TSAsciidocMappedFile)
+// instead of a heap copy. Peak RSS still counts the mapped pages the parse
+// touched, but those are clean page cache rather than anonymous memory.
+//
+// Usage: bench [--iterations N] [--isolate] [--stack] [--calibrate] [--mmap] [--json] file...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <tree_sitter/api.h>
+#include <unistd.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-mmap.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+typedef struct {
+  const char *path;
+  size_t bytes;
+  uint64_t parse_ns;
+  uint32_t nodes;
+  uint32_t max_stack_versions;
+  long peak_rss_kb;
+  bool has_error;
+} FileResult;
+
+typedef struct {
+  unsigned iterations;
+  bool isolate;
+  bool stack;
+  bool mmap;
+} Options;
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+// The runtime logs "process version:%u, version_count:%u, ..." before every
+// step of every stack version; the largest count is the widest GLR fork.
+static void log_stack_versions(void *payload, TSLogType type, const char *message) {
+  if (type != TSLogTypeParse) {
+    return;
+  }
+  const char *count = strstr(message, "version_count:");
+  if (count) {
+    uint32_t versions = (uint32_t)strtoul(count + strlen("version_count:"), NULL, 10);
+    uint32_t *max = payload;
+    if (versions > *max) {
+      *max = versions;
+    }
+  }
+}
+
+// Parses the heap copy `source`, or the mapping if there is one.
+static TSTree *parse(TSParser *parser, const char *source, size_t length,
+                     const TSAsciidocMappedFile *mapped) {
+  return mapped ? ts_asciidoc_mapped_file_parse(mapped, parser, NULL)
+                : ts_parser_parse_string(parser, NULL, source, (uint32_t)length);
+}
+
+static bool bench_file(TSParser *parser, const char *path, const Options *options,
+                       FileResult *result) {
+  size_t length;
+  char *source = NULL;
+  TSAsciidocMappedFile *mapped = NULL;
+  if (options->mmap) {
+    mapped = ts_asciidoc_mapped_file_open(path);
+    if (!mapped) {
+      fprintf(stderr, "%s: %s\n", path, strerror(errno));
+      return false;
+    }
+    length = ts_asciidoc_mapped_file_length(mapped);
+  } else {
+    source = tool_read_file(path, &length);
+    if (!source) {
+      return false;
+    }
+  }
+
+  uint64_t *samples = calloc(options->iterations, sizeof(uint64_t));
+  result->path = path;
+  result->bytes = length;
+
+  for (unsigned i = 0; i < options->iterations; i++) {
+    uint64_t start = tool_now_ns();
+    TSTree *tree = parse(parser, source, length, mapped);
+    samples[i] = tool_now_ns() - start;
+
+    if (i == 0) {
+      TSNode root = ts_tree_root_node(tree);
+      result->nodes = ts_node_descendant_count(root);
+      result->has_error = ts_node_has_error(root);
+    }
+    ts_tree_delete(tree);
+  }
+
+  qsort(samples, options->iterations, sizeof(uint64_t), compare_u64);
+  result->parse_ns = samples[options->iterations / 2];
+
+  if (options->stack) {
+    ts_parser_set_logger(parser, (TSLogger){&result->max_stack_versions, log_stack_versions});
+    ts_tree_delete(parse(parser, source, length, mapped));
+    ts_parser_set_logger(parser, (TSLogger){NULL, NULL});
+  }
+
+  result->peak_rss_kb = tool_peak_rss_kb();
+  free(samples);
+  free(source);
+  ts_asciidoc_mapped_file_close(mapped);
+  return true;
+}
+
+// Runs `bench_file` in a forked child and reads the result back over a pipe.
+static bool bench_file_isolated(TSParser *parser, const char *path, const Options *options,
+                                FileResult *result) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    perror("pipe");
+    return false;
+  }
+
+  fflush(NULL);
+  pid_t child = fork();
+  if (child < 0) {
+    perror("fork");
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+
+  if (child == 0) {
+    close(fds[0]);
+    bool ok = bench_file(parser, path, options, result);
+    ok = ok && write(fds[1], result, sizeof(*result)) == (ssize_t)sizeof(*result);
+    _exit(ok ? 0 : 1);
+  }
+
+  close(fds[1]);
+  ssize_t received = read(fds[0], result, sizeof(*result));
+  close(fds[0]);
+
+  int status;
+  waitpid(child, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || received != (ssize_t)sizeof(*result)) {
+    fprintf(stderr, "%s: benchmark child failed\n", path);
+    return false;
+  }
+  result->path = path;
+  return true;
+}
+
+// A fixed, branchy byte-classification loop, roughly shaped like a lexer. Its
+// MB/s only depends on the machine, so dividing parse throughput by it gives a
+// number that can be compared between a laptop and a CI runner.
+static double calibrate(void) {
+  static const char pattern[] = "== Title\n* item with *bold* and `code` text.\n|===\n| a | b\n";
+  size_t length = 16 << 20;
+  char *buffer = malloc(length);
+  for (size_t i = 0; i < length; i++) {
+    buffer[i] = pattern[i % (sizeof(pattern) - 1)];
+  }
+
+  uint64_t best = UINT64_MAX;
+  volatile unsigned sink = 0;
+  for (unsigned round = 0; round < 5; round++) {
+    unsigned counts[4] = {0};
+    uint64_t start = tool_now_ns();
+    for (size_t i = 0; i < length; i++) {
+      switch (buffer[i]) {
+        case '\n':
+          counts[0]++;
+          break;
+        case '*':
+        case '`':
+        case '|':
+        case '=':
+          counts[1] += i & 1;
+          break;
+        case ' ':
+          counts[2]++;
+          break;
+        default:
+          counts[3] += (unsigned)buffer[i];
+      }
+    }
+    uint64_t elapsed = tool_now_ns() - start;
+    sink += counts[0] + counts[1] + counts[2] + counts[3];
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+
+  free(buffer);
+  return (double)length / 1e6 / ((double)best / 1e9);
+}
+
+static double mb_per_second(const FileResult *result) {
+  return result->parse_ns ? (double)result->bytes / 1e6 / ((double)result->parse_ns / 1e9) : 0;
+}
+
+static double nodes_per_second(const FileResult *result) {
+  return result->parse_ns ? (double)result->nodes / ((double)result->parse_ns / 1e9) : 0;
+}
+
+static double ns_per_byte(const FileResult *result) {
+  return result->bytes ? (double)result->parse_ns / (double)result->bytes : 0;
+}
+
+static void print_table(const FileResult *results, unsigned count, const Options *options,
+                        double calibration) {
+  printf("%-40s %12s %10s %9s %10s %10s %8s %9s %s\n", "file", "bytes", "ms", "MB/s", "nodes",
+         "Mnodes/s", "ns/byte", "RSS MiB", options->stack ? "versions errors" : "errors");
+  for (unsigned i = 0; i < count; i++) {
+    const FileResult *r = &results[i];
+    printf("%-40s %12zu %10.3f %9.2f %10u %10.2f %8.1f %9.1f ", r->path, r->bytes,
+           (double)r->parse_ns / 1e6, mb_per_second(r), r->nodes, nodes_per_second(r) / 1e6,
+           ns_per_byte(r), (double)r->peak_rss_kb / 1024);
+    if (options->stack) {
+      printf("%8u ", r->max_stack_versions);
+    }
+    printf("%s\n", r->has_error ? "yes" : "no");
+  }
+  if (!options->isolate) {
+    printf("\npeak RSS: %.1f MiB\n", (double)tool_peak_rss_kb() / 1024);
+  }
+  if (calibration > 0) {
+    printf("calibration: %.1f MB/s\n", calibration);
+  }
+}
+
+static void print_json(const FileResult *results, unsigned count, const Options *options,
+                       double calibration) {
+  printf("{\n  \"peak_rss_kb\": %ld,\n", tool_peak_rss_kb());
+  if (calibration > 0) {
+    printf("  \"calibration_mb_per_s\": %.3f,\n", calibration);
+  }
+  printf("  \"files\": [\n");
+  for (unsigned i = 0; i < count; i++) {
+    const FileResult *r = &results[i];
+    printf("    {\"file\": ");
+    tool_json_string(stdout, r->path);
+    printf(", \"bytes\": %zu, \"parse_ns\": %llu, \"mb_per_s\": %.3f, \"nodes\": %u, "
+           "\"nodes_per_s\": %.0f, \"ns_per_byte\": %.3f, \"peak_rss_kb\": %ld, ",
+           r->bytes, (unsigned long long)r->parse_ns, mb_per_second(r), r->nodes,
+           nodes_per_second(r), ns_per_byte(r), r->peak_rss_kb);
+    if (options->stack) {
+      printf("\"max_stack_versions\": %u, ", r->max_stack_versions);
+    }
+    printf("\"has_error\": %s}%s\n", r->has_error ? "true" : "false", i + 1 < count ? "," : "");
+  }
+  printf("  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+  Options options = {.iterations = 3};
+  bool json = false;
+  bool calibration_requested = false;
+  int first_file = 1;
+
+  for (; first_file < argc && argv[first_file][0] == '-'; first_file++) {
+    const char *arg = argv[first_file];
+    if (strcmp(arg, "--iterations") == 0 && first_file + 1 < argc) {
+      options.iterations = (unsigned)atoi(argv[++first_file]);
+      if (options.iterations == 0) {
+        options.iterations = 1;
+      }
+    } else if (strcmp(arg, "--isolate") == 0) {
+      options.isolate = true;
+    } else if (strcmp(arg, "--stack") == 0) {
+      options.stack = true;
+    } else if (strcmp(arg, "--calibrate") == 0) {
+      calibration_requested = true;
+    } else if (strcmp(arg, "--mmap") == 0) {
+      options.mmap = true;
+    } else if (strcmp(arg, "--json") == 0) {
+      json = true;
+    } else {
+      break;
+    }
+  }
+
+  if (first_file >= argc) {
+    fputs("usage: bench [--iterations N] [--isolate] [--stack] [--calibrate] [--mmap] [--json] "
+          "file...\n",
+          stderr);
+    return 2;
+  }
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+
+  unsigned count = 0;
+  FileResult *results = calloc((size_t)(argc - first_file), sizeof(FileResult));
+  for (int i = first_file; i < argc; i++) {
+    bool ok = options.isolate ? bench_file_isolated(parser, argv[i], &options, &results[count])
+                              : bench_file(parser, argv[i], &options, &results[count]);
+    if (ok) {
+      count++;
+    }
+  }
+
+  double calibration = calibration_requested ? calibrate() : 0;
+  if (json) {
+    print_json(results, count, &options, calibration);
+  } else {
+    print_table(results, count, &options, calibration);
+  }
+
+  free(results);
+  ts_parser_delete(parser);
+  return count == (unsigned)(argc - first_file) ? 0 : 1;
+}
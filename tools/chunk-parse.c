@@ -0,0 +1,192 @@
+// Parallel chunked parsing of large documents.
+//
+// Parses each file twice, serially and with ts_asciidoc_chunked_parser_parse,
+// and reports the time of both, the prescan time, the number of split points
+// and chunks, and the speedup. --check also compares the S-expression of the
+// chunked tree with that of the serial tree and fails on any difference.
+//
+// --corpus reads test/corpus files instead and checks every example input
+// on its own; use it with --min-chunk 1 so that every split point is cut.
+//
+// Usage: chunk-parse [--threads N] [--min-chunk SIZE] [--check] [--corpus] [--json] file...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+#include <unistd.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-chunked.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+typedef struct {
+  TSParser *parser;
+  TSAsciidocChunkedParser *chunked;
+  bool check;
+  bool json;
+} Context;
+
+// Returns false if the chunked tree differs from the serial one.
+static bool compare_trees(const TSTree *serial, const TSAsciidocChunkedTree *chunked,
+                          const char *label) {
+  char *expected = ts_node_string(ts_tree_root_node(serial));
+  char *actual = ts_asciidoc_chunked_tree_string(chunked);
+  bool equal = strcmp(expected, actual) == 0;
+  if (!equal) {
+    size_t i = 0;
+    while (expected[i] && expected[i] == actual[i]) {
+      i++;
+    }
+    size_t from = i > 40 ? i - 40 : 0;
+    fprintf(stderr, "%s: chunked tree differs at character %zu\n  serial:  %.80s\n"
+                    "  chunked: %.80s\n",
+            label, i, expected + from, actual + from);
+  }
+  free(expected);
+  free(actual);
+  return equal;
+}
+
+static bool run_file(Context *context, const char *path) {
+  size_t length;
+  char *source = tool_read_file(path, &length);
+  if (!source) {
+    return false;
+  }
+
+  uint64_t begin = tool_now_ns();
+  uint32_t split_count;
+  ts_asciidoc_chunked_parser_split_points(context->chunked, source, (uint32_t)length,
+                                          &split_count);
+  uint64_t prescan_ns = tool_now_ns() - begin;
+
+  begin = tool_now_ns();
+  TSAsciidocChunkedTree *chunked =
+    ts_asciidoc_chunked_parser_parse(context->chunked, source, (uint32_t)length);
+  uint64_t chunked_ns = tool_now_ns() - begin;
+
+  begin = tool_now_ns();
+  TSTree *serial = ts_parser_parse_string(context->parser, NULL, source, (uint32_t)length);
+  uint64_t serial_ns = tool_now_ns() - begin;
+
+  bool ok = !context->check || compare_trees(serial, chunked, path);
+  uint32_t chunk_count = ts_asciidoc_chunked_tree_chunk_count(chunked);
+  double speedup = (double)serial_ns / (double)chunked_ns;
+  if (context->json) {
+    printf("{\"path\": ");
+    tool_json_string(stdout, path);
+    printf(", \"bytes\": %zu, \"split_points\": %u, \"chunks\": %u, \"prescan_ms\": %.3f, "
+           "\"serial_ms\": %.3f, \"chunked_ms\": %.3f, \"speedup\": %.2f",
+           length, split_count, chunk_count, prescan_ns / 1e6, serial_ns / 1e6,
+           chunked_ns / 1e6, speedup);
+    if (context->check) {
+      printf(", \"match\": %s", ok ? "true" : "false");
+    }
+    printf("}\n");
+  } else {
+    printf("%-32s %10zu %7u %7u %10.2f %10.2f %10.2f %7.2fx%s\n", path, length, split_count,
+           chunk_count, prescan_ns / 1e6, serial_ns / 1e6, chunked_ns / 1e6, speedup,
+           context->check ? (ok ? "  match" : "  DIFFERS") : "");
+  }
+
+  ts_tree_delete(serial);
+  ts_asciidoc_chunked_tree_delete(chunked);
+  free(source);
+  return ok;
+}
+
+static bool run_corpus(Context *context, const char *path, uint32_t *checked) {
+  uint32_t count;
+  ToolCorpusExample *examples = tool_read_corpus(path, &count);
+  if (!examples) {
+    return false;
+  }
+  bool ok = true;
+  for (uint32_t i = 0; i < count; i++) {
+    const ToolCorpusExample *example = &examples[i];
+    TSTree *serial =
+      ts_parser_parse_string(context->parser, NULL, example->input, example->input_length);
+    TSAsciidocChunkedTree *chunked =
+      ts_asciidoc_chunked_parser_parse(context->chunked, example->input, example->input_length);
+    char label[512];
+    snprintf(label, sizeof(label), "%s:%u (%s)", path, example->line, example->name);
+    if (!compare_trees(serial, chunked, label)) {
+      ok = false;
+    }
+    ts_tree_delete(serial);
+    ts_asciidoc_chunked_tree_delete(chunked);
+    (*checked)++;
+  }
+  tool_free_corpus(examples, count);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  uint32_t threads = online > 1 ? (uint32_t)online - 1 : 0;
+  uint64_t min_chunk = 0;
+  bool corpus = false;
+  Context context = {0};
+
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "--threads") == 0 && first + 1 < argc) {
+      threads = (uint32_t)atoi(argv[++first]);
+    } else if (strcmp(argv[first], "--min-chunk") == 0 && first + 1 < argc) {
+      min_chunk = tool_parse_size(argv[++first]);
+      if (min_chunk == 0 || min_chunk > UINT32_MAX) {
+        fprintf(stderr, "chunk-parse: bad size %s\n", argv[first]);
+        return 2;
+      }
+    } else if (strcmp(argv[first], "--check") == 0) {
+      context.check = true;
+    } else if (strcmp(argv[first], "--corpus") == 0) {
+      corpus = true;
+    } else if (strcmp(argv[first], "--json") == 0) {
+      context.json = true;
+    } else {
+      break;
+    }
+  }
+  if (first >= argc || argv[first][0] == '-') {
+    fputs("usage: chunk-parse [--threads N] [--min-chunk SIZE] [--check] [--corpus] [--json] "
+          "file...\n",
+          stderr);
+    return 2;
+  }
+
+  context.parser = ts_parser_new();
+  ts_parser_set_language(context.parser, tree_sitter_asciidoc());
+  context.chunked = ts_asciidoc_chunked_parser_new(threads);
+  if (min_chunk) {
+    ts_asciidoc_chunked_parser_set_min_chunk_bytes(context.chunked, (uint32_t)min_chunk);
+  }
+
+  bool ok = true;
+  if (corpus) {
+    uint32_t checked = 0;
+    for (int i = first; i < argc; i++) {
+      ok = run_corpus(&context, argv[i], &checked) && ok;
+    }
+    printf("%u corpus examples, chunked trees %s\n", checked,
+           ok ? "match the serial trees" : "DIFFER");
+  } else {
+    if (!context.json) {
+      printf("%u worker threads\n", threads);
+      printf("%-32s %10s %7s %7s %10s %10s %10s %8s\n", "file", "bytes", "splits", "chunks",
+             "prescan ms", "serial ms", "chunked ms", "speedup");
+    }
+    for (int i = first; i < argc; i++) {
+      ok = run_file(&context, argv[i]) && ok;
+    }
+  }
+
+  ts_asciidoc_chunked_parser_delete(context.chunked);
+  ts_parser_delete(context.parser);
+  return ok ? 0 : 1;
+}
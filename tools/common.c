@@ -0,0 +1,268 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+uint64_t tool_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+long tool_peak_rss_kb(void) {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+char *tool_read_file(const char *path, size_t *length) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    return NULL;
+  }
+
+  size_t capacity = 1 << 16;
+  size_t size = 0;
+  char *buffer = malloc(capacity);
+  while (buffer) {
+    if (size + 1 == capacity) {
+      char *grown = realloc(buffer, capacity * 2);
+      if (!grown) {
+        free(buffer);
+        buffer = NULL;
+        break;
+      }
+      buffer = grown;
+      capacity *= 2;
+    }
+
+    size_t read = fread(buffer + size, 1, capacity - size - 1, file);
+    if (read == 0) {
+      break;
+    }
+    size += read;
+  }
+
+  if (!buffer || ferror(file)) {
+    fprintf(stderr, "%s: read failed\n", path);
+    free(buffer);
+    fclose(file);
+    return NULL;
+  }
+
+  fclose(file);
+  buffer[size] = '\0';
+  *length = size;
+  return buffer;
+}
+
+void tool_json_string(FILE *out, const char *string) {
+  fputc('"', out);
+  for (const unsigned char *c = (const unsigned char *)string; *c; c++) {
+    switch (*c) {
+      case '"':
+        fputs("\\\"", out);
+        break;
+      case '\\':
+        fputs("\\\\", out);
+        break;
+      case '\n':
+        fputs("\\n", out);
+        break;
+      case '\r':
+        fputs("\\r", out);
+        break;
+      case '\t':
+        fputs("\\t", out);
+        break;
+      default:
+        if (*c < 0x20) {
+          fprintf(out, "\\u%04x", *c);
+        } else {
+          fputc(*c, out);
+        }
+    }
+  }
+  fputc('"', out);
+}
+
+uint64_t tool_parse_size(const char *text) {
+  char *end;
+  errno = 0;
+  unsigned long long value = strtoull(text, &end, 10);
+  if (errno || end == text) {
+    return 0;
+  }
+
+  switch (*end) {
+    case '\0':
+      return value;
+    case 'k':
+    case 'K':
+      value <<= 10;
+      break;
+    case 'm':
+    case 'M':
+      value <<= 20;
+      break;
+    case 'g':
+    case 'G':
+      value <<= 30;
+      break;
+    default:
+      return 0;
+  }
+
+  return end[1] == '\0' || ((end[1] == 'b' || end[1] == 'B') && end[2] == '\0') ? value : 0;
+}
+
+// Length of the line at `start` without its line ending.
+static size_t line_length(const char *text, size_t start, size_t length) {
+  const char *newline = memchr(text + start, '\n', length - start);
+  size_t end = newline ? (size_t)(newline - text) : length;
+  return end > start && text[end - 1] == '\r' ? end - 1 - start : end - start;
+}
+
+static size_t next_line(const char *text, size_t start, size_t length) {
+  const char *newline = memchr(text + start, '\n', length - start);
+  return newline ? (size_t)(newline - text) + 1 : length;
+}
+
+static bool is_rule(const char *line, size_t length, char c, size_t minimum) {
+  if (length < minimum) {
+    return false;
+  }
+  for (size_t i = 0; i < length; i++) {
+    if (line[i] != c) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static char *copy_trimmed(const char *text, size_t start, size_t end) {
+  while (start < end && isspace((unsigned char)text[start])) {
+    start++;
+  }
+  while (end > start && isspace((unsigned char)text[end - 1])) {
+    end--;
+  }
+  char *copy = malloc(end - start + 1);
+  memcpy(copy, text + start, end - start);
+  copy[end - start] = '\0';
+  return copy;
+}
+
+// Fills in the example whose body (input, divider and expected tree) is
+// [start, end).
+static bool split_example(const char *text, size_t start, size_t end,
+                          ToolCorpusExample *example) {
+  size_t divider = end;
+  size_t divider_length = 0;
+  for (size_t line = start; line < end; line = next_line(text, line, end)) {
+    size_t length = line_length(text, line, end);
+    if (length >= divider_length && is_rule(text + line, length, '-', 3)) {
+      divider = line;
+      divider_length = length;
+    }
+  }
+  if (divider == end) {
+    return false;
+  }
+
+  size_t input_end = divider;
+  if (input_end > start && text[input_end - 1] == '\n') {
+    input_end--;
+    if (input_end > start && text[input_end - 1] == '\r') {
+      input_end--;
+    }
+  }
+  example->input_length = (uint32_t)(input_end - start);
+  example->input = malloc(example->input_length + 1);
+  memcpy(example->input, text + start, example->input_length);
+  example->input[example->input_length] = '\0';
+  example->expected = copy_trimmed(text, next_line(text, divider, end), end);
+  return true;
+}
+
+ToolCorpusExample *tool_read_corpus(const char *path, uint32_t *count) {
+  size_t length;
+  char *text = tool_read_file(path, &length);
+  if (!text) {
+    return NULL;
+  }
+  size_t delimiter = line_length(text, 0, length);
+  if (!is_rule(text, delimiter, '=', 3)) {
+    fprintf(stderr, "%s: not a corpus file\n", path);
+    free(text);
+    return NULL;
+  }
+
+  ToolCorpusExample *examples = NULL;
+  uint32_t size = 0, capacity = 0;
+  size_t header = 0;
+  uint32_t row = 1;
+  while (header < length) {
+    // Header: delimiter, name, delimiter.
+    size_t name = next_line(text, header, length);
+    size_t closing = next_line(text, name, length);
+    size_t body = next_line(text, closing, length);
+    if (line_length(text, closing, length) != delimiter ||
+        !is_rule(text + closing, delimiter, '=', 3)) {
+      fprintf(stderr, "%s:%u: malformed example header\n", path, row);
+      break;
+    }
+
+    size_t end = body;
+    uint32_t body_rows = 0;
+    while (end < length && !(line_length(text, end, length) == delimiter &&
+                             is_rule(text + end, delimiter, '=', 3))) {
+      end = next_line(text, end, length);
+      body_rows++;
+    }
+
+    if (size == capacity) {
+      capacity = capacity ? capacity * 2 : 32;
+      examples = realloc(examples, capacity * sizeof(ToolCorpusExample));
+    }
+    ToolCorpusExample *example = &examples[size];
+    memset(example, 0, sizeof(*example));
+    example->line = row;
+    example->name = copy_trimmed(text, name, closing);
+    if (split_example(text, body, end, example)) {
+      size++;
+    } else {
+      fprintf(stderr, "%s:%u: example has no expected tree\n", path, row);
+      free(example->name);
+    }
+    row += 3 + body_rows;
+    header = end;
+  }
+
+  free(text);
+  *count = size;
+  return examples;
+}
+
+void tool_free_corpus(ToolCorpusExample *examples, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    free(examples[i].name);
+    free(examples[i].input);
+    free(examples[i].expected);
+  }
+  free(examples);
+}
@@ -0,0 +1,49 @@
+#ifndef TREE_SITTER_ASCIIDOC_TOOLS_COMMON_H_
+#define TREE_SITTER_ASCIIDOC_TOOLS_COMMON_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Helpers shared by the native benchmark and analysis tools in this directory.
+
+// Monotonic clock in nanoseconds.
+uint64_t tool_now_ns(void);
+
+// Peak resident set size of the calling process in KiB.
+long tool_peak_rss_kb(void);
+
+// Reads a whole file into a NUL-terminated heap buffer. Returns NULL and
+// prints a message to stderr on failure.
+char *tool_read_file(const char *path, size_t *length);
+
+// Writes `string` to `out` as a JSON string literal, including the quotes.
+void tool_json_string(FILE *out, const char *string);
+
+// Parses sizes such as "4096", "10K", "16M" or "1G" (binary multiples).
+// Returns 0 for malformed input.
+uint64_t tool_parse_size(const char *text);
+
+// One example of a tree-sitter corpus file (test/corpus/*.txt).
+typedef struct {
+  char *name;
+  // The input without the line ending before the `---` divider, as
+  // `tree-sitter test` parses it.
+  char *input;
+  uint32_t input_length;
+  // The expected S-expression as written, with surrounding whitespace
+  // removed.
+  char *expected;
+  // 1-based line of the example's header.
+  uint32_t line;
+} ToolCorpusExample;
+
+// Splits a corpus file into its examples. The header delimiter is the row of
+// `=` on the file's first line. Like `tree-sitter test`, the divider is the
+// longest row of three or more `-`, the last one if several are as long.
+// Returns NULL and prints a message to stderr on failure.
+ToolCorpusExample *tool_read_corpus(const char *path, uint32_t *count);
+
+void tool_free_corpus(ToolCorpusExample *examples, uint32_t count);
+
+#endif // TREE_SITTER_ASCIIDOC_TOOLS_COMMON_H_
@@ -0,0 +1,471 @@
+// Parallel corpus test runner.
+//
+// Loads every example of the given test/corpus files, parses them on
+// --threads threads with one parser each, and compares each tree with the
+// expected S-expression the way `tree-sitter test` does: whitespace and
+// `;` comments in the expected tree are ignored, and field names are only
+// compared if the expected tree has any. An example that takes longer than
+// --timeout-ms fails as a timeout, as the old per-file batches did.
+//
+// Each example's parse time is the best of --iterations parses. With
+// --baseline, examples are compared with a baseline written earlier by
+// --write-baseline:
+//
+//   - an example whose node count changed while its expected S-expression
+//     did not is flagged; anonymous and hidden nodes the S-expression leaves
+//     out changed, which is usually an unintended grammar change;
+//   - an example more than --max-slowdown percent and --min-slowdown-us
+//     slower than its baseline time is flagged as a time regression.
+//
+// Mismatches, timeouts and node count changes fail the run; time regressions
+// only do with --strict-time, parse times of a few microseconds being noisy.
+// Baselines are machine specific: write and compare them on the same host.
+//
+// Usage: corpus-test [--threads N] [--iterations N] [--timeout-ms N] [--filter TEXT]
+//                    [--baseline FILE] [--write-baseline FILE] [--max-slowdown PCT]
+//                    [--min-slowdown-us N] [--strict-time] [--json] file...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+#include <unistd.h>
+
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+typedef struct {
+  const char *path;
+  const ToolCorpusExample *example;
+  uint64_t expected_hash;
+  // Results.
+  bool passed;
+  bool timed_out;
+  uint64_t parse_ns;
+  uint32_t nodes;
+  char *expected;
+  char *actual;
+  // Baseline comparison.
+  bool in_baseline;
+  uint64_t baseline_ns;
+  uint32_t baseline_nodes;
+  bool nodes_changed;
+  bool slower;
+} Test;
+
+typedef struct {
+  Test *tests;
+  uint32_t *order;
+  uint32_t count;
+  uint32_t next;
+  pthread_mutex_t mutex;
+  unsigned iterations;
+  uint64_t timeout_micros;
+} Shared;
+
+// FNV-1a, to tell whether an example's expected tree changed since the
+// baseline was written.
+static uint64_t hash(const char *text) {
+  uint64_t h = 0xcbf29ce484222325u;
+  for (; *text; text++) {
+    h = (h ^ (unsigned char)*text) * 0x100000001b3u;
+  }
+  return h;
+}
+
+// Rewrites an S-expression as parentheses and atoms separated by single
+// spaces, without comments, and without field names unless `keep_fields`.
+// Sets `*has_fields` if there were any.
+static char *normalize(const char *text, bool keep_fields, bool *has_fields) {
+  size_t length = strlen(text);
+  char *out = malloc(length + 1);
+  size_t size = 0;
+  const char *p = text;
+  while (*p) {
+    if (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+      p++;
+      continue;
+    }
+    if (*p == ';') {
+      while (*p && *p != '\n') {
+        p++;
+      }
+      continue;
+    }
+    const char *start = p;
+    if (*p == '(' || *p == ')') {
+      p++;
+    } else if (*p == '"') {
+      for (p++; *p && *p != '"'; p++) {
+        if (*p == '\\' && p[1]) {
+          p++;
+        }
+      }
+      if (*p) {
+        p++;
+      }
+    } else {
+      while (*p && !strchr(" \t\r\n()", *p)) {
+        p++;
+      }
+    }
+    size_t token = (size_t)(p - start);
+    if (*start != '"' && token > 1 && start[token - 1] == ':') {
+      if (has_fields) {
+        *has_fields = true;
+      }
+      if (!keep_fields) {
+        continue;
+      }
+    }
+    if (size > 0 && *start != ')' && out[size - 1] != '(') {
+      out[size++] = ' ';
+    }
+    memcpy(out + size, start, token);
+    size += token;
+  }
+  out[size] = '\0';
+  return out;
+}
+
+static void run_test(TSParser *parser, const Shared *shared, Test *test) {
+  const ToolCorpusExample *example = test->example;
+  TSTree *tree = NULL;
+  test->parse_ns = UINT64_MAX;
+  for (unsigned i = 0; i < shared->iterations; i++) {
+    ts_tree_delete(tree);
+    uint64_t begin = tool_now_ns();
+    tree = ts_parser_parse_string(parser, NULL, example->input, example->input_length);
+    uint64_t elapsed = tool_now_ns() - begin;
+    if (!tree) {
+      ts_parser_reset(parser);
+      test->timed_out = true;
+      return;
+    }
+    if (elapsed < test->parse_ns) {
+      test->parse_ns = elapsed;
+    }
+  }
+
+  TSNode root = ts_tree_root_node(tree);
+  test->nodes = ts_node_descendant_count(root);
+  bool has_fields = false;
+  test->expected = normalize(example->expected, true, &has_fields);
+  if (!has_fields) {
+    free(test->expected);
+    test->expected = normalize(example->expected, false, NULL);
+  }
+  char *string = ts_node_string(root);
+  test->actual = normalize(string, has_fields, NULL);
+  free(string);
+  ts_tree_delete(tree);
+  test->passed = strcmp(test->expected, test->actual) == 0;
+}
+
+static void *worker_main(void *payload) {
+  Shared *shared = payload;
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+  ts_parser_set_timeout_micros(parser, shared->timeout_micros);
+  for (;;) {
+    pthread_mutex_lock(&shared->mutex);
+    uint32_t index = shared->next < shared->count ? shared->order[shared->next++] : UINT32_MAX;
+    pthread_mutex_unlock(&shared->mutex);
+    if (index == UINT32_MAX) {
+      break;
+    }
+    run_test(parser, shared, &shared->tests[index]);
+  }
+  ts_parser_delete(parser);
+  return NULL;
+}
+
+static const Test *sort_tests;
+
+// Largest inputs first, so no thread is left with a long one at the end.
+static int compare_size(const void *a, const void *b) {
+  uint32_t x = sort_tests[*(const uint32_t *)a].example->input_length;
+  uint32_t y = sort_tests[*(const uint32_t *)b].example->input_length;
+  return (x < y) - (x > y);
+}
+
+static const char *base_name(const char *path) {
+  const char *slash = strrchr(path, '/');
+  return slash ? slash + 1 : path;
+}
+
+// Baseline lines: file, example name, node count, parse ns and expected
+// tree hash, separated by tabs. Lines starting with `#` are comments.
+static bool write_baseline(const char *path, const Test *tests, uint32_t count) {
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+  fputs("# corpus-test baseline: file, example, nodes, parse ns, expected tree hash\n", file);
+  for (uint32_t i = 0; i < count; i++) {
+    const Test *test = &tests[i];
+    if (test->timed_out) {
+      continue;
+    }
+    fprintf(file, "%s\t%s\t%u\t%llu\t%016llx\n", base_name(test->path), test->example->name,
+            test->nodes, (unsigned long long)test->parse_ns,
+            (unsigned long long)test->expected_hash);
+  }
+  return fclose(file) == 0;
+}
+
+static bool apply_baseline(const char *path, Test *tests, uint32_t count, double max_slowdown,
+                           uint64_t min_slowdown_ns) {
+  size_t length;
+  char *text = tool_read_file(path, &length);
+  if (!text) {
+    return false;
+  }
+  for (char *line = strtok(text, "\n"); line; line = strtok(NULL, "\n")) {
+    if (line[0] == '#') {
+      continue;
+    }
+    char *fields[5];
+    int n = 0;
+    for (char *field = line; n < 5; n++) {
+      fields[n] = field;
+      char *tab = strchr(field, '\t');
+      if (!tab) {
+        n++;
+        break;
+      }
+      *tab = '\0';
+      field = tab + 1;
+    }
+    if (n != 5) {
+      continue;
+    }
+    // Examples are matched by file and name; repeated names in order.
+    for (uint32_t i = 0; i < count; i++) {
+      Test *test = &tests[i];
+      if (test->in_baseline || strcmp(base_name(test->path), fields[0]) != 0 ||
+          strcmp(test->example->name, fields[1]) != 0) {
+        continue;
+      }
+      test->in_baseline = true;
+      test->baseline_nodes = (uint32_t)strtoul(fields[2], NULL, 10);
+      test->baseline_ns = strtoull(fields[3], NULL, 10);
+      uint64_t baseline_hash = strtoull(fields[4], NULL, 16);
+      if (!test->timed_out) {
+        test->nodes_changed =
+          test->nodes != test->baseline_nodes && test->expected_hash == baseline_hash;
+        test->slower = test->parse_ns > test->baseline_ns * (1 + max_slowdown / 100) &&
+                       test->parse_ns - test->baseline_ns > min_slowdown_ns;
+      }
+      break;
+    }
+  }
+  free(text);
+  return true;
+}
+
+static void print_failure(const Test *test) {
+  fprintf(stderr, "\n%s:%u: %s\n", test->path, test->example->line, test->example->name);
+  if (test->timed_out) {
+    fputs("  timed out\n", stderr);
+    return;
+  }
+  if (!test->passed) {
+    size_t i = 0;
+    while (test->expected[i] && test->expected[i] == test->actual[i]) {
+      i++;
+    }
+    size_t from = i > 40 ? i - 40 : 0;
+    fprintf(stderr, "  trees differ at character %zu\n  expected: %.120s\n  actual:   %.120s\n",
+            i, test->expected + from, test->actual + from);
+  }
+  if (test->nodes_changed) {
+    fprintf(stderr, "  %u nodes, %u in the baseline, with the same expected tree\n", test->nodes,
+            test->baseline_nodes);
+  }
+}
+
+int main(int argc, char **argv) {
+  long online = sysconf(_SC_NPROCESSORS_ONLN);
+  uint32_t thread_count = online > 0 ? (uint32_t)online : 1;
+  unsigned iterations = 3;
+  uint64_t timeout_ms = 10000;
+  const char *filter = NULL;
+  const char *baseline = NULL;
+  const char *write_path = NULL;
+  double max_slowdown = 50;
+  uint64_t min_slowdown_us = 50;
+  bool strict_time = false;
+  bool json = false;
+
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    const char *arg = argv[first];
+    bool has_value = first + 1 < argc;
+    if (strcmp(arg, "--threads") == 0 && has_value) {
+      int value = atoi(argv[++first]);
+      thread_count = value > 0 ? (uint32_t)value : 1;
+    } else if (strcmp(arg, "--iterations") == 0 && has_value) {
+      int value = atoi(argv[++first]);
+      iterations = value > 0 ? (unsigned)value : 1;
+    } else if (strcmp(arg, "--timeout-ms") == 0 && has_value) {
+      timeout_ms = strtoull(argv[++first], NULL, 10);
+    } else if (strcmp(arg, "--filter") == 0 && has_value) {
+      filter = argv[++first];
+    } else if (strcmp(arg, "--baseline") == 0 && has_value) {
+      baseline = argv[++first];
+    } else if (strcmp(arg, "--write-baseline") == 0 && has_value) {
+      write_path = argv[++first];
+    } else if (strcmp(arg, "--max-slowdown") == 0 && has_value) {
+      max_slowdown = atof(argv[++first]);
+    } else if (strcmp(arg, "--min-slowdown-us") == 0 && has_value) {
+      min_slowdown_us = strtoull(argv[++first], NULL, 10);
+    } else if (strcmp(arg, "--strict-time") == 0) {
+      strict_time = true;
+    } else if (strcmp(arg, "--json") == 0) {
+      json = true;
+    } else {
+      break;
+    }
+  }
+  if (first >= argc) {
+    fputs("usage: corpus-test [--threads N] [--iterations N] [--timeout-ms N] [--filter TEXT]\n"
+          "                   [--baseline FILE] [--write-baseline FILE] [--max-slowdown PCT]\n"
+          "                   [--min-slowdown-us N] [--strict-time] [--json] file...\n",
+          stderr);
+    return 2;
+  }
+
+  uint64_t begin = tool_now_ns();
+  int file_count = argc - first;
+  ToolCorpusExample **files = calloc((size_t)file_count, sizeof(ToolCorpusExample *));
+  uint32_t *file_sizes = calloc((size_t)file_count, sizeof(uint32_t));
+  Test *tests = NULL;
+  uint32_t count = 0, capacity = 0;
+  bool ok = true;
+  for (int f = 0; f < file_count; f++) {
+    files[f] = tool_read_corpus(argv[first + f], &file_sizes[f]);
+    if (!files[f]) {
+      ok = false;
+      continue;
+    }
+    for (uint32_t i = 0; i < file_sizes[f]; i++) {
+      const ToolCorpusExample *example = &files[f][i];
+      if (filter && !strstr(example->name, filter)) {
+        continue;
+      }
+      if (count == capacity) {
+        capacity = capacity ? capacity * 2 : 256;
+        tests = realloc(tests, capacity * sizeof(Test));
+      }
+      tests[count++] = (Test){
+        .path = argv[first + f],
+        .example = example,
+        .expected_hash = hash(example->expected),
+      };
+    }
+  }
+
+  Shared shared = {
+    .tests = tests,
+    .order = malloc((count ? count : 1) * sizeof(uint32_t)),
+    .count = count,
+    .iterations = iterations,
+    .timeout_micros = timeout_ms * 1000,
+  };
+  for (uint32_t i = 0; i < count; i++) {
+    shared.order[i] = i;
+  }
+  sort_tests = tests;
+  qsort(shared.order, count, sizeof(uint32_t), compare_size);
+  pthread_mutex_init(&shared.mutex, NULL);
+
+  // The main thread is the last worker.
+  if (thread_count > count) {
+    thread_count = count > 0 ? count : 1;
+  }
+  pthread_t *handles = calloc(thread_count, sizeof(pthread_t));
+  uint32_t started = 0;
+  while (started + 1 < thread_count &&
+         pthread_create(&handles[started], NULL, worker_main, &shared) == 0) {
+    started++;
+  }
+  worker_main(&shared);
+  for (uint32_t i = 0; i < started; i++) {
+    pthread_join(handles[i], NULL);
+  }
+  pthread_mutex_destroy(&shared.mutex);
+
+  if (baseline && !apply_baseline(baseline, tests, count, max_slowdown, min_slowdown_us * 1000)) {
+    ok = false;
+  }
+  if (write_path && !write_baseline(write_path, tests, count)) {
+    ok = false;
+  }
+
+  uint32_t passed = 0, failed = 0, slower = 0, changed = 0, unmatched = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    const Test *test = &tests[i];
+    bool good = test->passed && !test->timed_out;
+    passed += good;
+    failed += !good;
+    slower += test->slower;
+    changed += test->nodes_changed;
+    unmatched += baseline && !test->in_baseline;
+    if (!good || test->nodes_changed) {
+      print_failure(test);
+    }
+    if (test->slower) {
+      fprintf(stderr, "%s:%u: %s: %.1f us, %.1f us in the baseline\n", test->path,
+              test->example->line, test->example->name, test->parse_ns / 1e3,
+              test->baseline_ns / 1e3);
+    }
+    if (json) {
+      printf("{\"file\": ");
+      tool_json_string(stdout, test->path);
+      printf(", \"line\": %u, \"name\": ", test->example->line);
+      tool_json_string(stdout, test->example->name);
+      printf(", \"status\": \"%s\", \"parse_us\": %.2f, \"nodes\": %u",
+             test->timed_out ? "timeout" : test->passed ? "pass" : "fail",
+             test->timed_out ? 0 : test->parse_ns / 1e3, test->nodes);
+      if (test->in_baseline) {
+        printf(", \"baseline_us\": %.2f, \"baseline_nodes\": %u, \"slower\": %s, "
+               "\"nodes_changed\": %s",
+               test->baseline_ns / 1e3, test->baseline_nodes, test->slower ? "true" : "false",
+               test->nodes_changed ? "true" : "false");
+      }
+      puts("}");
+    }
+  }
+
+  fprintf(stderr, "\n%u examples in %d files: %u passed, %u failed", count, file_count, passed,
+          failed);
+  if (baseline) {
+    fprintf(stderr, ", %u slower, %u with changed node counts, %u not in the baseline", slower,
+            changed, unmatched);
+  }
+  fprintf(stderr, " (%.0f ms, %u threads)\n", (tool_now_ns() - begin) / 1e6, started + 1);
+
+  ok = ok && failed == 0 && changed == 0 && !(strict_time && slower > 0);
+  for (uint32_t i = 0; i < count; i++) {
+    free(tests[i].expected);
+    free(tests[i].actual);
+  }
+  for (int f = 0; f < file_count; f++) {
+    if (files[f]) {
+      tool_free_corpus(files[f], file_sizes[f]);
+    }
+  }
+  free(handles);
+  free(shared.order);
+  free(tests);
+  free(file_sizes);
+  free(files);
+  return ok ? 0 : 1;
+}
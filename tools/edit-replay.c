@@ -0,0 +1,568 @@
+// Incremental reparse benchmark driven by recorded edit scripts.
+//
+// Replays each trace against a copy of a large document: every edit goes
+// through ts_tree_edit and an incremental ts_parser_parse_string from the
+// edited tree, as an editor does after a keystroke. Per trace it reports
+//
+//   p50..max     reparse latency percentiles over all edits and iterations
+//   changed      bytes covered by ts_tree_get_changed_ranges (median, max)
+//   reparsed     bytes the lexer read again per edit, on average
+//   reused       share of the document taken over from the old tree
+//
+// The lexed bytes come from one extra, untimed replay with a logger
+// attached, summing the `size` of each `lexed_lookahead` message. Tokens
+// lexed more than once by different GLR versions count each time.
+//
+// Traces are plain text, one command per line; `#` starts a comment. The
+// argument is the rest of the line, with \n, \t, \s (space) and \\ escapes.
+//
+//   seek F       cursor to the first line start at or after fraction F
+//   find TEXT    cursor to the next occurrence of TEXT
+//   after TEXT   cursor past the next occurrence of TEXT
+//   move N       cursor N bytes forward, or back if negative
+//   eol          cursor to the end of its line
+//   type TEXT    insert TEXT, one edit per byte
+//   paste TEXT   insert TEXT in one edit
+//   backspace N  delete the N bytes before the cursor, one edit each
+//   erase N      delete the N bytes after the cursor in one edit
+//
+// The traces in test/perf/traces are written against documents from
+// tools/gen-corpus; `make bench-edits` generates one and replays them all.
+//
+// Usage: edit-replay [--iterations N] [--json] --doc file trace...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+typedef enum {
+  COMMAND_SEEK,
+  COMMAND_FIND,
+  COMMAND_AFTER,
+  COMMAND_MOVE,
+  COMMAND_EOL,
+  COMMAND_TYPE,
+  COMMAND_PASTE,
+  COMMAND_BACKSPACE,
+  COMMAND_ERASE,
+} CommandKind;
+
+static const char *const COMMAND_NAMES[] = {
+  [COMMAND_SEEK] = "seek",
+  [COMMAND_FIND] = "find",
+  [COMMAND_AFTER] = "after",
+  [COMMAND_MOVE] = "move",
+  [COMMAND_EOL] = "eol",
+  [COMMAND_TYPE] = "type",
+  [COMMAND_PASTE] = "paste",
+  [COMMAND_BACKSPACE] = "backspace",
+  [COMMAND_ERASE] = "erase",
+};
+
+#define COMMAND_COUNT (sizeof(COMMAND_NAMES) / sizeof(COMMAND_NAMES[0]))
+
+typedef struct {
+  CommandKind kind;
+  unsigned line;
+  // Unescaped text for find, after, type and paste.
+  char *text;
+  // Fraction for seek, count for move, backspace and erase.
+  double number;
+} Command;
+
+typedef struct {
+  const char *path;
+  Command *commands;
+  size_t count;
+} Trace;
+
+typedef struct {
+  char *data;
+  uint32_t length;
+  uint32_t capacity;
+  uint32_t cursor;
+} Document;
+
+typedef struct {
+  uint64_t elapsed_ns;
+  uint32_t changed_bytes;
+  uint32_t lexed_bytes;
+} EditSample;
+
+typedef struct {
+  EditSample *samples;
+  size_t count;
+  size_t capacity;
+  // During the logged replay: samples of the first timed replay filled in
+  // with their lexed bytes so far.
+  size_t logged;
+  uint64_t lexed_bytes;
+  bool logging;
+} Recorder;
+
+// Decodes the escapes of a trace argument in place.
+static void unescape(char *text) {
+  char *out = text;
+  for (char *in = text; *in; in++) {
+    if (*in != '\\' || !in[1]) {
+      *out++ = *in;
+      continue;
+    }
+    in++;
+    *out++ = *in == 'n' ? '\n' : *in == 't' ? '\t' : *in == 's' ? ' ' : *in;
+  }
+  *out = 0;
+}
+
+static void free_trace(Trace *trace) {
+  for (size_t i = 0; i < trace->count; i++) {
+    free(trace->commands[i].text);
+  }
+  free(trace->commands);
+}
+
+static bool load_trace(const char *path, Trace *trace) {
+  size_t length;
+  char *source = tool_read_file(path, &length);
+  if (!source) {
+    return false;
+  }
+
+  trace->path = path;
+  trace->commands = NULL;
+  trace->count = 0;
+  size_t capacity = 0;
+  unsigned line = 0;
+  for (char *next = source; *next;) {
+    char *text = next;
+    char *end = strchr(text, '\n');
+    next = end ? end + 1 : text + strlen(text);
+    if (end) {
+      *end = 0;
+    }
+    line++;
+    while (*text == ' ' || *text == '\t') {
+      text++;
+    }
+    if (*text == 0 || *text == '#') {
+      continue;
+    }
+
+    size_t name_length = strcspn(text, " \t");
+    char *argument = text + name_length;
+    if (*argument) {
+      *argument++ = 0;
+    }
+    size_t kind = 0;
+    while (kind < COMMAND_COUNT && strcmp(text, COMMAND_NAMES[kind]) != 0) {
+      kind++;
+    }
+    if (kind == COMMAND_COUNT) {
+      fprintf(stderr, "%s:%u: unknown command '%s'\n", path, line, text);
+      free_trace(trace);
+      free(source);
+      return false;
+    }
+
+    if (trace->count == capacity) {
+      capacity = capacity ? capacity * 2 : 32;
+      trace->commands = realloc(trace->commands, capacity * sizeof(Command));
+    }
+    Command *command = &trace->commands[trace->count++];
+    command->kind = (CommandKind)kind;
+    command->line = line;
+    command->text = NULL;
+    command->number = 0;
+    switch (command->kind) {
+      case COMMAND_FIND:
+      case COMMAND_AFTER:
+      case COMMAND_TYPE:
+      case COMMAND_PASTE:
+        command->text = strdup(argument);
+        unescape(command->text);
+        if (!command->text[0]) {
+          fprintf(stderr, "%s:%u: %s needs text\n", path, line, COMMAND_NAMES[kind]);
+          free_trace(trace);
+          free(source);
+          return false;
+        }
+        break;
+      case COMMAND_EOL:
+        break;
+      default:
+        command->number = atof(argument);
+        break;
+    }
+  }
+  free(source);
+  return true;
+}
+
+static TSPoint advance_point(TSPoint point, const char *text, uint32_t length) {
+  for (uint32_t i = 0; i < length; i++) {
+    if (text[i] == '\n') {
+      point.row++;
+      point.column = 0;
+    } else {
+      point.column++;
+    }
+  }
+  return point;
+}
+
+static TSPoint point_at(const Document *document, uint32_t offset) {
+  TSPoint point = {0, 0};
+  const char *start = document->data;
+  const char *end = document->data + offset;
+  for (const char *line = start; (line = memchr(line, '\n', (size_t)(end - line)));) {
+    line++;
+    point.row++;
+    start = line;
+  }
+  point.column = (uint32_t)(end - start);
+  return point;
+}
+
+static void record_lexed(void *payload, TSLogType type, const char *message) {
+  Recorder *self = payload;
+  unsigned size;
+  (void)type;
+  if (strncmp(message, "lexed_lookahead sym:", 20) == 0) {
+    const char *field = strstr(message, ", size:");
+    if (field && sscanf(field, ", size:%u", &size) == 1) {
+      self->lexed_bytes += size;
+    }
+  }
+}
+
+// Replaces `removed` bytes at the cursor with `inserted` bytes of `text`,
+// edits the tree to match and reparses it. Returns the new tree.
+static TSTree *apply_edit(TSParser *parser, TSTree *tree, Document *document, uint32_t removed,
+                          const char *text, uint32_t inserted, Recorder *recorder) {
+  uint32_t start = document->cursor;
+  TSInputEdit edit = {
+    .start_byte = start,
+    .old_end_byte = start + removed,
+    .new_end_byte = start + inserted,
+    .start_point = point_at(document, start),
+  };
+  edit.old_end_point = advance_point(edit.start_point, document->data + start, removed);
+  edit.new_end_point = advance_point(edit.start_point, text, inserted);
+
+  uint32_t length = document->length - removed + inserted;
+  if (length + 1 > document->capacity) {
+    document->capacity = (length + 1) * 2;
+    document->data = realloc(document->data, document->capacity);
+  }
+  memmove(document->data + start + inserted, document->data + start + removed,
+          document->length - start - removed + 1);
+  memcpy(document->data + start, text, inserted);
+  document->length = length;
+  ts_tree_edit(tree, &edit);
+
+  recorder->lexed_bytes = 0;
+  uint64_t begin = tool_now_ns();
+  TSTree *new_tree = ts_parser_parse_string(parser, tree, document->data, document->length);
+  uint64_t elapsed = tool_now_ns() - begin;
+
+  uint32_t range_count;
+  TSRange *ranges = ts_tree_get_changed_ranges(tree, new_tree, &range_count);
+  uint32_t changed = 0;
+  for (uint32_t i = 0; i < range_count; i++) {
+    changed += ranges[i].end_byte - ranges[i].start_byte;
+  }
+  free(ranges);
+  ts_tree_delete(tree);
+
+  if (recorder->logging) {
+    // The same edits in the same order as the first timed replay.
+    if (recorder->logged < recorder->count) {
+      recorder->samples[recorder->logged++].lexed_bytes = (uint32_t)recorder->lexed_bytes;
+    }
+  } else {
+    if (recorder->count == recorder->capacity) {
+      recorder->capacity = recorder->capacity ? recorder->capacity * 2 : 256;
+      recorder->samples = realloc(recorder->samples, recorder->capacity * sizeof(EditSample));
+    }
+    recorder->samples[recorder->count++] = (EditSample){elapsed, changed, 0};
+  }
+  return new_tree;
+}
+
+static bool replay(const Trace *trace, const char *base, uint32_t base_length, TSParser *parser,
+                   Recorder *recorder) {
+  Document document = {malloc(base_length + 1), base_length, base_length + 1, 0};
+  memcpy(document.data, base, base_length + 1);
+  TSTree *tree = ts_parser_parse_string(parser, NULL, document.data, document.length);
+  bool ok = true;
+
+  for (size_t i = 0; i < trace->count && ok; i++) {
+    const Command *command = &trace->commands[i];
+    uint32_t count = command->number > 0 ? (uint32_t)command->number : 0;
+    switch (command->kind) {
+      case COMMAND_SEEK: {
+        uint32_t offset = (uint32_t)(document.length * command->number);
+        while (offset > 0 && offset < document.length && document.data[offset - 1] != '\n') {
+          offset++;
+        }
+        document.cursor = offset < document.length ? offset : document.length;
+        break;
+      }
+      case COMMAND_FIND:
+      case COMMAND_AFTER: {
+        const char *match = strstr(document.data + document.cursor, command->text);
+        if (!match) {
+          fprintf(stderr, "%s:%u: '%s' not found after byte %u\n", trace->path, command->line,
+                  command->text, document.cursor);
+          ok = false;
+          break;
+        }
+        document.cursor = (uint32_t)(match - document.data);
+        if (command->kind == COMMAND_AFTER) {
+          document.cursor += (uint32_t)strlen(command->text);
+        }
+        break;
+      }
+      case COMMAND_MOVE: {
+        int64_t offset = (int64_t)document.cursor + (int64_t)command->number;
+        if (offset < 0) {
+          offset = 0;
+        } else if (offset > (int64_t)document.length) {
+          offset = document.length;
+        }
+        document.cursor = (uint32_t)offset;
+        break;
+      }
+      case COMMAND_EOL:
+        while (document.cursor < document.length && document.data[document.cursor] != '\n') {
+          document.cursor++;
+        }
+        break;
+      case COMMAND_TYPE:
+        for (const char *c = command->text; *c; c++) {
+          tree = apply_edit(parser, tree, &document, 0, c, 1, recorder);
+          document.cursor++;
+        }
+        break;
+      case COMMAND_PASTE: {
+        uint32_t length = (uint32_t)strlen(command->text);
+        tree = apply_edit(parser, tree, &document, 0, command->text, length, recorder);
+        document.cursor += length;
+        break;
+      }
+      case COMMAND_BACKSPACE:
+        for (uint32_t n = 0; n < count && document.cursor > 0; n++) {
+          document.cursor--;
+          tree = apply_edit(parser, tree, &document, 1, "", 0, recorder);
+        }
+        break;
+      case COMMAND_ERASE:
+        if (count > document.length - document.cursor) {
+          count = document.length - document.cursor;
+        }
+        tree = apply_edit(parser, tree, &document, count, "", 0, recorder);
+        break;
+    }
+  }
+
+  ts_tree_delete(tree);
+  free(document.data);
+  return ok;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static uint64_t percentile(const uint64_t *sorted, size_t count, unsigned percent) {
+  return sorted[(count - 1) * percent / 100];
+}
+
+static const unsigned PERCENTILES[] = {50, 90, 95, 99, 100};
+
+#define PERCENTILE_COUNT (sizeof(PERCENTILES) / sizeof(PERCENTILES[0]))
+
+typedef struct {
+  const char *path;
+  size_t edits;
+  uint64_t latency_ns[PERCENTILE_COUNT];
+  uint64_t changed_median;
+  uint64_t changed_max;
+  double reparsed_mean;
+  double reused_share;
+} TraceResult;
+
+static void summarize(const Recorder *recorder, size_t edits_per_replay, uint32_t base_length,
+                      TraceResult *result) {
+  size_t count = recorder->count;
+  uint64_t *values = malloc((count ? count : 1) * sizeof(uint64_t));
+  result->edits = edits_per_replay;
+
+  for (size_t i = 0; i < count; i++) {
+    values[i] = recorder->samples[i].elapsed_ns;
+  }
+  qsort(values, count, sizeof(uint64_t), compare_u64);
+  for (size_t p = 0; p < PERCENTILE_COUNT; p++) {
+    result->latency_ns[p] = count ? percentile(values, count, PERCENTILES[p]) : 0;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    values[i] = recorder->samples[i].changed_bytes;
+  }
+  qsort(values, count, sizeof(uint64_t), compare_u64);
+  result->changed_median = count ? percentile(values, count, 50) : 0;
+  result->changed_max = count ? values[count - 1] : 0;
+
+  // Only the first replay's samples carry lexed byte counts.
+  uint64_t lexed = 0;
+  for (size_t i = 0; i < edits_per_replay && i < count; i++) {
+    lexed += recorder->samples[i].lexed_bytes;
+  }
+  size_t measured = edits_per_replay < count ? edits_per_replay : count;
+  result->reparsed_mean = measured ? (double)lexed / (double)measured : 0;
+  result->reused_share =
+    base_length ? 1.0 - result->reparsed_mean / (double)base_length : 0;
+  if (result->reused_share < 0) {
+    result->reused_share = 0;
+  }
+  free(values);
+}
+
+int main(int argc, char **argv) {
+  unsigned iterations = 3;
+  bool json = false;
+  const char *document_path = NULL;
+  const char **trace_paths = calloc((size_t)argc, sizeof(char *));
+  size_t trace_count = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = (unsigned)atoi(argv[++i]);
+      if (iterations == 0) {
+        iterations = 1;
+      }
+    } else if (strcmp(argv[i], "--doc") == 0 && i + 1 < argc) {
+      document_path = argv[++i];
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (argv[i][0] != '-') {
+      trace_paths[trace_count++] = argv[i];
+    } else {
+      trace_count = 0;
+      break;
+    }
+  }
+  if (!document_path || trace_count == 0) {
+    fputs("usage: edit-replay [--iterations N] [--json] --doc file trace...\n", stderr);
+    free(trace_paths);
+    return 2;
+  }
+
+  size_t base_length;
+  char *base = tool_read_file(document_path, &base_length);
+  if (!base) {
+    free(trace_paths);
+    return 1;
+  }
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+
+  uint64_t begin = tool_now_ns();
+  ts_tree_delete(ts_parser_parse_string(parser, NULL, base, (uint32_t)base_length));
+  uint64_t full_ns = tool_now_ns() - begin;
+
+  TraceResult *results = calloc(trace_count, sizeof(TraceResult));
+  int status = 0;
+  for (size_t t = 0; t < trace_count; t++) {
+    Trace trace;
+    if (!load_trace(trace_paths[t], &trace)) {
+      status = 1;
+      continue;
+    }
+
+    Recorder recorder = {0};
+    bool ok = true;
+    for (unsigned i = 0; i < iterations && ok; i++) {
+      ok = replay(&trace, base, (uint32_t)base_length, parser, &recorder);
+    }
+    size_t edits = recorder.count / iterations;
+    if (ok) {
+      recorder.logging = true;
+      ts_parser_set_logger(parser, (TSLogger){&recorder, record_lexed});
+      ok = replay(&trace, base, (uint32_t)base_length, parser, &recorder);
+      ts_parser_set_logger(parser, (TSLogger){NULL, NULL});
+    }
+    if (ok) {
+      results[t].path = trace_paths[t];
+      summarize(&recorder, edits, (uint32_t)base_length, &results[t]);
+    } else {
+      status = 1;
+    }
+    free(recorder.samples);
+    free_trace(&trace);
+  }
+
+  if (json) {
+    printf("{\n  \"document\": ");
+    tool_json_string(stdout, document_path);
+    printf(",\n  \"bytes\": %zu,\n  \"full_parse_ms\": %.3f,\n  \"iterations\": %u,\n"
+           "  \"traces\": [\n",
+           base_length, full_ns / 1e6, iterations);
+    size_t printed = 0, valid = 0;
+    for (size_t t = 0; t < trace_count; t++) {
+      valid += results[t].path != NULL;
+    }
+    for (size_t t = 0; t < trace_count; t++) {
+      const TraceResult *r = &results[t];
+      if (!r->path) {
+        continue;
+      }
+      printf("    {\"trace\": ");
+      tool_json_string(stdout, r->path);
+      printf(", \"edits\": %zu, \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p95_ms\": %.4f, "
+             "\"p99_ms\": %.4f, \"max_ms\": %.4f, \"changed_bytes_median\": %llu, "
+             "\"changed_bytes_max\": %llu, \"reparsed_bytes_per_edit\": %.1f, "
+             "\"reused_share\": %.4f}%s\n",
+             r->edits, r->latency_ns[0] / 1e6, r->latency_ns[1] / 1e6, r->latency_ns[2] / 1e6,
+             r->latency_ns[3] / 1e6, r->latency_ns[4] / 1e6,
+             (unsigned long long)r->changed_median, (unsigned long long)r->changed_max,
+             r->reparsed_mean, r->reused_share, ++printed < valid ? "," : "");
+    }
+    printf("  ]\n}\n");
+  } else {
+    printf("%s: %zu bytes, full parse %.2f ms, %u iterations\n\n", document_path, base_length,
+           full_ns / 1e6, iterations);
+    printf("%-28s %6s %8s %8s %8s %8s %8s %10s %10s %10s %7s\n", "trace", "edits", "p50 ms",
+           "p90 ms", "p95 ms", "p99 ms", "max ms", "changed", "max chg", "reparsed", "reused");
+    for (size_t t = 0; t < trace_count; t++) {
+      const TraceResult *r = &results[t];
+      if (!r->path) {
+        continue;
+      }
+      const char *name = strrchr(r->path, '/');
+      printf("%-28s %6zu %8.3f %8.3f %8.3f %8.3f %8.3f %10llu %10llu %10.0f %6.2f%%\n",
+             name ? name + 1 : r->path, r->edits, r->latency_ns[0] / 1e6, r->latency_ns[1] / 1e6,
+             r->latency_ns[2] / 1e6, r->latency_ns[3] / 1e6, r->latency_ns[4] / 1e6,
+             (unsigned long long)r->changed_median, (unsigned long long)r->changed_max,
+             r->reparsed_mean, 100 * r->reused_share);
+    }
+  }
+
+  free(results);
+  ts_parser_delete(parser);
+  free(base);
+  free(trace_paths);
+  return status;
+}
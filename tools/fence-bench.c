@@ -0,0 +1,260 @@
+// Incremental reparse benchmark for delimiter fences.
+//
+// Types the opening fence of each delimited block kind (`----`, `....`,
+// `++++`, `____` and `|===`) into the middle of a large document, one
+// character per edit, the way an editor sends keystrokes. After every edit
+// the tree is edited with ts_tree_edit and reparsed from the old tree. While
+// the fence has no closing fence within the scanner's reach, the block it
+// opens ends at the next section heading or at the scanner's line budget,
+// so the reparse should cost about as much as any other keystroke instead
+// of reshaping the rest of the document. The generated document has a
+// listing and a table in each section, so `----` and `|===` pair with those
+// when typed above them in the same section.
+//
+// For each edit it reports the reparse time and the bytes covered by
+// ts_tree_get_changed_ranges, then a median, p95 and maximum per fence next
+// to the time of a full parse. Each fence is removed again before the next
+// one is typed.
+//
+// Without a file argument the document is generated: --lines lines of
+// sections, paragraphs, listings and tables.
+//
+// Usage: fence-bench [--lines N] [--json] [file]
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+static const char *const FENCES[] = {"----", "....", "++++", "____", "|==="};
+
+#define FENCE_COUNT (sizeof(FENCES) / sizeof(FENCES[0]))
+
+typedef struct {
+  char *data;
+  uint32_t length;
+  uint32_t capacity;
+} Buffer;
+
+typedef struct {
+  uint64_t elapsed_ns;
+  uint32_t changed_bytes;
+  bool has_error;
+} EditSample;
+
+static void buffer_append(Buffer *self, const char *text) {
+  uint32_t length = (uint32_t)strlen(text);
+  if (self->length + length + 1 > self->capacity) {
+    self->capacity = (self->length + length + 1) * 2;
+    self->data = realloc(self->data, self->capacity);
+  }
+  memcpy(self->data + self->length, text, length + 1);
+  self->length += length;
+}
+
+static void buffer_splice(Buffer *self, uint32_t start, uint32_t removed, const char *text) {
+  uint32_t inserted = (uint32_t)strlen(text);
+  if (self->length - removed + inserted + 1 > self->capacity) {
+    self->capacity = (self->length - removed + inserted + 1) * 2;
+    self->data = realloc(self->data, self->capacity);
+  }
+  memmove(self->data + start + inserted, self->data + start + removed,
+          self->length - start - removed + 1);
+  memcpy(self->data + start, text, inserted);
+  self->length = self->length - removed + inserted;
+}
+
+static void generate_document(Buffer *out, uint32_t lines) {
+  char line[128];
+  uint32_t count = 2;
+  buffer_append(out, "= Fence Benchmark\n\n");
+  for (uint32_t section = 1; count < lines; section++) {
+    snprintf(line, sizeof(line), "== Section %u\n\n", section);
+    buffer_append(out, line);
+    count += 2;
+    for (int paragraph = 0; paragraph < 4 && count < lines; paragraph++) {
+      snprintf(line, sizeof(line),
+               "Paragraph %d of section %u with *bold*, _emphasis_ and `code`.\n\n", paragraph,
+               section);
+      buffer_append(out, line);
+      count += 2;
+    }
+    snprintf(line, sizeof(line), "[source,c]\n----\nint section = %u;\n----\n\n", section);
+    buffer_append(out, line);
+    buffer_append(out, "|===\n|Name |Value\n\n|a |1\n|===\n\n");
+    count += 12;
+  }
+}
+
+static TSPoint point_at(const Buffer *text, uint32_t offset) {
+  TSPoint point = {0, 0};
+  for (uint32_t i = 0; i < offset; i++) {
+    if (text->data[i] == '\n') {
+      point.row++;
+      point.column = 0;
+    } else {
+      point.column++;
+    }
+  }
+  return point;
+}
+
+// Start of an empty line near the middle of the document, between blocks.
+static uint32_t middle_blank_line(const Buffer *text) {
+  for (uint32_t i = text->length / 2; i + 1 < text->length; i++) {
+    if (text->data[i] == '\n' && text->data[i + 1] == '\n') {
+      return i + 1;
+    }
+  }
+  return text->length;
+}
+
+// Replaces `removed` bytes at `start` with `inserted`, edits the tree to
+// match and reparses. Returns the new tree.
+static TSTree *apply_edit(TSParser *parser, TSTree *tree, Buffer *text, uint32_t start,
+                          uint32_t removed, const char *inserted, EditSample *sample) {
+  TSInputEdit edit = {
+    .start_byte = start,
+    .old_end_byte = start + removed,
+    .new_end_byte = start + (uint32_t)strlen(inserted),
+    .start_point = point_at(text, start),
+    .old_end_point = point_at(text, start + removed),
+  };
+  buffer_splice(text, start, removed, inserted);
+  edit.new_end_point = point_at(text, edit.new_end_byte);
+  ts_tree_edit(tree, &edit);
+
+  uint64_t begin = tool_now_ns();
+  TSTree *new_tree = ts_parser_parse_string(parser, tree, text->data, text->length);
+  uint64_t elapsed = tool_now_ns() - begin;
+
+  if (sample) {
+    uint32_t range_count;
+    TSRange *ranges = ts_tree_get_changed_ranges(tree, new_tree, &range_count);
+    sample->elapsed_ns = elapsed;
+    sample->changed_bytes = 0;
+    for (uint32_t i = 0; i < range_count; i++) {
+      sample->changed_bytes += ranges[i].end_byte - ranges[i].start_byte;
+    }
+    sample->has_error = ts_node_has_error(ts_tree_root_node(new_tree));
+    free(ranges);
+  }
+  ts_tree_delete(tree);
+  return new_tree;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static uint64_t percentile(uint64_t *sorted, size_t count, unsigned percent) {
+  return sorted[(count - 1) * percent / 100];
+}
+
+int main(int argc, char **argv) {
+  uint32_t lines = 20000;
+  bool json = false;
+  const char *path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+      lines = (uint32_t)atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      fputs("usage: fence-bench [--lines N] [--json] [file]\n", stderr);
+      return 2;
+    }
+  }
+
+  Buffer text = {0};
+  if (path) {
+    size_t length;
+    text.data = tool_read_file(path, &length);
+    if (!text.data) {
+      return 1;
+    }
+    text.length = (uint32_t)length;
+    text.capacity = (uint32_t)length + 1;
+  } else {
+    generate_document(&text, lines);
+  }
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+
+  uint64_t begin = tool_now_ns();
+  TSTree *tree = ts_parser_parse_string(parser, NULL, text.data, text.length);
+  uint64_t full_ns = tool_now_ns() - begin;
+  uint32_t position = middle_blank_line(&text);
+  TSPoint at = point_at(&text, position);
+
+  if (json) {
+    printf("{\n  \"bytes\": %u,\n  \"line\": %u,\n  \"full_parse_ms\": %.3f,\n  \"fences\": [\n",
+           text.length, at.row + 1, full_ns / 1e6);
+  } else {
+    printf("%u bytes, fences typed at line %u, full parse %.2f ms\n\n", text.length, at.row + 1,
+           full_ns / 1e6);
+    printf("%-6s %-10s %10s %14s %6s\n", "fence", "typed", "ms", "changed bytes", "error");
+  }
+
+  for (size_t f = 0; f < FENCE_COUNT; f++) {
+    // The fence characters, then the newline that completes the line.
+    const char *fence = FENCES[f];
+    size_t keystrokes = strlen(fence) + 1;
+    EditSample samples[8];
+    uint64_t times[8];
+    char typed[8] = {0};
+
+    for (size_t k = 0; k < keystrokes; k++) {
+      char key[2] = {k < keystrokes - 1 ? fence[k] : '\n', 0};
+      tree = apply_edit(parser, tree, &text, position + (uint32_t)k, 0, key, &samples[k]);
+      times[k] = samples[k].elapsed_ns;
+      typed[k] = key[0];
+      if (!json) {
+        printf("%-6s %-10s %10.3f %14u %6s\n", k == 0 ? fence : "",
+               key[0] == '\n' ? "\\n" : typed, samples[k].elapsed_ns / 1e6,
+               samples[k].changed_bytes, samples[k].has_error ? "yes" : "");
+      }
+    }
+    tree = apply_edit(parser, tree, &text, position, (uint32_t)keystrokes, "", NULL);
+
+    qsort(times, keystrokes, sizeof(uint64_t), compare_u64);
+    if (json) {
+      printf("    {\"fence\": ");
+      tool_json_string(stdout, fence);
+      printf(", \"edits\": [");
+      for (size_t k = 0; k < keystrokes; k++) {
+        printf("%s{\"ms\": %.4f, \"changed_bytes\": %u, \"has_error\": %s}", k ? ", " : "",
+               samples[k].elapsed_ns / 1e6, samples[k].changed_bytes,
+               samples[k].has_error ? "true" : "false");
+      }
+      printf("], \"median_ms\": %.4f, \"p95_ms\": %.4f, \"max_ms\": %.4f}%s\n",
+             percentile(times, keystrokes, 50) / 1e6, percentile(times, keystrokes, 95) / 1e6,
+             times[keystrokes - 1] / 1e6, f + 1 < FENCE_COUNT ? "," : "");
+    } else {
+      printf("%-6s median %.3f ms, p95 %.3f ms, max %.3f ms (%.1f%% of a full parse)\n\n", "",
+             percentile(times, keystrokes, 50) / 1e6, percentile(times, keystrokes, 95) / 1e6,
+             times[keystrokes - 1] / 1e6, 100.0 * times[keystrokes - 1] / full_ns);
+    }
+  }
+
+  if (json) {
+    printf("  ]\n}\n");
+  }
+
+  ts_tree_delete(tree);
+  ts_parser_delete(parser);
+  free(text.data);
+  return 0;
+}
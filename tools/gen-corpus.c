@@ -0,0 +1,694 @@
+// Deterministic generator for synthetic AsciiDoc benchmark documents.
+//
+// The same seed, size and mix always produce byte-identical output, so
+// benchmark numbers from different commits are comparable.
+//
+// Usage: gen-corpus [--seed N] [--size 10K..500M] [--mix name=weight,...]
+//                   [--only name] [--inline PCT] [--unicode PCT]
+//                   [--depth N] [--no-header] [--list] [-o file]
+
+#include "common.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef enum {
+  SECTION,
+  PARAGRAPH,
+  UNORDERED_LIST,
+  ORDERED_LIST,
+  CHECKLIST,
+  DESCRIPTION_LIST,
+  CALLOUT_LIST,
+  DELIMITED_BLOCK,
+  LISTING_BLOCK,
+  FENCED_CODE_BLOCK,
+  TABLE_BLOCK,
+  CONDITIONAL_BLOCK,
+  ADMONITION,
+  ATTRIBUTE_ENTRY,
+  BLOCK_MACRO,
+  THEMATIC_BREAK,
+  CONSTRUCT_COUNT,
+} Construct;
+
+static const char *CONSTRUCT_NAMES[CONSTRUCT_COUNT] = {
+  [SECTION] = "section",
+  [PARAGRAPH] = "paragraph",
+  [UNORDERED_LIST] = "unordered_list",
+  [ORDERED_LIST] = "ordered_list",
+  [CHECKLIST] = "checklist",
+  [DESCRIPTION_LIST] = "description_list",
+  [CALLOUT_LIST] = "callout_list",
+  [DELIMITED_BLOCK] = "delimited_block",
+  [LISTING_BLOCK] = "listing_block",
+  [FENCED_CODE_BLOCK] = "fenced_code_block",
+  [TABLE_BLOCK] = "table_block",
+  [CONDITIONAL_BLOCK] = "conditional_block",
+  [ADMONITION] = "admonition",
+  [ATTRIBUTE_ENTRY] = "attribute_entry",
+  [BLOCK_MACRO] = "block_macro",
+  [THEMATIC_BREAK] = "thematic_break",
+};
+
+// Roughly the block mix of a large technical manual.
+static const unsigned DEFAULT_WEIGHTS[CONSTRUCT_COUNT] = {
+  [SECTION] = 6,
+  [PARAGRAPH] = 30,
+  [UNORDERED_LIST] = 8,
+  [ORDERED_LIST] = 5,
+  [CHECKLIST] = 2,
+  [DESCRIPTION_LIST] = 4,
+  [CALLOUT_LIST] = 2,
+  [DELIMITED_BLOCK] = 5,
+  [LISTING_BLOCK] = 8,
+  [FENCED_CODE_BLOCK] = 3,
+  [TABLE_BLOCK] = 5,
+  [CONDITIONAL_BLOCK] = 3,
+  [ADMONITION] = 4,
+  [ATTRIBUTE_ENTRY] = 3,
+  [BLOCK_MACRO] = 2,
+  [THEMATIC_BREAK] = 1,
+};
+
+static const char *WORDS[] = {
+  "the",      "parser",   "document", "section", "table",   "value",     "returns",
+  "config",   "request",  "client",   "server",  "option",  "default",   "example",
+  "when",     "with",     "and",      "for",     "each",    "node",      "tree",
+  "build",    "release",  "manual",   "reference", "cluster", "storage", "index",
+  "field",    "query",    "response", "handler", "module",  "timeout",   "retry",
+  "version",  "setting",  "must",     "should",  "is",      "a",         "of",
+  "to",       "in",       "this",     "that",    "from",    "42",        "v2",
+};
+
+static const char *UNICODE_WORDS[] = {
+  "naïve",  "café",  "Größe",   "señal",   "déjà",     "über",
+  "日本語", "設定",  "Ελληνικά", "русский", "اختبار",   "emoji🚀",
+};
+
+static const char *LANGUAGES[] = {"java", "json", "bash", "python", "yaml", "c", "javascript"};
+
+static const char *ADMONITIONS[] = {"NOTE", "TIP", "IMPORTANT", "WARNING", "CAUTION"};
+
+#define ARRAY_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
+typedef struct {
+  FILE *out;
+  uint64_t written;
+  uint64_t rng;
+  unsigned weights[CONSTRUCT_COUNT];
+  unsigned weight_total;
+  unsigned inline_percent;
+  unsigned unicode_percent;
+  unsigned max_depth;
+  unsigned section_level;
+  unsigned anchor_count;
+} Generator;
+
+// splitmix64: tiny, fast and identical on every platform.
+static uint64_t next_random(Generator *self) {
+  uint64_t z = (self->rng += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static unsigned random_below(Generator *self, unsigned bound) {
+  return (unsigned)(next_random(self) % bound);
+}
+
+static bool chance(Generator *self, unsigned percent) {
+  return random_below(self, 100) < percent;
+}
+
+static void emit(Generator *self, const char *text) {
+  size_t length = strlen(text);
+  fwrite(text, 1, length, self->out);
+  self->written += length;
+}
+
+static void emitf(Generator *self, const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int length = vfprintf(self->out, format, args);
+  va_end(args);
+  if (length > 0) {
+    self->written += (uint64_t)length;
+  }
+}
+
+static void emit_repeated(Generator *self, char c, unsigned count) {
+  for (unsigned i = 0; i < count; i++) {
+    fputc(c, self->out);
+  }
+  self->written += count;
+}
+
+static const char *word(Generator *self) {
+  if (self->unicode_percent && chance(self, self->unicode_percent)) {
+    return UNICODE_WORDS[random_below(self, ARRAY_LENGTH(UNICODE_WORDS))];
+  }
+  return WORDS[random_below(self, ARRAY_LENGTH(WORDS))];
+}
+
+static void emit_inline_markup(Generator *self) {
+  const char *text = word(self);
+  switch (random_below(self, 11)) {
+    case 0:
+      emitf(self, "*%s %s*", text, word(self));
+      break;
+    case 1:
+      emitf(self, "_%s_", text);
+      break;
+    case 2:
+      emitf(self, "`%s()`", text);
+      break;
+    case 3:
+      emitf(self, "^%s^", text);
+      break;
+    case 4:
+      emitf(self, "~%s~", text);
+      break;
+    case 5:
+      emitf(self, "#%s#", text);
+      break;
+    case 6:
+      emitf(self, "<<anchor-%u>>", random_below(self, self->anchor_count + 1));
+      break;
+    case 7:
+      emitf(self, "https://example.com/%s[%s %s]", text, word(self), word(self));
+      break;
+    case 8:
+      emitf(self, "{attr-%u}", random_below(self, 32));
+      break;
+    case 9:
+      emitf(self, "kbd:[Ctrl+%c]", 'A' + random_below(self, 26));
+      break;
+    default:
+      emitf(self, "footnote:[%s %s]", text, word(self));
+      break;
+  }
+}
+
+// Plain words for titles and terms, without inline markup.
+static void emit_words(Generator *self, unsigned min_words, unsigned max_words) {
+  unsigned count = min_words + random_below(self, max_words - min_words + 1);
+  for (unsigned i = 0; i < count; i++) {
+    if (i > 0) {
+      emit(self, " ");
+    }
+    emit(self, word(self));
+  }
+}
+
+// One line of prose without the line ending.
+static void emit_text(Generator *self, unsigned min_words, unsigned max_words) {
+  unsigned count = min_words + random_below(self, max_words - min_words + 1);
+  for (unsigned i = 0; i < count; i++) {
+    if (i > 0) {
+      emit(self, " ");
+    }
+    if (self->inline_percent && chance(self, self->inline_percent)) {
+      emit_inline_markup(self);
+    } else {
+      emit(self, word(self));
+    }
+  }
+  if (chance(self, 60)) {
+    emit(self, ".");
+  }
+}
+
+static void emit_paragraph(Generator *self) {
+  unsigned lines = 1 + random_below(self, 4);
+  for (unsigned i = 0; i < lines; i++) {
+    emit_text(self, 6, 16);
+    emit(self, "\n");
+  }
+}
+
+static void emit_section(Generator *self) {
+  // `section_level` is the deepest level allowed next: one below the current section.
+  unsigned level = 2 + random_below(self, self->section_level - 1);
+  self->section_level = level + 1 > 6 ? 6 : level + 1;
+  if (chance(self, 30)) {
+    emitf(self, "[[anchor-%u]]\n", ++self->anchor_count);
+  }
+  emit_repeated(self, '=', level);
+  emit(self, " ");
+  emit_words(self, 2, 6);
+  emit(self, "\n");
+}
+
+static void emit_unordered_list(Generator *self) {
+  bool markdown = chance(self, 25);
+  unsigned items = 2 + random_below(self, 6);
+  unsigned depth = 1;
+  for (unsigned i = 0; i < items; i++) {
+    if (markdown) {
+      emit_repeated(self, ' ', (depth - 1) * 2);
+      emit(self, "- ");
+    } else {
+      emit_repeated(self, '*', depth);
+      emit(self, " ");
+    }
+    emit_text(self, 3, 12);
+    emit(self, "\n");
+    if (chance(self, 35) && depth < 3) {
+      depth++;
+    } else if (depth > 1 && chance(self, 50)) {
+      depth--;
+    }
+  }
+}
+
+static void emit_ordered_list(Generator *self) {
+  unsigned items = 2 + random_below(self, 6);
+  unsigned depth = 1;
+  for (unsigned i = 0; i < items; i++) {
+    emit_repeated(self, '.', depth);
+    emit(self, " ");
+    emit_text(self, 3, 12);
+    emit(self, "\n");
+    if (chance(self, 30) && depth < 3) {
+      depth++;
+    } else if (depth > 1 && chance(self, 50)) {
+      depth--;
+    }
+  }
+}
+
+static void emit_checklist(Generator *self) {
+  unsigned items = 2 + random_below(self, 5);
+  for (unsigned i = 0; i < items; i++) {
+    emitf(self, "* [%c] ", chance(self, 50) ? 'x' : ' ');
+    emit_text(self, 3, 8);
+    emit(self, "\n");
+  }
+}
+
+static void emit_description_list(Generator *self) {
+  unsigned items = 2 + random_below(self, 4);
+  for (unsigned i = 0; i < items; i++) {
+    bool nested = i > 0 && chance(self, 25);
+    emitf(self, "%s %s%s ", word(self), word(self), nested ? ":::" : "::");
+    emit_text(self, 3, 10);
+    emit(self, "\n");
+  }
+}
+
+static void emit_callout_list(Generator *self) {
+  unsigned items = 1 + random_below(self, 4);
+  for (unsigned i = 0; i < items; i++) {
+    emitf(self, "<%u> ", i + 1);
+    emit_text(self, 3, 8);
+    emit(self, "\n");
+  }
+}
+
+static void emit_code_lines(Generator *self, unsigned min_lines, unsigned max_lines) {
+  unsigned lines = min_lines + random_below(self, max_lines - min_lines + 1);
+  for (unsigned i = 0; i < lines; i++) {
+    unsigned indent = random_below(self, 3) * 2;
+    emitf(self, "%*s%s.%s(\"%s\", %u); <%u>\n", indent, "", word(self), word(self), word(self),
+          random_below(self, 1000), i % 3 + 1);
+  }
+}
+
+static void emit_listing_block(Generator *self) {
+  if (chance(self, 30)) {
+    emit(self, ".");
+    emit_words(self, 2, 5);
+    emit(self, "\n");
+  }
+  emitf(self, "[source,%s]\n----\n", LANGUAGES[random_below(self, ARRAY_LENGTH(LANGUAGES))]);
+  emit_code_lines(self, 3, 20);
+  emit(self, "----\n");
+}
+
+static void emit_fenced_code_block(Generator *self) {
+  emitf(self, "```%s\n", LANGUAGES[random_below(self, ARRAY_LENGTH(LANGUAGES))]);
+  emit_code_lines(self, 3, 15);
+  emit(self, "```\n");
+}
+
+static void emit_delimited_block(Generator *self, unsigned depth);
+
+static void emit_block_body(Generator *self, unsigned depth) {
+  unsigned blocks = 1 + random_below(self, 3);
+  for (unsigned i = 0; i < blocks; i++) {
+    if (i > 0) {
+      emit(self, "\n");
+    }
+    switch (random_below(self, 4)) {
+      case 0:
+        if (depth < self->max_depth) {
+          emit_delimited_block(self, depth + 1);
+          break;
+        }
+        // fallthrough
+      case 1:
+        emit_paragraph(self);
+        break;
+      case 2:
+        emit_listing_block(self);
+        break;
+      default:
+        emit_unordered_list(self);
+        break;
+    }
+  }
+}
+
+// Nested delimited blocks. Compound blocks (example, sidebar) may contain other
+// blocks; verbatim blocks (literal, quote, open, passthrough) hold plain lines.
+static void emit_delimited_block(Generator *self, unsigned depth) {
+  // Nested compound fences get one extra marker character per level so the
+  // inner fence can never close the outer one.
+  unsigned fence_length = 4 + depth;
+  switch (random_below(self, 6)) {
+    case 0:
+    case 1: {
+      char fence = chance(self, 50) ? '=' : '*';
+      emit_repeated(self, fence, fence_length);
+      emit(self, "\n");
+      emit_block_body(self, depth);
+      emit_repeated(self, fence, fence_length);
+      emit(self, "\n");
+      return;
+    }
+    case 2:
+      emit(self, "....\n");
+      emit_code_lines(self, 2, 8);
+      emit(self, "....\n");
+      return;
+    case 3:
+      emit(self, "____\n");
+      emit_paragraph(self);
+      emit(self, "____\n");
+      return;
+    case 4:
+      emit(self, "--\n");
+      emit_paragraph(self);
+      emit(self, "--\n");
+      return;
+    default:
+      emit(self, "++++\n<div class=\"note\">\n");
+      emit_text(self, 4, 10);
+      emit(self, "\n</div>\n++++\n");
+      return;
+  }
+}
+
+static void emit_table_block(Generator *self) {
+  unsigned columns = 2 + random_below(self, 4);
+  unsigned rows = 2 + random_below(self, 10);
+  if (chance(self, 40)) {
+    emit(self, ".");
+    emit_words(self, 2, 5);
+    emit(self, "\n");
+  }
+  emitf(self, "[cols=\"%u*\",options=\"header\"]\n|===\n", columns);
+  for (unsigned row = 0; row < rows; row++) {
+    for (unsigned column = 0; column < columns; column++) {
+      if (column > 0) {
+        emit(self, " ");
+      }
+      switch (random_below(self, 8)) {
+        case 0:
+          emit(self, "2+|");
+          column++;
+          break;
+        case 1:
+          emit(self, "a|");
+          break;
+        case 2:
+          emit(self, ".2+|");
+          break;
+        default:
+          emit(self, "|");
+          break;
+      }
+      emitf(self, " %s %s", word(self), word(self));
+    }
+    emit(self, "\n");
+  }
+  emit(self, "|===\n");
+}
+
+static void emit_conditional_block(Generator *self) {
+  switch (random_below(self, 3)) {
+    case 0:
+      emitf(self, "ifdef::attr-%u[]\n", random_below(self, 32));
+      break;
+    case 1:
+      emitf(self, "ifndef::attr-%u[]\n", random_below(self, 32));
+      break;
+    default:
+      emitf(self, "ifeval::[{level} > %u]\n", random_below(self, 10));
+      break;
+  }
+  emit(self, "\n");
+  emit_paragraph(self);
+  emit(self, "\nendif::[]\n\n");
+}
+
+static void emit_admonition(Generator *self) {
+  const char *label = ADMONITIONS[random_below(self, ARRAY_LENGTH(ADMONITIONS))];
+  if (chance(self, 60)) {
+    emitf(self, "%s: ", label);
+    emit_text(self, 5, 14);
+    emit(self, "\n");
+  } else {
+    emitf(self, "[%s]\n====\n", label);
+    emit_paragraph(self);
+    emit(self, "====\n");
+  }
+}
+
+static void emit_attribute_entry(Generator *self) {
+  emitf(self, ":attr-%u: %s %s\n", random_below(self, 32), word(self), word(self));
+}
+
+static void emit_block_macro(Generator *self) {
+  if (chance(self, 50)) {
+    emitf(self, "image::images/%s-%u.png[%s]\n", word(self), random_below(self, 100), word(self));
+  } else {
+    emitf(self, "include::partials/%s.adoc[]\n", word(self));
+  }
+}
+
+static void emit_block(Generator *self, Construct construct) {
+  switch (construct) {
+    case SECTION:
+      emit_section(self);
+      break;
+    case PARAGRAPH:
+      emit_paragraph(self);
+      break;
+    case UNORDERED_LIST:
+      emit_unordered_list(self);
+      break;
+    case ORDERED_LIST:
+      emit_ordered_list(self);
+      break;
+    case CHECKLIST:
+      emit_checklist(self);
+      break;
+    case DESCRIPTION_LIST:
+      emit_description_list(self);
+      break;
+    case CALLOUT_LIST:
+      emit_callout_list(self);
+      break;
+    case DELIMITED_BLOCK:
+      emit_delimited_block(self, 0);
+      break;
+    case LISTING_BLOCK:
+      emit_listing_block(self);
+      break;
+    case FENCED_CODE_BLOCK:
+      emit_fenced_code_block(self);
+      break;
+    case TABLE_BLOCK:
+      emit_table_block(self);
+      break;
+    case CONDITIONAL_BLOCK:
+      emit_conditional_block(self);
+      break;
+    case ADMONITION:
+      emit_admonition(self);
+      break;
+    case ATTRIBUTE_ENTRY:
+      emit_attribute_entry(self);
+      break;
+    case BLOCK_MACRO:
+      emit_block_macro(self);
+      break;
+    case THEMATIC_BREAK:
+      emit(self, "'''\n");
+      break;
+    case CONSTRUCT_COUNT:
+      break;
+  }
+}
+
+static Construct pick_construct(Generator *self) {
+  unsigned ticket = random_below(self, self->weight_total);
+  for (unsigned i = 0; i < CONSTRUCT_COUNT; i++) {
+    if (ticket < self->weights[i]) {
+      return (Construct)i;
+    }
+    ticket -= self->weights[i];
+  }
+  return PARAGRAPH;
+}
+
+static int construct_for_name(const char *name, size_t length) {
+  for (unsigned i = 0; i < CONSTRUCT_COUNT; i++) {
+    if (strlen(CONSTRUCT_NAMES[i]) == length && strncmp(CONSTRUCT_NAMES[i], name, length) == 0) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+static bool parse_mix(Generator *self, const char *mix) {
+  memset(self->weights, 0, sizeof(self->weights));
+  while (*mix) {
+    const char *equals = strchr(mix, '=');
+    if (!equals) {
+      return false;
+    }
+    int construct = construct_for_name(mix, (size_t)(equals - mix));
+    if (construct < 0) {
+      fprintf(stderr, "unknown construct in --mix: %.*s\n", (int)(equals - mix), mix);
+      return false;
+    }
+    char *end;
+    self->weights[construct] = (unsigned)strtoul(equals + 1, &end, 10);
+    if (*end != ',' && *end != '\0') {
+      return false;
+    }
+    mix = *end ? end + 1 : end;
+  }
+  return true;
+}
+
+static void usage(void) {
+  fputs(
+    "usage: gen-corpus [--seed N] [--size 10K..500M] [--mix name=weight,...] [--only name]\n"
+    "                  [--inline PCT] [--unicode PCT] [--depth N] [--no-header] [--list]\n"
+    "                  [-o file]\n",
+    stderr
+  );
+}
+
+int main(int argc, char **argv) {
+  Generator self = {
+    .out = stdout,
+    .rng = 1,
+    .inline_percent = 10,
+    .unicode_percent = 2,
+    .max_depth = 3,
+    .section_level = 2,
+  };
+  memcpy(self.weights, DEFAULT_WEIGHTS, sizeof(self.weights));
+  uint64_t target = 1 << 20;
+  bool header = true;
+  const char *output = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    if (strcmp(arg, "--list") == 0) {
+      for (unsigned c = 0; c < CONSTRUCT_COUNT; c++) {
+        puts(CONSTRUCT_NAMES[c]);
+      }
+      return 0;
+    } else if (strcmp(arg, "--no-header") == 0) {
+      header = false;
+      continue;
+    } else if (!value) {
+      usage();
+      return 2;
+    }
+
+    if (strcmp(arg, "--seed") == 0) {
+      self.rng = strtoull(value, NULL, 10);
+    } else if (strcmp(arg, "--size") == 0) {
+      target = tool_parse_size(value);
+      if (target == 0) {
+        fprintf(stderr, "invalid size: %s\n", value);
+        return 2;
+      }
+    } else if (strcmp(arg, "--mix") == 0) {
+      if (!parse_mix(&self, value)) {
+        fprintf(stderr, "invalid --mix: %s\n", value);
+        return 2;
+      }
+    } else if (strcmp(arg, "--only") == 0) {
+      int construct = construct_for_name(value, strlen(value));
+      if (construct < 0) {
+        fprintf(stderr, "unknown construct: %s (see --list)\n", value);
+        return 2;
+      }
+      memset(self.weights, 0, sizeof(self.weights));
+      self.weights[construct] = 1;
+    } else if (strcmp(arg, "--inline") == 0) {
+      self.inline_percent = (unsigned)atoi(value);
+    } else if (strcmp(arg, "--unicode") == 0) {
+      self.unicode_percent = (unsigned)atoi(value);
+    } else if (strcmp(arg, "--depth") == 0) {
+      self.max_depth = (unsigned)atoi(value);
+    } else if (strcmp(arg, "-o") == 0) {
+      output = value;
+    } else {
+      usage();
+      return 2;
+    }
+    i++;
+  }
+
+  for (unsigned i = 0; i < CONSTRUCT_COUNT; i++) {
+    self.weight_total += self.weights[i];
+  }
+  if (self.weight_total == 0) {
+    fputs("--mix selects no constructs\n", stderr);
+    return 2;
+  }
+
+  if (output) {
+    self.out = fopen(output, "wb");
+    if (!self.out) {
+      perror(output);
+      return 1;
+    }
+  }
+  setvbuf(self.out, NULL, _IOFBF, 1 << 20);
+
+  if (header) {
+    emit(&self, "= ");
+    emit_words(&self, 3, 6);
+    emit(&self, "\nJane Doe <jane@example.com>\nv1.0, 2024-01-01\n");
+    for (unsigned i = 0; i < 8; i++) {
+      emitf(&self, ":attr-%u: %s\n", i, word(&self));
+    }
+    emit(&self, "\n");
+  }
+
+  while (self.written < target) {
+    emit_block(&self, pick_construct(&self));
+    emit(&self, "\n");
+  }
+
+  if (fclose(self.out) != 0) {
+    perror(output ? output : "stdout");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,505 @@
+// GLR fork and conflict-cost profiler.
+//
+// Attaches a logger to the parser (`ts_parser_set_logger`) and follows the
+// runtime's parse log to attribute stack splits, merges, condenses and
+// error-recovery steps to the grammar rules and source lines that caused
+// them. Over a corpus it ranks constructs by wasted work: steps executed by
+// stack versions other than the first while the parse is forked, plus
+// error-recovery steps.
+//
+// A split is labelled with the symbols the parser reduced in the step that
+// forked, e.g. "section_level_2 | inline_element", which lines up with the
+// `conflicts` entries in grammar.js. Forks with no reduction in that step are
+// shift/reduce splits and are labelled with the lookahead instead.
+//
+// Usage: glr-profile [--top N] [--lines N] [--json] file...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+#define MAX_STEP_REDUCTIONS 4
+#define MAX_SYMBOL_NAME 64
+#define NO_CONSTRUCT UINT32_MAX
+
+typedef struct {
+  char *label;
+  uint64_t splits;
+  uint64_t merges;
+  uint64_t condenses;
+  uint64_t forked_steps;
+  uint64_t wasted_steps;
+  uint64_t recoveries;
+  uint32_t max_versions;
+  uint32_t first_file;
+  uint32_t first_row;
+} Construct;
+
+typedef struct {
+  uint32_t construct;
+  uint32_t file;
+  uint32_t row;
+  uint64_t cost;
+} LineCost;
+
+typedef struct {
+  const char *path;
+  uint64_t steps;
+  uint64_t forked_steps;
+  uint64_t recoveries;
+  uint32_t max_versions;
+} FileTotals;
+
+typedef struct {
+  Construct *constructs;
+  uint32_t construct_count;
+  uint32_t construct_capacity;
+  uint32_t *construct_index; // open addressing, NO_CONSTRUCT = empty
+  uint32_t construct_index_capacity;
+
+  LineCost *lines; // open addressing, cost == 0 = empty
+  uint32_t line_count;
+  uint32_t line_capacity;
+
+  FileTotals *files;
+  uint32_t file;
+
+  // Parse state reconstructed from the log.
+  uint32_t version_count;
+  uint32_t row;
+  uint32_t fork_origin;
+  char lookahead[MAX_SYMBOL_NAME];
+  char reductions[MAX_STEP_REDUCTIONS][MAX_SYMBOL_NAME];
+  unsigned reduction_count;
+} Profiler;
+
+static uint64_t hash_string(const char *string) {
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (; *string; string++) {
+    hash = (hash ^ (unsigned char)*string) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+static uint64_t hash_line(uint32_t construct, uint32_t file, uint32_t row) {
+  uint64_t hash = ((uint64_t)construct << 32 | file) * 0x9e3779b97f4a7c15ull;
+  return (hash ^ row) * 0xbf58476d1ce4e5b9ull;
+}
+
+static void grow_construct_index(Profiler *self) {
+  uint32_t capacity = self->construct_index_capacity ? self->construct_index_capacity * 2 : 256;
+  uint32_t *index = malloc(capacity * sizeof(uint32_t));
+  memset(index, 0xff, capacity * sizeof(uint32_t));
+  for (uint32_t i = 0; i < self->construct_count; i++) {
+    uint32_t slot = (uint32_t)hash_string(self->constructs[i].label) & (capacity - 1);
+    while (index[slot] != NO_CONSTRUCT) {
+      slot = (slot + 1) & (capacity - 1);
+    }
+    index[slot] = i;
+  }
+  free(self->construct_index);
+  self->construct_index = index;
+  self->construct_index_capacity = capacity;
+}
+
+static uint32_t intern_construct(Profiler *self, const char *label) {
+  if ((self->construct_count + 1) * 2 > self->construct_index_capacity) {
+    grow_construct_index(self);
+  }
+
+  uint32_t mask = self->construct_index_capacity - 1;
+  uint32_t slot = (uint32_t)hash_string(label) & mask;
+  while (self->construct_index[slot] != NO_CONSTRUCT) {
+    uint32_t existing = self->construct_index[slot];
+    if (strcmp(self->constructs[existing].label, label) == 0) {
+      return existing;
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  if (self->construct_count == self->construct_capacity) {
+    self->construct_capacity = self->construct_capacity ? self->construct_capacity * 2 : 64;
+    self->constructs = realloc(self->constructs, self->construct_capacity * sizeof(Construct));
+  }
+
+  uint32_t id = self->construct_count++;
+  self->constructs[id] = (Construct){
+    .label = strdup(label),
+    .first_file = self->file,
+    .first_row = self->row,
+  };
+  self->construct_index[slot] = id;
+  return id;
+}
+
+static void add_line_cost(Profiler *self, uint32_t construct, uint64_t cost) {
+  if ((self->line_count + 1) * 2 > self->line_capacity) {
+    uint32_t capacity = self->line_capacity ? self->line_capacity * 2 : 1024;
+    LineCost *lines = calloc(capacity, sizeof(LineCost));
+    for (uint32_t i = 0; i < self->line_capacity; i++) {
+      LineCost *entry = &self->lines[i];
+      if (entry->cost) {
+        uint32_t slot = (uint32_t)hash_line(entry->construct, entry->file, entry->row);
+        while (lines[slot & (capacity - 1)].cost) {
+          slot++;
+        }
+        lines[slot & (capacity - 1)] = *entry;
+      }
+    }
+    free(self->lines);
+    self->lines = lines;
+    self->line_capacity = capacity;
+  }
+
+  uint32_t mask = self->line_capacity - 1;
+  uint32_t slot = (uint32_t)hash_line(construct, self->file, self->row) & mask;
+  for (;;) {
+    LineCost *entry = &self->lines[slot];
+    if (!entry->cost) {
+      *entry = (LineCost){construct, self->file, self->row, cost};
+      self->line_count++;
+      return;
+    }
+    if (entry->construct == construct && entry->file == self->file && entry->row == self->row) {
+      entry->cost += cost;
+      return;
+    }
+    slot = (slot + 1) & mask;
+  }
+}
+
+static void copy_symbol(char *destination, const char *source) {
+  size_t length = strcspn(source, ",");
+  if (length >= MAX_SYMBOL_NAME) {
+    length = MAX_SYMBOL_NAME - 1;
+  }
+  memcpy(destination, source, length);
+  destination[length] = '\0';
+}
+
+static int compare_names(const void *a, const void *b) {
+  return strcmp((const char *)a, (const char *)b);
+}
+
+// Label for a fork that happened during the previous step.
+static uint32_t split_construct(Profiler *self) {
+  char label[MAX_STEP_REDUCTIONS * (MAX_SYMBOL_NAME + 3) + 16] = "";
+  if (self->reduction_count == 0) {
+    snprintf(label, sizeof(label), "shift %s", self->lookahead[0] ? self->lookahead : "?");
+    return intern_construct(self, label);
+  }
+
+  qsort(self->reductions, self->reduction_count, MAX_SYMBOL_NAME, compare_names);
+  for (unsigned i = 0; i < self->reduction_count; i++) {
+    if (i > 0 && strcmp(self->reductions[i], self->reductions[i - 1]) == 0) {
+      continue;
+    }
+    if (label[0]) {
+      strcat(label, " | ");
+    }
+    strcat(label, self->reductions[i]);
+  }
+  return intern_construct(self, label);
+}
+
+static void on_process(Profiler *self, const char *message) {
+  unsigned version, count, row;
+  int state;
+  if (sscanf(message, "process version:%u, version_count:%u, state:%d, row:%u", &version,
+             &count, &state, &row) != 4) {
+    return;
+  }
+
+  FileTotals *file = &self->files[self->file];
+  if (count > self->version_count && self->version_count > 0) {
+    uint32_t construct = split_construct(self);
+    self->constructs[construct].splits += count - self->version_count;
+    if (self->fork_origin == NO_CONSTRUCT) {
+      self->fork_origin = construct;
+    }
+  } else if (count < self->version_count && self->fork_origin != NO_CONSTRUCT) {
+    self->constructs[self->fork_origin].merges += self->version_count - count;
+  }
+
+  self->version_count = count;
+  self->row = row;
+  self->reduction_count = 0;
+  file->steps++;
+  if (count > file->max_versions) {
+    file->max_versions = count;
+  }
+
+  if (count <= 1) {
+    self->fork_origin = NO_CONSTRUCT;
+    return;
+  }
+
+  if (self->fork_origin == NO_CONSTRUCT) {
+    self->fork_origin = intern_construct(self, "(fork from earlier step)");
+  }
+  Construct *origin = &self->constructs[self->fork_origin];
+  origin->forked_steps++;
+  file->forked_steps++;
+  if (count > origin->max_versions) {
+    origin->max_versions = count;
+  }
+  if (version > 0) {
+    origin->wasted_steps++;
+    add_line_cost(self, self->fork_origin, 1);
+  }
+}
+
+static bool is_recovery_step(const char *message) {
+  static const char *PREFIXES[] = {
+    "detect_error", "handle_error", "recover", "skip_token", "resume", "ignore_empty_external",
+  };
+  for (size_t i = 0; i < sizeof(PREFIXES) / sizeof(PREFIXES[0]); i++) {
+    if (strncmp(message, PREFIXES[i], strlen(PREFIXES[i])) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void log_message(void *payload, TSLogType type, const char *message) {
+  Profiler *self = payload;
+  if (type != TSLogTypeParse) {
+    if (strncmp(message, "lexed_lookahead sym:", 20) == 0) {
+      copy_symbol(self->lookahead, message + 20);
+    }
+    return;
+  }
+
+  if (strncmp(message, "process version:", 16) == 0) {
+    on_process(self, message);
+  } else if (strncmp(message, "reduce sym:", 11) == 0) {
+    if (self->reduction_count < MAX_STEP_REDUCTIONS) {
+      copy_symbol(self->reductions[self->reduction_count++], message + 11);
+    }
+  } else if (strncmp(message, "lexed_lookahead sym:", 20) == 0) {
+    copy_symbol(self->lookahead, message + 20);
+  } else if (strncmp(message, "condense", 8) == 0) {
+    if (self->fork_origin != NO_CONSTRUCT) {
+      self->constructs[self->fork_origin].condenses++;
+    }
+  } else if (is_recovery_step(message)) {
+    char label[MAX_SYMBOL_NAME + 16];
+    snprintf(label, sizeof(label), "error at %s", self->lookahead[0] ? self->lookahead : "?");
+    uint32_t construct = intern_construct(self, label);
+    self->constructs[construct].recoveries++;
+    self->files[self->file].recoveries++;
+    add_line_cost(self, construct, 1);
+  }
+}
+
+static uint64_t construct_cost(const Construct *construct) {
+  return construct->wasted_steps + construct->recoveries;
+}
+
+static int compare_constructs(const void *a, const void *b) {
+  uint64_t x = construct_cost(a);
+  uint64_t y = construct_cost(b);
+  return (x < y) - (x > y);
+}
+
+static int compare_line_costs(const void *a, const void *b) {
+  const LineCost *x = a;
+  const LineCost *y = b;
+  if (x->construct != y->construct) {
+    return (x->construct > y->construct) - (x->construct < y->construct);
+  }
+  return (x->cost < y->cost) - (x->cost > y->cost);
+}
+
+// Sorts constructs by cost and groups line costs by (new) construct id with
+// the most expensive line first. Returns the grouped line array.
+static LineCost *finish(Profiler *self, uint32_t *line_count) {
+  uint32_t *rank = malloc(self->construct_count * sizeof(uint32_t));
+  Construct *sorted = malloc(self->construct_count * sizeof(Construct));
+  memcpy(sorted, self->constructs, self->construct_count * sizeof(Construct));
+  qsort(sorted, self->construct_count, sizeof(Construct), compare_constructs);
+  for (uint32_t i = 0; i < self->construct_count; i++) {
+    for (uint32_t j = 0; j < self->construct_count; j++) {
+      if (self->constructs[j].label == sorted[i].label) {
+        rank[j] = i;
+        break;
+      }
+    }
+  }
+  memcpy(self->constructs, sorted, self->construct_count * sizeof(Construct));
+  free(sorted);
+
+  LineCost *lines = malloc((self->line_count + 1) * sizeof(LineCost));
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < self->line_capacity; i++) {
+    if (self->lines[i].cost) {
+      lines[count] = self->lines[i];
+      lines[count].construct = rank[lines[count].construct];
+      count++;
+    }
+  }
+  qsort(lines, count, sizeof(LineCost), compare_line_costs);
+  free(rank);
+  *line_count = count;
+  return lines;
+}
+
+static void print_report(const Profiler *self, const LineCost *lines, uint32_t line_count,
+                         unsigned top, unsigned lines_per_construct) {
+  uint64_t steps = 0, forked = 0, recoveries = 0;
+  printf("%-44s %12s %12s %10s %9s\n", "file", "steps", "forked", "recoveries", "versions");
+  for (uint32_t i = 0; self->files[i].path; i++) {
+    const FileTotals *f = &self->files[i];
+    printf("%-44s %12llu %12llu %10llu %9u\n", f->path, (unsigned long long)f->steps,
+           (unsigned long long)f->forked_steps, (unsigned long long)f->recoveries, f->max_versions);
+    steps += f->steps;
+    forked += f->forked_steps;
+    recoveries += f->recoveries;
+  }
+  printf("\n%llu steps, %.1f%% while forked, %llu error-recovery steps\n\n",
+         (unsigned long long)steps, steps ? 100.0 * (double)forked / (double)steps : 0,
+         (unsigned long long)recoveries);
+
+  printf("%-4s %-48s %10s %8s %8s %9s %10s %8s\n", "rank", "construct", "wasted", "splits",
+         "merges", "condenses", "recoveries", "versions");
+  uint32_t line = 0;
+  for (uint32_t i = 0; i < self->construct_count && i < top; i++) {
+    const Construct *c = &self->constructs[i];
+    if (construct_cost(c) == 0 && c->splits == 0) {
+      break;
+    }
+    printf("%-4u %-48s %10llu %8llu %8llu %9llu %10llu %8u\n", i + 1, c->label,
+           (unsigned long long)c->wasted_steps, (unsigned long long)c->splits,
+           (unsigned long long)c->merges, (unsigned long long)c->condenses,
+           (unsigned long long)c->recoveries, c->max_versions);
+
+    while (line < line_count && lines[line].construct < i) {
+      line++;
+    }
+    for (unsigned shown = 0; line < line_count && lines[line].construct == i; line++) {
+      if (shown++ < lines_per_construct) {
+        printf("       %s:%u  (%llu)\n", self->files[lines[line].file].path, lines[line].row + 1,
+               (unsigned long long)lines[line].cost);
+      }
+    }
+  }
+}
+
+static void print_json(const Profiler *self, const LineCost *lines, uint32_t line_count,
+                       unsigned top, unsigned lines_per_construct) {
+  printf("{\n  \"files\": [\n");
+  for (uint32_t i = 0; self->files[i].path; i++) {
+    const FileTotals *f = &self->files[i];
+    printf("    {\"file\": ");
+    tool_json_string(stdout, f->path);
+    printf(", \"steps\": %llu, \"forked_steps\": %llu, \"recoveries\": %llu, "
+           "\"max_versions\": %u}%s\n",
+           (unsigned long long)f->steps, (unsigned long long)f->forked_steps,
+           (unsigned long long)f->recoveries, f->max_versions, self->files[i + 1].path ? "," : "");
+  }
+  printf("  ],\n  \"constructs\": [\n");
+  uint32_t line = 0;
+  uint32_t shown_constructs = self->construct_count < top ? self->construct_count : top;
+  for (uint32_t i = 0; i < shown_constructs; i++) {
+    const Construct *c = &self->constructs[i];
+    printf("    {\"construct\": ");
+    tool_json_string(stdout, c->label);
+    printf(", \"wasted_steps\": %llu, \"forked_steps\": %llu, \"splits\": %llu, "
+           "\"merges\": %llu, \"condenses\": %llu, \"recoveries\": %llu, \"max_versions\": %u, "
+           "\"lines\": [",
+           (unsigned long long)c->wasted_steps, (unsigned long long)c->forked_steps,
+           (unsigned long long)c->splits, (unsigned long long)c->merges,
+           (unsigned long long)c->condenses, (unsigned long long)c->recoveries, c->max_versions);
+    while (line < line_count && lines[line].construct < i) {
+      line++;
+    }
+    for (unsigned shown = 0; line < line_count && lines[line].construct == i; line++) {
+      if (shown < lines_per_construct) {
+        printf("%s{\"file\": ", shown ? ", " : "");
+        tool_json_string(stdout, self->files[lines[line].file].path);
+        printf(", \"line\": %u, \"cost\": %llu}", lines[line].row + 1,
+               (unsigned long long)lines[line].cost);
+        shown++;
+      }
+    }
+    printf("]}%s\n", i + 1 < shown_constructs ? "," : "");
+  }
+  printf("  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+  unsigned top = 20;
+  unsigned lines_per_construct = 3;
+  bool json = false;
+  int first_file = 1;
+
+  for (; first_file < argc && argv[first_file][0] == '-'; first_file++) {
+    if (strcmp(argv[first_file], "--top") == 0 && first_file + 1 < argc) {
+      top = (unsigned)atoi(argv[++first_file]);
+    } else if (strcmp(argv[first_file], "--lines") == 0 && first_file + 1 < argc) {
+      lines_per_construct = (unsigned)atoi(argv[++first_file]);
+    } else if (strcmp(argv[first_file], "--json") == 0) {
+      json = true;
+    } else {
+      break;
+    }
+  }
+
+  if (first_file >= argc) {
+    fputs("usage: glr-profile [--top N] [--lines N] [--json] file...\n", stderr);
+    return 2;
+  }
+
+  Profiler profiler = {.fork_origin = NO_CONSTRUCT};
+  profiler.files = calloc((size_t)(argc - first_file + 1), sizeof(FileTotals));
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+  ts_parser_set_logger(parser, (TSLogger){&profiler, log_message});
+
+  int status = 0;
+  for (int i = first_file; i < argc; i++) {
+    size_t length;
+    char *source = tool_read_file(argv[i], &length);
+    if (!source) {
+      status = 1;
+      continue;
+    }
+
+    profiler.files[profiler.file].path = argv[i];
+    profiler.version_count = 0;
+    profiler.fork_origin = NO_CONSTRUCT;
+    profiler.lookahead[0] = '\0';
+    ts_tree_delete(ts_parser_parse_string(parser, NULL, source, (uint32_t)length));
+    profiler.file++;
+    free(source);
+  }
+
+  uint32_t line_count;
+  LineCost *lines = finish(&profiler, &line_count);
+  if (json) {
+    print_json(&profiler, lines, line_count, top, lines_per_construct);
+  } else {
+    print_report(&profiler, lines, line_count, top, lines_per_construct);
+  }
+
+  free(lines);
+  for (uint32_t i = 0; i < profiler.construct_count; i++) {
+    free(profiler.constructs[i].label);
+  }
+  free(profiler.constructs);
+  free(profiler.construct_index);
+  free(profiler.lines);
+  free(profiler.files);
+  ts_parser_delete(parser);
+  return status;
+}
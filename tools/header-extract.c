@@ -0,0 +1,248 @@
+// Document header extraction for bulk indexing.
+//
+// Prints one JSON object per file with the header fields read by
+// `ts_asciidoc_header_read`: title, authors, email, revision and the
+// attribute entries of the header. Only the header is read and parsed.
+//
+// --bench prints no metadata. It times the header reader over all files
+// against the full path it replaces (read the whole file, parse it, and
+// run a query for the header and its attribute entries), and reports files
+// per second and bytes read for both.
+//
+// --check runs the reader over built-in documents, from memory and through
+// a pipe, and exits 1 if a title or an attribute count is wrong. It covers
+// the blank lines and comments allowed before the header.
+//
+// Usage: header-extract [--bench] file... | header-extract --check
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+#include <unistd.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-header.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+static const char HEADER_QUERY[] = "(document_header) @header\n"
+                                   "(source_file (attribute_entry) @attribute)\n";
+
+typedef struct {
+  const char *text;
+  // NULL for a document without a title.
+  const char *title;
+  uint32_t attributes;
+} HeaderCase;
+
+static const HeaderCase HEADER_CASES[] = {
+  {"= Title\n:toc:\n\nBody\n", "Title", 1},
+  {"\n\n= Title\n:toc:\n\nBody\n", "Title", 1},
+  {" \n\t\n= Title\nJane Doe\n\n:late: no\n", "Title", 0},
+  {"\r\n\r\n= Title\r\n:toc:\r\n\r\n", "Title", 1},
+  {"// Licensed under MIT\n\n= Title\n\n", "Title", 0},
+  {"////\nLicense\n\nterms\n////\n\n= Title\n:a: 1\n:b: 2\n\nBody\n", "Title", 2},
+  {"\n\n= Title", "Title", 0},
+  {"A paragraph.\n\n= Not the title\n", NULL, 0},
+  {"\n:toc:\n\n= Not the title\n", NULL, 1},
+  {"\n\n", NULL, 0},
+  {"", NULL, 0},
+};
+
+static bool header_matches(const TSAsciidocHeader *header, const char *title,
+                           uint32_t attributes) {
+  if (!header || header->has_title != (title != NULL) ||
+      header->attribute_count != attributes) {
+    return false;
+  }
+  return !title || (header->title.length == strlen(title) &&
+                    memcmp(header->source + header->title.start_byte, title,
+                           header->title.length) == 0);
+}
+
+// Reads `text` through a pipe, as ts_asciidoc_header_read reads a file.
+static const TSAsciidocHeader *read_through_pipe(TSAsciidocHeaderReader *reader,
+                                                 const char *text, size_t length) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return NULL;
+  }
+  // Within the pipe's buffer, so nothing blocks.
+  bool written = write(fds[1], text, length) == (ssize_t)length;
+  close(fds[1]);
+  const TSAsciidocHeader *header = written ? ts_asciidoc_header_read_fd(reader, fds[0]) : NULL;
+  close(fds[0]);
+  return header;
+}
+
+static int check(void) {
+  TSAsciidocHeaderReader *reader = ts_asciidoc_header_reader_new();
+  uint32_t cases = sizeof(HEADER_CASES) / sizeof(HEADER_CASES[0]);
+  uint32_t failures = 0;
+  for (uint32_t i = 0; i <= cases; i++) {
+    // The last case has more leading blank lines than one read returns.
+    char padded[4096];
+    HeaderCase test = {padded, "Title", 1};
+    if (i == cases) {
+      memset(padded, '\n', 3000);
+      strcpy(padded + 3000, "= Title\n:toc:\n\nBody\n");
+    } else {
+      test = HEADER_CASES[i];
+    }
+    size_t length = strlen(test.text);
+    if (!header_matches(ts_asciidoc_header_parse(reader, test.text, (uint32_t)length),
+                        test.title, test.attributes)) {
+      fprintf(stderr, "case %u: wrong header from memory\n", i + 1);
+      failures++;
+    }
+    if (!header_matches(read_through_pipe(reader, test.text, length), test.title,
+                        test.attributes)) {
+      fprintf(stderr, "case %u: wrong header through a pipe\n", i + 1);
+      failures++;
+    }
+  }
+  ts_asciidoc_header_reader_delete(reader);
+  printf("%u header cases, %u failures\n", cases + 1, failures);
+  return failures ? 1 : 0;
+}
+
+static void print_slice(const TSAsciidocHeader *header, TSAsciidocSlice slice) {
+  char *text = malloc(slice.length + 1);
+  memcpy(text, header->source + slice.start_byte, slice.length);
+  text[slice.length] = 0;
+  tool_json_string(stdout, text);
+  free(text);
+}
+
+static void print_header(const char *path, const TSAsciidocHeader *header) {
+  printf("{\"path\": ");
+  tool_json_string(stdout, path);
+  printf(", \"title\": ");
+  if (header->has_title) {
+    print_slice(header, header->title);
+  } else {
+    printf("null");
+  }
+  printf(", \"authors\": [");
+  for (uint32_t i = 0; i < header->author_count; i++) {
+    printf(i ? ", " : "");
+    print_slice(header, header->author_names[i]);
+  }
+  printf("], \"email\": ");
+  print_slice(header, header->author_email);
+  printf(", \"revision\": {\"version\": ");
+  print_slice(header, header->revision_version);
+  printf(", \"date\": ");
+  print_slice(header, header->revision_date);
+  printf(", \"remark\": ");
+  print_slice(header, header->revision_remark);
+  printf("}, \"attributes\": {");
+  for (uint32_t i = 0; i < header->attribute_count; i++) {
+    printf(i ? ", " : "");
+    print_slice(header, header->attributes[i].name);
+    printf(": ");
+    print_slice(header, header->attributes[i].value);
+  }
+  printf("}, \"bytes_read\": %u%s}\n", header->source_length,
+         header->truncated ? ", \"truncated\": true" : "");
+}
+
+static int bench(char **paths, int count) {
+  TSAsciidocHeaderReader *reader = ts_asciidoc_header_reader_new();
+  uint64_t header_bytes = 0;
+  uint64_t begin = tool_now_ns();
+  for (int i = 0; i < count; i++) {
+    const TSAsciidocHeader *header = ts_asciidoc_header_read(reader, paths[i]);
+    if (!header) {
+      fprintf(stderr, "%s: %s\n", paths[i], strerror(errno));
+      ts_asciidoc_header_reader_delete(reader);
+      return 1;
+    }
+    header_bytes += header->source_length;
+  }
+  uint64_t header_ns = tool_now_ns() - begin;
+  ts_asciidoc_header_reader_delete(reader);
+
+  const TSLanguage *language = tree_sitter_asciidoc();
+  uint32_t error_offset;
+  TSQueryError error;
+  TSQuery *query =
+    ts_query_new(language, HEADER_QUERY, sizeof(HEADER_QUERY) - 1, &error_offset, &error);
+  if (!query) {
+    fprintf(stderr, "header query: error %d at offset %u\n", error, error_offset);
+    return 1;
+  }
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, language);
+  TSQueryCursor *cursor = ts_query_cursor_new();
+  uint64_t full_bytes = 0, captures = 0;
+  begin = tool_now_ns();
+  for (int i = 0; i < count; i++) {
+    size_t length;
+    char *source = tool_read_file(paths[i], &length);
+    if (!source) {
+      continue;
+    }
+    TSTree *tree = ts_parser_parse_string(parser, NULL, source, (uint32_t)length);
+    ts_query_cursor_exec(cursor, query, ts_tree_root_node(tree));
+    TSQueryMatch match;
+    while (ts_query_cursor_next_match(cursor, &match)) {
+      captures += match.capture_count;
+    }
+    ts_tree_delete(tree);
+    free(source);
+    full_bytes += length;
+  }
+  uint64_t full_ns = tool_now_ns() - begin;
+  ts_query_cursor_delete(cursor);
+  ts_parser_delete(parser);
+  ts_query_delete(query);
+
+  printf("%d files\n", count);
+  printf("%-24s %12s %14s %14s\n", "path", "files/s", "bytes read", "ms");
+  printf("%-24s %12.0f %14llu %14.2f\n", "header reader", count / (header_ns / 1e9),
+         (unsigned long long)header_bytes, header_ns / 1e6);
+  printf("%-24s %12.0f %14llu %14.2f\n", "full parse + query", count / (full_ns / 1e9),
+         (unsigned long long)full_bytes, full_ns / 1e6);
+  printf("speedup %.1fx (%llu query captures)\n", (double)full_ns / (double)header_ns,
+         (unsigned long long)captures);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  bool benchmark = false;
+  int first = 1;
+  if (argc == 2 && strcmp(argv[1], "--check") == 0) {
+    return check();
+  }
+  if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+    benchmark = true;
+    first = 2;
+  }
+  if (first >= argc || argv[first][0] == '-') {
+    fputs("usage: header-extract [--bench] file... | header-extract --check\n", stderr);
+    return 2;
+  }
+  if (benchmark) {
+    return bench(argv + first, argc - first);
+  }
+
+  TSAsciidocHeaderReader *reader = ts_asciidoc_header_reader_new();
+  int status = 0;
+  for (int i = first; i < argc; i++) {
+    const TSAsciidocHeader *header = ts_asciidoc_header_read(reader, argv[i]);
+    if (!header) {
+      fprintf(stderr, "%s: %s\n", argv[i], strerror(errno));
+      status = 1;
+      continue;
+    }
+    print_header(argv[i], header);
+  }
+  ts_asciidoc_header_reader_delete(reader);
+  return status;
+}
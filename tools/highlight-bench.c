@@ -0,0 +1,270 @@
+// Static highlight table benchmark.
+//
+// Highlights a document with `ts_asciidoc_highlight` and with a
+// `TSQueryCursor` running the full queries/highlights.scm, checks that both
+// produce the same spans (first pattern wins per node), and reports the
+// median time of each. The query time covers executing the cursor and
+// draining its captures; it does not include resolving overlapping captures,
+// which a real highlighter also has to do.
+//
+// --window BYTES times both over a window of that size in the middle of the
+// document instead, as an editor highlighting only its viewport would.
+//
+// Usage: highlight-bench [--iterations N] [--window BYTES] [--query file] [file]
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-highlight.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+typedef struct {
+  const void *id;
+  uint32_t start_byte;
+  uint32_t end_byte;
+  uint32_t pattern;
+  const char *capture;
+} QueryCapture;
+
+typedef struct {
+  uint32_t start_byte;
+  uint32_t end_byte;
+  const char *capture;
+} Span;
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+static int compare_query_captures(const void *a, const void *b) {
+  const QueryCapture *x = a;
+  const QueryCapture *y = b;
+  if (x->id != y->id) {
+    return (x->id > y->id) - (x->id < y->id);
+  }
+  if (x->start_byte != y->start_byte) {
+    return (x->start_byte > y->start_byte) - (x->start_byte < y->start_byte);
+  }
+  return (x->pattern > y->pattern) - (x->pattern < y->pattern);
+}
+
+static int compare_spans(const void *a, const void *b) {
+  const Span *x = a;
+  const Span *y = b;
+  if (x->start_byte != y->start_byte) {
+    return (x->start_byte > y->start_byte) - (x->start_byte < y->start_byte);
+  }
+  if (x->end_byte != y->end_byte) {
+    return (x->end_byte < y->end_byte) - (x->end_byte > y->end_byte);
+  }
+  return strcmp(x->capture, y->capture);
+}
+
+// Spans the query engine produces once each node keeps only the capture of
+// its first matching pattern.
+static Span *query_spans(TSQuery *query, TSNode root, uint32_t *count) {
+  TSQueryCursor *cursor = ts_query_cursor_new();
+  ts_query_cursor_exec(cursor, query, root);
+
+  uint32_t capacity = 1024, length = 0;
+  QueryCapture *captures = malloc(capacity * sizeof(QueryCapture));
+  TSQueryMatch match;
+  uint32_t capture_index;
+  while (ts_query_cursor_next_capture(cursor, &match, &capture_index)) {
+    const TSQueryCapture *capture = &match.captures[capture_index];
+    if (length == capacity) {
+      capacity *= 2;
+      captures = realloc(captures, capacity * sizeof(QueryCapture));
+    }
+    uint32_t name_length;
+    captures[length++] = (QueryCapture){
+      .id = capture->node.id,
+      .start_byte = ts_node_start_byte(capture->node),
+      .end_byte = ts_node_end_byte(capture->node),
+      .pattern = match.pattern_index,
+      .capture = ts_query_capture_name_for_id(query, capture->index, &name_length),
+    };
+  }
+  ts_query_cursor_delete(cursor);
+
+  qsort(captures, length, sizeof(QueryCapture), compare_query_captures);
+  Span *spans = malloc((length + 1) * sizeof(Span));
+  uint32_t span_count = 0;
+  for (uint32_t i = 0; i < length; i++) {
+    if (i > 0 && captures[i].id == captures[i - 1].id &&
+        captures[i].start_byte == captures[i - 1].start_byte) {
+      continue;
+    }
+    spans[span_count++] = (Span){captures[i].start_byte, captures[i].end_byte, captures[i].capture};
+  }
+  free(captures);
+
+  qsort(spans, span_count, sizeof(Span), compare_spans);
+  *count = span_count;
+  return spans;
+}
+
+static Span *table_spans(TSAsciidocHighlighter *highlighter, TSNode root, uint32_t *count) {
+  uint32_t length;
+  const TSAsciidocHighlightSpan *highlights =
+    ts_asciidoc_highlight(highlighter, root, 0, UINT32_MAX, &length);
+  Span *spans = malloc((length + 1) * sizeof(Span));
+  for (uint32_t i = 0; i < length; i++) {
+    spans[i] = (Span){
+      highlights[i].start_byte,
+      highlights[i].end_byte,
+      ts_asciidoc_highlighter_capture_name(highlighter, highlights[i].capture),
+    };
+  }
+  qsort(spans, length, sizeof(Span), compare_spans);
+  *count = length;
+  return spans;
+}
+
+static uint32_t compare_results(const Span *expected, uint32_t expected_count, const Span *actual,
+                                uint32_t actual_count) {
+  uint32_t mismatches = 0;
+  uint32_t i = 0, j = 0;
+  while (i < expected_count || j < actual_count) {
+    int order = i == expected_count ? 1
+                : j == actual_count ? -1
+                                    : compare_spans(&expected[i], &actual[j]);
+    if (order == 0) {
+      i++;
+      j++;
+      continue;
+    }
+    const Span *span = order < 0 ? &expected[i++] : &actual[j++];
+    if (mismatches++ < 10) {
+      fprintf(stderr, "%s: [%u, %u) @%s\n", order < 0 ? "query only" : "table only",
+              span->start_byte, span->end_byte, span->capture);
+    }
+  }
+  return mismatches;
+}
+
+int main(int argc, char **argv) {
+  unsigned iterations = 20;
+  uint64_t window = 0;
+  const char *query_path = "queries/highlights.scm";
+  const char *path = "asciidoc-syntax-reference.adoc";
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = (unsigned)atoi(argv[++i]);
+      if (iterations == 0) {
+        iterations = 1;
+      }
+    } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+      window = tool_parse_size(argv[++i]);
+    } else if (strcmp(argv[i], "--query") == 0 && i + 1 < argc) {
+      query_path = argv[++i];
+    } else if (argv[i][0] != '-') {
+      path = argv[i];
+    } else {
+      fputs("usage: highlight-bench [--iterations N] [--window BYTES] [--query file] [file]\n",
+            stderr);
+      return 2;
+    }
+  }
+
+  size_t length, query_length;
+  char *source = tool_read_file(path, &length);
+  char *query_source = tool_read_file(query_path, &query_length);
+  if (!source || !query_source) {
+    return 1;
+  }
+
+  const TSLanguage *language = tree_sitter_asciidoc();
+  uint32_t error_offset;
+  TSQueryError error_type;
+  TSQuery *query =
+    ts_query_new(language, query_source, (uint32_t)query_length, &error_offset, &error_type);
+  if (!query) {
+    fprintf(stderr, "%s: query error %d at byte %u\n", query_path, error_type, error_offset);
+    return 1;
+  }
+
+  TSAsciidocHighlighter *highlighter = ts_asciidoc_highlighter_new();
+  if (!highlighter) {
+    fputs("ts_asciidoc_highlighter_new failed; regenerate bindings/c/highlight-table.h\n", stderr);
+    return 1;
+  }
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, language);
+  TSTree *tree = ts_parser_parse_string(parser, NULL, source, (uint32_t)length);
+  TSNode root = ts_tree_root_node(tree);
+
+  uint32_t expected_count, actual_count;
+  Span *expected = query_spans(query, root, &expected_count);
+  Span *actual = table_spans(highlighter, root, &actual_count);
+  uint32_t mismatches = compare_results(expected, expected_count, actual, actual_count);
+
+  uint32_t window_start = 0, window_end = UINT32_MAX;
+  if (window > 0 && window < length) {
+    window_start = (uint32_t)((length - window) / 2);
+    window_end = window_start + (uint32_t)window;
+  }
+
+  uint64_t *query_ns = calloc(iterations, sizeof(uint64_t));
+  uint64_t *table_ns = calloc(iterations, sizeof(uint64_t));
+  TSQueryCursor *cursor = ts_query_cursor_new();
+  volatile uint32_t sink = 0;
+  for (unsigned i = 0; i < iterations; i++) {
+    uint64_t start = tool_now_ns();
+    ts_query_cursor_set_byte_range(cursor, window_start, window_end);
+    ts_query_cursor_exec(cursor, query, root);
+    TSQueryMatch match;
+    uint32_t capture_index;
+    while (ts_query_cursor_next_capture(cursor, &match, &capture_index)) {
+      sink += capture_index;
+    }
+    query_ns[i] = tool_now_ns() - start;
+
+    start = tool_now_ns();
+    uint32_t count;
+    ts_asciidoc_highlight(highlighter, root, window_start, window_end, &count);
+    table_ns[i] = tool_now_ns() - start;
+    sink += count;
+  }
+  qsort(query_ns, iterations, sizeof(uint64_t), compare_u64);
+  qsort(table_ns, iterations, sizeof(uint64_t), compare_u64);
+  uint64_t query_median = query_ns[iterations / 2];
+  uint64_t table_median = table_ns[iterations / 2];
+
+  double measured = window_end == UINT32_MAX ? (double)length : (double)(window_end - window_start);
+  printf("%s: %zu bytes, %u spans", path, length, actual_count);
+  if (window_end != UINT32_MAX) {
+    printf(", window [%u, %u)", window_start, window_end);
+  }
+  printf("\n%-16s %10s %10s\n", "", "ms", "MB/s");
+  printf("%-16s %10.3f %10.2f\n", "ts_query_cursor", (double)query_median / 1e6,
+         measured / 1e6 / ((double)query_median / 1e9));
+  printf("%-16s %10.3f %10.2f\n", "static table", (double)table_median / 1e6,
+         measured / 1e6 / ((double)table_median / 1e9));
+  printf("speedup: %.2fx\n", table_median ? (double)query_median / (double)table_median : 0);
+  if (mismatches) {
+    fprintf(stderr, "%u spans differ from the query engine\n", mismatches);
+  }
+
+  free(query_ns);
+  free(table_ns);
+  free(expected);
+  free(actual);
+  ts_query_cursor_delete(cursor);
+  ts_tree_delete(tree);
+  ts_parser_delete(parser);
+  ts_asciidoc_highlighter_delete(highlighter);
+  ts_query_delete(query);
+  free(query_source);
+  free(source);
+  return mismatches ? 1 : 0;
+}
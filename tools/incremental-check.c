@@ -0,0 +1,581 @@
+// Incremental update check for the editor library.
+//
+// Replays edits against a document and, after each reparse, compares what
+// the incremental providers hold with a fresh computation over the new
+// tree. For semantic tokens, in both position encodings, the `data` array
+// after ts_asciidoc_semantic_tokens_edit and _update must equal a
+// whole-document tokenization, and the previous array with the
+// `semanticTokens/full/delta` edits applied must equal the new one. For
+// folds, the list after ts_asciidoc_folds_edit and _update must equal the
+// folds of the new tree, and the folds as the edit moved them, less the
+// removed ones, plus the added ones, must equal that list too.
+//
+// A built-in script covers inline markup typed a character at a time,
+// inserts and deletes spanning lines, joined lines, non-ASCII text whose
+// UTF-16 columns differ from its bytes, and blocks opened and closed. Each
+// file argument then gets --edits random edits from a seeded generator, so
+// a failure can be replayed.
+//
+// Usage: incremental-check [--edits N] [--seed N] [file...]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-fold.h"
+#include "tree_sitter/tree-sitter-asciidoc-semantic-tokens.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+#define ENCODING_COUNT 2
+
+static const char *const ENCODING_NAMES[ENCODING_COUNT] = {"utf-16", "utf-8"};
+
+// Replaces the text from `skip` bytes into the first occurrence of `at` up
+// to the first occurrence of `until` after it, or nothing when `until` is
+// NULL, with `text`.
+typedef struct {
+  const char *at;
+  uint32_t skip;
+  const char *until;
+  const char *text;
+} ScriptEdit;
+
+typedef struct {
+  const char *name;
+  const char *source;
+  ScriptEdit edits[8];
+} Script;
+
+static const Script SCRIPTS[] = {
+  {
+    .name = "inline markup typed a character at a time",
+    .source = "= Title\n\nSome plain text here.\n\nA second paragraph.\n",
+    .edits =
+      {
+        {.at = "plain", .text = "*"},
+        {.at = "plain", .skip = 5, .text = "*"},
+        {.at = "second", .text = "_"},
+        {.at = "second", .skip = 6, .text = "_"},
+        {.at = "*plain", .until = "plain"},
+        {.at = "A _second", .skip = 2, .until = "second", .text = "`"},
+      },
+  },
+  {
+    .name = "edits spanning lines",
+    .source = "= Title\n\n== One\n\nFirst *bold* paragraph.\n\n== Two\n\n"
+              "Second `code` paragraph.\n",
+    .edits =
+      {
+        {.at = "== Two", .text = "== Inserted\n\nText with _emphasis_\nover two lines.\n\n"},
+        {.at = "\nover", .until = "over", .text = " "},
+        {.at = "*bold*", .until = "_emphasis_", .text = "*bold* text.\n\nMore "},
+        {.at = "First", .until = "Second", .text = ""},
+        {.at = "Second", .text = "\n\n\n"},
+        {.at = "= Title", .skip = 7, .until = "Second", .text = "\n"},
+      },
+  },
+  {
+    .name = "non-ASCII text",
+    .source = "= T\xc3\xaftle\n\n\xc3\x9cmlaut *bold* and \xf0\x9f\x98\x80 `code` here.\n\n"
+              "Na\xc3\xafve _text_ \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e end.\n",
+    .edits =
+      {
+        {.at = "*bold*", .text = "\xf0\x9f\x98\x80\xc3\xa9 "},
+        {.at = "\xf0\x9f\x98\x80 `code`", .until = " `code`"},
+        {.at = "\xe6\x97\xa5",
+         .until = " end",
+         .text = "\xe3\x83\x86\xe3\x82\xad *\xe5\xbc\xb7*"},
+        {.at = "Na\xc3\xafve",
+         .text = "== \xc3\x9cn\xc3\xaf" "code\n\n\xf0\x9f\x98\x80 *x*\n\n"},
+        {.at = "\xf0\x9f\x98\x80 *x*", .skip = 4, .until = "*x*", .text = "\n"},
+        {.at = "\xc3\x9cmlaut", .until = "Na\xc3\xafve", .text = "\xc3\xa9"},
+      },
+  },
+  {
+    .name = "blocks opened and closed",
+    .source = "= Title\n\n== One\n\nText.\n\n== Two\n\nMore text.\n",
+    .edits =
+      {
+        {.at = "Text.", .text = "----\n"},
+        {.at = "Text.", .skip = 5, .text = "\n----"},
+        {.at = "More", .text = "====\n"},
+        {.at = "More text.", .skip = 10, .text = "\n===="},
+        {.at = "----\nText", .until = "Text"},
+        {.at = "== Two", .text = "* one\n* two\n\n"},
+        {.at = "== One", .until = "== Two"},
+      },
+  },
+};
+
+#define SCRIPT_COUNT (sizeof(SCRIPTS) / sizeof(SCRIPTS[0]))
+
+// Inserted by the random edits: markup that opens and closes inline spans,
+// line breaks, headings, block fences and non-ASCII text.
+static const char *const SNIPPETS[] = {
+  "*",      "_",          "`",      "#",      "\n",         "\n\n",         "== Heading\n",
+  "----\n", "|===\n",     "....\n", " word ", "{attr}",     "<<ref>>",      "[source,c]\n",
+  "\xc3\xa9", "\xf0\x9f\x98\x80", "\xe6\x97\xa5\xe6\x9c\xac", "* item\n", ":name: value\n",
+  "====\n", "****\n",
+};
+
+#define SNIPPET_COUNT (sizeof(SNIPPETS) / sizeof(SNIPPETS[0]))
+
+typedef struct {
+  char *data;
+  uint32_t length;
+  uint32_t capacity;
+} Buffer;
+
+// The last `data` array sent to the client.
+typedef struct {
+  uint32_t *data;
+  uint32_t count;
+  uint32_t capacity;
+} Sent;
+
+typedef struct {
+  TSAsciidocFold *contents;
+  uint32_t size;
+  uint32_t capacity;
+} FoldList;
+
+typedef struct {
+  TSParser *parser;
+  TSAsciidocSemanticTokens *tokens[ENCODING_COUNT];
+  TSAsciidocSemanticTokens *fresh_tokens[ENCODING_COUNT];
+  Sent sent[ENCODING_COUNT];
+  uint32_t *patched;
+  uint32_t patched_capacity;
+  TSAsciidocFolds *folds;
+  TSAsciidocFolds *fresh_folds;
+  // The folds after the edit moved them, and the expected list built from
+  // them.
+  FoldList moved;
+  FoldList expected;
+  uint64_t rng;
+  uint32_t edits;
+  uint32_t failures;
+} Checker;
+
+static void buffer_set(Buffer *self, const char *text, uint32_t length) {
+  if (length + 1 > self->capacity) {
+    self->capacity = (length + 1) * 2;
+    self->data = realloc(self->data, self->capacity);
+  }
+  memcpy(self->data, text, length);
+  self->data[length] = '\0';
+  self->length = length;
+}
+
+static void buffer_splice(Buffer *self, uint32_t start, uint32_t removed, const char *text) {
+  uint32_t inserted = (uint32_t)strlen(text);
+  if (self->length - removed + inserted + 1 > self->capacity) {
+    self->capacity = (self->length - removed + inserted + 1) * 2;
+    self->data = realloc(self->data, self->capacity);
+  }
+  memmove(self->data + start + inserted, self->data + start + removed,
+          self->length - start - removed + 1);
+  memcpy(self->data + start, text, inserted);
+  self->length = self->length - removed + inserted;
+}
+
+static TSPoint point_at(const Buffer *text, uint32_t offset) {
+  TSPoint point = {0, 0};
+  for (uint32_t i = 0; i < offset; i++) {
+    if (text->data[i] == '\n') {
+      point.row++;
+      point.column = 0;
+    } else {
+      point.column++;
+    }
+  }
+  return point;
+}
+
+static void *reserve(void *data, uint32_t *capacity, uint32_t count, size_t size) {
+  if (count > *capacity) {
+    *capacity = count * 2;
+    data = realloc(data, *capacity * size);
+  }
+  return data;
+}
+
+// splitmix64, as in gen-corpus.
+static uint64_t next_random(Checker *self) {
+  uint64_t z = (self->rng += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static uint32_t random_below(Checker *self, uint32_t bound) {
+  return bound ? (uint32_t)(next_random(self) % bound) : 0;
+}
+
+static void fail(Checker *self, const char *name, uint32_t step, const char *format, ...) {
+  self->failures++;
+  fprintf(stderr, "%s: edit %u: ", name, step);
+  va_list arguments;
+  va_start(arguments, format);
+  vfprintf(stderr, format, arguments);
+  va_end(arguments);
+  fputc('\n', stderr);
+}
+
+static void send_tokens(Checker *self, int encoding) {
+  Sent *sent = &self->sent[encoding];
+  uint32_t count;
+  const uint32_t *data = ts_asciidoc_semantic_tokens_data(self->tokens[encoding], &count);
+  sent->data = reserve(sent->data, &sent->capacity, count + 1, sizeof(uint32_t));
+  memcpy(sent->data, data, count * sizeof(uint32_t));
+  sent->count = count;
+}
+
+// The sent array with the delta applied, in self->patched. Returns its
+// length, or UINT32_MAX if the edits are out of order or out of range.
+static uint32_t apply_delta(Checker *self, const Sent *sent,
+                            const TSAsciidocSemanticTokensEdit *edits, uint32_t edit_count) {
+  uint32_t previous_count = sent->count;
+  uint32_t length = 0;
+  uint32_t position = 0;
+  for (uint32_t i = 0; i <= edit_count; i++) {
+    uint32_t start = i < edit_count ? edits[i].start : previous_count;
+    if (start < position || start > previous_count ||
+        (i < edit_count && edits[i].delete_count > previous_count - start)) {
+      return UINT32_MAX;
+    }
+    uint32_t inserted = i < edit_count ? edits[i].data_count : 0;
+    self->patched = reserve(self->patched, &self->patched_capacity,
+                            length + (start - position) + inserted, sizeof(uint32_t));
+    memcpy(self->patched + length, sent->data + position,
+           (start - position) * sizeof(uint32_t));
+    length += start - position;
+    if (i < edit_count) {
+      memcpy(self->patched + length, edits[i].data, inserted * sizeof(uint32_t));
+      length += inserted;
+      position = start + edits[i].delete_count;
+    }
+  }
+  return length;
+}
+
+static void check_tokens(Checker *self, const char *name, uint32_t step, int encoding,
+                         const TSTree *old_tree, const TSTree *tree, const Buffer *text) {
+  TSAsciidocSemanticTokens *tokens = self->tokens[encoding];
+  TSAsciidocSemanticTokens *fresh = self->fresh_tokens[encoding];
+  const char *label = ENCODING_NAMES[encoding];
+  ts_asciidoc_semantic_tokens_update(tokens, old_tree, tree, text->data, text->length);
+  ts_asciidoc_semantic_tokens_update(fresh, NULL, tree, text->data, text->length);
+
+  uint32_t count, expected_count;
+  const uint32_t *data = ts_asciidoc_semantic_tokens_data(tokens, &count);
+  const uint32_t *expected = ts_asciidoc_semantic_tokens_data(fresh, &expected_count);
+  if (count != expected_count) {
+    fail(self, name, step, "%s tokens: %u integers incrementally, %u from scratch", label, count,
+         expected_count);
+  } else {
+    for (uint32_t i = 0; i < count; i++) {
+      if (data[i] != expected[i]) {
+        fail(self, name, step, "%s tokens differ from scratch at integer %u: %u, not %u", label,
+             i, data[i], expected[i]);
+        break;
+      }
+    }
+  }
+
+  uint32_t edit_count;
+  const TSAsciidocSemanticTokensEdit *edits =
+    ts_asciidoc_semantic_tokens_delta(tokens, &edit_count);
+  uint32_t patched = apply_delta(self, &self->sent[encoding], edits, edit_count);
+  if (patched == UINT32_MAX) {
+    fail(self, name, step, "%s delta of %u edits does not fit the %u integers sent before",
+         label, edit_count, self->sent[encoding].count);
+  } else if (patched != count || memcmp(self->patched, data, count * sizeof(uint32_t)) != 0) {
+    fail(self, name, step, "%s delta applied to the sent array does not give the new one",
+         label);
+  }
+  send_tokens(self, encoding);
+}
+
+static void fold_list_set(FoldList *list, const TSAsciidocFold *folds, uint32_t count) {
+  list->contents = reserve(list->contents, &list->capacity, count + 1, sizeof(TSAsciidocFold));
+  memcpy(list->contents, folds, count * sizeof(TSAsciidocFold));
+  list->size = count;
+}
+
+static void fold_list_append(FoldList *list, const TSAsciidocFold *folds, uint32_t count) {
+  list->contents =
+    reserve(list->contents, &list->capacity, list->size + count + 1, sizeof(TSAsciidocFold));
+  memcpy(list->contents + list->size, folds, count * sizeof(TSAsciidocFold));
+  list->size += count;
+}
+
+static bool same_fold(const TSAsciidocFold *a, const TSAsciidocFold *b) {
+  return a->start_byte == b->start_byte && a->end_byte == b->end_byte &&
+         a->start_point.row == b->start_point.row &&
+         a->start_point.column == b->start_point.column &&
+         a->end_point.row == b->end_point.row && a->end_point.column == b->end_point.column &&
+         a->symbol == b->symbol;
+}
+
+// The order of ts_asciidoc_folds.
+static int compare_folds(const void *a, const void *b) {
+  const TSAsciidocFold *x = a;
+  const TSAsciidocFold *y = b;
+  if (x->start_byte != y->start_byte) {
+    return (x->start_byte > y->start_byte) - (x->start_byte < y->start_byte);
+  }
+  if (x->end_byte != y->end_byte) {
+    return (x->end_byte < y->end_byte) - (x->end_byte > y->end_byte);
+  }
+  return (x->symbol > y->symbol) - (x->symbol < y->symbol);
+}
+
+// Index of the first fold of `folds` that differs from `expected`, or
+// UINT32_MAX if the lists are the same.
+static uint32_t first_difference(const TSAsciidocFold *folds, uint32_t count,
+                                 const TSAsciidocFold *expected, uint32_t expected_count) {
+  for (uint32_t i = 0; i < count || i < expected_count; i++) {
+    if (i == count || i == expected_count || !same_fold(&folds[i], &expected[i])) {
+      return i;
+    }
+  }
+  return UINT32_MAX;
+}
+
+static void check_folds(Checker *self, const char *name, uint32_t step, const TSTree *old_tree,
+                        const TSTree *tree) {
+  ts_asciidoc_folds_update(self->folds, old_tree, tree);
+  ts_asciidoc_folds_update(self->fresh_folds, NULL, tree);
+
+  uint32_t count, fresh_count;
+  const TSAsciidocFold *folds = ts_asciidoc_folds(self->folds, &count);
+  const TSAsciidocFold *fresh = ts_asciidoc_folds(self->fresh_folds, &fresh_count);
+  uint32_t index = first_difference(folds, count, fresh, fresh_count);
+  if (index != UINT32_MAX) {
+    fail(self, name, step, "fold %u of %u differs from the %u folds of the new tree", index,
+         count, fresh_count);
+  }
+
+  // Moved folds less the removed ones; both lists are in fold order.
+  uint32_t added_count, removed_count;
+  const TSAsciidocFold *added = ts_asciidoc_folds_added(self->folds, &added_count);
+  const TSAsciidocFold *removed = ts_asciidoc_folds_removed(self->folds, &removed_count);
+  qsort(self->moved.contents, self->moved.size, sizeof(TSAsciidocFold), compare_folds);
+  self->expected.size = 0;
+  uint32_t next_removed = 0;
+  for (uint32_t i = 0; i < self->moved.size; i++) {
+    const TSAsciidocFold *fold = &self->moved.contents[i];
+    while (next_removed < removed_count && compare_folds(&removed[next_removed], fold) < 0) {
+      next_removed++;
+    }
+    if (next_removed < removed_count && same_fold(&removed[next_removed], fold)) {
+      next_removed++;
+    } else {
+      fold_list_append(&self->expected, fold, 1);
+    }
+  }
+  fold_list_append(&self->expected, added, added_count);
+  qsort(self->expected.contents, self->expected.size, sizeof(TSAsciidocFold), compare_folds);
+  index = first_difference(folds, count, self->expected.contents, self->expected.size);
+  if (index != UINT32_MAX) {
+    fail(self, name, step,
+         "fold %u: %u folds before, %u removed and %u added do not give the %u folds after",
+         index, self->moved.size, removed_count, added_count, count);
+  }
+}
+
+static void start_document(Checker *self, TSTree **tree, const Buffer *text) {
+  *tree = ts_parser_parse_string(self->parser, NULL, text->data, text->length);
+  for (int encoding = 0; encoding < ENCODING_COUNT; encoding++) {
+    ts_asciidoc_semantic_tokens_update(self->tokens[encoding], NULL, *tree, text->data,
+                                       text->length);
+    send_tokens(self, encoding);
+  }
+  ts_asciidoc_folds_update(self->folds, NULL, *tree);
+}
+
+// Replaces `removed` bytes at `start` with `inserted`, as an editor would:
+// ts_tree_edit and the providers' edit calls, then a reparse from the old
+// tree, then the checks. Returns the new tree.
+static TSTree *apply_edit(Checker *self, const char *name, uint32_t step, TSTree *tree,
+                          Buffer *text, uint32_t start, uint32_t removed, const char *inserted) {
+  TSInputEdit edit = {
+    .start_byte = start,
+    .old_end_byte = start + removed,
+    .new_end_byte = start + (uint32_t)strlen(inserted),
+    .start_point = point_at(text, start),
+    .old_end_point = point_at(text, start + removed),
+  };
+  buffer_splice(text, start, removed, inserted);
+  edit.new_end_point = point_at(text, edit.new_end_byte);
+
+  ts_tree_edit(tree, &edit);
+  for (int encoding = 0; encoding < ENCODING_COUNT; encoding++) {
+    ts_asciidoc_semantic_tokens_edit(self->tokens[encoding], &edit);
+  }
+  ts_asciidoc_folds_edit(self->folds, &edit);
+  uint32_t fold_count;
+  const TSAsciidocFold *folds = ts_asciidoc_folds(self->folds, &fold_count);
+  fold_list_set(&self->moved, folds, fold_count);
+  TSTree *new_tree = ts_parser_parse_string(self->parser, tree, text->data, text->length);
+
+  self->edits++;
+  for (int encoding = 0; encoding < ENCODING_COUNT; encoding++) {
+    check_tokens(self, name, step, encoding, tree, new_tree, text);
+  }
+  check_folds(self, name, step, tree, new_tree);
+  ts_tree_delete(tree);
+  return new_tree;
+}
+
+static void run_script(Checker *self, const Script *script) {
+  Buffer text = {0};
+  buffer_set(&text, script->source, (uint32_t)strlen(script->source));
+  TSTree *tree;
+  start_document(self, &tree, &text);
+
+  for (uint32_t i = 0; i < sizeof(script->edits) / sizeof(script->edits[0]); i++) {
+    const ScriptEdit *edit = &script->edits[i];
+    if (!edit->at) {
+      break;
+    }
+    const char *at = strstr(text.data, edit->at);
+    if (!at) {
+      fprintf(stderr, "%s: edit %u: \"%s\" not found\n", script->name, i + 1, edit->at);
+      self->failures++;
+      break;
+    }
+    uint32_t start = (uint32_t)(at - text.data) + edit->skip;
+    uint32_t removed = 0;
+    if (edit->until) {
+      const char *until = strstr(text.data + start, edit->until);
+      removed = until ? (uint32_t)(until - text.data) - start : 0;
+    }
+    tree = apply_edit(self, script->name, i + 1, tree, &text, start, removed,
+                      edit->text ? edit->text : "");
+  }
+
+  ts_tree_delete(tree);
+  free(text.data);
+}
+
+// Moves `offset` back to the start of a UTF-8 sequence.
+static uint32_t char_boundary(const Buffer *text, uint32_t offset) {
+  while (offset > 0 && offset < text->length && (text->data[offset] & 0xc0) == 0x80) {
+    offset--;
+  }
+  return offset;
+}
+
+static bool run_file(Checker *self, const char *path, uint32_t edit_count) {
+  size_t length;
+  char *source = tool_read_file(path, &length);
+  if (!source) {
+    return false;
+  }
+  Buffer text = {0};
+  buffer_set(&text, source, (uint32_t)length);
+  free(source);
+  TSTree *tree;
+  start_document(self, &tree, &text);
+
+  for (uint32_t i = 0; i < edit_count; i++) {
+    uint32_t start = char_boundary(&text, random_below(self, text.length + 1));
+    uint32_t end = start;
+    // Mostly insertions; some also delete a few bytes or the rest of the line.
+    switch (random_below(self, 4)) {
+      case 0:
+        end = char_boundary(&text, start + random_below(self, 24));
+        if (end > text.length) {
+          end = text.length;
+        }
+        break;
+      case 1: {
+        const char *newline = memchr(text.data + start, '\n', text.length - start);
+        end = newline ? (uint32_t)(newline - text.data) + 1 : text.length;
+        break;
+      }
+      default:
+        break;
+    }
+    if (end < start) {
+      end = start;
+    }
+    tree = apply_edit(self, path, i + 1, tree, &text, start, end - start,
+                      SNIPPETS[random_below(self, SNIPPET_COUNT)]);
+  }
+
+  ts_tree_delete(tree);
+  free(text.data);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  uint32_t edit_count = 200;
+  uint64_t seed = 1;
+
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "--edits") == 0 && first + 1 < argc) {
+      int value = atoi(argv[++first]);
+      edit_count = value > 0 ? (uint32_t)value : 0;
+    } else if (strcmp(argv[first], "--seed") == 0 && first + 1 < argc) {
+      seed = strtoull(argv[++first], NULL, 10);
+    } else {
+      fputs("usage: incremental-check [--edits N] [--seed N] [file...]\n", stderr);
+      return 2;
+    }
+  }
+
+  Checker checker = {
+    .parser = ts_parser_new(),
+    .folds = ts_asciidoc_folds_new(),
+    .fresh_folds = ts_asciidoc_folds_new(),
+    .rng = seed,
+  };
+  ts_parser_set_language(checker.parser, tree_sitter_asciidoc());
+  for (int encoding = 0; encoding < ENCODING_COUNT; encoding++) {
+    TSAsciidocPositionEncoding value =
+      encoding == 0 ? TSAsciidocPositionUTF16 : TSAsciidocPositionUTF8;
+    checker.tokens[encoding] = ts_asciidoc_semantic_tokens_new(value);
+    checker.fresh_tokens[encoding] = ts_asciidoc_semantic_tokens_new(value);
+    if (!checker.tokens[encoding] || !checker.fresh_tokens[encoding]) {
+      fputs("incremental-check: cannot create the highlighter\n", stderr);
+      return 2;
+    }
+  }
+
+  bool ok = true;
+  for (uint32_t i = 0; i < SCRIPT_COUNT; i++) {
+    run_script(&checker, &SCRIPTS[i]);
+  }
+  for (int i = first; i < argc; i++) {
+    ok = run_file(&checker, argv[i], edit_count) && ok;
+  }
+
+  printf("%u edits checked, %u failures\n", checker.edits, checker.failures);
+
+  for (int encoding = 0; encoding < ENCODING_COUNT; encoding++) {
+    ts_asciidoc_semantic_tokens_delete(checker.tokens[encoding]);
+    ts_asciidoc_semantic_tokens_delete(checker.fresh_tokens[encoding]);
+  }
+  ts_parser_delete(checker.parser);
+  for (int encoding = 0; encoding < ENCODING_COUNT; encoding++) {
+    free(checker.sent[encoding].data);
+  }
+  free(checker.patched);
+  ts_asciidoc_folds_delete(checker.folds);
+  ts_asciidoc_folds_delete(checker.fresh_folds);
+  free(checker.moved.contents);
+  free(checker.expected.contents);
+  return ok && checker.failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,223 @@
+// Node kind statistics for a set of documents.
+//
+// Parses each file, or with --corpus each example of the given test/corpus
+// files, and adds its tree to a TSAsciidocStats. Reports, for every node
+// kind of the grammar, the node count, the bytes covered, the estimated
+// tree memory and its share of the total, and the ERROR and MISSING nodes
+// inside that kind with their rate per thousand nodes of it; kinds are
+// sorted by memory. Anonymous kinds are shown quoted. Then lists the --top
+// documents with the most nodes per byte, the ones whose trees cost the
+// most to keep open for their size.
+//
+// Usage: parse-stats [--corpus] [--top N] [--json] file...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-stats.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+typedef struct {
+  char *label;
+  TSAsciidocTreeStats stats;
+} Document;
+
+typedef struct {
+  TSParser *parser;
+  TSAsciidocStats *stats;
+  Document *documents;
+  uint32_t count;
+  uint32_t capacity;
+} Context;
+
+static void add_document(Context *context, const char *label, const char *source,
+                         uint32_t length) {
+  TSTree *tree = ts_parser_parse_string(context->parser, NULL, source, length);
+  if (!tree) {
+    fprintf(stderr, "%s: parse failed\n", label);
+    return;
+  }
+  TSAsciidocTreeStats stats = ts_asciidoc_stats_add_tree(context->stats, tree);
+  ts_tree_delete(tree);
+  if (context->count == context->capacity) {
+    context->capacity = context->capacity ? context->capacity * 2 : 64;
+    context->documents = realloc(context->documents, context->capacity * sizeof(Document));
+  }
+  size_t size = strlen(label) + 1;
+  Document *document = &context->documents[context->count++];
+  document->label = malloc(size);
+  memcpy(document->label, label, size);
+  document->stats = stats;
+}
+
+static double nodes_per_byte(const TSAsciidocTreeStats *stats) {
+  return stats->bytes ? (double)stats->nodes / stats->bytes : 0;
+}
+
+static int compare_density(const void *a, const void *b) {
+  double x = nodes_per_byte(&((const Document *)a)->stats);
+  double y = nodes_per_byte(&((const Document *)b)->stats);
+  return (x < y) - (x > y);
+}
+
+static int compare_memory(const void *a, const void *b) {
+  const TSAsciidocKindStats *x = a;
+  const TSAsciidocKindStats *y = b;
+  if (x->memory_bytes != y->memory_bytes) {
+    return (x->memory_bytes < y->memory_bytes) - (x->memory_bytes > y->memory_bytes);
+  }
+  return (x->count < y->count) - (x->count > y->count);
+}
+
+static double per_thousand(uint64_t part, uint64_t whole) {
+  return whole ? 1000.0 * part / whole : 0;
+}
+
+static void print_text(const TSAsciidocKindStats *kinds, uint32_t kind_count,
+                       const TSAsciidocTreeStats *totals, const Document *documents,
+                       uint32_t top) {
+  printf("%-32s %10s %12s %10s %6s %8s %8s %7s\n", "kind", "count", "bytes", "mem KiB", "mem %",
+         "errors", "missing", "per 1k");
+  for (uint32_t i = 0; i < kind_count; i++) {
+    const TSAsciidocKindStats *kind = &kinds[i];
+    char name[64];
+    snprintf(name, sizeof(name), kind->named ? "%s" : "\"%s\"", kind->kind);
+    printf("%-32s %10llu %12llu %10.1f %6.1f %8llu %8llu %7.2f\n", name,
+           (unsigned long long)kind->count, (unsigned long long)kind->bytes,
+           kind->memory_bytes / 1024.0,
+           totals->memory_bytes ? 100.0 * kind->memory_bytes / totals->memory_bytes : 0,
+           (unsigned long long)kind->errors_within, (unsigned long long)kind->missing_within,
+           per_thousand(kind->errors_within + kind->missing_within, kind->count));
+  }
+  printf("\n%llu nodes over %llu bytes (%.3f nodes/byte), about %.1f KiB of tree, "
+         "%llu ERROR and %llu MISSING nodes\n",
+         (unsigned long long)totals->nodes, (unsigned long long)totals->bytes,
+         nodes_per_byte(totals), totals->memory_bytes / 1024.0,
+         (unsigned long long)totals->errors, (unsigned long long)totals->missing);
+
+  if (top > 0) {
+    printf("\n%-48s %10s %10s %10s\n", "most nodes per byte", "bytes", "nodes", "nodes/B");
+    for (uint32_t i = 0; i < top; i++) {
+      const TSAsciidocTreeStats *stats = &documents[i].stats;
+      printf("%-48s %10llu %10llu %10.3f\n", documents[i].label,
+             (unsigned long long)stats->bytes, (unsigned long long)stats->nodes,
+             nodes_per_byte(stats));
+    }
+  }
+}
+
+static void print_json(const TSAsciidocKindStats *kinds, uint32_t kind_count,
+                       const TSAsciidocTreeStats *totals, const Document *documents,
+                       uint32_t document_count, uint32_t top) {
+  printf("{\"documents\": %u, \"nodes\": %llu, \"bytes\": %llu, \"memory_bytes\": %llu, "
+         "\"errors\": %llu, \"missing\": %llu, \"kinds\": [",
+         document_count, (unsigned long long)totals->nodes, (unsigned long long)totals->bytes,
+         (unsigned long long)totals->memory_bytes, (unsigned long long)totals->errors,
+         (unsigned long long)totals->missing);
+  for (uint32_t i = 0; i < kind_count; i++) {
+    const TSAsciidocKindStats *kind = &kinds[i];
+    printf("%s{\"kind\": ", i ? ", " : "");
+    tool_json_string(stdout, kind->kind);
+    printf(", \"named\": %s, \"count\": %llu, \"bytes\": %llu, \"memory_bytes\": %llu, "
+           "\"errors_within\": %llu, \"missing_within\": %llu}",
+           kind->named ? "true" : "false", (unsigned long long)kind->count,
+           (unsigned long long)kind->bytes, (unsigned long long)kind->memory_bytes,
+           (unsigned long long)kind->errors_within, (unsigned long long)kind->missing_within);
+  }
+  printf("], \"most_nodes_per_byte\": [");
+  for (uint32_t i = 0; i < top; i++) {
+    const TSAsciidocTreeStats *stats = &documents[i].stats;
+    printf("%s{\"document\": ", i ? ", " : "");
+    tool_json_string(stdout, documents[i].label);
+    printf(", \"bytes\": %llu, \"nodes\": %llu, \"nodes_per_byte\": %.4f}",
+           (unsigned long long)stats->bytes, (unsigned long long)stats->nodes,
+           nodes_per_byte(stats));
+  }
+  printf("]}\n");
+}
+
+int main(int argc, char **argv) {
+  bool corpus = false;
+  bool json = false;
+  uint32_t top = 10;
+
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "--corpus") == 0) {
+      corpus = true;
+    } else if (strcmp(argv[first], "--top") == 0 && first + 1 < argc) {
+      int value = atoi(argv[++first]);
+      top = value > 0 ? (uint32_t)value : 0;
+    } else if (strcmp(argv[first], "--json") == 0) {
+      json = true;
+    } else {
+      break;
+    }
+  }
+  if (first >= argc) {
+    fputs("usage: parse-stats [--corpus] [--top N] [--json] file...\n", stderr);
+    return 2;
+  }
+
+  Context context = {.parser = ts_parser_new(), .stats = ts_asciidoc_stats_new()};
+  ts_parser_set_language(context.parser, tree_sitter_asciidoc());
+  bool ok = true;
+  for (int i = first; i < argc; i++) {
+    if (corpus) {
+      uint32_t count;
+      ToolCorpusExample *examples = tool_read_corpus(argv[i], &count);
+      if (!examples) {
+        ok = false;
+        continue;
+      }
+      for (uint32_t j = 0; j < count; j++) {
+        char label[512];
+        snprintf(label, sizeof(label), "%s:%u", argv[i], examples[j].line);
+        add_document(&context, label, examples[j].input, examples[j].input_length);
+      }
+      tool_free_corpus(examples, count);
+    } else {
+      size_t length;
+      char *source = tool_read_file(argv[i], &length);
+      if (!source) {
+        ok = false;
+        continue;
+      }
+      add_document(&context, argv[i], source, (uint32_t)length);
+      free(source);
+    }
+  }
+
+  uint32_t kind_count = ts_asciidoc_stats_kind_count(context.stats);
+  TSAsciidocKindStats *kinds = malloc(kind_count * sizeof(TSAsciidocKindStats));
+  for (uint32_t i = 0; i < kind_count; i++) {
+    kinds[i] = ts_asciidoc_stats_kind(context.stats, i);
+  }
+  qsort(kinds, kind_count, sizeof(TSAsciidocKindStats), compare_memory);
+  qsort(context.documents, context.count, sizeof(Document), compare_density);
+  if (top > context.count) {
+    top = context.count;
+  }
+  TSAsciidocTreeStats totals = ts_asciidoc_stats_totals(context.stats);
+  if (json) {
+    print_json(kinds, kind_count, &totals, context.documents, context.count, top);
+  } else {
+    print_text(kinds, kind_count, &totals, context.documents, top);
+  }
+
+  for (uint32_t i = 0; i < context.count; i++) {
+    free(context.documents[i].label);
+  }
+  free(context.documents);
+  free(kinds);
+  ts_asciidoc_stats_delete(context.stats);
+  ts_parser_delete(context.parser);
+  return ok ? 0 : 1;
+}
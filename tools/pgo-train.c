@@ -0,0 +1,87 @@
+// Training run for the profile-guided release build.
+//
+// Parses each input --iterations times so that an instrumented parser
+// library records where a parse spends its time. Files ending in `.txt` are
+// read as test/corpus files and each example input is parsed on its own;
+// any other file is parsed whole. Prints the number of documents and bytes
+// parsed; the profile itself is written by the instrumentation at exit.
+//
+// Usage: pgo-train [--iterations N] file...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+static uint64_t parse(TSParser *parser, const char *source, uint32_t length,
+                      unsigned iterations) {
+  for (unsigned i = 0; i < iterations; i++) {
+    ts_tree_delete(ts_parser_parse_string(parser, NULL, source, length));
+  }
+  return (uint64_t)length * iterations;
+}
+
+static bool is_corpus(const char *path) {
+  size_t length = strlen(path);
+  return length > 4 && strcmp(path + length - 4, ".txt") == 0;
+}
+
+int main(int argc, char **argv) {
+  unsigned iterations = 5;
+
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "--iterations") == 0 && first + 1 < argc) {
+      int value = atoi(argv[++first]);
+      iterations = value > 0 ? (unsigned)value : 1;
+    } else {
+      break;
+    }
+  }
+  if (first >= argc) {
+    fputs("usage: pgo-train [--iterations N] file...\n", stderr);
+    return 2;
+  }
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+  uint64_t documents = 0, bytes = 0;
+  bool ok = true;
+  for (int i = first; i < argc; i++) {
+    if (is_corpus(argv[i])) {
+      uint32_t count;
+      ToolCorpusExample *examples = tool_read_corpus(argv[i], &count);
+      if (!examples) {
+        ok = false;
+        continue;
+      }
+      for (uint32_t j = 0; j < count; j++) {
+        bytes += parse(parser, examples[j].input, examples[j].input_length, iterations);
+      }
+      documents += count;
+      tool_free_corpus(examples, count);
+    } else {
+      size_t length;
+      char *source = tool_read_file(argv[i], &length);
+      if (!source) {
+        ok = false;
+        continue;
+      }
+      bytes += parse(parser, source, (uint32_t)length, iterations);
+      documents++;
+      free(source);
+    }
+  }
+  ts_parser_delete(parser);
+
+  printf("trained on %llu documents, %.1f MB parsed\n", (unsigned long long)documents,
+         bytes / 1e6);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+// Request latency with and without TSAsciidocPool.
+//
+// Simulates a service that parses a document and runs a query over it per
+// request, on several threads at once. Each request is served twice over:
+// once creating a parser, compiling the query and creating a cursor for the
+// request alone ("fresh"), and once with a lease from a TSAsciidocPool and
+// the query the pool compiled at startup ("pooled"). Reports requests per
+// second and the median and 99th percentile latency of both, and the pool's
+// counters.
+//
+// Usage: pool-bench [--threads N] [--requests N] [--query FILE] [--json] file
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-pool.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+typedef struct {
+  const char *source;
+  uint32_t length;
+  const char *query_source;
+  uint32_t query_length;
+  TSAsciidocPool *pool;
+  bool pooled;
+  uint32_t requests;
+} Shared;
+
+typedef struct {
+  const Shared *shared;
+  uint64_t *latencies;
+  uint64_t matches;
+} Thread;
+
+static uint64_t run_query(TSQueryCursor *cursor, const TSQuery *query, const TSTree *tree) {
+  uint64_t matches = 0;
+  TSQueryMatch match;
+  ts_query_cursor_exec(cursor, query, ts_tree_root_node(tree));
+  while (ts_query_cursor_next_match(cursor, &match)) {
+    matches++;
+  }
+  return matches;
+}
+
+static uint64_t fresh_request(const Shared *shared) {
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+  uint32_t error_offset;
+  TSQueryError error_type;
+  TSQuery *query = ts_query_new(tree_sitter_asciidoc(), shared->query_source,
+                                shared->query_length, &error_offset, &error_type);
+  TSQueryCursor *cursor = ts_query_cursor_new();
+  TSTree *tree = ts_parser_parse_string(parser, NULL, shared->source, shared->length);
+  uint64_t matches = run_query(cursor, query, tree);
+  ts_tree_delete(tree);
+  ts_query_cursor_delete(cursor);
+  ts_query_delete(query);
+  ts_parser_delete(parser);
+  return matches;
+}
+
+static uint64_t pooled_request(const Shared *shared) {
+  TSAsciidocLease *lease = ts_asciidoc_pool_checkout(shared->pool);
+  TSTree *tree = ts_asciidoc_lease_parse_string(lease, NULL, shared->source, shared->length);
+  uint64_t matches = run_query(ts_asciidoc_lease_cursor(lease),
+                               ts_asciidoc_pool_query(shared->pool, "bench"), tree);
+  ts_tree_delete(tree);
+  ts_asciidoc_pool_return(shared->pool, lease);
+  return matches;
+}
+
+static void *thread_main(void *payload) {
+  Thread *thread = payload;
+  const Shared *shared = thread->shared;
+  for (uint32_t i = 0; i < shared->requests; i++) {
+    uint64_t begin = tool_now_ns();
+    thread->matches += shared->pooled ? pooled_request(shared) : fresh_request(shared);
+    thread->latencies[i] = tool_now_ns() - begin;
+  }
+  return NULL;
+}
+
+static int compare_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return (x > y) - (x < y);
+}
+
+typedef struct {
+  double requests_per_s;
+  double p50_us;
+  double p99_us;
+  uint64_t matches;
+} Result;
+
+static Result run(Shared *shared, uint32_t thread_count) {
+  Thread *threads = calloc(thread_count, sizeof(Thread));
+  pthread_t *handles = calloc(thread_count, sizeof(pthread_t));
+  uint64_t *latencies = calloc((size_t)thread_count * shared->requests, sizeof(uint64_t));
+  for (uint32_t i = 0; i < thread_count; i++) {
+    threads[i].shared = shared;
+    threads[i].latencies = latencies + (size_t)i * shared->requests;
+  }
+
+  uint64_t begin = tool_now_ns();
+  uint32_t started = 0;
+  while (started < thread_count &&
+         pthread_create(&handles[started], NULL, thread_main, &threads[started]) == 0) {
+    started++;
+  }
+  Result result = {0};
+  for (uint32_t i = 0; i < started; i++) {
+    pthread_join(handles[i], NULL);
+    result.matches += threads[i].matches;
+  }
+  uint64_t elapsed = tool_now_ns() - begin;
+
+  size_t count = (size_t)started * shared->requests;
+  if (count > 0) {
+    qsort(latencies, count, sizeof(uint64_t), compare_u64);
+    result.requests_per_s = count / (elapsed / 1e9);
+    result.p50_us = latencies[count / 2] / 1e3;
+    result.p99_us = latencies[count * 99 / 100] / 1e3;
+  }
+  free(latencies);
+  free(handles);
+  free(threads);
+  return result;
+}
+
+int main(int argc, char **argv) {
+  uint32_t thread_count = 4;
+  uint32_t requests = 2000;
+  const char *query_path = "queries/highlights.scm";
+  bool json = false;
+
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "--threads") == 0 && first + 1 < argc) {
+      int value = atoi(argv[++first]);
+      thread_count = value > 0 ? (uint32_t)value : 1;
+    } else if (strcmp(argv[first], "--requests") == 0 && first + 1 < argc) {
+      int value = atoi(argv[++first]);
+      requests = value > 0 ? (uint32_t)value : 1;
+    } else if (strcmp(argv[first], "--query") == 0 && first + 1 < argc) {
+      query_path = argv[++first];
+    } else if (strcmp(argv[first], "--json") == 0) {
+      json = true;
+    } else {
+      break;
+    }
+  }
+  if (first + 1 != argc) {
+    fputs("usage: pool-bench [--threads N] [--requests N] [--query FILE] [--json] file\n",
+          stderr);
+    return 2;
+  }
+
+  size_t length, query_length;
+  char *source = tool_read_file(argv[first], &length);
+  char *query_source = tool_read_file(query_path, &query_length);
+  if (!source || !query_source) {
+    free(source);
+    free(query_source);
+    return 1;
+  }
+
+  Shared shared = {
+    .source = source,
+    .length = (uint32_t)length,
+    .query_source = query_source,
+    .query_length = (uint32_t)query_length,
+    .pool = ts_asciidoc_pool_new(),
+    .requests = requests,
+  };
+  uint32_t error_offset;
+  TSQueryError error_type;
+  if (!ts_asciidoc_pool_add_query(shared.pool, "bench", query_source, (uint32_t)query_length,
+                                  &error_offset, &error_type)) {
+    fprintf(stderr, "%s: query error %d at byte %u\n", query_path, (int)error_type,
+            error_offset);
+    ts_asciidoc_pool_delete(shared.pool);
+    free(source);
+    free(query_source);
+    return 1;
+  }
+
+  Result fresh = run(&shared, thread_count);
+  shared.pooled = true;
+  Result pooled = run(&shared, thread_count);
+  TSAsciidocPoolStats stats = ts_asciidoc_pool_stats(shared.pool);
+  bool ok = fresh.matches == pooled.matches;
+
+  if (json) {
+    printf("{\"bytes\": %zu, \"threads\": %u, \"requests\": %u, "
+           "\"fresh\": {\"requests_per_s\": %.0f, \"p50_us\": %.1f, \"p99_us\": %.1f}, "
+           "\"pooled\": {\"requests_per_s\": %.0f, \"p50_us\": %.1f, \"p99_us\": %.1f}, "
+           "\"created\": %llu, \"reused\": %llu, \"discarded\": %llu}\n",
+           length, thread_count, requests, fresh.requests_per_s, fresh.p50_us, fresh.p99_us,
+           pooled.requests_per_s, pooled.p50_us, pooled.p99_us,
+           (unsigned long long)stats.created, (unsigned long long)stats.reused,
+           (unsigned long long)stats.discarded);
+  } else {
+    printf("%zu bytes, %u threads x %u requests\n", length, thread_count, requests);
+    printf("%-8s %12s %10s %10s\n", "", "requests/s", "p50 us", "p99 us");
+    printf("%-8s %12.0f %10.1f %10.1f\n", "fresh", fresh.requests_per_s, fresh.p50_us,
+           fresh.p99_us);
+    printf("%-8s %12.0f %10.1f %10.1f\n", "pooled", pooled.requests_per_s, pooled.p50_us,
+           pooled.p99_us);
+    printf("pool: %llu leases created, %llu checkouts reused one, %llu discarded\n",
+           (unsigned long long)stats.created, (unsigned long long)stats.reused,
+           (unsigned long long)stats.discarded);
+  }
+  if (!ok) {
+    fprintf(stderr, "pool-bench: pooled requests found %llu matches, fresh ones %llu\n",
+            (unsigned long long)pooled.matches, (unsigned long long)fresh.matches);
+  }
+
+  ts_asciidoc_pool_delete(shared.pool);
+  free(source);
+  free(query_source);
+  return ok ? 0 : 1;
+}
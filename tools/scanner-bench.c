@@ -0,0 +1,439 @@
+// External scanner microbenchmark.
+//
+// Drives src/scanner.c through an in-memory mock TSLexer, with no parser or
+// runtime involved. Each scan routine is called directly on a set of
+// representative line starts, under every one of the 8192 `valid_symbols`
+// combinations, and so is the `tree_sitter_asciidoc_external_scanner_scan`
+// entry point. The combinations cover the twelve marker symbols, each with
+// and without the openers of unclosed delimited blocks. For each it reports:
+//
+//   ns/call      mean time per call, including the mock lexer reset
+//   accept       share of calls that produced a token
+//   B/token      mean token length in bytes for accepted calls
+//   waste        share of calls that read ahead and then returned false
+//   B/waste      mean bytes read ahead by those calls
+//
+// A scanner that returns a token the parser did not ask for is a bug; such
+// calls are counted as violations and make the tool exit non-zero. So does a
+// fence case below that the scanner opens or bounds differently than
+// expected. The bench builds the scanner with an 8-line fence budget so the
+// cases can reach it.
+//
+// Usage: scanner-bench [--iterations N] [--json]
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ASCIIDOC_FENCE_LINE_BUDGET 8
+#include "../src/scanner.c"
+
+#define SYMBOL_COUNT (_ERROR_SENTINEL + 1)
+#define MARKER_SYMBOL_COUNT (_HIGHLIGHT_CLOSE + 1)
+// One more bit toggles the _UNCLOSED_*_OPEN symbols together.
+#define MASK_COUNT (1u << (MARKER_SYMBOL_COUNT + 1))
+
+typedef struct {
+  TSLexer lexer;
+  const char *input;
+  uint32_t length;
+  uint32_t position;
+  uint32_t lookahead_size;
+  uint32_t token_start;
+  uint32_t token_end;
+  uint32_t column;
+  bool marked;
+} MockLexer;
+
+static void mock_decode(MockLexer *self) {
+  if (self->position >= self->length) {
+    self->lexer.lookahead = 0;
+    self->lookahead_size = 0;
+    return;
+  }
+
+  const unsigned char *s = (const unsigned char *)self->input + self->position;
+  uint32_t available = self->length - self->position;
+  uint32_t size = s[0] < 0x80 ? 1 : s[0] < 0xe0 ? 2 : s[0] < 0xf0 ? 3 : 4;
+  if (s[0] < 0x80 || size > available || (s[0] & 0xc0) == 0x80) {
+    self->lexer.lookahead = s[0] < 0x80 ? s[0] : 0xfffd;
+    self->lookahead_size = 1;
+    return;
+  }
+
+  int32_t c = s[0] & (0x7f >> size);
+  for (uint32_t i = 1; i < size; i++) {
+    c = (c << 6) | (s[i] & 0x3f);
+  }
+  self->lexer.lookahead = c;
+  self->lookahead_size = size;
+}
+
+// Mirrors the runtime lexer: skipping moves the token start past the
+// skipped character, and columns count characters.
+static void mock_advance(TSLexer *lexer, bool skip) {
+  MockLexer *self = (MockLexer *)lexer;
+  if (self->position >= self->length) {
+    return;
+  }
+
+  self->column = lexer->lookahead == '\n' ? 0 : self->column + 1;
+  self->position += self->lookahead_size;
+  if (skip) {
+    self->token_start = self->position;
+  }
+  mock_decode(self);
+}
+
+static void mock_mark_end(TSLexer *lexer) {
+  MockLexer *self = (MockLexer *)lexer;
+  self->token_end = self->position;
+  self->marked = true;
+}
+
+static uint32_t mock_get_column(TSLexer *lexer) { return ((MockLexer *)lexer)->column; }
+
+static bool mock_is_at_included_range_start(const TSLexer *lexer) {
+  (void)lexer;
+  return false;
+}
+
+static bool mock_eof(const TSLexer *lexer) {
+  const MockLexer *self = (const MockLexer *)lexer;
+  return self->position >= self->length;
+}
+
+static void mock_log(const TSLexer *lexer, const char *format, ...) {
+  (void)lexer;
+  (void)format;
+}
+
+static void mock_reset(MockLexer *self, const char *input, uint32_t column) {
+  self->input = input;
+  self->length = (uint32_t)strlen(input);
+  self->position = 0;
+  self->token_start = 0;
+  self->token_end = 0;
+  self->column = column;
+  self->marked = false;
+  self->lexer.result_symbol = UINT16_MAX;
+  mock_decode(self);
+}
+
+// Length of the token the runtime would produce after an accepting call.
+static uint32_t mock_token_length(const MockLexer *self) {
+  uint32_t end = self->marked ? self->token_end : self->position;
+  return end - self->token_start;
+}
+
+typedef struct {
+  const char *text;
+  uint32_t column;
+} Sample;
+
+typedef bool (*ScanFunction)(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols,
+                             unsigned indent);
+
+typedef struct {
+  const char *name;
+  ScanFunction scan;
+  // Routines called after the entry point has skipped the indentation.
+  bool skips_indent;
+  const Sample *samples;
+} Routine;
+
+typedef struct {
+  uint64_t calls;
+  uint64_t accepted;
+  uint64_t token_bytes;
+  uint64_t wasted;
+  uint64_t wasted_bytes;
+  uint64_t violations;
+  uint64_t elapsed_ns;
+} RoutineStats;
+
+static bool run_ordered_list_marker(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols,
+                                    unsigned indent) {
+  (void)scanner;
+  return scan_ordered_list_marker(lexer, valid_symbols, indent);
+}
+
+static bool run_block_quote_marker(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols,
+                                   unsigned indent) {
+  (void)scanner;
+  return scan_block_quote_marker(lexer, valid_symbols, indent);
+}
+
+static bool run_hash_marker(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols,
+                            unsigned indent) {
+  (void)scanner;
+  (void)indent;
+  return scan_hash_marker(lexer, valid_symbols);
+}
+
+static bool run_entry_point(Scanner *scanner, TSLexer *lexer, const bool *valid_symbols,
+                            unsigned indent) {
+  (void)indent;
+  return tree_sitter_asciidoc_external_scanner_scan(scanner, lexer, valid_symbols);
+}
+
+static const Sample UNORDERED_SAMPLES[] = {
+  {"* item\n", 0}, {"** nested item\n", 0}, {"***** deep\n", 0}, {"- item\n", 0},
+  {"  * indented\n", 0}, {"'''\n", 0}, {"***\n", 0}, {"___\r\n", 0}, {"* * *\n", 0},
+  {"*bold* text\n", 0}, {"--\n", 0}, {"----\n", 0}, {"-- \n", 0}, {"____\n", 0},
+  {"''quoted''\n", 0}, {"----\ncode\n----\n", 0}, {"----\nopen\n== Next\n", 0},
+  {"____\nquote\n", 0}, {NULL, 0},
+};
+
+static const Sample ORDERED_SAMPLES[] = {
+  {"1. item\n", 0}, {"10. item\n", 0}, {"  2. indented\n", 0}, {"1.5 release\n", 0},
+  {"2024 was\n", 0}, {"12.\n", 0}, {"3.\titem\n", 0}, {NULL, 0},
+};
+
+static const Sample BLOCK_QUOTE_SAMPLES[] = {
+  {"> quote\n", 0}, {">> nested\n", 0}, {">no space\n", 0}, {"    > code\n", 0}, {NULL, 0},
+};
+
+static const Sample DOT_SAMPLES[] = {
+  {". item\n", 0}, {".. nested\n", 0}, {"  . indented\n", 0}, {".Block title\n", 0},
+  {".Title at eof", 0}, {"...\n", 0}, {".\n", 0}, {".5 percent\n", 0}, {"....\n", 0},
+  {"....\nliteral\n....\n", 0}, {NULL, 0},
+};
+
+static const Sample LIST_CONTINUATION_SAMPLES[] = {
+  {"+\n", 0}, {"+ \r\n", 0}, {"+", 0}, {"++\n", 0}, {"+1 vote\n", 0}, {"+++ passthrough +++\n", 0},
+  {"++++\n<br>\n", 0}, {NULL, 0},
+};
+
+static const Sample TABLE_FENCE_SAMPLES[] = {
+  {"|===\n|a |b\n|===\n", 0}, {"|===\n|a |b\n\n== Next\n", 0}, {"||===\n", 0}, {"| cell\n", 0},
+  {"|==\n", 0}, {NULL, 0},
+};
+
+static const Sample HASH_SAMPLES[] = {
+  {"#highlight# text\n", 0}, {"#a \\# b# text\n", 0}, {"# not a heading\n", 0}, {"#no close\n", 0},
+  {"#", 0}, {"#\n", 0}, {"#tag", 4}, {NULL, 0},
+};
+
+// Line starts and mid-line positions as the parser presents them.
+static const Sample ENTRY_SAMPLES[] = {
+  {"* item\n", 0}, {"1. item\n", 0}, {"> quote\n", 0}, {". item\n", 0}, {".Block title\n", 0},
+  {"+\n", 0}, {"'''\n", 0}, {"#highlight# text\n", 0}, {"Plain paragraph text\n", 0},
+  {"== Section\n", 0}, {"----\n", 0}, {"|===\n", 0}, {"    indented literal\n", 0}, {"\n", 0},
+  {". and more\n", 12}, {"#mark# here\n", 5}, {"* not a marker\n", 3}, {NULL, 0},
+};
+
+static const Routine ROUTINES[] = {
+  {"scan_unordered_or_thematic", scan_unordered_or_thematic, true, UNORDERED_SAMPLES},
+  {"scan_ordered_list_marker", run_ordered_list_marker, true, ORDERED_SAMPLES},
+  {"scan_block_quote_marker", run_block_quote_marker, true, BLOCK_QUOTE_SAMPLES},
+  {"scan_dot_marker", scan_dot_marker, true, DOT_SAMPLES},
+  {"scan_list_continuation", scan_list_continuation, true, LIST_CONTINUATION_SAMPLES},
+  {"scan_table_fence", scan_table_fence, true, TABLE_FENCE_SAMPLES},
+  {"scan_hash_marker", run_hash_marker, false, HASH_SAMPLES},
+  {"external_scanner_scan", run_entry_point, false, ENTRY_SAMPLES},
+};
+
+#define ROUTINE_COUNT (sizeof(ROUTINES) / sizeof(ROUTINES[0]))
+
+typedef struct {
+  const char *text;
+  // Body lines of the unclosed block, or -1 for a fence the scanner leaves
+  // to the grammar because it is closed.
+  int32_t lines;
+} FenceCase;
+
+static const FenceCase FENCE_CASES[] = {
+  {.text = "----\ncode\n----\n", .lines = -1},
+  {.text = "----\ntext\n\n== Next\n\nmore\n", .lines = 2},
+  {.text = "----\nopen\nno line ending", .lines = 1},
+  {.text = "----\n= Doc\n\n== Section\ntext\n----\n", .lines = -1},
+  {.text = "----\ntext\n\n== Next\n\n[source,c]\n----\ncode\n----\n", .lines = 2},
+  {.text = "----\ntext\n\n== Next\n\n----\ncode\n----\n", .lines = 2},
+  {.text = "----\n1\n2\n3\n4\n5\n6\n7\n----\n", .lines = -1},
+  {.text = "----\n1\n2\n3\n4\n5\n6\n7\n8\n----\n", .lines = 8},
+  {.text = "----\n1\n2\n3\n4\n5\n== Next\n7\n8\n", .lines = 5},
+  {.text = "____\nquote\n\n== Next\nmore\n____\n", .lines = -1},
+  {.text = "|===\n|a |b\n\n== Next\n\n.Title\n|===\n|c\n|===\n", .lines = 2},
+  {.text = "....\nliteral\n  \n== Next\n....\n", .lines = -1},
+  {.text = "++++\n<br>\n== Next\n\n++++\n", .lines = 1},
+};
+
+#define FENCE_CASE_COUNT (sizeof(FENCE_CASES) / sizeof(FENCE_CASES[0]))
+
+static MockLexer mock = {
+  .lexer =
+    {
+      .advance = mock_advance,
+      .mark_end = mock_mark_end,
+      .get_column = mock_get_column,
+      .is_at_included_range_start = mock_is_at_included_range_start,
+      .eof = mock_eof,
+      .log = mock_log,
+    },
+};
+
+static Scanner scanner;
+
+static bool valid_symbols[MASK_COUNT][SYMBOL_COUNT];
+
+static void init_valid_symbols(void) {
+  for (uint32_t mask = 0; mask < MASK_COUNT; mask++) {
+    for (unsigned symbol = 0; symbol < MARKER_SYMBOL_COUNT; symbol++) {
+      valid_symbols[mask][symbol] = mask & (1u << symbol);
+    }
+    for (unsigned symbol = _UNCLOSED_LISTING_OPEN; symbol <= _UNCLOSED_TABLE_OPEN; symbol++) {
+      valid_symbols[mask][symbol] = mask & (1u << MARKER_SYMBOL_COUNT);
+    }
+  }
+}
+
+// Positions the lexer the way the entry point does before dispatching to a
+// routine: indentation skipped and counted.
+static unsigned prepare(const Routine *routine, const Sample *sample) {
+  mock_reset(&mock, sample->text, sample->column);
+  scanner.unclosed_lines = 0;
+  unsigned indent = 0;
+  if (routine->skips_indent) {
+    while (mock.lexer.lookahead == ' ' || mock.lexer.lookahead == '\t') {
+      mock_advance(&mock.lexer, true);
+      indent++;
+    }
+  }
+  return indent;
+}
+
+static void measure_routine(const Routine *routine, unsigned iterations, RoutineStats *stats) {
+  // Untimed pass collecting token sizes, read-ahead waste and violations.
+  for (const Sample *sample = routine->samples; sample->text; sample++) {
+    for (uint32_t mask = 0; mask < MASK_COUNT; mask++) {
+      unsigned indent = prepare(routine, sample);
+      uint32_t start = mock.position;
+      bool accepted = routine->scan(&scanner, &mock.lexer, valid_symbols[mask], indent);
+
+      stats->calls++;
+      if (accepted) {
+        stats->accepted++;
+        stats->token_bytes += mock_token_length(&mock);
+        TSSymbol symbol = mock.lexer.result_symbol;
+        if (symbol >= SYMBOL_COUNT || !valid_symbols[mask][symbol]) {
+          if (stats->violations++ == 0) {
+            fprintf(stderr, "%s: returned symbol %u not in valid_symbols 0x%04x for \"%s\"\n",
+                    routine->name, symbol, mask, sample->text);
+          }
+        }
+      } else if (mock.position > start) {
+        stats->wasted++;
+        stats->wasted_bytes += mock.position - start;
+      }
+    }
+  }
+
+  volatile unsigned sink = 0;
+  uint64_t begin = tool_now_ns();
+  for (unsigned i = 0; i < iterations; i++) {
+    for (const Sample *sample = routine->samples; sample->text; sample++) {
+      for (uint32_t mask = 0; mask < MASK_COUNT; mask++) {
+        unsigned indent = prepare(routine, sample);
+        sink += routine->scan(&scanner, &mock.lexer, valid_symbols[mask], indent);
+      }
+    }
+  }
+  stats->elapsed_ns = tool_now_ns() - begin;
+  (void)sink;
+}
+
+// Runs the entry point on each fence case with only the unclosed fence
+// openers valid and returns the number of cases it got wrong.
+static uint64_t check_fence_cases(void) {
+  const bool *valid = valid_symbols[1u << MARKER_SYMBOL_COUNT];
+  uint64_t failures = 0;
+  for (size_t i = 0; i < FENCE_CASE_COUNT; i++) {
+    const FenceCase *fence = &FENCE_CASES[i];
+    mock_reset(&mock, fence->text, 0);
+    scanner.unclosed_lines = 0;
+    bool accepted = tree_sitter_asciidoc_external_scanner_scan(&scanner, &mock.lexer, valid);
+    int32_t lines = accepted ? (int32_t)scanner.unclosed_lines : -1;
+    if (lines != fence->lines) {
+      fprintf(stderr, "fence case %zu: expected %d body lines, got %d for \"%s\"\n", i,
+              fence->lines, lines, fence->text);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+static double ratio(uint64_t numerator, uint64_t denominator) {
+  return denominator ? (double)numerator / (double)denominator : 0;
+}
+
+static void print_table(const RoutineStats *stats, unsigned iterations) {
+  printf("%-28s %8s %9s %8s %9s %8s %9s %10s\n", "routine", "calls", "ns/call", "accept",
+         "B/token", "waste", "B/waste", "violations");
+  for (size_t i = 0; i < ROUTINE_COUNT; i++) {
+    const RoutineStats *s = &stats[i];
+    printf("%-28s %8llu %9.2f %7.1f%% %9.2f %7.1f%% %9.2f %10llu\n", ROUTINES[i].name,
+           (unsigned long long)s->calls, ratio(s->elapsed_ns, s->calls * iterations),
+           100 * ratio(s->accepted, s->calls), ratio(s->token_bytes, s->accepted),
+           100 * ratio(s->wasted, s->calls), ratio(s->wasted_bytes, s->wasted),
+           (unsigned long long)s->violations);
+  }
+}
+
+static void print_json(const RoutineStats *stats, unsigned iterations) {
+  printf("{\n  \"valid_symbol_combinations\": %u,\n  \"iterations\": %u,\n  \"routines\": [\n",
+         MASK_COUNT, iterations);
+  for (size_t i = 0; i < ROUTINE_COUNT; i++) {
+    const RoutineStats *s = &stats[i];
+    printf("    {\"routine\": ");
+    tool_json_string(stdout, ROUTINES[i].name);
+    printf(", \"calls\": %llu, \"ns_per_call\": %.3f, \"accepted\": %llu, "
+           "\"bytes_per_token\": %.3f, \"wasted\": %llu, \"waste_rate\": %.4f, "
+           "\"bytes_per_waste\": %.3f, \"violations\": %llu}%s\n",
+           (unsigned long long)s->calls, ratio(s->elapsed_ns, s->calls * iterations),
+           (unsigned long long)s->accepted, ratio(s->token_bytes, s->accepted),
+           (unsigned long long)s->wasted, ratio(s->wasted, s->calls),
+           ratio(s->wasted_bytes, s->wasted), (unsigned long long)s->violations,
+           i + 1 < ROUTINE_COUNT ? "," : "");
+  }
+  printf("  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+  unsigned iterations = 50;
+  bool json = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      iterations = (unsigned)atoi(argv[++i]);
+      if (iterations == 0) {
+        iterations = 1;
+      }
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else {
+      fputs("usage: scanner-bench [--iterations N] [--json]\n", stderr);
+      return 2;
+    }
+  }
+
+  init_valid_symbols();
+
+  RoutineStats stats[ROUTINE_COUNT] = {0};
+  uint64_t violations = check_fence_cases();
+  for (size_t i = 0; i < ROUTINE_COUNT; i++) {
+    measure_routine(&ROUTINES[i], iterations, &stats[i]);
+    violations += stats[i].violations;
+  }
+
+  if (json) {
+    print_json(stats, iterations);
+  } else {
+    print_table(stats, iterations);
+  }
+  return violations ? 1 : 0;
+}
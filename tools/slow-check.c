@@ -0,0 +1,92 @@
+// Time assertions for the slow-input fixtures.
+//
+// Parses each file with the measure the fuzzer uses (fuzz/slow.h), best of
+// three, and fails if any is still slow: more than --ns-per-byte per byte,
+// or a growth exponent above --max-exponent when the file is repeated
+// --repeat times. test/slow holds the fixtures, each an input that once was
+// slow or one aimed at a scanner routine or token that could be, so that
+// `make test-slow` catches the regression if it ever is again.
+//
+// Usage: slow-check [--ns-per-byte N] [--max-exponent X] [--repeat N] [--json] file...
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+
+#include "../fuzz/slow.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+int main(int argc, char **argv) {
+  SlowLimits limits = slow_default_limits();
+  limits.runs = 3;
+  bool json = false;
+
+  int first = 1;
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "--ns-per-byte") == 0 && first + 1 < argc) {
+      limits.max_ns_per_byte = atof(argv[++first]);
+    } else if (strcmp(argv[first], "--max-exponent") == 0 && first + 1 < argc) {
+      limits.max_exponent = atof(argv[++first]);
+    } else if (strcmp(argv[first], "--repeat") == 0 && first + 1 < argc) {
+      limits.repeat = (uint32_t)atoi(argv[++first]);
+    } else if (strcmp(argv[first], "--json") == 0) {
+      json = true;
+    } else {
+      break;
+    }
+  }
+  if (first >= argc) {
+    fputs("usage: slow-check [--ns-per-byte N] [--max-exponent X] [--repeat N] [--json] "
+          "file...\n",
+          stderr);
+    return 2;
+  }
+
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+  if (!json) {
+    printf("%-40s %9s %10s %9s %9s\n", "file", "bytes", "parse us", "ns/byte", "exponent");
+  }
+
+  unsigned failures = 0;
+  for (int i = first; i < argc; i++) {
+    size_t length;
+    char *source = tool_read_file(argv[i], &length);
+    if (!source) {
+      failures++;
+      continue;
+    }
+    SlowMeasurement measurement;
+    bool slow = slow_measure(parser, source, (uint32_t)length, &limits, &measurement);
+    free(source);
+    failures += slow;
+
+    const char *verdict = measurement.too_slow_per_byte ? "SLOW"
+                          : measurement.superlinear     ? "SUPERLINEAR"
+                                                        : "ok";
+    if (json) {
+      printf("{\"file\": ");
+      tool_json_string(stdout, argv[i]);
+      printf(", \"bytes\": %zu, \"parse_us\": %.1f, \"ns_per_byte\": %.1f, "
+             "\"repeated_us\": %.1f, \"exponent\": %.3f, \"verdict\": \"%s\"}\n",
+             length, measurement.ns / 1e3, measurement.ns_per_byte,
+             measurement.repeated_ns / 1e3, measurement.exponent, verdict);
+    } else {
+      printf("%-40s %9zu %10.1f %9.1f %9.2f %s\n", argv[i], length, measurement.ns / 1e3,
+             measurement.ns_per_byte, measurement.exponent, verdict);
+    }
+  }
+
+  if (failures > 0) {
+    fprintf(stderr, "slow-check: %u of %d files over the limits (%.0f ns/byte, exponent %.2f)\n",
+            failures, argc - first, limits.max_ns_per_byte, limits.max_exponent);
+  }
+  ts_parser_delete(parser);
+  return failures > 0 ? 1 : 0;
+}
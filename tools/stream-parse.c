@@ -0,0 +1,130 @@
+// Streaming parse of a document read from a pipe.
+//
+// Reads standard input (or a file) through TSAsciidocStream, which parses
+// the input a section at a time while it arrives and releases each section
+// once its blocks have been delivered. Prints a count of the top-level
+// blocks by kind, the number and largest size of the pieces parsed, the
+// most input buffered at once and the peak RSS, which follow the largest
+// section rather than the size of the input.
+//
+// --blocks prints each top-level block as it is delivered instead: its
+// kind, byte range and rows.
+//
+// Usage: gen-corpus --size 1G | stream-parse [--blocks] [--json] [file]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+#include <unistd.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-stream.h"
+
+#define MAX_KINDS 64
+
+typedef struct {
+  bool print_blocks;
+  const char *kinds[MAX_KINDS];
+  uint64_t counts[MAX_KINDS];
+  uint32_t kind_count;
+} Context;
+
+static void on_block(void *payload, TSAsciidocStream *stream, TSNode block) {
+  Context *context = payload;
+  const char *kind = ts_node_type(block);
+  if (context->print_blocks) {
+    uint64_t origin = ts_asciidoc_stream_origin(stream);
+    printf("%-24s %10llu %10llu %8u %8u%s\n", kind,
+           (unsigned long long)(origin + ts_node_start_byte(block)),
+           (unsigned long long)(origin + ts_node_end_byte(block)),
+           ts_node_start_point(block).row + 1, ts_node_end_point(block).row + 1,
+           ts_node_has_error(block) ? "  error" : "");
+    return;
+  }
+  // Node type names are static strings of the language.
+  uint32_t i = 0;
+  while (i < context->kind_count && context->kinds[i] != kind) {
+    i++;
+  }
+  if (i == context->kind_count) {
+    if (i == MAX_KINDS) {
+      return;
+    }
+    context->kinds[context->kind_count++] = kind;
+  }
+  context->counts[i]++;
+}
+
+int main(int argc, char **argv) {
+  Context context = {0};
+  bool json = false;
+  const char *path = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--blocks") == 0) {
+      context.print_blocks = true;
+    } else if (strcmp(argv[i], "--json") == 0) {
+      json = true;
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      fputs("usage: stream-parse [--blocks] [--json] [file]\n", stderr);
+      return 2;
+    }
+  }
+
+  int fd = STDIN_FILENO;
+  if (path) {
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      fprintf(stderr, "%s: %s\n", path, strerror(errno));
+      return 1;
+    }
+  }
+
+  TSAsciidocStream *stream = ts_asciidoc_stream_new(on_block, &context);
+  uint64_t begin = tool_now_ns();
+  bool ok = ts_asciidoc_stream_read_fd(stream, fd);
+  uint64_t elapsed = tool_now_ns() - begin;
+  if (!ok) {
+    fprintf(stderr, "%s: %s\n", path ? path : "stdin", strerror(errno));
+  }
+  if (path) {
+    close(fd);
+  }
+  TSAsciidocStreamStats stats = ts_asciidoc_stream_stats(stream);
+  ts_asciidoc_stream_delete(stream);
+
+  double seconds = elapsed / 1e9;
+  if (json) {
+    printf("{\"bytes\": %llu, \"ms\": %.3f, \"mb_per_s\": %.2f, \"segments\": %u, "
+           "\"largest_segment\": %u, \"blocks\": %u, \"error_blocks\": %u, "
+           "\"peak_buffered_bytes\": %llu, \"peak_rss_kb\": %ld, \"kinds\": {",
+           (unsigned long long)stats.bytes, elapsed / 1e6, stats.bytes / 1e6 / seconds,
+           stats.segments, stats.largest_segment, stats.blocks, stats.error_blocks,
+           (unsigned long long)stats.peak_buffered_bytes, tool_peak_rss_kb());
+    for (uint32_t i = 0; i < context.kind_count; i++) {
+      printf(i ? ", " : "");
+      tool_json_string(stdout, context.kinds[i]);
+      printf(": %llu", (unsigned long long)context.counts[i]);
+    }
+    printf("}}\n");
+  } else if (!context.print_blocks) {
+    for (uint32_t i = 0; i < context.kind_count; i++) {
+      printf("%-24s %10llu\n", context.kinds[i], (unsigned long long)context.counts[i]);
+    }
+    printf("\n%llu bytes in %.2f ms (%.1f MB/s)\n", (unsigned long long)stats.bytes,
+           elapsed / 1e6, stats.bytes / 1e6 / seconds);
+    printf("%u blocks (%u with errors) in %u pieces, largest piece %u bytes\n", stats.blocks,
+           stats.error_blocks, stats.segments, stats.largest_segment);
+    printf("peak buffered input %llu KiB, peak RSS %ld KiB\n",
+           (unsigned long long)stats.peak_buffered_bytes / 1024, tool_peak_rss_kb());
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+// Workspace anchor and attribute index.
+//
+// Builds and queries the index file described in
+// bindings/c/tree_sitter/tree-sitter-asciidoc-xref.h. `update` parses the
+// given documents and replaces their entries, or drops a document that no
+// longer exists, then saves the index. The query commands print one
+// `path:line:column: kind name` line per result and the lookup time on
+// stderr.
+//
+// Usage: xref-index INDEX update file...
+//        xref-index INDEX def|refs NAME [--attribute]
+//        xref-index INDEX complete PREFIX [--attribute] [--limit N]
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "common.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tree_sitter/api.h>
+#include <unistd.h>
+
+#include "tree_sitter/tree-sitter-asciidoc-xref.h"
+#include "tree_sitter/tree-sitter-asciidoc.h"
+
+static const char *const KIND_NAMES[] = {
+  "anchor", "bibliography", "attribute", "xref", "attribute-reference",
+};
+
+static int usage(void) {
+  fputs("usage: xref-index INDEX update file...\n"
+        "       xref-index INDEX def|refs NAME [--attribute]\n"
+        "       xref-index INDEX complete PREFIX [--attribute] [--limit N]\n",
+        stderr);
+  return 2;
+}
+
+static int update(TSAsciidocXrefIndex *index, const char *index_path, int count,
+                  char **paths) {
+  TSParser *parser = ts_parser_new();
+  ts_parser_set_language(parser, tree_sitter_asciidoc());
+  uint64_t start = tool_now_ns();
+  for (int i = 0; i < count; i++) {
+    if (access(paths[i], F_OK) != 0) {
+      ts_asciidoc_xref_index_update(index, paths[i], NULL, NULL);
+      continue;
+    }
+    size_t length;
+    char *source = tool_read_file(paths[i], &length);
+    if (!source) {
+      continue;
+    }
+    TSTree *tree = ts_parser_parse_string(parser, NULL, source, (uint32_t)length);
+    ts_asciidoc_xref_index_update(index, paths[i], tree, source);
+    ts_tree_delete(tree);
+    free(source);
+  }
+  ts_parser_delete(parser);
+
+  if (!ts_asciidoc_xref_index_save(index, index_path)) {
+    fprintf(stderr, "%s: %s\n", index_path, strerror(errno));
+    return 1;
+  }
+  fprintf(stderr, "%d documents updated, %u indexed, %.1f ms\n", count,
+          ts_asciidoc_xref_index_document_count(index),
+          (double)(tool_now_ns() - start) / 1e6);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 4) {
+    return usage();
+  }
+  const char *index_path = argv[1];
+  const char *command = argv[2];
+
+  TSAsciidocXrefIndex *index = ts_asciidoc_xref_index_open(index_path);
+  if (!index) {
+    if (strcmp(command, "update") != 0) {
+      fprintf(stderr, "%s: not an index file\n", index_path);
+      return 1;
+    }
+    index = ts_asciidoc_xref_index_new();
+  }
+
+  if (strcmp(command, "update") == 0) {
+    int status = update(index, index_path, argc - 3, argv + 3);
+    ts_asciidoc_xref_index_delete(index);
+    return status;
+  }
+
+  const char *name = argv[3];
+  TSAsciidocXrefNamespace name_space = TSAsciidocXrefLabel;
+  uint32_t limit = 50;
+  for (int i = 4; i < argc; i++) {
+    if (strcmp(argv[i], "--attribute") == 0) {
+      name_space = TSAsciidocXrefAttribute;
+    } else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+      limit = (uint32_t)atoi(argv[++i]);
+    } else {
+      ts_asciidoc_xref_index_delete(index);
+      return usage();
+    }
+  }
+
+  uint32_t length = (uint32_t)strlen(name);
+  uint32_t count;
+  const TSAsciidocXrefEntry *entries;
+  uint64_t start = tool_now_ns();
+  if (strcmp(command, "def") == 0) {
+    entries = ts_asciidoc_xref_definitions(index, name_space, name, length, &count);
+  } else if (strcmp(command, "refs") == 0) {
+    entries = ts_asciidoc_xref_references(index, name_space, name, length, &count);
+  } else if (strcmp(command, "complete") == 0) {
+    entries = ts_asciidoc_xref_complete(index, name_space, name, length, limit, &count);
+  } else {
+    ts_asciidoc_xref_index_delete(index);
+    return usage();
+  }
+  uint64_t elapsed = tool_now_ns() - start;
+
+  for (uint32_t i = 0; i < count; i++) {
+    printf("%s:%u:%u: %s %s\n", entries[i].path, entries[i].start_point.row + 1,
+           entries[i].start_point.column + 1, KIND_NAMES[entries[i].kind], entries[i].name);
+  }
+  fprintf(stderr, "%u results in %.1f us\n", count, (double)elapsed / 1e3);
+  ts_asciidoc_xref_index_delete(index);
+  return count > 0 ? 0 : 1;
+}